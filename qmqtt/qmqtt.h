@@ -34,5 +34,6 @@
 
 #include "qmqtt_message.h"
 #include "qmqtt_client.h"
+#include "qmqtt_topicdispatcher.h"
 
 #endif // QMQTT_H
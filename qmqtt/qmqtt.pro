@@ -24,10 +24,13 @@ HEADERS += qmqtt_global.h \
     qmqtt_timer_p.h \
     qmqtt_client.h \
     qmqtt_frame.h \
+    qmqtt_framebuffer_p.h \
+    qmqtt_framewriter_p.h \
     qmqtt_message.h \
     qmqtt_routesubscription.h \
     qmqtt_routedmessage.h \
     qmqtt_router.h \
+    qmqtt_topicdispatcher.h \
     qmqtt_networkinterface.h \
     qmqtt_socketinterface.h \
     qmqtt_timerinterface.h
@@ -36,12 +39,15 @@ SOURCES += \
     qmqtt_client_p.cpp \
     qmqtt_client.cpp \
     qmqtt_frame.cpp \
+    qmqtt_framebuffer.cpp \
+    qmqtt_framewriter.cpp \
     qmqtt_message.cpp \
     qmqtt_network.cpp \
     qmqtt_ssl_network.cpp \
     qmqtt_routesubscription.cpp \
     qmqtt_routedmessage.cpp \
     qmqtt_router.cpp \
+    qmqtt_topicdispatcher.cpp \
     qmqtt_message_p.cpp \
     qmqtt_socket.cpp \
     qmqtt_ssl_socket.cpp \
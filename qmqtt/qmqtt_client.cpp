@@ -257,6 +257,54 @@ QMQTT::ConnectionState QMQTT::Client::connectionState() const
     return d->connectionState();
 }
 
+int QMQTT::Client::retransmitInterval() const
+{
+    Q_D(const Client);
+    return d->retransmitInterval();
+}
+
+void QMQTT::Client::setRetransmitInterval(const int retransmitInterval)
+{
+    Q_D(Client);
+    d->setRetransmitInterval(retransmitInterval);
+}
+
+int QMQTT::Client::inflightCount() const
+{
+    Q_D(const Client);
+    return d->inflightCount();
+}
+
+quint64 QMQTT::Client::retransmitCount() const
+{
+    Q_D(const Client);
+    return d->retransmitCount();
+}
+
+qreal QMQTT::Client::retransmitRate() const
+{
+    Q_D(const Client);
+    return d->retransmitRate();
+}
+
+bool QMQTT::Client::writeBatching() const
+{
+    Q_D(const Client);
+    return d->writeBatching();
+}
+
+void QMQTT::Client::setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency)
+{
+    Q_D(Client);
+    d->setWriteBatching(enabled, maxBytes, maxLatency);
+}
+
+QMQTT::WriteStats QMQTT::Client::writeStats() const
+{
+    Q_D(const Client);
+    return d->writeStats();
+}
+
 bool QMQTT::Client::isConnectedToHost() const
 {
     Q_D(const Client);
@@ -299,6 +347,12 @@ void QMQTT::Client::onTimerPingReq()
     d->onTimerPingReq();
 }
 
+void QMQTT::Client::onTimerRetransmit()
+{
+    Q_D(Client);
+    d->onTimerRetransmit();
+}
+
 void QMQTT::Client::disconnectFromHost()
 {
     Q_D(Client);
@@ -33,6 +33,7 @@
 #define QMQTT_CLIENT_H
 
 #include "qmqtt_global.h"
+#include "qmqtt_networkinterface.h"
 
 #include <QObject>
 #include <QAbstractSocket>
@@ -114,6 +115,7 @@ class Q_MQTT_EXPORT Client : public QObject
     Q_PROPERTY(bool _willRetain READ willRetain WRITE setWillRetain)
     Q_PROPERTY(QString _willMessage READ willMessage WRITE setWillMessage)
     Q_PROPERTY(QString _connectionState READ connectionState)
+    Q_PROPERTY(int _retransmitInterval READ retransmitInterval WRITE setRetransmitInterval)
 
 public:
     Client(const QHostAddress& host = QHostAddress::LocalHost,
@@ -161,6 +163,17 @@ public:
     quint8 willQos() const;
     bool willRetain() const;
     QString willMessage() const;
+    int retransmitInterval() const;
+
+    // Number of QoS 1/2 publishes that have not yet been acknowledged by the broker
+    int inflightCount() const;
+    // Total number of retransmitted publishes since this client was created
+    quint64 retransmitCount() const;
+    // Retransmissions per second, measured over the last second in which messages were in flight
+    qreal retransmitRate() const;
+
+    bool writeBatching() const;
+    WriteStats writeStats() const;
 
     bool isConnectedToHost() const;
 
@@ -179,6 +192,12 @@ public Q_SLOTS:
     void setWillQos(const quint8 willQos);
     void setWillRetain(const bool willRetain);
     void setWillMessage(const QString& willMessage);
+    void setRetransmitInterval(const int retransmitInterval);
+
+    // Opt-in output batching. Frames are coalesced and written once the batch reaches
+    // maxBytes, or maxLatency ms after the first queued frame (0 = once per event loop
+    // iteration). TCP_NODELAY is enabled while batching.
+    void setWriteBatching(const bool enabled, const int maxBytes = 16384, const int maxLatency = 0);
 
     void connectToHost();
     void disconnectFromHost();
@@ -186,6 +205,8 @@ public Q_SLOTS:
     quint16 subscribe(const QString& topic, const quint8 qos);
     void unsubscribe(const QString& topic);
 
+    // QoS 1 and 2 messages are assigned a message id from the client's in-flight window,
+    // which is returned. If the window is full the message is queued and 0 is returned.
     quint16 publish(const Message& message);
 
 Q_SIGNALS:
@@ -197,8 +218,8 @@ Q_SIGNALS:
     void subscribed(const QString& topic);
     // todo: should emit on server unsuback (or is that only at specific QoS levels?)
     void unsubscribed(const QString& topic);
-    // todo: should emit on server puback (or is that only at specific QoS levels?)
-    void published(const QMQTT::Message& message);
+    // Emitted when a QoS 0 message is sent, on PUBACK for QoS 1 and on PUBCOMP for QoS 2
+    void published(const QMQTT::Message& message, quint16 msgid = 0);
 
     void received(const QMQTT::Message& message);
 
@@ -207,6 +228,7 @@ protected Q_SLOTS:
     void onNetworkDisconnected();
     void onNetworkReceived(const QMQTT::Frame& frame);
     void onTimerPingReq();
+    void onTimerRetransmit();
     void onNetworkError(QAbstractSocket::SocketError error);
 
 protected:
@@ -46,6 +46,18 @@ static const quint8 QOS0 = 0x00;
 static const quint8 QOS1 = 0x01;
 static const quint8 QOS2 = 0x02;
 
+static const int DEFAULT_RETRANSMIT_INTERVAL_MS = 2000;
+// The retransmit timer scans the in-flight table in batches at this interval
+static const int RETRANSMIT_SCAN_INTERVAL_MS = 250;
+static const int RETRANSMIT_RATE_WINDOW_MS = 1000;
+
+QMQTT::ClientPrivate::InflightMessage::InflightMessage()
+    : state(InflightFree)
+    , sentAt(0)
+    , retries(0)
+{
+}
+
 QMQTT::ClientPrivate::ClientPrivate(Client* qq_ptr)
     : _host(QHostAddress::LocalHost)
     , _port(1883)
@@ -56,8 +68,16 @@ QMQTT::ClientPrivate::ClientPrivate(Client* qq_ptr)
     , _connectionState(STATE_INIT)
     , _willQos(0)
     , _willRetain(false)
+    , _inflightCount(0)
+    , _retransmitInterval(DEFAULT_RETRANSMIT_INTERVAL_MS)
+    , _retransmitCount(0)
+    , _windowRetransmits(0)
+    , _rateWindowStart(0)
+    , _retransmitRate(0)
     , q_ptr(qq_ptr)
 {
+    _clock.start();
+    _retransmitTimer.setInterval(RETRANSMIT_SCAN_INTERVAL_MS);
 }
 
 QMQTT::ClientPrivate::~ClientPrivate()
@@ -126,6 +146,7 @@ void QMQTT::ClientPrivate::init(NetworkInterface* network)
     initializeErrorHash();
 
     QObject::connect(&_timer, &QTimer::timeout, q, &Client::onTimerPingReq);
+    QObject::connect(&_retransmitTimer, &QTimer::timeout, q, &Client::onTimerRetransmit);
     QObject::connect(_network.data(), &Network::connected,
                      q, &Client::onNetworkConnected);
     QObject::connect(_network.data(), &Network::disconnected,
@@ -256,7 +277,8 @@ quint16 QMQTT::ClientPrivate::sendPublish(const Message& msg)
 
 void QMQTT::ClientPrivate::sendPuback(const quint8 type, const quint16 mid)
 {
-    Frame frame(type);
+    // PUBREL is itself acknowledged, so it is sent at QoS 1
+    Frame frame(type == PUBREL ? SETQOS(PUBREL, QOS1) : type);
     frame.writeInt(mid);
     _network->sendFrame(frame);
 }
@@ -313,17 +335,167 @@ void QMQTT::ClientPrivate::stopKeepAlive()
 
 quint16 QMQTT::ClientPrivate::nextmid()
 {
+    // 0 is not a valid message id
+    if (_gmid == 0)
+    {
+        _gmid = 1;
+    }
     return _gmid++;
 }
 
+quint16 QMQTT::ClientPrivate::nextInflightMid()
+{
+    if (_inflightCount >= INFLIGHT_WINDOW_SIZE)
+    {
+        return 0;
+    }
+
+    // Ids are handed out sequentially, so a free slot is found within one window
+    forever
+    {
+        quint16 mid = nextmid();
+        if (_inflight[mid & (INFLIGHT_WINDOW_SIZE - 1)].state == InflightFree)
+        {
+            return mid;
+        }
+    }
+}
+
 quint16 QMQTT::ClientPrivate::publish(const Message& message)
 {
     Q_Q(Client);
-    quint16 msgid = sendPublish(message);
-    emit q->published(message);
+
+    if (message.qos() == QOS0)
+    {
+        quint16 msgid = sendPublish(message);
+        emit q->published(message, msgid);
+        return msgid;
+    }
+
+    quint16 msgid = nextInflightMid();
+    if (msgid == 0)
+    {
+        // In-flight window is full, this will be sent when a slot is acknowledged
+        qCWarning(client) << "In-flight window full, queueing publish to" << message.topic();
+        _pendingPublishes.enqueue(message);
+        return 0;
+    }
+    return publishInflight(message, msgid);
+}
+
+quint16 QMQTT::ClientPrivate::publishInflight(const Message& msg, const quint16 msgid)
+{
+    InflightMessage& entry = _inflight[msgid & (INFLIGHT_WINDOW_SIZE - 1)];
+    entry.message = msg;
+    entry.message.setId(msgid);
+    entry.message.setDup(false);
+    entry.state = msg.qos() == QOS1 ? InflightAwaitingPuback : InflightAwaitingPubrec;
+    entry.sentAt = _clock.elapsed();
+    entry.retries = 0;
+    _inflightCount++;
+
+    sendPublish(entry.message);
+
+    if (!_retransmitTimer.isActive())
+    {
+        _rateWindowStart = entry.sentAt;
+        _windowRetransmits = 0;
+        _retransmitTimer.start();
+    }
     return msgid;
 }
 
+void QMQTT::ClientPrivate::resendInflight(InflightMessage& entry, const qint64 now)
+{
+    if (entry.state == InflightAwaitingPubcomp)
+    {
+        sendPuback(PUBREL, entry.message.id());
+    }
+    else
+    {
+        entry.message.setDup(true);
+        sendPublish(entry.message);
+    }
+    entry.sentAt = now;
+    entry.retries++;
+    _retransmitCount++;
+    _windowRetransmits++;
+}
+
+void QMQTT::ClientPrivate::completeInflight(InflightMessage& entry)
+{
+    Q_Q(Client);
+
+    Message message(entry.message);
+    entry.message = Message();
+    entry.state = InflightFree;
+    _inflightCount--;
+
+    // Fill the freed slot from the queue before notifying, so the window stays full
+    if (!_pendingPublishes.isEmpty())
+    {
+        publishInflight(_pendingPublishes.head(), nextInflightMid());
+        _pendingPublishes.dequeue();
+    }
+    else if (_inflightCount == 0)
+    {
+        _retransmitTimer.stop();
+        _retransmitRate = 0;
+    }
+
+    emit q->published(message, message.id());
+}
+
+void QMQTT::ClientPrivate::onTimerRetransmit()
+{
+    qint64 now = _clock.elapsed();
+
+    // While disconnected everything in flight is resent after the next CONNACK
+    if (isConnectedToHost())
+    {
+        for (int i = 0; i < INFLIGHT_WINDOW_SIZE; ++i)
+        {
+            InflightMessage& entry = _inflight[i];
+            if ((entry.state != InflightFree) && (now - entry.sentAt >= _retransmitInterval))
+            {
+                resendInflight(entry, now);
+            }
+        }
+    }
+
+    if (now - _rateWindowStart >= RETRANSMIT_RATE_WINDOW_MS)
+    {
+        _retransmitRate = _windowRetransmits * 1000.0 / (now - _rateWindowStart);
+        _windowRetransmits = 0;
+        _rateWindowStart = now;
+    }
+}
+
+int QMQTT::ClientPrivate::inflightCount() const
+{
+    return _inflightCount;
+}
+
+quint64 QMQTT::ClientPrivate::retransmitCount() const
+{
+    return _retransmitCount;
+}
+
+qreal QMQTT::ClientPrivate::retransmitRate() const
+{
+    return _retransmitRate;
+}
+
+int QMQTT::ClientPrivate::retransmitInterval() const
+{
+    return _retransmitInterval;
+}
+
+void QMQTT::ClientPrivate::setRetransmitInterval(const int retransmitInterval)
+{
+    _retransmitInterval = retransmitInterval;
+}
+
 void QMQTT::ClientPrivate::puback(const quint8 type, const quint16 msgid)
 {
     sendPuback(type, msgid);
@@ -412,6 +584,17 @@ void QMQTT::ClientPrivate::handleConnack(const quint8 ack)
 {
     Q_Q(Client);
     Q_UNUSED(ack);
+
+    // Anything still unacknowledged may have been lost with the previous connection
+    qint64 now = _clock.elapsed();
+    for (int i = 0; i < INFLIGHT_WINDOW_SIZE; ++i)
+    {
+        if (_inflight[i].state != InflightFree)
+        {
+            resendInflight(_inflight[i], now);
+        }
+    }
+
     emit q->connected();
 }
 
@@ -432,15 +615,36 @@ void QMQTT::ClientPrivate::handlePublish(const Message& message)
 
 void QMQTT::ClientPrivate::handlePuback(const quint8 type, const quint16 msgid)
 {
-    if(type == PUBREC)
+    InflightMessage& entry = _inflight[msgid & (INFLIGHT_WINDOW_SIZE - 1)];
+    bool tracked = (entry.state != InflightFree) && (entry.message.id() == msgid);
+
+    if (type == PUBACK)
+    {
+        if (tracked && (entry.state == InflightAwaitingPuback))
+        {
+            completeInflight(entry);
+        }
+    }
+    else if(type == PUBREC)
     {
         sendPuback(PUBREL, msgid);
+        if (tracked && (entry.state == InflightAwaitingPubrec))
+        {
+            entry.state = InflightAwaitingPubcomp;
+            entry.sentAt = _clock.elapsed();
+        }
     }
     else if (type == PUBREL)
     {
         sendPuback(PUBCOMP, msgid);
     }
-    // todo: emit published signal (type? msgid?)
+    else if (type == PUBCOMP)
+    {
+        if (tracked && (entry.state == InflightAwaitingPubcomp))
+        {
+            completeInflight(entry);
+        }
+    }
 }
 
 bool QMQTT::ClientPrivate::autoReconnect() const
@@ -468,6 +672,21 @@ bool QMQTT::ClientPrivate::isConnectedToHost() const
     return _network->isConnectedToHost();
 }
 
+bool QMQTT::ClientPrivate::writeBatching() const
+{
+    return _network->writeBatching();
+}
+
+void QMQTT::ClientPrivate::setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency)
+{
+    _network->setWriteBatching(enabled, maxBytes, maxLatency);
+}
+
+QMQTT::WriteStats QMQTT::ClientPrivate::writeStats() const
+{
+    return _network->writeStats();
+}
+
 QMQTT::ConnectionState QMQTT::ClientPrivate::connectionState() const
 {
     return _connectionState;
@@ -36,7 +36,10 @@
 #include "qmqtt_client_p.h"
 #include "qmqtt_network_p.h"
 #include "qmqtt_ssl_network_p.h"
+#include "qmqtt_message.h"
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QQueue>
 
 #ifndef QT_NO_SSL
 QT_FORWARD_DECLARE_CLASS(QSslConfiguration)
@@ -44,9 +47,31 @@ QT_FORWARD_DECLARE_CLASS(QSslConfiguration)
 
 namespace QMQTT {
 
+// Maximum number of unacknowledged QoS 1/2 publishes per client. Must be a power of two,
+// since message ids are mapped onto slots of the in-flight table by their low bits.
+static const quint16 INFLIGHT_WINDOW_SIZE = 64;
+
 class ClientPrivate
 {
 public:
+    enum InflightState
+    {
+        InflightFree = 0,
+        InflightAwaitingPuback,
+        InflightAwaitingPubrec,
+        InflightAwaitingPubcomp
+    };
+
+    struct InflightMessage
+    {
+        Message message;
+        InflightState state;
+        qint64 sentAt;
+        quint16 retries;
+
+        InflightMessage();
+    };
+
     ClientPrivate(Client* qq_ptr);
     ~ClientPrivate();
 
@@ -75,10 +100,30 @@ public:
     bool _willRetain;
     QString _willMessage;
     QHash<QAbstractSocket::SocketError, ClientError> _socketErrorHash;
+    InflightMessage _inflight[INFLIGHT_WINDOW_SIZE];
+    int _inflightCount;
+    QQueue<Message> _pendingPublishes;
+    QTimer _retransmitTimer;
+    QElapsedTimer _clock;
+    int _retransmitInterval;
+    quint64 _retransmitCount;
+    quint32 _windowRetransmits;
+    qint64 _rateWindowStart;
+    qreal _retransmitRate;
 
     Client* const q_ptr;
 
     quint16 nextmid();
+    quint16 nextInflightMid();
+    quint16 publishInflight(const Message& message, const quint16 msgid);
+    void resendInflight(InflightMessage& entry, const qint64 now);
+    void completeInflight(InflightMessage& entry);
+    void onTimerRetransmit();
+    int inflightCount() const;
+    quint64 retransmitCount() const;
+    qreal retransmitRate() const;
+    int retransmitInterval() const;
+    void setRetransmitInterval(const int retransmitInterval);
     void connectToHost();
     void sendConnect();
     void onTimerPingReq();
@@ -105,6 +150,9 @@ public:
     bool autoReconnectInterval() const;
     void setAutoReconnectInterval(const int autoReconnectInterval);
     bool isConnectedToHost() const;
+    bool writeBatching() const;
+    void setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency);
+    WriteStats writeStats() const;
     QMQTT::ConnectionState connectionState() const;
     void setCleanSession(const bool cleanSession);
     bool cleanSession() const;
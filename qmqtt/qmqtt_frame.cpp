@@ -31,6 +31,7 @@
  */
 #include <QDataStream>
 #include <QLoggingCategory>
+#include <cstring>
 #include "qmqtt_frame.h"
 
 namespace QMQTT {
@@ -40,18 +41,32 @@ Q_LOGGING_CATEGORY(frame, "qmqtt.frame")
 Frame::Frame()
     : _header(0)
     , _data(QByteArray())
+    , _pos(0)
+    , _end(0)
 {
 }
 
 Frame::Frame(const quint8 header)
     : _header(header)
     , _data(QByteArray())
+    , _pos(0)
+    , _end(0)
 {
 }
 
 Frame::Frame(const quint8 header, const QByteArray &data)
     : _header(header)
     , _data(data)
+    , _pos(0)
+    , _end(data.size())
+{
+}
+
+Frame::Frame(const quint8 header, const QByteArray &buffer, const int offset, const int length)
+    : _header(header)
+    , _data(buffer)
+    , _pos(offset)
+    , _end(offset + length)
 {
 }
 
@@ -59,19 +74,24 @@ Frame::Frame(const Frame& other)
 {
     _header = other._header;
     _data = other._data;
+    _pos = other._pos;
+    _end = other._end;
 }
 
 Frame& Frame::operator=(const Frame& other)
 {
     _header = other._header;
     _data = other._data;
+    _pos = other._pos;
+    _end = other._end;
     return *this;
 }
 
 bool Frame::operator==(const Frame& other) const
 {
   return _header == other._header
-      && _data == other._data;
+      && size() == other.size()
+      && memcmp(_data.constData() + _pos, other._data.constData() + other._pos, size()) == 0;
 }
 
 
@@ -86,36 +106,67 @@ quint8 Frame::header() const
 
 QByteArray Frame::data() const
 {
-    return _data;
+    if (_pos == 0 && _end == _data.size())
+    {
+        // Whole buffer, share it
+        return _data;
+    }
+    return _data.mid(_pos, _end - _pos);
+}
+
+int Frame::size() const
+{
+    return _end - _pos;
+}
+
+void Frame::detach()
+{
+    // Frames that view part of a larger buffer must own their bytes before
+    // anything can be appended to them
+    if (_pos != 0 || _end != _data.size())
+    {
+        _data = data();
+        _pos = 0;
+        _end = _data.size();
+    }
 }
 
 quint8 Frame::readChar()
 {
-    char c = _data.at(0);
-    _data.remove(0, 1);
-    return c;
+    if (_pos >= _end)
+    {
+        return 0;
+    }
+    return static_cast<quint8>(_data.at(_pos++));
 }
 
 quint16 Frame::readInt()
 {
-    quint8 msb = static_cast<quint8>(_data.at(0));
-    quint8 lsb = static_cast<quint8>(_data.at(1));
-    _data.remove(0, 2);
+    if (_end - _pos < 2)
+    {
+        _pos = _end;
+        return 0;
+    }
+    quint8 msb = static_cast<quint8>(_data.at(_pos));
+    quint8 lsb = static_cast<quint8>(_data.at(_pos + 1));
+    _pos += 2;
     return (msb << 8) | lsb;
 }
 
 QString Frame::readString()
 {
-    quint16 len = readInt();
-    QString s = QString::fromUtf8(_data.left(len));
-    _data.remove(0, len);
+    int len = qMin<int>(readInt(), _end - _pos);
+    QString s = QString::fromUtf8(_data.constData() + _pos, len);
+    _pos += len;
     return s;
 }
 
 void Frame::writeInt(const quint16 i)
 {
+    detach();
     _data.append(MSB(i));
     _data.append(LSB(i));
+    _end = _data.size();
 }
 
 void Frame::writeString(const QString &string)
@@ -128,30 +179,36 @@ void Frame::writeString(const QString &string)
     }
     writeInt(data.size());
     _data.append(data);
+    _end = _data.size();
 }
 
 void Frame::writeChar(const quint8 c)
 {
+    detach();
     _data.append(c);
+    _end = _data.size();
 }
 
 void Frame::writeRawData(const QByteArray &data)
 {
+    detach();
     _data.append(data);
+    _end = _data.size();
 }
 
 void Frame::write(QDataStream &stream)
 {
     QByteArray lenbuf;
+    int length = size();
 
-    if (!encodeLength(lenbuf, _data.size()))
+    if (!encodeLength(lenbuf, length))
     {
         qCritical("qmqtt: Control packet bigger than 256 MB, dropped!");
         return;
     }
 
     stream << (quint8)_header;
-    if(_data.size() == 0) {
+    if(length == 0) {
         stream << (quint8)0;
         return;
     }
@@ -160,12 +217,38 @@ void Frame::write(QDataStream &stream)
         qCritical("qmqtt: Control packet write error!");
         return;
     }
-    if (stream.writeRawData(_data.data(), _data.size()) != _data.size())
+    if (stream.writeRawData(_data.constData() + _pos, length) != length)
     {
         qCritical("qmqtt: Control packet write error!");
     }
 }
 
+void Frame::write(QByteArray &buffer) const
+{
+    char lenbuf[4];
+    int lenSize = 0;
+    int length = size();
+    int remaining = length;
+
+    do {
+        if (lenSize == 4)
+        {
+            qCritical("qmqtt: Control packet bigger than 256 MB, dropped!");
+            return;
+        }
+        quint8 d = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0) {
+            d |= 0x80;
+        }
+        lenbuf[lenSize++] = d;
+    } while (remaining > 0);
+
+    buffer.append(static_cast<char>(_header));
+    buffer.append(lenbuf, lenSize);
+    buffer.append(_data.constData() + _pos, length);
+}
+
 bool Frame::encodeLength(QByteArray &lenbuf, int length)
 {
     lenbuf.clear();
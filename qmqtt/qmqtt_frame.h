@@ -92,6 +92,9 @@ public:
     explicit Frame();
     explicit Frame(const quint8 header);
     explicit Frame(const quint8 header, const QByteArray &data);
+    // Creates a frame that views length bytes of buffer starting at offset. The
+    // buffer is shared, not copied.
+    explicit Frame(const quint8 header, const QByteArray &buffer, const int offset, const int length);
     virtual ~Frame();
 
     Frame(const Frame& other);
@@ -101,6 +104,7 @@ public:
 
     quint8 header() const;
     QByteArray data() const;
+    int size() const;
 
     quint16 readInt();
     quint8 readChar();
@@ -113,11 +117,18 @@ public:
 
     //TODO: FIXME LATER
     void write(QDataStream &stream);
+    // Appends the encoded frame (fixed header, remaining length and data) to buffer
+    void write(QByteArray &buffer) const;
     bool encodeLength(QByteArray &lenbuf, int length);
 
 private:
+    void detach();
+
     quint8 _header;
     QByteArray _data;
+    // Read cursor and end of this frame's bytes within _data
+    int _pos;
+    int _end;
 };
 
 } // namespace QMQTT
@@ -0,0 +1,141 @@
+/*
+ * qmqtt_framebuffer.cpp - qmqtt incremental frame parser
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "qmqtt_framebuffer_p.h"
+#include <QIODevice>
+
+// Initial capacity of the receive buffer. It grows as needed and is never
+// shrunk, so steady-state parsing does not allocate.
+static const int DEFAULT_BUFFER_CAPACITY = 64 * 1024;
+
+// The remaining length field is at most 4 bytes long (MQTT 3.1, 2.1)
+static const int MAX_REMAINING_LENGTH_BYTES = 4;
+
+QMQTT::FrameBuffer::FrameBuffer()
+    : _readPos(0)
+{
+    _buffer.reserve(DEFAULT_BUFFER_CAPACITY);
+}
+
+bool QMQTT::FrameBuffer::readFrom(QIODevice* device)
+{
+    qint64 available = device->bytesAvailable();
+    if (available <= 0)
+    {
+        return true;
+    }
+
+    int oldSize = _buffer.size();
+    _buffer.resize(oldSize + static_cast<int>(available));
+    qint64 read = device->read(_buffer.data() + oldSize, available);
+    _buffer.resize(oldSize + static_cast<int>(qMax<qint64>(read, 0)));
+    return read >= 0;
+}
+
+void QMQTT::FrameBuffer::append(const char* data, const int length)
+{
+    _buffer.append(data, length);
+}
+
+QMQTT::FrameBuffer::Status QMQTT::FrameBuffer::next(Frame& frame)
+{
+    const int available = _buffer.size() - _readPos;
+    if (available < 2)
+    {
+        return FrameIncomplete;
+    }
+
+    const uchar* bytes = reinterpret_cast<const uchar*>(_buffer.constData()) + _readPos;
+
+    // Decode the variable length remaining length field following the header byte
+    int length = 0;
+    int multiplier = 1;
+    int headerLength = 1;
+    uchar byte = 0;
+    do
+    {
+        if (headerLength > MAX_REMAINING_LENGTH_BYTES)
+        {
+            return FrameMalformed;
+        }
+        if (headerLength >= available)
+        {
+            return FrameIncomplete;
+        }
+        byte = bytes[headerLength++];
+        length += (byte & 127) * multiplier;
+        multiplier *= 128;
+    } while ((byte & 128) != 0);
+
+    if (available - headerLength < length)
+    {
+        return FrameIncomplete;
+    }
+
+    frame = Frame(bytes[0], _buffer, _readPos + headerLength, length);
+    _readPos += headerLength + length;
+    return FrameComplete;
+}
+
+void QMQTT::FrameBuffer::compact()
+{
+    if (_readPos == 0)
+    {
+        return;
+    }
+    if (_readPos == _buffer.size())
+    {
+        // Capacity was reserved, so this keeps the allocation
+        _buffer.resize(0);
+    }
+    else
+    {
+        // Only the tail of a partially received frame is moved
+        _buffer.remove(0, _readPos);
+    }
+    _readPos = 0;
+}
+
+void QMQTT::FrameBuffer::clear()
+{
+    _buffer.resize(0);
+    _readPos = 0;
+}
+
+int QMQTT::FrameBuffer::bytesBuffered() const
+{
+    return _buffer.size() - _readPos;
+}
+
+int QMQTT::FrameBuffer::capacity() const
+{
+    return _buffer.capacity();
+}
@@ -0,0 +1,87 @@
+/*
+ * qmqtt_framebuffer_p.h - qmqtt incremental frame parser header
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef QMQTT_FRAMEBUFFER_P_H
+#define QMQTT_FRAMEBUFFER_P_H
+
+#include "qmqtt_frame.h"
+#include <QByteArray>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace QMQTT {
+
+/*
+ * Accumulates bytes read from a socket and splits them into frames.
+ *
+ * All incoming data is appended to a single buffer and parsed in place using a
+ * read cursor. Complete frames are handed out as views into that buffer, so no
+ * bytes are copied or shifted while a frame is being parsed. Consumed bytes are
+ * released at most once per read, which keeps parsing linear in the amount of
+ * data received regardless of payload size.
+ */
+class FrameBuffer
+{
+public:
+    enum Status
+    {
+        FrameComplete = 0,
+        FrameIncomplete,
+        FrameMalformed
+    };
+
+    FrameBuffer();
+
+    // Reads everything currently available from the device into the buffer.
+    // Returns false if the device reported an error.
+    bool readFrom(QIODevice* device);
+    void append(const char* data, const int length);
+
+    // Parses the next frame at the read cursor. The frame is only valid as
+    // FrameComplete; on FrameIncomplete more data is required.
+    Status next(Frame& frame);
+
+    // Releases bytes that have already been handed out as frames
+    void compact();
+    void clear();
+
+    int bytesBuffered() const;
+    // Bytes the buffer can hold before it has to grow
+    int capacity() const;
+
+private:
+    QByteArray _buffer;
+    int _readPos;
+};
+
+} // namespace QMQTT
+
+#endif // QMQTT_FRAMEBUFFER_P_H
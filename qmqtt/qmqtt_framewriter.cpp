@@ -0,0 +1,168 @@
+/*
+ * qmqtt_framewriter.cpp - qmqtt batched frame writer
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "qmqtt_framewriter_p.h"
+#include <QAbstractSocket>
+#include <QIODevice>
+
+// Output buffer capacity reserved up front, large enough for a full batch of
+// small control and telemetry frames
+static const int DEFAULT_BUFFER_CAPACITY = 16 * 1024;
+
+// Approximate IPv4 + TCP header overhead of every segment put on the wire,
+// used to estimate the bytes saved by writing several frames at once
+static const int TCPIP_HEADER_BYTES = 40;
+
+QMQTT::WriteStats::WriteStats()
+    : frames(0)
+    , writes(0)
+    , bytes(0)
+    , bytesSaved(0)
+    , totalLatencyUs(0)
+    , maxLatencyUs(0)
+{
+}
+
+QMQTT::FrameWriter::FrameWriter(QObject* parent)
+    : QObject(parent)
+    , _device(NULL)
+    , _batching(false)
+    , _maxBatchBytes(DEFAULT_BUFFER_CAPACITY)
+    , _batchFrames(0)
+{
+    _buffer.reserve(DEFAULT_BUFFER_CAPACITY);
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(0);
+    QObject::connect(&_flushTimer, &QTimer::timeout, this, &FrameWriter::flush);
+}
+
+void QMQTT::FrameWriter::setDevice(QIODevice* device)
+{
+    _device = device;
+}
+
+void QMQTT::FrameWriter::setBatching(const bool enabled, const int maxBytes, const int maxLatency)
+{
+    if (!enabled)
+    {
+        flush();
+    }
+    _batching = enabled;
+    _maxBatchBytes = qMax(maxBytes, 1);
+    _flushTimer.setInterval(qMax(maxLatency, 0));
+    if (_buffer.capacity() < _maxBatchBytes)
+    {
+        _buffer.reserve(_maxBatchBytes);
+    }
+    applySocketOptions();
+}
+
+bool QMQTT::FrameWriter::batching() const
+{
+    return _batching;
+}
+
+QMQTT::WriteStats QMQTT::FrameWriter::stats() const
+{
+    return _stats;
+}
+
+void QMQTT::FrameWriter::applySocketOptions()
+{
+    // Batches are already coalesced here, so Nagle's algorithm would only
+    // delay them further
+    QAbstractSocket* socket = qobject_cast<QAbstractSocket*>(_device);
+    if (socket && (socket->state() == QAbstractSocket::ConnectedState))
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, _batching ? 1 : 0);
+    }
+}
+
+void QMQTT::FrameWriter::write(const Frame& frame)
+{
+    if (!_batching)
+    {
+        _buffer.resize(0);
+        frame.write(_buffer);
+        _batchFrames = 1;
+        writeBuffer();
+        return;
+    }
+
+    if (_batchFrames == 0)
+    {
+        _batchAge.start();
+        _flushTimer.start();
+    }
+    frame.write(_buffer);
+    _batchFrames++;
+
+    if (_buffer.size() >= _maxBatchBytes)
+    {
+        flush();
+    }
+}
+
+void QMQTT::FrameWriter::flush()
+{
+    _flushTimer.stop();
+    if (_batchFrames == 0)
+    {
+        return;
+    }
+
+    quint64 latency = static_cast<quint64>(_batchAge.nsecsElapsed() / 1000);
+    _stats.totalLatencyUs += latency;
+    _stats.maxLatencyUs = qMax(_stats.maxLatencyUs, latency);
+    _stats.bytesSaved += static_cast<quint64>(_batchFrames - 1) * TCPIP_HEADER_BYTES;
+    writeBuffer();
+}
+
+void QMQTT::FrameWriter::writeBuffer()
+{
+    if (_device && _device->write(_buffer.constData(), _buffer.size()) != _buffer.size())
+    {
+        qCritical("qmqtt: Control packet write error!");
+    }
+    _stats.frames += _batchFrames;
+    _stats.writes++;
+    _stats.bytes += _buffer.size();
+
+    _buffer.resize(0);
+    _batchFrames = 0;
+}
+
+void QMQTT::FrameWriter::clear()
+{
+    _flushTimer.stop();
+    _buffer.resize(0);
+    _batchFrames = 0;
+}
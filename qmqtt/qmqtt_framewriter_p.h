@@ -0,0 +1,91 @@
+/*
+ * qmqtt_framewriter_p.h - qmqtt batched frame writer header
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef QMQTT_FRAMEWRITER_P_H
+#define QMQTT_FRAMEWRITER_P_H
+
+#include "qmqtt_networkinterface.h"
+#include "qmqtt_frame.h"
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include <QElapsedTimer>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
+namespace QMQTT {
+
+/*
+ * Writes frames to a socket.
+ *
+ * With batching disabled, every frame is encoded and written immediately as a
+ * single write. With batching enabled, frames are encoded into one reserved
+ * output buffer and written together when the batch reaches maxBytes, or
+ * maxLatency milliseconds after the first frame was queued. A latency of 0
+ * flushes once per event loop iteration.
+ */
+class FrameWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameWriter(QObject* parent = NULL);
+
+    void setDevice(QIODevice* device);
+    void setBatching(const bool enabled, const int maxBytes, const int maxLatency);
+    bool batching() const;
+    WriteStats stats() const;
+
+    void write(const Frame& frame);
+    // Drops any queued frames without writing them
+    void clear();
+
+public Q_SLOTS:
+    void flush();
+    void applySocketOptions();
+
+private:
+    void writeBuffer();
+
+    QIODevice* _device;
+    QByteArray _buffer;
+    QTimer _flushTimer;
+    QElapsedTimer _batchAge;
+    bool _batching;
+    int _maxBatchBytes;
+    int _batchFrames;
+    WriteStats _stats;
+
+    Q_DISABLE_COPY(FrameWriter)
+};
+
+} // namespace QMQTT
+
+#endif // QMQTT_FRAMEWRITER_P_H
@@ -45,7 +45,6 @@ QMQTT::Network::Network(QObject* parent)
     , _host(DEFAULT_HOST)
     , _autoReconnect(DEFAULT_AUTORECONNECT)
     , _autoReconnectInterval(DEFAULT_AUTORECONNECT_INTERVAL_MS)
-    , _bytesRemaining(0)
     , _socket(new QMQTT::Socket)
     , _autoReconnectTimer(new QMQTT::Timer)
 {
@@ -59,7 +58,6 @@ QMQTT::Network::Network(SocketInterface* socketInterface, TimerInterface* timerI
     , _host(DEFAULT_HOST)
     , _autoReconnect(DEFAULT_AUTORECONNECT)
     , _autoReconnectInterval(DEFAULT_AUTORECONNECT_INTERVAL_MS)
-    , _bytesRemaining(0)
     , _socket(socketInterface)
     , _autoReconnectTimer(timerInterface)
 {
@@ -72,7 +70,9 @@ void QMQTT::Network::initialize()
     _autoReconnectTimer->setParent(this);
     _autoReconnectTimer->setSingleShot(true);
     _autoReconnectTimer->setInterval(_autoReconnectInterval);
+    _writer.setDevice(_socket->ioDevice());
 
+    QObject::connect(_socket, &SocketInterface::connected, &_writer, &FrameWriter::applySocketOptions);
     QObject::connect(_socket, &SocketInterface::connected, this, &Network::connected);
     QObject::connect(_socket, &SocketInterface::disconnected, this, &Network::onDisconnected);
     QObject::connect(_socket->ioDevice(), &QIODevice::readyRead, this, &Network::onSocketReadReady);
@@ -109,7 +109,7 @@ void QMQTT::Network::connectToHost(const QString& hostName, const quint16 port)
 
 void QMQTT::Network::connectToHost()
 {
-    _bytesRemaining = 0;
+    _readBuffer.clear();
     if (_hostName.isEmpty())
     {
         _socket->connectToHost(_host, _port);
@@ -133,16 +133,32 @@ void QMQTT::Network::sendFrame(Frame& frame)
 {
     if(_socket->state() == QAbstractSocket::ConnectedState)
     {
-        QDataStream out(_socket->ioDevice());
-        frame.write(out);
+        _writer.write(frame);
     }
 }
 
 void QMQTT::Network::disconnectFromHost()
 {
+    // Make sure a queued DISCONNECT actually goes out
+    _writer.flush();
     _socket->disconnectFromHost();
 }
 
+void QMQTT::Network::setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency)
+{
+    _writer.setBatching(enabled, maxBytes, maxLatency);
+}
+
+bool QMQTT::Network::writeBatching() const
+{
+    return _writer.batching();
+}
+
+QMQTT::WriteStats QMQTT::Network::writeStats() const
+{
+    return _writer.stats();
+}
+
 QAbstractSocket::SocketState QMQTT::Network::state() const
 {
     return _socket->state();
@@ -172,61 +188,40 @@ void QMQTT::Network::setAutoReconnectInterval(const int autoReconnectInterval)
 void QMQTT::Network::onSocketReadReady()
 {
     QIODevice *ioDevice = _socket->ioDevice();
-    while(!ioDevice->atEnd())
+    if (!_readBuffer.readFrom(ioDevice))
     {
-        if(_bytesRemaining == 0)
-        {
-            if (!ioDevice->getChar(reinterpret_cast<char *>(&_header)))
-            {
-                // malformed packet
-                emit error(QAbstractSocket::OperationError);
-                ioDevice->close();
-                return;
-            }
-
-            _bytesRemaining = readRemainingLength();
-            if (_bytesRemaining < 0)
-            {
-                // malformed remaining length
-                emit error(QAbstractSocket::OperationError);
-                ioDevice->close();
-                return;
-            }
-        }
-
-        QByteArray data = ioDevice->read(_bytesRemaining);
-        _buffer.append(data);
-        _bytesRemaining -= data.size();
+        emit error(QAbstractSocket::NetworkError);
+        return;
+    }
 
-        if(_bytesRemaining == 0)
+    FrameBuffer::Status status;
+    forever
+    {
+        // Scoped so the frame releases its view of the buffer before compact()
+        Frame frame;
+        status = _readBuffer.next(frame);
+        if (status != FrameBuffer::FrameComplete)
         {
-            Frame frame(_header, _buffer);
-            _buffer.clear();
-            emit received(frame);
+            break;
         }
+        emit received(frame);
     }
-}
 
-int QMQTT::Network::readRemainingLength()
-{
-     quint8 byte = 0;
-     int length = 0;
-     int multiplier = 1;
-     QIODevice *ioDevice = _socket->ioDevice();
-     do {
-         if (!ioDevice->getChar(reinterpret_cast<char *>(&byte)))
-             return -1;
-         length += (byte & 127) * multiplier;
-         multiplier *= 128;
-         if (multiplier > 128*128*128)
-             return -1;
-     } while ((byte & 128) != 0);
+    if (status == FrameBuffer::FrameMalformed)
+    {
+        // malformed remaining length
+        _readBuffer.clear();
+        emit error(QAbstractSocket::OperationError);
+        ioDevice->close();
+        return;
+    }
 
-     return length;
+    _readBuffer.compact();
 }
 
 void QMQTT::Network::onDisconnected()
 {
+    _writer.clear();
     emit disconnected();
     if(_autoReconnect)
     {
@@ -39,6 +39,21 @@
 
 namespace QMQTT {
 
+// Counters describing how outgoing frames were written to the socket
+struct Q_MQTT_EXPORT WriteStats
+{
+    quint64 frames;
+    quint64 writes;
+    quint64 bytes;
+    // Estimated TCP/IP header bytes saved by writing several frames at once
+    quint64 bytesSaved;
+    // Time batches waited before being flushed, in microseconds
+    quint64 totalLatencyUs;
+    quint64 maxLatencyUs;
+
+    WriteStats();
+};
+
 class Q_MQTT_EXPORT NetworkInterface : public QObject
 {
     Q_OBJECT
@@ -53,6 +68,9 @@ public:
     virtual int autoReconnectInterval() const = 0;
     virtual void setAutoReconnectInterval(const int autoReconnectInterval) = 0;
     virtual QAbstractSocket::SocketState state() const = 0;
+    virtual void setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency) = 0;
+    virtual bool writeBatching() const = 0;
+    virtual WriteStats writeStats() const = 0;
 
 public Q_SLOTS:
     virtual void connectToHost(const QHostAddress& host, const quint16 port) = 0;
@@ -48,7 +48,6 @@ QMQTT::SslNetwork::SslNetwork(const QSslConfiguration &config, bool ignoreSelfSi
     , _hostName(DEFAULT_HOST_NAME)
     , _autoReconnect(DEFAULT_AUTORECONNECT)
     , _autoReconnectInterval(DEFAULT_AUTORECONNECT_INTERVAL_MS)
-    , _bytesRemaining(0)
     , _socket(new QMQTT::SslSocket(config, ignoreSelfSigned))
     , _autoReconnectTimer(new QMQTT::Timer)
 {
@@ -62,7 +61,6 @@ QMQTT::SslNetwork::SslNetwork(SocketInterface* socketInterface, TimerInterface*
     , _hostName(DEFAULT_HOST_NAME)
     , _autoReconnect(DEFAULT_AUTORECONNECT)
     , _autoReconnectInterval(DEFAULT_AUTORECONNECT_INTERVAL_MS)
-    , _bytesRemaining(0)
     , _socket(socketInterface)
     , _autoReconnectTimer(timerInterface)
 {
@@ -75,7 +73,9 @@ void QMQTT::SslNetwork::initialize()
     _autoReconnectTimer->setParent(this);
     _autoReconnectTimer->setSingleShot(true);
     _autoReconnectTimer->setInterval(_autoReconnectInterval);
+    _writer.setDevice(_socket->ioDevice());
 
+    QObject::connect(_socket, &SocketInterface::connected, &_writer, &FrameWriter::applySocketOptions);
     QObject::connect(_socket, &SocketInterface::connected, this, &SslNetwork::connected);
     QObject::connect(_socket, &SocketInterface::disconnected, this, &SslNetwork::onDisconnected);
     QObject::connect(_socket->ioDevice(), &QIODevice::readyRead, this, &SslNetwork::onSocketReadReady);
@@ -114,7 +114,7 @@ void QMQTT::SslNetwork::connectToHost(const QString& hostName, const quint16 por
 
 void QMQTT::SslNetwork::connectToHost()
 {
-    _bytesRemaining = 0;
+    _readBuffer.clear();
     _socket->connectToHost(_hostName, _port);
 }
 
@@ -131,16 +131,32 @@ void QMQTT::SslNetwork::sendFrame(Frame& frame)
 {
     if(_socket->state() == QAbstractSocket::ConnectedState)
     {
-        QDataStream out(_socket->ioDevice());
-        frame.write(out);
+        _writer.write(frame);
     }
 }
 
 void QMQTT::SslNetwork::disconnectFromHost()
 {
+    // Make sure a queued DISCONNECT actually goes out
+    _writer.flush();
     _socket->disconnectFromHost();
 }
 
+void QMQTT::SslNetwork::setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency)
+{
+    _writer.setBatching(enabled, maxBytes, maxLatency);
+}
+
+bool QMQTT::SslNetwork::writeBatching() const
+{
+    return _writer.batching();
+}
+
+QMQTT::WriteStats QMQTT::SslNetwork::writeStats() const
+{
+    return _writer.stats();
+}
+
 QAbstractSocket::SocketState QMQTT::SslNetwork::state() const
 {
     return _socket->state();
@@ -169,61 +185,40 @@ void QMQTT::SslNetwork::setAutoReconnectInterval(const int autoReconnectInterval
 void QMQTT::SslNetwork::onSocketReadReady()
 {
     QIODevice *ioDevice = _socket->ioDevice();
-    while(!ioDevice->atEnd())
+    if (!_readBuffer.readFrom(ioDevice))
     {
-        if(_bytesRemaining == 0)
-        {
-            if (!ioDevice->getChar(reinterpret_cast<char *>(&_header)))
-            {
-                // malformed packet
-                emit error(QAbstractSocket::OperationError);
-                ioDevice->close();
-                return;
-            }
-
-            _bytesRemaining = readRemainingLength();
-            if (_bytesRemaining < 0)
-            {
-                // malformed remaining length
-                emit error(QAbstractSocket::OperationError);
-                ioDevice->close();
-                return;
-            }
-        }
-
-        QByteArray data = ioDevice->read(_bytesRemaining);
-        _buffer.append(data);
-        _bytesRemaining -= data.size();
+        emit error(QAbstractSocket::NetworkError);
+        return;
+    }
 
-        if(_bytesRemaining == 0)
+    FrameBuffer::Status status;
+    forever
+    {
+        // Scoped so the frame releases its view of the buffer before compact()
+        Frame frame;
+        status = _readBuffer.next(frame);
+        if (status != FrameBuffer::FrameComplete)
         {
-            Frame frame(_header, _buffer);
-            _buffer.clear();
-            emit received(frame);
+            break;
         }
+        emit received(frame);
     }
-}
 
-int QMQTT::SslNetwork::readRemainingLength()
-{
-     quint8 byte = 0;
-     int length = 0;
-     int multiplier = 1;
-     QIODevice *ioDevice = _socket->ioDevice();
-     do {
-         if (!ioDevice->getChar(reinterpret_cast<char *>(&byte)))
-             return -1;
-         length += (byte & 127) * multiplier;
-         multiplier *= 128;
-         if (multiplier > 128*128*128)
-             return -1;
-     } while ((byte & 128) != 0);
+    if (status == FrameBuffer::FrameMalformed)
+    {
+        // malformed remaining length
+        _readBuffer.clear();
+        emit error(QAbstractSocket::OperationError);
+        ioDevice->close();
+        return;
+    }
 
-     return length;
+    _readBuffer.compact();
 }
 
 void QMQTT::SslNetwork::onDisconnected()
 {
+    _writer.clear();
     emit disconnected();
     if(_autoReconnect)
     {
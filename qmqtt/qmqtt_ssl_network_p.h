@@ -35,6 +35,8 @@
 
 #include "qmqtt_networkinterface.h"
 #include "qmqtt_frame.h"
+#include "qmqtt_framebuffer_p.h"
+#include "qmqtt_framewriter_p.h"
 #include <QByteArray>
 #include <QObject>
 #include <QTcpSocket>
@@ -68,6 +70,9 @@ public:
     QAbstractSocket::SocketState state() const;
     int autoReconnectInterval() const;
     void setAutoReconnectInterval(const int autoReconnectInterval);
+    void setWriteBatching(const bool enabled, const int maxBytes, const int maxLatency);
+    bool writeBatching() const;
+    WriteStats writeStats() const;
 
 public Q_SLOTS:
     void connectToHost(const QHostAddress& host, const quint16 port);
@@ -79,15 +84,13 @@ protected Q_SLOTS:
 
 protected:
     void initialize();
-    int readRemainingLength();
 
     quint16 _port;
     QString _hostName;
-    QByteArray _buffer;
+    FrameBuffer _readBuffer;
+    FrameWriter _writer;
     bool _autoReconnect;
     int _autoReconnectInterval;
-    int _bytesRemaining;
-    quint8 _header;
     SocketInterface* _socket;
     TimerInterface* _autoReconnectTimer;
 
@@ -0,0 +1,249 @@
+/*
+ * qmqtt_topicdispatcher.cpp - qmqtt topic trie dispatcher
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "qmqtt_topicdispatcher.h"
+#include <QLoggingCategory>
+
+namespace QMQTT {
+
+Q_LOGGING_CATEGORY(dispatcher, "qmqtt.dispatcher")
+
+// Upper bound on cached topic lookups, in case topics are generated dynamically
+static const int MAX_CACHED_TOPICS = 1024;
+
+static const QString SINGLE_LEVEL_WILDCARD = QStringLiteral("+");
+static const QString MULTI_LEVEL_WILDCARD = QStringLiteral("#");
+
+// Interned ids of the wildcards, and of levels no filter names
+static const quint32 NO_LEVEL = 0;
+static const quint32 SINGLE_LEVEL = 1;
+static const quint32 MULTI_LEVEL = 2;
+
+TopicDispatcher::Node::~Node()
+{
+    qDeleteAll(children);
+}
+
+TopicDispatcher::TopicDispatcher()
+    : _root(new Node)
+    , _nextRouteId(1)
+{
+    internWildcards();
+}
+
+TopicDispatcher::~TopicDispatcher()
+{
+    delete _root;
+}
+
+bool TopicDispatcher::isValidFilter(const QString& filter)
+{
+    if (filter.isEmpty())
+    {
+        return false;
+    }
+    QStringList levels = filter.split(QLatin1Char('/'));
+    for (int i = 0; i < levels.size(); ++i)
+    {
+        const QString& level = levels[i];
+        if (level.contains(QLatin1Char('#')) && ((level != MULTI_LEVEL_WILDCARD) || (i != levels.size() - 1)))
+        {
+            return false;
+        }
+        if (level.contains(QLatin1Char('+')) && (level != SINGLE_LEVEL_WILDCARD))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int TopicDispatcher::addRoute(const QString& filter, const Handler& handler)
+{
+    if (!isValidFilter(filter))
+    {
+        qCWarning(dispatcher) << "Invalid topic filter" << filter;
+        return 0;
+    }
+
+    Node* node = _root;
+    for (const QString& level : filter.split(QLatin1Char('/')))
+    {
+        Node*& child = node->children[intern(level)];
+        if (!child)
+        {
+            child = new Node;
+        }
+        node = child;
+    }
+
+    int id = _nextRouteId++;
+    node->routes.append(id);
+    _handlers.insert(id, handler);
+    _routeNodes.insert(id, node);
+    _routeFilters.insert(id, filter);
+    _matchCache.clear();
+    return id;
+}
+
+void TopicDispatcher::removeRoute(const int id)
+{
+    Node* node = _routeNodes.take(id);
+    if (node)
+    {
+        node->routes.removeAll(id);
+        _handlers.remove(id);
+        _routeFilters.remove(id);
+        _matchCache.clear();
+    }
+}
+
+void TopicDispatcher::clear()
+{
+    delete _root;
+    _root = new Node;
+    _levels.clear();
+    internWildcards();
+    _handlers.clear();
+    _routeNodes.clear();
+    _routeFilters.clear();
+    _matchCache.clear();
+}
+
+quint32 TopicDispatcher::intern(const QString& level)
+{
+    auto it = _levels.constFind(level);
+    if (it != _levels.constEnd())
+    {
+        return *it;
+    }
+    // Ids follow the wildcards'
+    return *_levels.insert(level, static_cast<quint32>(_levels.size()) + 1);
+}
+
+void TopicDispatcher::internWildcards()
+{
+    _levels.insert(SINGLE_LEVEL_WILDCARD, SINGLE_LEVEL);
+    _levels.insert(MULTI_LEVEL_WILDCARD, MULTI_LEVEL);
+}
+
+QStringList TopicDispatcher::filters() const
+{
+    QStringList filters = _routeFilters.values();
+    filters.removeDuplicates();
+    return filters;
+}
+
+int TopicDispatcher::dispatch(const Message& message) const
+{
+    // Copy (by reference count) so handlers can change the routes while we iterate
+    const QVector<int> routes = match(message.topic());
+    int called = 0;
+    for (int id : routes)
+    {
+        auto handler = _handlers.constFind(id);
+        if (handler != _handlers.constEnd())
+        {
+            // Call a copy, a handler that removes its own route would otherwise be destroyed while it runs
+            const Handler call = *handler;
+            call(message);
+            called++;
+        }
+    }
+    return called;
+}
+
+const QVector<int>& TopicDispatcher::match(const QString& topic) const
+{
+    auto cached = _matchCache.constFind(topic);
+    if (cached != _matchCache.constEnd())
+    {
+        return *cached;
+    }
+
+    if (_matchCache.size() >= MAX_CACHED_TOPICS)
+    {
+        _matchCache.clear();
+    }
+
+    // Look each level up where it lies in the topic, wrapping it rather than copying it
+    const QVector<QStringRef> refs = topic.splitRef(QLatin1Char('/'));
+    QVector<quint32> levels(refs.size());
+    for (int i = 0; i < refs.size(); ++i)
+    {
+        levels[i] = _levels.value(QString::fromRawData(refs[i].unicode(), refs[i].size()), NO_LEVEL);
+    }
+
+    QVector<int> routes;
+    collect(_root, levels, topic.startsWith(QLatin1Char('$')), 0, routes);
+    return *_matchCache.insert(topic, routes);
+}
+
+void TopicDispatcher::collect(const Node* node, const QVector<quint32>& levels, const bool system, const int level, QVector<int>& routes)
+{
+    // Wildcards at the first level do not match topics beginning with '$'
+    bool wildcards = (level > 0) || !system;
+    // '#' also matches the parent level, so "a/#" matches "a"
+    Node* multi = wildcards ? node->children.value(MULTI_LEVEL) : nullptr;
+
+    if (level == levels.size())
+    {
+        routes += node->routes;
+        if (multi)
+        {
+            routes += multi->routes;
+        }
+        return;
+    }
+
+    // Wildcard ids are only reached through the wildcard branches, a topic level of "+" or "#"
+    // matches nothing by itself
+    quint32 id = levels[level];
+    Node* exact = (id > MULTI_LEVEL) ? node->children.value(id) : nullptr;
+    if (exact)
+    {
+        collect(exact, levels, system, level + 1, routes);
+    }
+    if (wildcards)
+    {
+        Node* single = node->children.value(SINGLE_LEVEL);
+        if (single)
+        {
+            collect(single, levels, system, level + 1, routes);
+        }
+        if (multi)
+        {
+            routes += multi->routes;
+        }
+    }
+}
+
+} // namespace QMQTT
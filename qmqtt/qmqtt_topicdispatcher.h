@@ -0,0 +1,123 @@
+/*
+ * qmqtt_topicdispatcher.h - qmqtt topic trie dispatcher header
+ *
+ * Copyright (c) 2013  Ery Lee <ery.lee at gmail dot com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *   * Neither the name of mqttc nor the names of its contributors may be used
+ *     to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef QMQTT_TOPICDISPATCHER_H
+#define QMQTT_TOPICDISPATCHER_H
+
+#include <qmqtt_global.h>
+#include "qmqtt_message.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <functional>
+
+namespace QMQTT {
+
+/*
+ * Dispatches received messages to handlers by topic filter.
+ *
+ * Topic filters are compiled into a trie with one node per topic level, with
+ * '+' and '#' wildcards supported as in MQTT subscriptions. The set of routes
+ * matching a topic is resolved by a single walk of the trie and then cached by
+ * topic, so messages on a topic that has been seen before cost one hash lookup.
+ *
+ * Topic levels are interned: each distinct level named by a filter gets an
+ * integer id, and the trie is keyed by those ids. The levels of a received
+ * topic are looked up in place without being copied, and a level that no
+ * filter names maps to no id, so generated topics never grow the table.
+ *
+ * Handlers may be added or removed from inside a handler.
+ */
+class Q_MQTT_EXPORT TopicDispatcher
+{
+public:
+    typedef std::function<void(const Message&)> Handler;
+
+    TopicDispatcher();
+    ~TopicDispatcher();
+
+    // Adds a handler for all topics matching filter, and returns an id that can be
+    // passed to removeRoute()
+    int addRoute(const QString& filter, const Handler& handler);
+
+    // Adds a handler that receives the payload decoded as T, which must be
+    // constructible from a QByteArray
+    template <typename T, typename F>
+    int addRoute(const QString& filter, F handler)
+    {
+        return addRoute(filter, Handler([handler](const Message& message)
+        {
+            handler(T(message.payload()));
+        }));
+    }
+
+    void removeRoute(const int id);
+    void clear();
+
+    // Topic filters with at least one route, suitable for subscribing to
+    QStringList filters() const;
+
+    // Calls every handler whose filter matches the message's topic, and returns how many were called
+    int dispatch(const Message& message) const;
+
+    static bool isValidFilter(const QString& filter);
+
+private:
+    struct Node
+    {
+        // Keyed by interned level
+        QHash<quint32, Node*> children;
+        QVector<int> routes;
+
+        ~Node();
+    };
+
+    quint32 intern(const QString& level);
+    void internWildcards();
+    const QVector<int>& match(const QString& topic) const;
+    static void collect(const Node* node, const QVector<quint32>& levels, const bool system, const int level, QVector<int>& routes);
+
+    Node* _root;
+    QHash<QString, quint32> _levels;
+    QHash<int, Handler> _handlers;
+    QHash<int, Node*> _routeNodes;
+    QHash<int, QString> _routeFilters;
+    int _nextRouteId;
+    mutable QHash<QString, QVector<int>> _matchCache;
+
+    Q_DISABLE_COPY(TopicDispatcher)
+};
+
+} // namespace QMQTT
+
+#endif // QMQTT_TOPICDISPATCHER_H
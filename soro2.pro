@@ -4,6 +4,7 @@ SUBDIRS =\
     soro_mc \
     soro_mc_master \
     soro_core \
+    soro_video \
     soro_videostreamer \
     soro_audiostreamer \
     soro_audioserver \
@@ -11,15 +12,18 @@ SUBDIRS =\
     qmqtt \
     soro_science_controller \
     soro_arm_controller \
-    soro_drive_controller
+    soro_drive_controller \
+    tests
 
 soro_core.depends = qmqtt
+soro_video.depends = soro_core
 soro_mc.depends = soro_core qmqtt
 soro_mc_master.depends = soro_core qmqtt
-soro_videostreamer.depends = soro_core qmqtt
+soro_videostreamer.depends = soro_core soro_video qmqtt
 soro_audiostreamer.depends = soro_core qmqtt
 soro_audioserver.depends = soro_core qmqtt
-soro_videoserver.depends = soro_core qmqtt
+soro_videoserver.depends = soro_core soro_video qmqtt
 soro_science_controller.depends = soro_core qmqtt
 soro_arm_controller.depends = soro_core qmqtt
 soro_drive_controller.depends = soro_core qmqtt
+tests.depends = soro_core qmqtt
@@ -2,6 +2,7 @@
 #define ABSTRACTMESSAGE_H
 
 #include <QByteArray>
+#include <cstring>
 
 #include "soro_core_global.h"
 
@@ -10,6 +11,26 @@ namespace Soro {
 struct SORO_CORE_EXPORT AbstractMessage
 {
     virtual operator QByteArray() const=0;
+
+    /* Encodes this message into a caller provided buffer, returning the number of bytes written
+     * or -1 if it does not fit. Messages with a fixed-layout schema (see messagecodec.h) override
+     * this to encode without allocating.
+     */
+    virtual int encode(char *buffer, int capacity) const
+    {
+        QByteArray payload = *this;
+        if (payload.size() > capacity) return -1;
+        memcpy(buffer, payload.constData(), payload.size());
+        return payload.size();
+    }
+
+    /* False if this message was decoded from a payload it could not read, such as one that is
+     * cut short or in an unknown format. Such a message holds default values and must be dropped.
+     */
+    bool isValid() const { return _valid; }
+
+protected:
+    bool _valid = true;
 };
 
 } // namespace Soro
@@ -1,54 +1,62 @@
 #include "atmospheresensormessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
-AtmosphereSensorMessage::AtmosphereSensorMessage() { }
+typedef MessageCodec::Schema<AtmosphereSensorMessage, 1,
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, temperature),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, humidity),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq2Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq4Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq5Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq6Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq7Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq9Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, mq135Reading),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, oxygenPercent),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, co2Ppm),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, dustConcentration),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, windSpeed),
+        SORO_CODEC_FIELD(AtmosphereSensorMessage, windDirection)> AtmosphereSensorSchema;
+
+// Size of the QDataStream encoding used before AtmosphereSensorSchema
+static const int LEGACY_SIZE = 66;
+
+AtmosphereSensorMessage::AtmosphereSensorMessage()
+{
+    temperature = humidity = 0;
+    mq2Reading = mq4Reading = mq5Reading = mq6Reading = mq7Reading = mq9Reading = mq135Reading = 0;
+    oxygenPercent = 0;
+    co2Ppm = 0;
+    dustConcentration = windSpeed = windDirection = 0;
+}
 
-AtmosphereSensorMessage::AtmosphereSensorMessage(const QByteArray &payload)
+AtmosphereSensorMessage::AtmosphereSensorMessage(const QByteArray &payload) : AtmosphereSensorMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream >> temperature;
-    stream >> humidity;
-    stream >> mq2Reading;
-    stream >> mq4Reading;
-    stream >> mq5Reading;
-    stream >> mq6Reading;
-    stream >> mq7Reading;
-    stream >> mq9Reading;
-    stream >> mq135Reading;
-    stream >> oxygenPercent;
-    stream >> co2Ppm;
-    stream >> dustConcentration;
-    stream >> windSpeed;
-    stream >> windDirection;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> temperature >> humidity
+                   >> mq2Reading >> mq4Reading >> mq5Reading >> mq6Reading >> mq7Reading >> mq9Reading >> mq135Reading
+                   >> oxygenPercent >> co2Ppm >> dustConcentration >> windSpeed >> windDirection;
+        });
+    }
+    else
+    {
+        _valid = AtmosphereSensorSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 AtmosphereSensorMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << temperature
-           << humidity
-           << mq2Reading
-           << mq4Reading
-           << mq5Reading
-           << mq6Reading
-           << mq7Reading
-           << mq9Reading
-           << mq135Reading
-           << oxygenPercent
-           << co2Ppm
-           << dustConcentration
-           << windSpeed
-           << windDirection;
-
-    return payload;
+    return AtmosphereSensorSchema::encode(*this);
+}
+
+int AtmosphereSensorMessage::encode(char *buffer, int capacity) const
+{
+    return AtmosphereSensorSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
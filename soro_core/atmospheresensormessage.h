@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT AtmosphereSensorMessage : public AbstractMessage
     AtmosphereSensorMessage();
     AtmosphereSensorMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     double temperature;
     double humidity;
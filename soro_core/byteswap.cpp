@@ -0,0 +1,151 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "byteswap.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORO_BYTESWAP_X86
+#include <immintrin.h>
+#endif
+
+namespace Soro {
+namespace ByteSwap {
+
+typedef void (*SwapKernel)(const char *in, char *out, int count);
+
+// Byte swaps count 16-bit values from in to out. in and out need not be aligned.
+static void swapScalar(const char *in, char *out, int count)
+{
+    // Four values at a time in a 64-bit word, this is also the only kernel on other architectures
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        quint64 values;
+        memcpy(&values, in + i * 2, 8);
+        values = ((values & 0x00FF00FF00FF00FFull) << 8) | ((values >> 8) & 0x00FF00FF00FF00FFull);
+        memcpy(out + i * 2, &values, 8);
+    }
+    for (; i < count; ++i)
+    {
+        quint16 value;
+        memcpy(&value, in + i * 2, 2);
+        value = static_cast<quint16>((value << 8) | (value >> 8));
+        memcpy(out + i * 2, &value, 2);
+    }
+}
+
+#ifdef SORO_BYTESWAP_X86
+
+// SSE2 is part of the x86_64 baseline, the shift pair is as fast as a pshufb here
+__attribute__((target("sse2")))
+static void swapSse2(const char *in, char *out, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), v);
+    }
+    swapScalar(in + i * 2, out + i * 2, count - i);
+}
+
+__attribute__((target("avx2")))
+static void swapAvx2(const char *in, char *out, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2));
+        v = _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), v);
+    }
+    swapSse2(in + i * 2, out + i * 2, count - i);
+}
+
+#endif
+
+static SwapKernel selectKernel()
+{
+#ifdef SORO_BYTESWAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return swapAvx2;
+    if (__builtin_cpu_supports("sse2")) return swapSse2;
+#endif
+    return swapScalar;
+}
+
+static inline void convert(const char *in, char *out, int count)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    memmove(out, in, count * 2);
+#else
+    static const SwapKernel kernel = selectKernel();
+    kernel(in, out, count);
+#endif
+}
+
+void decodeBigEndian16(const char *in, quint16 *out, int count)
+{
+    convert(in, reinterpret_cast<char*>(out), count);
+}
+
+void encodeBigEndian16(const quint16 *in, char *out, int count)
+{
+    convert(reinterpret_cast<const char*>(in), out, count);
+}
+
+bool isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case KernelScalar:
+        return true;
+#ifdef SORO_BYTESWAP_X86
+    case KernelSse2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+    case KernelAvx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+void swap16(Kernel kernel, const char *in, char *out, int count)
+{
+    switch (kernel)
+    {
+#ifdef SORO_BYTESWAP_X86
+    case KernelSse2:
+        swapSse2(in, out, count);
+        break;
+    case KernelAvx2:
+        swapAvx2(in, out, count);
+        break;
+#endif
+    default:
+        swapScalar(in, out, count);
+        break;
+    }
+}
+
+} // namespace ByteSwap
+} // namespace Soro
@@ -0,0 +1,33 @@
+#ifndef BYTESWAP_H
+#define BYTESWAP_H
+
+#include <QtGlobal>
+
+#include "soro_core_global.h"
+
+/* Bulk conversion of 16-bit values to and from big endian byte arrays. On x86 this uses
+ * AVX2 when the CPU supports it and SSE2 otherwise, with a scalar fallback elsewhere.
+ */
+namespace Soro {
+namespace ByteSwap {
+
+SORO_CORE_EXPORT void decodeBigEndian16(const char *in, quint16 *out, int count);
+SORO_CORE_EXPORT void encodeBigEndian16(const quint16 *in, char *out, int count);
+
+// The kernels the conversions choose between, so they can be compared with each other
+enum Kernel
+{
+    KernelScalar,
+    KernelSse2,
+    KernelAvx2
+};
+
+// Returns true if this build and CPU can run kernel
+SORO_CORE_EXPORT bool isSupported(Kernel kernel);
+// Byte swaps count 16-bit values from in to out with a kernel that is supported
+SORO_CORE_EXPORT void swap16(Kernel kernel, const char *in, char *out, int count);
+
+} // namespace ByteSwap
+} // namespace Soro
+
+#endif // BYTESWAP_H
@@ -16,6 +16,7 @@
 
 #include "camerasettingsmodel.h"
 #include "constants.h"
+#include "videomessage.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -68,6 +69,7 @@ void CameraSettingsModel::load()
         int index = jsonObject.toObject()["index"].toInt(-1);
         camera.computerIndex = jsonObject.toObject()["computerIndex"].toInt(0); // Computer index defaults to zero
         camera.name = jsonObject.toObject()["name"].toString("");
+        camera.priority = jsonObject.toObject()["priority"].toInt(1); // Priority defaults to one
 
         if (jsonObject.toObject().contains("mono"))
         {
@@ -102,6 +104,22 @@ void CameraSettingsModel::load()
         {
             throw QString("Error parsing camera settings file '%1': Camera entry is missing a name.").arg(FILE_PATH);
         }
+        if (camera.priority <= 0)
+        {
+            throw QString("Error parsing camera settings file '%1': Camera entry has an invalid priority.").arg(FILE_PATH);
+        }
+        if ((camera.name.toUtf8().size() > VideoMessage::MAX_NAME_BYTES)
+                || (camera.serial.toUtf8().size() > VideoMessage::MAX_SERIAL_BYTES)
+                || (camera.serial2.toUtf8().size() > VideoMessage::MAX_SERIAL_BYTES)
+                || (camera.vendorId.toUtf8().size() > VideoMessage::MAX_ID_BYTES)
+                || (camera.vendorId2.toUtf8().size() > VideoMessage::MAX_ID_BYTES)
+                || (camera.productId.toUtf8().size() > VideoMessage::MAX_ID_BYTES)
+                || (camera.productId2.toUtf8().size() > VideoMessage::MAX_ID_BYTES))
+        {
+            throw QString("Error parsing camera settings file '%1': Camera \"%2\" has a name longer than %3 bytes, a serial longer than %4 bytes, or a vendor or product id longer than %5 bytes.")
+                    .arg(FILE_PATH, camera.name, QString::number(VideoMessage::MAX_NAME_BYTES),
+                         QString::number(VideoMessage::MAX_SERIAL_BYTES), QString::number(VideoMessage::MAX_ID_BYTES));
+        }
         if (cameraMap.contains(index))
         {
             throw QString("Error parsing camera settings file '%1': Two cameras have a duplicate index entry. This is not allowed.").arg(FILE_PATH);
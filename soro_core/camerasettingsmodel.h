@@ -24,6 +24,9 @@ public:
         int computerIndex;
         bool isStereo;
 
+        // Relative share of the video link this camera gets when bandwidth is limited
+        int priority;
+
         // Information about the camera device to match, or if this is a stereo camera,
         // then this is the information about the right camera device
         QString serial;
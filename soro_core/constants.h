@@ -71,4 +71,9 @@
 #define SORO_NET_MC_FIRST_VIDEO_PORT        5660
 #define SORO_NET_MC_LAST_VIDEO_PORT         5750
 
+// A camera can be streamed in several renditions at once. Rendition r of camera c uses the video
+// ports (and state topic) numbered c + r * SORO_NET_VIDEO_RENDITION_STRIDE
+#define SORO_MAX_VIDEO_RENDITIONS           3
+#define SORO_NET_VIDEO_RENDITION_STRIDE     30
+
 #endif // CONSTANTS_H
@@ -17,38 +17,61 @@
 #include "drivemessage.h"
 #include "constants.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
-DriveMessage::DriveMessage() { }
+typedef MessageCodec::Schema<DriveMessage, 1,
+        SORO_CODEC_FIELD(DriveMessage, wheelFL),
+        SORO_CODEC_FIELD(DriveMessage, wheelML),
+        SORO_CODEC_FIELD(DriveMessage, wheelBL),
+        SORO_CODEC_FIELD(DriveMessage, wheelFR),
+        SORO_CODEC_FIELD(DriveMessage, wheelMR),
+        SORO_CODEC_FIELD(DriveMessage, wheelBR)> DriveSchema;
 
-DriveMessage::DriveMessage(const QByteArray &payload)
+// Size of the QDataStream encoding used before DriveSchema
+static const int LEGACY_SIZE = 12;
+
+DriveMessage::DriveMessage()
+{
+    wheelFL = wheelML = wheelBL = wheelFR = wheelMR = wheelBR = 0;
+}
+
+DriveMessage::DriveMessage(const QByteArray &payload) : DriveMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream >> wheelFL;
-    stream >> wheelML;
-    stream >> wheelBL;
-    stream >> wheelFR;
-    stream >> wheelMR;
-    stream >> wheelBR;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> wheelFL >> wheelML >> wheelBL >> wheelFR >> wheelMR >> wheelBR;
+        });
+    }
+    else
+    {
+        _valid = DriveSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 DriveMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
+    return DriveSchema::encode(*this);
+}
 
-    stream << wheelFL
-           << wheelML
-           << wheelBL
-           << wheelFR
-           << wheelMR
-           << wheelBR;
+int DriveMessage::encode(char *buffer, int capacity) const
+{
+    return DriveSchema::encode(*this, buffer, capacity);
+}
 
+QByteArray DriveMessage::encodeLegacy() const
+{
+    QByteArray payload(LEGACY_SIZE, Qt::Uninitialized);
+    char *out = payload.data();
+    serialize<qint16>(out, wheelFL);
+    serialize<qint16>(out + 2, wheelML);
+    serialize<qint16>(out + 4, wheelBL);
+    serialize<qint16>(out + 6, wheelFR);
+    serialize<qint16>(out + 8, wheelMR);
+    serialize<qint16>(out + 10, wheelBR);
     return payload;
 }
 
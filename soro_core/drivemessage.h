@@ -13,6 +13,12 @@ struct SORO_CORE_EXPORT DriveMessage : public AbstractMessage
     DriveMessage();
     DriveMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
+
+    /* Encodes this message in the layout from before the message codec, six big endian wheel
+     * speeds, which is what the drive microcontroller reads
+     */
+    QByteArray encodeLegacy() const;
 
     qint16 wheelFL;
     qint16 wheelML;
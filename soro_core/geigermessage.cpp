@@ -1,31 +1,43 @@
 #include "geigermessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
+typedef MessageCodec::Schema<GeigerMessage, 1,
+        SORO_CODEC_FIELD(GeigerMessage, countsPerMinute)> GeigerSchema;
+
+// Size of the QDataStream encoding used before GeigerSchema
+static const int LEGACY_SIZE = 4;
+
 GeigerMessage::GeigerMessage()
 {
     countsPerMinute = 0;
 }
 
-GeigerMessage::GeigerMessage(const QByteArray &payload)
+GeigerMessage::GeigerMessage(const QByteArray &payload) : GeigerMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream >> countsPerMinute;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> countsPerMinute;
+        });
+    }
+    else
+    {
+        _valid = GeigerSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 GeigerMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << countsPerMinute;
+    return GeigerSchema::encode(*this);
+}
 
-    return payload;
+int GeigerMessage::encode(char *buffer, int capacity) const
+{
+    return GeigerSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
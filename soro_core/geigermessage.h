@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT GeigerMessage : public AbstractMessage
     GeigerMessage();
     GeigerMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     quint32 countsPerMinute;
 };
@@ -27,12 +27,14 @@ VideoProfile::VideoProfile()
     framerate = 30;
     bitrate = 2048000;
     mjpeg_quality = 50;
+    fec_percentage = 0;
 }
 
 VideoProfile::VideoProfile(QString description)
 {
     QStringList items = description.split(',');
-    if ((items[0] == "VP") && (items.size() == 7))
+    // Profiles written before FEC was added have no eighth item, they send none
+    if ((items[0] == "VP") && ((items.size() == 7) || (items.size() == 8)))
     {
         codec = items[1].toUInt();
         width = items[2].toUInt();
@@ -40,6 +42,7 @@ VideoProfile::VideoProfile(QString description)
         framerate = items[4].toUInt();
         bitrate = items[5].toUInt();
         mjpeg_quality = items[6].toUInt();
+        fec_percentage = items.value(7, "0").toUInt();
     }
     else
     {
@@ -49,6 +52,7 @@ VideoProfile::VideoProfile(QString description)
         framerate = 30;
         bitrate = 2048000;
         mjpeg_quality = 50;
+        fec_percentage = 0;
     }
 }
 
@@ -69,13 +73,14 @@ AudioProfile::AudioProfile(QString description)
 
 QString VideoProfile::toString() const
 {
-    return QString("VP,%1,%2,%3,%4,%5,%6")
+    return QString("VP,%1,%2,%3,%4,%5,%6,%7")
             .arg(QString::number(codec),
                  QString::number(width),
                  QString::number(height),
                  QString::number(framerate),
                  QString::number(bitrate),
-                 QString::number(mjpeg_quality));
+                 QString::number(mjpeg_quality),
+                 QString::number(fec_percentage));
 }
 
 bool VideoProfile::operator==(const VideoProfile& other) const
@@ -85,7 +90,8 @@ bool VideoProfile::operator==(const VideoProfile& other) const
             (height == other.height) &&
             (framerate == other.framerate) &&
             (bitrate == other.bitrate) &&
-            (mjpeg_quality == other.mjpeg_quality);
+            (mjpeg_quality == other.mjpeg_quality) &&
+            (fec_percentage == other.fec_percentage);
 }
 
 AudioProfile::AudioProfile()
@@ -107,64 +113,210 @@ bool AudioProfile::operator==(const AudioProfile& other) const
             (bitrate == other.bitrate);
 }
 
+// The FEC encoder of a main stream, named so its overhead can be changed while playing
+static QString getNamedRtpFecEncodeString(VideoProfile profile)
+{
+    if (profile.fec_percentage == 0) return "";
+    return QString("%1 name=%2 ! ").arg(getRtpFecEncodeElement(profile), VIDEO_FEC_ENCODER_NAME);
+}
+
 QString createRtpAlsaEncodeString(quint16 bindPort,  QHostAddress address, quint16 port, AudioProfile profile)
 {
     return "alsasrc ! audioconvert ! " + createRtpAudioEncodeString(bindPort, address, port, profile);
 }
 
-QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
+QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi, quint8 capturePath)
 {
+    QString captureCaps = QString("width=%1,height=%2,framerate=%3/1")
+            .arg(QString::number(profile.width),
+                 QString::number(profile.height),
+                 QString::number(profile.framerate));
+    bool surfaces = capturePathUsesSurfaces(capturePath, profile, vaapi);
+    // Each rendition of the camera is a branch from here, the main stream gets its own thread
+    QString captureTee = QString("tee name=%1 allow-not-linked=true ! queue max-size-buffers=2 ! ").arg(CAPTURE_TEE_NAME);
+
+    if ((capturePath == CAPTURE_PATH_H264_PASSTHROUGH) && (profile.codec == VIDEO_CODEC_H264))
+    {
+        // The camera's own encoder does the work, there is nothing to reconfigure but FEC and the sink.
+        // No capture tee either, there are no decoded frames for renditions or recordings.
+        return QString("v4l2src device=/dev/%1 ! "
+                       "capsfilter name=%2 caps=\"video/x-h264,%3\" ! "
+                       "h264parse ! "
+                       "%4 ! "
+                       "%5"
+                       "udpsink name=%6 bind-port=%7 host=%8 port=%9")
+                .arg(cameraDevice,
+                     VIDEO_ENCODE_CAPS_NAME,
+                     captureCaps,
+                     getRtpPayElement(profile.codec),
+                     getNamedRtpFecEncodeString(profile),
+                     VIDEO_SINK_NAME,
+                     QString::number(bindPort),
+                     address.toString(),
+                     QString::number(port));
+    }
+    if (capturePath == CAPTURE_PATH_MJPEG_DECODE)
+    {
+        return QString("v4l2src device=/dev/%1 ! "
+                       "image/jpeg,%2 ! "
+                       "%3 ! "
+                       "%4"
+                       "%5 ! "
+                       "%6")
+                .arg(cameraDevice,
+                     captureCaps,
+                     surfaces ? "vaapijpegdec" : "jpegdec",
+                     captureTee,
+                     surfaces ? "vaapipostproc" : "videoconvert ! videoscale method=0 add-borders=true",
+                     createRtpVideoEncodeString(bindPort, address, port, profile, vaapi, surfaces));
+    }
+    if (surfaces)
+    {
+        // CAPTURE_PATH_DMABUF, the camera's buffers are handed to the GPU as they are
+        return QString("v4l2src device=/dev/%1 io-mode=dmabuf ! "
+                       "video/x-raw,%2 ! "
+                       "%3"
+                       "vaapipostproc ! "
+                       "%4")
+                .arg(cameraDevice,
+                     captureCaps,
+                     captureTee,
+                     createRtpVideoEncodeString(bindPort, address, port, profile, vaapi, surfaces));
+    }
+
     return QString("v4l2src device=/dev/%1 ! "
+                   "%2"
                    "videoconvert ! "
                    "videoscale method=0 add-borders=true ! "
-                   "%2")
+                   "%3")
             .arg(cameraDevice,
+                 captureTee,
                  createRtpVideoEncodeString(bindPort, address, port, profile, vaapi));
 }
 
-QString createRtpStereoV4L2EncodeString(QString leftCameraDevice, QString rightCameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
+QString createRtpVideoRenditionString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi, bool surfaces)
 {
-    return QString("v4l2src device=/dev/%5 ! "
-                   "videoconvert ! "
-                   "videoscale method=0 add-borders=true ! "
-                   "video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
-                   "videoscale method=0 add-borders=false ! "
-                   "video/x-raw,width=%4,height=%2 ! "
-                   "videobox left=-%4 ! "
-                   "videomixer name=mix background=black ! "
-                   "%7 "
-                   "v4l2src device=/dev/%6 ! "
-                   "videoconvert ! "
-                   "videoscale method=0 add-borders=true ! "
-                   "video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
-                   "videoscale method=0 add-borders=false ! "
-                   "video/x-raw,width=%4,height=%2 ! "
-                   "mix.").arg(
-                QString::number(profile.width),
-                QString::number(profile.height),
-                QString::number(profile.framerate),
-                QString::number(profile.width / 2),
-                rightCameraDevice,
-                leftCameraDevice,
-                createRtpVideoEncodeString(bindPort, address, port, profile, vaapi));
-}
-
-QString createRtpVideoEncodeString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
-{
-    return QString("video/x-raw,format=I420,width=%1,height=%2,framerate=%3/1 ! "
+    // Nothing here is named, so the elements of the main stream can still be found by name. The rate
+    // is only ever lowered, a rendition cannot ask the camera for more frames than the main stream.
+    return QString("queue max-size-buffers=2 leaky=downstream ! "
+                   "videorate drop-only=true ! "
+                   "%1 ! "
+                   "capsfilter caps=\"%2\" ! "
+                   "%3 ! "
                    "%4 ! "
-                   "%5 ! "
+                   "%5"
                    "udpsink bind-port=%6 host=%7 port=%8")
-            .arg(QString::number(profile.width),
-                 QString::number(profile.height),
-                 QString::number(profile.framerate),
+            .arg(surfaces ? "vaapipostproc" : "videoconvert ! videoscale method=0 add-borders=true",
+                 getVideoEncodeCapsString(profile, surfaces && vaapi && hasVaapiEncoder(profile.codec)),
                  getVideoEncodeElement(profile, vaapi),
                  getRtpPayElement(profile.codec),
+                 profile.fec_percentage > 0 ? getRtpFecEncodeElement(profile) + " ! " : "",
                  QString::number(bindPort),
                  address.toString(),
                  QString::number(port));
 }
 
+QString createVideoRecordString(QString locationPattern, quint32 segmentSeconds, VideoProfile profile, bool vaapi, bool surfaces)
+{
+    // Nothing here is named either. The queue after the encoder rides out slow writes to disk without
+    // holding up the capture. Each split asks the encoder for a keyframe, so files stay close to their
+    // length whatever its keyframe interval, and Matroska is written as it goes, so a file cut short
+    // can still be played up to where it stopped.
+    QString parse = getVideoParseElement(profile.codec);
+    return QString("queue max-size-buffers=2 leaky=downstream ! "
+                   "videorate drop-only=true ! "
+                   "%1 ! "
+                   "capsfilter caps=\"%2\" ! "
+                   "%3 ! "
+                   "%4"
+                   "queue max-size-buffers=0 max-size-bytes=0 max-size-time=5000000000 ! "
+                   "splitmuxsink muxer-factory=matroskamux send-keyframe-requests=true max-size-time=%5 location=\"%6\"")
+            .arg(surfaces ? "vaapipostproc" : "videoconvert ! videoscale method=0 add-borders=true",
+                 getVideoEncodeCapsString(profile, surfaces && vaapi && hasVaapiEncoder(profile.codec)),
+                 getVideoEncodeElement(profile, vaapi),
+                 parse.isEmpty() ? "" : parse + " ! ",
+                 QString::number(segmentSeconds * 1000000000ull),
+                 locationPattern);
+}
+
+QString createRtpStereoV4L2EncodeString(QString leftCameraDevice, QString rightCameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
+{
+    // Each eye is scaled straight to half width (on the GPU with VAAPI), so the compositor only
+    // places the two halves side by side. Its latency lets it wait up to one frame for the later eye.
+    QString eyeCaps = QString("video/x-raw,format=I420,width=%1,height=%2,framerate=%3/1")
+            .arg(QString::number(profile.width / 2),
+                 QString::number(profile.height),
+                 QString::number(profile.framerate));
+    QString eyeScale = (vaapi && hasVaapiEncoder(profile.codec))
+            ? "vaapipostproc"
+            : "videoscale method=0 add-borders=false ! videoconvert";
+
+    return QString("compositor name=%1 background=black latency=%2 sink_0::xpos=0 sink_1::xpos=%3 ! "
+                   "%4 "
+                   "v4l2src device=/dev/%5 ! identity name=%6 ! %7 ! %8 ! queue max-size-buffers=2 ! %1.sink_0 "
+                   "v4l2src device=/dev/%9 ! identity name=%10 ! %7 ! %8 ! queue max-size-buffers=2 ! %1.sink_1")
+            .arg(STEREO_COMPOSITOR_NAME,
+                 QString::number(1000000000ull / qMax<quint16>(profile.framerate, 1)),
+                 QString::number(profile.width / 2),
+                 createRtpVideoEncodeString(bindPort, address, port, profile, vaapi),
+                 leftCameraDevice,
+                 STEREO_LEFT_EYE_NAME,
+                 eyeScale,
+                 eyeCaps,
+                 rightCameraDevice)
+            .arg(STEREO_RIGHT_EYE_NAME);
+}
+
+QString createRtpVideoEncodeString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi, bool surfaces)
+{
+    // The caps, encoder, FEC and sink are named so a running pipeline can be reconfigured
+    return QString("capsfilter name=%1 caps=\"%2\" ! "
+                   "%3 name=%4 ! "
+                   "%5 ! "
+                   "%6"
+                   "udpsink name=%7 bind-port=%8 host=%9 port=%10")
+            .arg(VIDEO_ENCODE_CAPS_NAME,
+                 getVideoEncodeCapsString(profile, surfaces),
+                 getVideoEncodeElement(profile, vaapi),
+                 VIDEO_ENCODER_NAME,
+                 getRtpPayElement(profile.codec),
+                 getNamedRtpFecEncodeString(profile),
+                 VIDEO_SINK_NAME,
+                 QString::number(bindPort),
+                 address.toString())
+            .arg(QString::number(port));
+}
+
+QString getVideoEncodeCapsString(VideoProfile profile, bool surfaces)
+{
+    // VAAPI picks the surface format itself
+    return QString(surfaces ? "video/x-raw(memory:VASurface),width=%1,height=%2,framerate=%3/1"
+                            : "video/x-raw,format=I420,width=%1,height=%2,framerate=%3/1")
+            .arg(QString::number(profile.width),
+                 QString::number(profile.height),
+                 QString::number(profile.framerate));
+}
+
+bool capturePathUsesSurfaces(quint8 capturePath, VideoProfile profile, bool vaapi)
+{
+    return vaapi && hasVaapiEncoder(profile.codec) &&
+            ((capturePath == CAPTURE_PATH_DMABUF) || (capturePath == CAPTURE_PATH_MJPEG_DECODE));
+}
+
+bool hasVaapiEncoder(quint8 codec)
+{
+    switch (codec)
+    {
+    case VIDEO_CODEC_H264:
+    case VIDEO_CODEC_MJPEG:
+    case VIDEO_CODEC_VP8:
+    case VIDEO_CODEC_H265:
+        return true;
+    default:
+        return false;
+    }
+}
+
 QString createRtpAudioEncodeString(quint16 bindPort, QHostAddress address, quint16 port, AudioProfile profile)
 {
     return QString("%1 ! %2 ! udpsink bind-port=%3 host=%4 port=%5")
@@ -185,14 +337,81 @@ QString createRtpAudioDecodeString(QHostAddress address, quint16 port, quint8 co
     return createRtpDepayString(address, port, codec) + " ! " + getAudioDecodeElement(codec);
 }
 
-QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 codec, bool vaapi)
+QString createRtpVideoReceiveString(QHostAddress address, quint16 port, quint8 codec, quint8 receiveMode, quint32 latencyMs, bool fec)
+{
+    // The jitter buffer always puts packets back in order and tells the depayloader about lost ones.
+    // How long it waits for late packets is what sets the modes apart.
+    QString jitterBuffer;
+    switch (receiveMode)
+    {
+    case RECEIVE_MODE_LOWEST_LATENCY:
+        // Packets later than FEC needs to rebuild them are dropped, they would only hold up newer frames
+        jitterBuffer = QString("rtpjitterbuffer do-lost=true drop-on-latency=true latency=%1")
+                .arg(QString::number(fec ? FEC_RECEIVE_LATENCY_MS : 0));
+        break;
+    case RECEIVE_MODE_RECORDING:
+        jitterBuffer = QString("rtpjitterbuffer do-lost=true latency=%1")
+                .arg(QString::number(qMax(latencyMs, RECORDING_RECEIVE_LATENCY_MS)));
+        break;
+    default:
+        jitterBuffer = QString("rtpjitterbuffer do-lost=true latency=%1")
+                .arg(QString::number(fec ? qMax(latencyMs, FEC_RECEIVE_LATENCY_MS) : latencyMs));
+        break;
+    }
+
+    QString depay = getRtpDepayElement(codec);
+    int split = depay.lastIndexOf(" ! ");
+    if (fec)
+    {
+        // The storage keeps the packets FEC is computed over, so lost packets the jitter buffer
+        // reports can be rebuilt
+        return QString("udpsrc address=%1 port=%2 ! %3 ! "
+                       "rtpstorage name=%4 size-time=%5 ! "
+                       "%6 ! "
+                       "rtpulpfecdec name=%7 pt=%8 ! "
+                       "%9").arg(
+                    address.toString(),
+                    QString::number(port),
+                    depay.left(split),
+                    VIDEO_FEC_STORAGE_NAME,
+                    QString::number(qMax(latencyMs, RECORDING_RECEIVE_LATENCY_MS) * 1000000ull),
+                    jitterBuffer,
+                    VIDEO_FEC_DECODER_NAME,
+                    QString::number(VIDEO_FEC_PAYLOAD_TYPE),
+                    depay.mid(split + 3));
+    }
+    return QString("udpsrc address=%1 port=%2 ! %3 ! %4 ! %5").arg(
+                address.toString(),
+                QString::number(port),
+                depay.left(split),
+                jitterBuffer,
+                depay.mid(split + 3));
+}
+
+QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 codec, quint8 receiveMode, quint32 latencyMs, bool vaapi, bool fec, bool gl)
 {
-    return createRtpDepayString(address, port, codec) + " ! " + getVideoDecodeElement(codec, vaapi) + " ! videoconvert ! video/x-raw,format=RGB ! videoconvert";
+    // The view gate and caps let everything through until they are set otherwise
+    QString bin = createRtpVideoReceiveString(address, port, codec, receiveMode, latencyMs, fec) +
+            QString(" ! identity name=%1 ! ").arg(VIDEO_VIEW_GATE_NAME) +
+            getVideoDecodeElement(codec, vaapi);
+    if (!gl)
+    {
+        bin += QString(" ! videoscale ! capsfilter name=%1 caps=video/x-raw").arg(VIDEO_VIEW_CAPS_NAME);
+    }
+    return bin + " ! " + getVideoSinkConvertString(gl);
 }
 
-QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, QString textOverlay, bool decodeVaapi, bool encodeVaapi)
+QString getVideoSinkConvertString(bool gl)
 {
-    QString bin = createRtpDepayString(address, port, codec) + " ! " + getVideoDecodeElement(codec, decodeVaapi) + " ! videoconvert ! video/x-raw,format=I420 ! ";
+    // No caps after the conversion, the sink picks the format and the conversion is skipped if the video
+    // already has it. VAAPI surfaces are imported by glupload without leaving the GPU.
+    return gl ? "glupload ! glcolorconvert" : "videoconvert";
+}
+
+QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, QString textOverlay, bool decodeVaapi, bool encodeVaapi, bool fec)
+{
+    QString bin = createRtpVideoReceiveString(address, port, codec, RECEIVE_MODE_RECORDING, 0, fec) + " ! " +
+            getVideoDecodeElement(codec, decodeVaapi) + " ! videoconvert ! video/x-raw,format=I420 ! ";
     if (timeOverlay)
     {
         bin += "timeoverlay halignment=center valignment=top ! ";
@@ -248,6 +467,35 @@ QString getRtpPayElement(quint8 codec)
     }
 }
 
+QString getRtpFecEncodeElement(VideoProfile profile)
+{
+    if (profile.fec_percentage == 0) return "";
+    // Without RED, so the media packets go out unchanged and FEC packets are only told apart by payload type
+    return QString("rtpulpfecenc pt=%1 percentage=%2")
+            .arg(QString::number(VIDEO_FEC_PAYLOAD_TYPE),
+                 QString::number(profile.fec_percentage));
+}
+
+QString getVideoParseElement(quint8 codec)
+{
+    switch (codec)
+    {
+    case VIDEO_CODEC_H264:
+        return "h264parse";
+    case VIDEO_CODEC_H265:
+        return "h265parse";
+    case VIDEO_CODEC_MPEG2:
+        return "mpegvideoparse";
+    case VIDEO_CODEC_MPEG4:
+        return "mpeg4videoparse";
+    case VIDEO_CODEC_MJPEG:
+        return "jpegparse";
+    default:
+        // VP8 and VP9 frames are muxed as they come from the encoder
+        return "";
+    }
+}
+
 QString getRtpDepayElement(quint8 codec)
 {
     switch (codec)
@@ -257,7 +505,7 @@ QString getRtpDepayElement(quint8 codec)
     case VIDEO_CODEC_H264:
         return "application/x-rtp,media=video,encoding-name=H264,clock-rate=90000,payload=96 ! rtph264depay";
     case VIDEO_CODEC_MJPEG:
-        return "application/x-rtp,media=video,encoding-name=JPEG,payload=26 ! rtpjpegdepay";
+        return "application/x-rtp,media=video,encoding-name=JPEG,clock-rate=90000,payload=26 ! rtpjpegdepay";
     case VIDEO_CODEC_VP8:
         return "application/x-rtp,media=video,encoding-name=VP8,clock-rate=90000,payload=96 ! rtpvp8depay";
     case VIDEO_CODEC_VP9:
@@ -299,27 +547,29 @@ QString getAudioDecodeElement(quint8 codec)
 
 QString getVideoEncodeElement(VideoProfile profile, bool vaapi)
 {
+    if (vaapi && !hasVaapiEncoder(profile.codec))
+    {
+        // No VAAPI encoder for these formats
+        vaapi = false;
+    }
+
+    QString element;
     if (vaapi)
     {
         switch (profile.codec)
         {
-        case VIDEO_CODEC_MPEG4:
-        case VIDEO_CODEC_VP9:
-            // No VAAPI encoder for these formats
-            return getVideoEncodeElement(profile, false);
         case VIDEO_CODEC_H264:
-            return QString("vaapih264enc bitrate=%1")
-                    .arg(QString::number(profile.bitrate / 1000)); // Bitrate wanted in kbit/sec
+            element = "vaapih264enc";
+            break;
         case VIDEO_CODEC_MJPEG:
-            return QString("vaapijpegenc bitrate=%1 quality=%2")
-                    .arg(QString::number(profile.bitrate / 1000), // Bitrate wanted in kbit/sec
-                         QString::number(profile.mjpeg_quality));
+            element = "vaapijpegenc";
+            break;
         case VIDEO_CODEC_VP8:
-            return QString("vaapivp8enc bitrate=%1")
-                    .arg(QString::number(profile.bitrate / 1000)); // Bitrate wanted in kbit/sec
+            element = "vaapivp8enc";
+            break;
         case VIDEO_CODEC_H265:
-            return QString("vaapih265enc bitrate=%1")
-                    .arg(QString::number(profile.bitrate / 1000)); // Bitrate wanted in kbit/sec
+            element = "vaapih265enc";
+            break;
         default:
             // unknown codec
             return "";
@@ -330,29 +580,79 @@ QString getVideoEncodeElement(VideoProfile profile, bool vaapi)
         switch (profile.codec)
         {
         case VIDEO_CODEC_MPEG4:
-            return QString("avenc_mpeg4 bitrate=%1")
-                    .arg(QString::number(profile.bitrate));
+            element = "avenc_mpeg4";
             break;
         case VIDEO_CODEC_H264:
-            return QString("x264enc speed-preset=ultrafast tune=zerolatency bitrate=%1")
-                    .arg(QString::number(profile.bitrate / 1000)); // Bitrate wanted in kbit/sec
+            element = "x264enc speed-preset=ultrafast tune=zerolatency";
+            break;
         case VIDEO_CODEC_MJPEG:
-            return QString("jpegenc quality=%1")
-                    .arg(QString::number(profile.mjpeg_quality));
+            element = "jpegenc";
+            break;
         case VIDEO_CODEC_VP8:
-            return QString("vp8enc target-bitrate=%1")
-                    .arg(QString::number(profile.bitrate));
+            element = "vp8enc";
+            break;
         case VIDEO_CODEC_VP9:
-            return QString("vp9enc target-bitrate=%1")
-                    .arg(QString::number(profile.bitrate));
+            element = "vp9enc";
+            break;
         case VIDEO_CODEC_H265:
-            return QString("x265enc speed-preset=ultrafast tune=zerolatency bitrate=%1")
-                    .arg(QString::number(profile.bitrate / 1000)); // Bitrate wanted in kbit/sec
+            element = "x265enc speed-preset=ultrafast tune=zerolatency";
+            break;
         default:
             // unknown codec
             return "";
         }
     }
+
+    for (const EncoderProperty& property : getVideoEncodeProperties(profile, vaapi))
+    {
+        element += QString(" %1=%2").arg(property.first, QString::number(property.second));
+    }
+    return element;
+}
+
+QList<EncoderProperty> getVideoEncodeProperties(VideoProfile profile, bool vaapi)
+{
+    QList<EncoderProperty> properties;
+    if (vaapi && hasVaapiEncoder(profile.codec))
+    {
+        switch (profile.codec)
+        {
+        case VIDEO_CODEC_MJPEG:
+            properties << EncoderProperty("bitrate", profile.bitrate / 1000); // Bitrate wanted in kbit/sec
+            properties << EncoderProperty("quality", profile.mjpeg_quality);
+            break;
+        case VIDEO_CODEC_H264:
+        case VIDEO_CODEC_VP8:
+        case VIDEO_CODEC_H265:
+            properties << EncoderProperty("bitrate", profile.bitrate / 1000); // Bitrate wanted in kbit/sec
+            break;
+        default:
+            break;
+        }
+    }
+    else
+    {
+        switch (profile.codec)
+        {
+        case VIDEO_CODEC_MPEG4:
+            properties << EncoderProperty("bitrate", profile.bitrate);
+            break;
+        case VIDEO_CODEC_H264:
+        case VIDEO_CODEC_H265:
+            properties << EncoderProperty("bitrate", profile.bitrate / 1000); // Bitrate wanted in kbit/sec
+            break;
+        case VIDEO_CODEC_MJPEG:
+            properties << EncoderProperty("quality", profile.mjpeg_quality);
+            break;
+        case VIDEO_CODEC_VP8:
+        case VIDEO_CODEC_VP9:
+            properties << EncoderProperty("target-bitrate", profile.bitrate);
+            break;
+        default:
+            break;
+        }
+    }
+    return properties;
 }
 
 QString getVideoDecodeElement(quint8 codec, bool vaapi)
@@ -404,5 +704,22 @@ QString getCodecName(quint8 codec)
     }
 }
 
+QString getCapturePathName(quint8 capturePath)
+{
+    switch (capturePath)
+    {
+    case CAPTURE_PATH_RAW:
+        return "raw";
+    case CAPTURE_PATH_MJPEG_DECODE:
+        return "MJPEG decode";
+    case CAPTURE_PATH_DMABUF:
+        return "DMABUF";
+    case CAPTURE_PATH_H264_PASSTHROUGH:
+        return "H264 passthrough";
+    default:
+        return "INVALID";
+    }
+}
+
 } // namespace GStreamerUtil
 } // namespace Soro
@@ -3,6 +3,8 @@
 
 #include <QString>
 #include <QHostAddress>
+#include <QList>
+#include <QPair>
 
 #include "soro_core_global.h"
 
@@ -24,6 +26,52 @@ const quint8 AUDIO_CODEC_AC3 = 100;
 
 const quint8 CODEC_NULL = 255;
 
+// Ways of getting video from a camera into the encoder, from most to least CPU work
+const quint8 CAPTURE_PATH_RAW = 0;                  // Raw frames converted and scaled on the CPU
+const quint8 CAPTURE_PATH_MJPEG_DECODE = 1;         // MJPEG frames decoded, on the GPU with VAAPI
+const quint8 CAPTURE_PATH_DMABUF = 2;               // Raw frames imported into VAAPI without copying
+const quint8 CAPTURE_PATH_H264_PASSTHROUGH = 3;     // H264 from the camera sent as is
+
+// Names of the elements in a video encode pipeline that can be changed while it is running
+const char VIDEO_ENCODER_NAME[] = "videoencoder";
+const char VIDEO_ENCODE_CAPS_NAME[] = "videoencodecaps";
+const char VIDEO_SINK_NAME[] = "videosink";
+const char VIDEO_FEC_ENCODER_NAME[] = "videofec";
+
+// Names of the elements in a video decode pipeline that recover lost packets from FEC
+const char VIDEO_FEC_STORAGE_NAME[] = "videofecstorage";
+const char VIDEO_FEC_DECODER_NAME[] = "videofecdec";
+
+// Names of the elements in a video decode pipeline that adapt it to how the video is shown. The gate in front
+// of the decoder can drop all but keyframes, and the caps after it can scale the decoded video down.
+const char VIDEO_VIEW_GATE_NAME[] = "videoviewgate";
+const char VIDEO_VIEW_CAPS_NAME[] = "videoviewcaps";
+
+// RTP payload type of ULPFEC packets, sent in the same stream as the media packets they protect
+const quint8 VIDEO_FEC_PAYLOAD_TYPE = 122;
+
+// How a received video stream is buffered on its way to the screen
+const quint8 RECEIVE_MODE_LOWEST_LATENCY = 0;   // Frames are shown as soon as they are decoded, late packets are dropped
+const quint8 RECEIVE_MODE_SMOOTH = 1;           // Packets wait in a jitter buffer so frames are shown at an even pace
+const quint8 RECEIVE_MODE_RECORDING = 2;        // Packets wait long enough that nothing which arrives is dropped
+
+// Shortest time packets wait in the jitter buffer in the recording mode, and in the lowest latency mode when
+// lost packets can be recovered from FEC
+const quint32 RECORDING_RECEIVE_LATENCY_MS = 1000;
+const quint32 FEC_RECEIVE_LATENCY_MS = 40;
+
+// Name of the tee a single camera's capture is split at, so more renditions can be encoded from it
+const char CAPTURE_TEE_NAME[] = "capturetee";
+
+// Names of the elements each eye of a stereo pipeline passes through as it leaves its camera, and of
+// the element that puts the eyes side by side
+const char STEREO_LEFT_EYE_NAME[] = "lefteye";
+const char STEREO_RIGHT_EYE_NAME[] = "righteye";
+const char STEREO_COMPOSITOR_NAME[] = "stereomix";
+
+// A numeric property of an encoder element, with its value
+typedef QPair<QString, quint32> EncoderProperty;
+
 struct SORO_CORE_EXPORT VideoProfile
 {
     quint8 codec;
@@ -32,6 +80,8 @@ struct SORO_CORE_EXPORT VideoProfile
     quint16 framerate;
     quint32 bitrate;
     quint8 mjpeg_quality;
+    // Size of the ULPFEC packets sent with the stream, as a percentage of the media packets. 0 sends none.
+    quint8 fec_percentage;
 
     VideoProfile();
     VideoProfile(QString description);
@@ -69,28 +119,74 @@ struct SORO_CORE_EXPORT AudioProfile
 QString createRtpAlsaEncodeString(quint16 bindPort, QHostAddress address, quint16 port, AudioProfile profile);
 
 /* Creates a pipeline string that encodes video from a camera into a RTP stream
+ *
+ * Every capture path but CAPTURE_PATH_H264_PASSTHROUGH splits the capture at a tee named CAPTURE_TEE_NAME,
+ * from which renditions and recordings are encoded. The passthrough path never decodes the camera's
+ * H264, so it has no such tee. Captures that need renditions or a recording must use another path.
+ */
+QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false, quint8 capturePath=CAPTURE_PATH_RAW);
+
+/* Creates a pipeline string for a rendition, a branch that takes video from the capture tee of a camera's
+ * pipeline and encodes it into a RTP stream of its own. If surfaces is set, the capture is on a path
+ * that feeds VAAPI.
+ */
+QString createRtpVideoRenditionString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false, bool surfaces=false);
+
+/* Creates a pipeline string for a recording, a branch that takes video from the capture tee of a camera's
+ * pipeline, encodes it and writes it to a series of Matroska files of about segmentSeconds each. The
+ * location pattern holds one printf-style integer, which is replaced with the number of each file.
  */
-QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false);
+QString createVideoRecordString(QString locationPattern, quint32 segmentSeconds, VideoProfile profile, bool vaapi=false, bool surfaces=false);
 
+/* Creates a pipeline string that puts the video from two cameras side by side, each squeezed to half
+ * the width of the profile, and encodes it into a RTP stream
+ */
 QString createRtpStereoV4L2EncodeString(QString leftCameraDevice, QString rightCameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false);
 
-/* Creates a pipeline string that encodes raw video into a RTP stream
+/* Creates a pipeline string that encodes raw video into a RTP stream. If surfaces is set, the video arrives
+ * as VAAPI surfaces instead of in system memory.
+ */
+QString createRtpVideoEncodeString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false, bool surfaces=false);
+
+/* Gets the caps raw video is converted to before it is encoded for the specified video profile
  */
-QString createRtpVideoEncodeString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false);
+QString getVideoEncodeCapsString(VideoProfile profile, bool surfaces=false);
+
+/* Checks whether video captured on the specified path reaches the encoder as VAAPI surfaces
+ */
+bool capturePathUsesSurfaces(quint8 capturePath, VideoProfile profile, bool vaapi);
+
+/* Checks whether there is a VAAPI encoder for the specified video codec
+ */
+bool hasVaapiEncoder(quint8 codec);
 
 /* Creates a pipeline string that encodes raw audio into a RTP stream
  */
 QString createRtpAudioEncodeString(quint16 bindPort, QHostAddress address, quint16 port, AudioProfile profile);
 
-/* Creates a pipeline string that accepts an RTP video stream on a UDP port, and decodes it from the specified codec to a raw video stream
+/* Creates a pipeline string that accepts an RTP video stream on a UDP port and buffers it according to the receive
+ * mode, and depayloads it to an encoded video stream. The latency is how long packets wait in the jitter buffer in
+ * the smooth mode. If fec is set, the stream carries ULPFEC packets that are used to recover lost media packets,
+ * and the FEC decoder needs the storage element's internal-storage as its storage property.
+ */
+QString createRtpVideoReceiveString(QHostAddress address, quint16 port, quint8 codec, quint8 receiveMode, quint32 latencyMs=0, bool fec=false);
+
+/* Creates a pipeline string that accepts an RTP video stream on a UDP port, and decodes it from the specified codec to a raw video stream.
+ * The stream is buffered as in createRtpVideoReceiveString(), and converted once into whatever format the sink downstream accepts.
+ * If gl is set, that sink is a GL sink such as qmlglsink, which scales on the GPU, so there are no view caps to scale with.
+ */
+QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 codec, quint8 receiveMode, quint32 latencyMs=0, bool vaapi=false, bool fec=false, bool gl=false);
+
+/* Gets the elements that convert raw video, in system memory or on the GPU, into a format the video sink accepts.
+ * If gl is set, the sink is a GL sink and the video is uploaded to textures and converted there.
  */
-QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 codec, bool vaapi=false);
+QString getVideoSinkConvertString(bool gl=false);
 
 /* Creates a pipeline string that accepts an RTP video stream on a UDP port, and decodes it from the specified codec and
  * re-encodes it as an H264 video file at the specifed location. If desired, a timestamp and/or custom text can be
  * overlaid on the video.
  */
-QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, QString textOverlay, bool decodeVaapi=false, bool encodeVaapi=false);
+QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, QString textOverlay, bool decodeVaapi=false, bool encodeVaapi=false, bool fec=false);
 
 /* Creates a pipeline string that outputs a video test pattern
  */
@@ -117,6 +213,16 @@ QString getRtpDepayElement(quint8 codec);
  */
 QString getRtpPayElement(quint8 codec);
 
+/* Gets the element name and associated options to add ULPFEC packets to an RTP video stream in the specified
+ * profile, or an empty string if the profile sends none
+ */
+QString getRtpFecEncodeElement(VideoProfile profile);
+
+/* Gets the element that parses an encoded stream in the specified video codec so it can be muxed into
+ * a file, or an empty string if the encoder's output can be muxed as it is
+ */
+QString getVideoParseElement(quint8 codec);
+
 /* Gets the element name and associated options to decode the specified video profile
  */
 QString getVideoDecodeElement(quint8 codec, bool vaapi=false);
@@ -125,6 +231,11 @@ QString getVideoDecodeElement(quint8 codec, bool vaapi=false);
  */
 QString getVideoEncodeElement(VideoProfile profile, bool vaapi=false);
 
+/* Gets the properties of the encoder element that are set from the specified video profile, in the
+ * units that element expects
+ */
+QList<EncoderProperty> getVideoEncodeProperties(VideoProfile profile, bool vaapi=false);
+
 /* Gets the element name and associated options to decode the specified audio codec
  */
 QString getAudioDecodeElement(quint8 codec);
@@ -137,6 +248,10 @@ QString getAudioEncodeElement(AudioProfile profile);
  */
 QString getCodecName(quint8 codec);
 
+/* Gets the human-readable name of a capture path
+ */
+QString getCapturePathName(quint8 capturePath);
+
 } // namespace GStreamerUtil
 } // namespace Soro
 
@@ -16,32 +16,44 @@
 
 #include "latencymessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
+typedef MessageCodec::Schema<LatencyMessage, 1,
+        SORO_CODEC_FIELD(LatencyMessage, latency)> LatencySchema;
+
+// Size of the QDataStream encoding used before LatencySchema
+static const int LEGACY_SIZE = 2;
+
 LatencyMessage::LatencyMessage()
 {
     latency = 0;
 }
 
-LatencyMessage::LatencyMessage(const QByteArray &payload)
+LatencyMessage::LatencyMessage(const QByteArray &payload) : LatencyMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream >> latency;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> latency;
+        });
+    }
+    else
+    {
+        _valid = LatencySchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 LatencyMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << latency;
+    return LatencySchema::encode(*this);
+}
 
-    return payload;
+int LatencyMessage::encode(char *buffer, int capacity) const
+{
+    return LatencySchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
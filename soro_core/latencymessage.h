@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT LatencyMessage : public AbstractMessage
     LatencyMessage();
     LatencyMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     quint16 latency;
 };
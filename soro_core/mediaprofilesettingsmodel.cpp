@@ -82,6 +82,7 @@ void MediaProfileSettingsModel::load() {
         profile.bitrate = jsonObject.toObject()["bitrate"].toInt(0);
         profile.framerate = jsonObject.toObject()["framerate"].toInt(0);
         profile.mjpeg_quality = jsonObject.toObject()["quality"].toInt(0);
+        profile.fec_percentage = jsonObject.toObject()["fec_percentage"].toInt(0);
         QString encoding = jsonObject.toObject()["encoding"].toString().toLower();
 
         if (encoding == "mjpeg")
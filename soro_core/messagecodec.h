@@ -0,0 +1,311 @@
+#ifndef MESSAGECODEC_H
+#define MESSAGECODEC_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QVector>
+#include <cstring>
+#include <type_traits>
+
+#include "serialize.h"
+#include "latlng.h"
+#include "gstreamerutil.h"
+#include "spectrum.h"
+
+/* Fixed-layout binary encoding for messages.
+ *
+ * A message's encoding is described by a schema listing its fields in order, for example
+ *
+ *   typedef MessageCodec::Schema<DriveMessage, 1,
+ *           SORO_CODEC_FIELD(DriveMessage, wheelFL),
+ *           SORO_CODEC_FIELD(DriveMessage, wheelML)> DriveSchema;
+ *
+ * Every field has a fixed size, so the encoded size of a message is known at compile time and
+ * messages can be encoded into a caller's buffer without allocating. All values are big endian.
+ *
+ * Encoded messages begin with a two byte header holding the codec format version and the schema
+ * revision. Schemas may only grow by appending fields (and bumping their revision): a decoder
+ * leaves fields missing from an older sender at their defaults, and ignores trailing fields
+ * from a newer sender.
+ *
+ * Messages that existed before this codec were written field by field with a big endian
+ * QDataStream. Their constructors still accept that layout through decodeLegacy(), so payloads
+ * from nodes that have not been rebuilt (and from firmware that speaks the old layout) are read
+ * rather than mistaken for default values.
+ */
+
+#define SORO_CODEC_FIELD(MessageType, member) \
+    Soro::MessageCodec::Field<MessageType, decltype(MessageType::member), &MessageType::member>
+
+#define SORO_CODEC_STRING(MessageType, member, maxBytes) \
+    Soro::MessageCodec::StringField<MessageType, &MessageType::member, maxBytes>
+
+#define SORO_CODEC_ARRAY(MessageType, member, count) \
+    Soro::MessageCodec::ArrayField<MessageType, decltype(MessageType::member), &MessageType::member, count>
+
+namespace Soro {
+namespace MessageCodec {
+
+const quint8 FORMAT_VERSION = 1;
+const int HEADER_SIZE = 2;
+
+/* Encoding of a single value
+ */
+template <typename T, typename Enable=void>
+struct Traits;
+
+template <typename T>
+struct Traits<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    static const int SIZE = sizeof(T);
+    static inline void encode(char *out, T value) { serialize<T>(out, value); }
+    static inline void decode(const char *in, T& value) { value = deserialize<T>(in); }
+};
+
+template <>
+struct Traits<LatLng>
+{
+    static const int SIZE = 16;
+    static inline void encode(char *out, const LatLng& value)
+    {
+        serialize<double>(out, value.latitude);
+        serialize<double>(out + 8, value.longitude);
+    }
+    static inline void decode(const char *in, LatLng& value)
+    {
+        value.latitude = deserialize<double>(in);
+        value.longitude = deserialize<double>(in + 8);
+    }
+};
+
+template <>
+struct Traits<GStreamerUtil::VideoProfile>
+{
+    static const int SIZE = 12;
+    static inline void encode(char *out, const GStreamerUtil::VideoProfile& value)
+    {
+        Traits<quint8>::encode(out, value.codec);
+        Traits<quint16>::encode(out + 1, value.width);
+        Traits<quint16>::encode(out + 3, value.height);
+        Traits<quint16>::encode(out + 5, value.framerate);
+        Traits<quint32>::encode(out + 7, value.bitrate);
+        Traits<quint8>::encode(out + 11, value.mjpeg_quality);
+    }
+    static inline void decode(const char *in, GStreamerUtil::VideoProfile& value)
+    {
+        Traits<quint8>::decode(in, value.codec);
+        Traits<quint16>::decode(in + 1, value.width);
+        Traits<quint16>::decode(in + 3, value.height);
+        Traits<quint16>::decode(in + 5, value.framerate);
+        Traits<quint32>::decode(in + 7, value.bitrate);
+        Traits<quint8>::decode(in + 11, value.mjpeg_quality);
+    }
+};
+
+template <>
+struct Traits<Spectrum>
+{
+    static const int SIZE = Spectrum::ENCODED_SIZE;
+    static inline void encode(char *out, const Spectrum& value) { value.encode(out); }
+    static inline void decode(const char *in, Spectrum& value) { value.decode(in); }
+};
+
+/* A member of a message encoded with its type's traits
+ */
+template <typename M, typename T, T M::*member>
+struct Field
+{
+    static const int SIZE = Traits<T>::SIZE;
+    static inline bool encode(const M& msg, char *out) { Traits<T>::encode(out, msg.*member); return true; }
+    static inline bool decode(M& msg, const char *in) { Traits<T>::decode(in, msg.*member); return true; }
+};
+
+/* A string member, encoded as a length byte followed by up to maxBytes of UTF-8 and zero padding.
+ * Strings longer than maxBytes are not truncated: the message fails to encode instead, since a
+ * shortened serial or device id would silently match the wrong device.
+ */
+template <typename M, QString M::*member, int maxBytes>
+struct StringField
+{
+    static_assert(maxBytes > 0 && maxBytes < 256, "String fields hold at most 255 bytes");
+    static const int SIZE = 1 + maxBytes;
+
+    static inline bool encode(const M& msg, char *out)
+    {
+        const QString& str = msg.*member;
+        const QChar *chars = str.constData();
+        const int count = str.size();
+        int length = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            uint code = chars[i].unicode();
+            if (chars[i].isHighSurrogate() && (i + 1 < count) && chars[i + 1].isLowSurrogate())
+            {
+                code = QChar::surrogateToUcs4(chars[i], chars[i + 1]);
+            }
+
+            char bytes[4];
+            int n;
+            if (code < 0x80)
+            {
+                bytes[0] = code;
+                n = 1;
+            }
+            else if (code < 0x800)
+            {
+                bytes[0] = 0xC0 | (code >> 6);
+                bytes[1] = 0x80 | (code & 0x3F);
+                n = 2;
+            }
+            else if (code < 0x10000)
+            {
+                bytes[0] = 0xE0 | (code >> 12);
+                bytes[1] = 0x80 | ((code >> 6) & 0x3F);
+                bytes[2] = 0x80 | (code & 0x3F);
+                n = 3;
+            }
+            else
+            {
+                bytes[0] = 0xF0 | (code >> 18);
+                bytes[1] = 0x80 | ((code >> 12) & 0x3F);
+                bytes[2] = 0x80 | ((code >> 6) & 0x3F);
+                bytes[3] = 0x80 | (code & 0x3F);
+                n = 4;
+                ++i;
+            }
+
+            if (length + n > maxBytes) return false;
+            memcpy(out + 1 + length, bytes, n);
+            length += n;
+        }
+
+        out[0] = length;
+        memset(out + 1 + length, 0, maxBytes - length);
+        return true;
+    }
+
+    static inline bool decode(M& msg, const char *in)
+    {
+        int length = reinterpret_cast<const uchar&>(in[0]);
+        if (length > maxBytes) return false;
+        msg.*member = QString::fromUtf8(in + 1, length);
+        return true;
+    }
+};
+
+/* A vector of numbers holding exactly count values. Missing values are encoded as zero.
+ */
+template <typename M, typename V, V M::*member, int count>
+struct ArrayField
+{
+    typedef typename V::value_type T;
+    static_assert(std::is_arithmetic<T>::value, "Array fields hold numeric values");
+    static const int SIZE = count * sizeof(T);
+
+    static inline bool encode(const M& msg, char *out)
+    {
+        const V& values = msg.*member;
+        const int available = qMin(values.size(), count);
+        serializeArray<T>(out, values.constData(), available);
+        memset(out + available * sizeof(T), 0, (count - available) * sizeof(T));
+        return true;
+    }
+
+    static inline bool decode(M& msg, const char *in)
+    {
+        V& values = msg.*member;
+        values.resize(count);
+        deserializeArray<T>(in, values.data(), count);
+        return true;
+    }
+};
+
+/* Encodes a list of fields back to back
+ */
+template <typename M, typename... Fields>
+struct FieldList;
+
+template <typename M>
+struct FieldList<M>
+{
+    static const int SIZE = 0;
+    static inline bool encode(const M&, char*) { return true; }
+    static inline bool decode(M&, const char*, int) { return true; }
+};
+
+template <typename M, typename F, typename... Rest>
+struct FieldList<M, F, Rest...>
+{
+    static const int SIZE = F::SIZE + FieldList<M, Rest...>::SIZE;
+
+    static inline bool encode(const M& msg, char *out)
+    {
+        return F::encode(msg, out) && FieldList<M, Rest...>::encode(msg, out + F::SIZE);
+    }
+
+    // Stops at the end of the buffer, which must fall between two fields
+    static inline bool decode(M& msg, const char *in, int length)
+    {
+        if (length == 0) return true;
+        if (length < F::SIZE) return false;
+        return F::decode(msg, in) && FieldList<M, Rest...>::decode(msg, in + F::SIZE, length - F::SIZE);
+    }
+};
+
+/* The encoding of a message type, at a given revision of its field list
+ */
+template <typename M, quint8 revision, typename... Fields>
+struct Schema
+{
+    static const int SIZE = HEADER_SIZE + FieldList<M, Fields...>::SIZE;
+
+    /* Encodes msg into buffer, returning the number of bytes written or -1 if
+     * capacity is too small or a string field is too long
+     */
+    static inline int encode(const M& msg, char *buffer, int capacity)
+    {
+        if (capacity < SIZE) return -1;
+        buffer[0] = FORMAT_VERSION;
+        buffer[1] = revision;
+        return FieldList<M, Fields...>::encode(msg, buffer + HEADER_SIZE) ? SIZE : -1;
+    }
+
+    /* Encodes msg, returning an empty payload (which no receiver accepts) if a string field
+     * is too long
+     */
+    static inline QByteArray encode(const M& msg)
+    {
+        QByteArray payload(SIZE, Qt::Uninitialized);
+        if (encode(msg, payload.data(), SIZE) < 0) return QByteArray();
+        return payload;
+    }
+
+    /* Decodes into msg, returning false if the buffer is not in a format this codec understands
+     * or holds no fields, or is cut off inside a field
+     */
+    static inline bool decode(M& msg, const char *buffer, int length)
+    {
+        if ((length <= HEADER_SIZE) || (static_cast<quint8>(buffer[0]) != FORMAT_VERSION)) return false;
+        return FieldList<M, Fields...>::decode(msg, buffer + HEADER_SIZE, length - HEADER_SIZE);
+    }
+};
+
+/* Reads a payload written by a message's QDataStream encoding from before this codec. read is
+ * given a big endian stream over the payload, and the payload is accepted only if it held
+ * exactly what read consumed.
+ */
+template <typename F>
+inline bool decodeLegacy(const QByteArray& payload, F read)
+{
+    QDataStream stream(payload);
+    stream.setByteOrder(QDataStream::BigEndian);
+    read(stream);
+    return (stream.status() == QDataStream::Ok) && stream.atEnd();
+}
+
+} // namespace MessageCodec
+} // namespace Soro
+
+#endif // MESSAGECODEC_H
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mqtthub.h"
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#define LogTag "MqttHub"
+
+namespace Soro {
+
+#define PRESENCE_TOPIC "component_presence"
+#define SYSTEM_DOWN_TOPIC "system_down"
+
+MqttHub *MqttHub::_self = nullptr;
+
+MqttHub* MqttHub::getInstance(const QHostAddress& brokerAddress, quint16 brokerPort)
+{
+    if (!_self)
+    {
+        _self = new MqttHub(brokerAddress, brokerPort, QCoreApplication::instance());
+    }
+    return _self;
+}
+
+MqttHub::MqttHub(const QHostAddress& brokerAddress, quint16 brokerPort, QObject *parent) : QObject(parent)
+{
+    LOG_I(LogTag, "Creating shared MQTT client...");
+    _client = new QMQTT::Client(brokerAddress, brokerPort, this);
+    connect(_client, &QMQTT::Client::connected, this, &MqttHub::onConnected);
+    connect(_client, &QMQTT::Client::disconnected, this, &MqttHub::onDisconnected);
+    connect(_client, &QMQTT::Client::received, this, &MqttHub::onReceived);
+    _client->setClientId(QCoreApplication::applicationName() + "_" + QString::number(QCoreApplication::applicationPid()));
+    _client->setAutoReconnect(true);
+    _client->setAutoReconnectInterval(1000);
+    _client->setWillTopic(PRESENCE_TOPIC);
+    _client->setWillQos(2);
+    _client->setWillRetain(false);
+
+    // Connect once the components created alongside us have registered their wills
+    QTimer::singleShot(0, _client, &QMQTT::Client::connectToHost);
+}
+
+MqttHub::~MqttHub()
+{
+    // Endpoints may outlive us during application shutdown
+    for (MqttEndpoint *endpoint : _endpoints)
+    {
+        endpoint->_hub = nullptr;
+    }
+    if (_self == this)
+    {
+        _self = nullptr;
+    }
+}
+
+MqttEndpoint* MqttHub::createEndpoint(const QString& clientId, QObject *parent, bool hasWill)
+{
+    MqttEndpoint *endpoint = new MqttEndpoint(this, clientId, hasWill, parent);
+    _endpoints.append(endpoint);
+    updateWill();
+
+    if (_client->isConnectedToHost())
+    {
+        if (hasWill)
+        {
+            LOG_W(LogTag, "Component " + clientId + " was added after connecting, its will takes effect on the next reconnect");
+        }
+        // Let the caller connect to the endpoint's signals first
+        QTimer::singleShot(0, endpoint, [endpoint]()
+        {
+            Q_EMIT endpoint->connected();
+        });
+    }
+    return endpoint;
+}
+
+bool MqttHub::isConnectedToHost() const
+{
+    return _client->isConnectedToHost();
+}
+
+QStringList MqttHub::getComponents() const
+{
+    QStringList components;
+    for (MqttEndpoint *endpoint : _endpoints)
+    {
+        if (endpoint->_hasWill)
+        {
+            components.append(endpoint->_clientId);
+        }
+    }
+    return components;
+}
+
+QByteArray MqttHub::getWillMessage() const
+{
+    return getComponents().join('\n').toUtf8();
+}
+
+QStringList MqttHub::parsePresence(const QByteArray& payload)
+{
+    return QString::fromUtf8(payload).split('\n', QString::SkipEmptyParts);
+}
+
+void MqttHub::updateWill()
+{
+    _client->setWillMessage(QString::fromUtf8(getWillMessage()));
+}
+
+void MqttHub::onConnected()
+{
+    LOG_I(LogTag, "Connected to MQTT broker as " + _client->clientId());
+    _subscribedQos.clear();
+    _client->subscribe(PRESENCE_TOPIC, 2);
+    for (const QString& topic : _topicQos.keys())
+    {
+        subscribeOnBroker(topic);
+    }
+    for (MqttEndpoint *endpoint : _endpoints)
+    {
+        Q_EMIT endpoint->connected();
+    }
+}
+
+void MqttHub::onDisconnected()
+{
+    LOG_W(LogTag, "Disconnected from MQTT broker");
+    _subscribedQos.clear();
+    for (MqttEndpoint *endpoint : _endpoints)
+    {
+        Q_EMIT endpoint->disconnected();
+    }
+}
+
+void MqttHub::onReceived(const QMQTT::Message& message)
+{
+    if (message.topic() == PRESENCE_TOPIC)
+    {
+        // Another process has gone down, announce each of its components the way they used to announce themselves
+        for (const QString& component : parsePresence(message.payload()))
+        {
+            _dispatcher.dispatch(QMQTT::Message(0, SYSTEM_DOWN_TOPIC, component.toUtf8(), 2));
+        }
+        return;
+    }
+    _dispatcher.dispatch(message);
+}
+
+int MqttHub::addRoute(MqttEndpoint *endpoint, const QString& topic, quint8 qos)
+{
+    int id = _dispatcher.addRoute(topic, [endpoint](const QMQTT::Message& message)
+    {
+        Q_EMIT endpoint->received(message);
+    });
+    if (id == 0) return 0;
+
+    _topicRefs[topic]++;
+    _topicQos[topic] = qMax(_topicQos.value(topic), qos);
+    if (_client->isConnectedToHost())
+    {
+        subscribeOnBroker(topic);
+    }
+    return id;
+}
+
+void MqttHub::removeRoute(const QString& topic, int id)
+{
+    _dispatcher.removeRoute(id);
+    if (--_topicRefs[topic] <= 0)
+    {
+        _topicRefs.remove(topic);
+        _topicQos.remove(topic);
+        if (_subscribedQos.remove(topic) > 0)
+        {
+            _client->unsubscribe(topic);
+        }
+    }
+}
+
+void MqttHub::removeEndpoint(MqttEndpoint *endpoint)
+{
+    _endpoints.removeAll(endpoint);
+    updateWill();
+}
+
+void MqttHub::subscribeOnBroker(const QString& topic)
+{
+    quint8 qos = _topicQos.value(topic);
+    auto subscribed = _subscribedQos.constFind(topic);
+    if ((subscribed != _subscribedQos.constEnd()) && (*subscribed >= qos))
+    {
+        // Already subscribed on this session
+        return;
+    }
+    _subscribedQos.insert(topic, qos);
+    _client->subscribe(topic, qos);
+}
+
+MqttEndpoint::MqttEndpoint(MqttHub *hub, const QString& clientId, bool hasWill, QObject *parent) : QObject(parent)
+{
+    _hub = hub;
+    _clientId = clientId;
+    _hasWill = hasWill;
+}
+
+MqttEndpoint::~MqttEndpoint()
+{
+    if (!_hub) return;
+    for (auto it = _routes.constBegin(); it != _routes.constEnd(); ++it)
+    {
+        _hub->removeRoute(it.key(), it.value());
+    }
+    _hub->removeEndpoint(this);
+}
+
+QString MqttEndpoint::clientId() const
+{
+    return _clientId;
+}
+
+bool MqttEndpoint::isConnectedToHost() const
+{
+    return _hub && _hub->isConnectedToHost();
+}
+
+void MqttEndpoint::subscribe(const QString& topic, const quint8 qos)
+{
+    if (!_hub) return;
+
+    // Components subscribe again on every reconnect, only add a route the first time
+    if (_routes.contains(topic))
+    {
+        if (qos > _hub->_topicQos.value(topic))
+        {
+            _hub->_topicQos[topic] = qos;
+            if (_hub->isConnectedToHost())
+            {
+                _hub->subscribeOnBroker(topic);
+            }
+        }
+        return;
+    }
+    int id = _hub->addRoute(this, topic, qos);
+    if (id != 0)
+    {
+        _routes.insert(topic, id);
+    }
+}
+
+void MqttEndpoint::unsubscribe(const QString& topic)
+{
+    if (_hub && _routes.contains(topic))
+    {
+        _hub->removeRoute(topic, _routes.take(topic));
+    }
+}
+
+quint16 MqttEndpoint::publish(const QMQTT::Message& message)
+{
+    if (!_hub) return 0;
+    return _hub->_client->publish(message);
+}
+
+} // namespace Soro
@@ -0,0 +1,118 @@
+#ifndef MQTTHUB_H
+#define MQTTHUB_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QStringList>
+
+#include "qmqtt/qmqtt.h"
+
+#include "soro_core_global.h"
+#include "constants.h"
+
+namespace Soro {
+
+class MqttHub;
+
+/* A component's view of its process' shared MQTT connection. This mirrors the parts of QMQTT::Client
+ * that components use, so a component can swap its own client for an endpoint without other changes.
+ *
+ * Each endpoint only receives messages on the topics it has subscribed to.
+ */
+class SORO_CORE_EXPORT MqttEndpoint : public QObject
+{
+    Q_OBJECT
+    friend class MqttHub;
+
+public:
+    ~MqttEndpoint();
+
+    QString clientId() const;
+    bool isConnectedToHost() const;
+
+    void subscribe(const QString& topic, const quint8 qos = 0);
+    void unsubscribe(const QString& topic);
+    quint16 publish(const QMQTT::Message& message);
+
+Q_SIGNALS:
+    void connected();
+    void disconnected();
+    void received(const QMQTT::Message& message);
+
+private:
+    MqttEndpoint(MqttHub *hub, const QString& clientId, bool hasWill, QObject *parent);
+
+    MqttHub *_hub;
+    QString _clientId;
+    bool _hasWill;
+    QHash<QString, int> _routes;
+};
+
+/* Owns the single MQTT connection of a process, and multiplexes it between the components
+ * of that process through MqttEndpoint objects.
+ *
+ * Since a connection can only have one will, the wills of all components are combined into one
+ * message on the component_presence topic, listing the client ID of each component. Every hub
+ * subscribes to component_presence and re-delivers each listed ID to its endpoints as a
+ * system_down message, so components see the same system_down messages as before.
+ *
+ * Components that keep their own client, such as those on the master, must subscribe to
+ * component_presence themselves and read it with parsePresence().
+ */
+class SORO_CORE_EXPORT MqttHub : public QObject
+{
+    Q_OBJECT
+    friend class MqttEndpoint;
+
+public:
+    /* Gets the hub for this process, creating it on first use. The connection to the broker
+     * is opened once control returns to the event loop, so all endpoints created during startup
+     * are included in the will.
+     */
+    static MqttHub* getInstance(const QHostAddress& brokerAddress, quint16 brokerPort=SORO_NET_MQTT_BROKER_PORT);
+    ~MqttHub();
+
+    /* Creates an endpoint for a component. If hasWill is set, the component's client ID is published
+     * on system_down if this process loses its connection unexpectedly.
+     */
+    MqttEndpoint* createEndpoint(const QString& clientId, QObject *parent, bool hasWill=true);
+
+    bool isConnectedToHost() const;
+    QStringList getComponents() const;
+
+    /* Gets the message published on component_presence if this process goes down
+     */
+    QByteArray getWillMessage() const;
+
+    /* Gets the client IDs listed in a component_presence message
+     */
+    static QStringList parsePresence(const QByteArray& payload);
+
+private Q_SLOTS:
+    void onConnected();
+    void onDisconnected();
+    void onReceived(const QMQTT::Message& message);
+
+private:
+    MqttHub(const QHostAddress& brokerAddress, quint16 brokerPort, QObject *parent);
+
+    int addRoute(MqttEndpoint *endpoint, const QString& topic, quint8 qos);
+    void removeRoute(const QString& topic, int id);
+    void removeEndpoint(MqttEndpoint *endpoint);
+    void subscribeOnBroker(const QString& topic);
+    void updateWill();
+
+    QMQTT::Client *_client;
+    QMQTT::TopicDispatcher _dispatcher;
+    QList<MqttEndpoint*> _endpoints;
+    QHash<QString, int> _topicRefs;
+    QHash<QString, quint8> _topicQos;
+    QHash<QString, quint8> _subscribedQos;
+
+    static MqttHub *_self;
+};
+
+} // namespace Soro
+
+#endif // MQTTHUB_H
@@ -16,29 +16,44 @@
 
 #include "pingmessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
-PingMessage::PingMessage() { }
+typedef MessageCodec::Schema<PingMessage, 1,
+        SORO_CODEC_FIELD(PingMessage, pingId)> PingSchema;
 
-PingMessage::PingMessage(const QByteArray &payload)
+// Size of the QDataStream encoding used before PingSchema
+static const int LEGACY_SIZE = 8;
+
+PingMessage::PingMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
+    pingId = 0;
+}
 
-    stream >> pingId;
+PingMessage::PingMessage(const QByteArray &payload) : PingMessage()
+{
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> pingId;
+        });
+    }
+    else
+    {
+        _valid = PingSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 PingMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << pingId;
+    return PingSchema::encode(*this);
+}
 
-    return payload;
+int PingMessage::encode(char *buffer, int capacity) const
+{
+    return PingSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT PingMessage : public AbstractMessage
     PingMessage();
     PingMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     quint64 pingId;
 };
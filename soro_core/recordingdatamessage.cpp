@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordingdatamessage.h"
+
+#include <QDataStream>
+
+namespace Soro {
+
+RecordingDataMessage::RecordingDataMessage()
+{
+    camera_index = 0;
+    start_ms = 0;
+    end_ms = 0;
+    file_size = 0;
+    offset = 0;
+}
+
+RecordingDataMessage::RecordingDataMessage(const QByteArray &payload) : RecordingDataMessage()
+{
+    QDataStream stream(payload);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    stream >> camera_index;
+    stream >> start_ms;
+    stream >> end_ms;
+    stream >> file_size;
+    stream >> offset;
+    stream >> data;
+}
+
+RecordingDataMessage::operator QByteArray() const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    stream << camera_index;
+    stream << start_ms;
+    stream << end_ms;
+    stream << file_size;
+    stream << offset;
+    stream << data;
+
+    return payload;
+}
+
+} // namespace Soro
@@ -0,0 +1,32 @@
+#ifndef RECORDINGDATAMESSAGE_H
+#define RECORDINGDATAMESSAGE_H
+
+#include <QByteArray>
+
+#include "abstractmessage.h"
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* A piece of a recorded video file, sent in answer to a RecordingRequestMessage. A file is identified
+ * by its camera and the wall clock times it covers, and is complete once the pieces received add up
+ * to its size.
+ */
+struct SORO_CORE_EXPORT RecordingDataMessage : public AbstractMessage
+{
+    RecordingDataMessage();
+    RecordingDataMessage(const QByteArray& payload);
+    operator QByteArray() const override;
+
+    quint16 camera_index;
+    qint64 start_ms;
+    qint64 end_ms;
+    quint32 file_size;
+    // Where in the file this piece belongs
+    quint32 offset;
+    QByteArray data;
+};
+
+} // namespace Soro
+
+#endif // RECORDINGDATAMESSAGE_H
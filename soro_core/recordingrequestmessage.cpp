@@ -0,0 +1,51 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordingrequestmessage.h"
+
+#include "messagecodec.h"
+
+namespace Soro {
+
+typedef MessageCodec::Schema<RecordingRequestMessage, 1,
+        SORO_CODEC_FIELD(RecordingRequestMessage, camera_index),
+        SORO_CODEC_FIELD(RecordingRequestMessage, start_ms),
+        SORO_CODEC_FIELD(RecordingRequestMessage, end_ms),
+        SORO_CODEC_STRING(RecordingRequestMessage, client_id, 63)> RecordingRequestSchema;
+
+RecordingRequestMessage::RecordingRequestMessage()
+{
+    camera_index = 0;
+    start_ms = 0;
+    end_ms = 0;
+}
+
+RecordingRequestMessage::RecordingRequestMessage(const QByteArray &payload) : RecordingRequestMessage()
+{
+    _valid = RecordingRequestSchema::decode(*this, payload.constData(), payload.size());
+}
+
+RecordingRequestMessage::operator QByteArray() const
+{
+    return RecordingRequestSchema::encode(*this);
+}
+
+int RecordingRequestMessage::encode(char *buffer, int capacity) const
+{
+    return RecordingRequestSchema::encode(*this, buffer, capacity);
+}
+
+} // namespace Soro
@@ -0,0 +1,30 @@
+#ifndef RECORDINGREQUESTMESSAGE_H
+#define RECORDINGREQUESTMESSAGE_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "abstractmessage.h"
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Asks the video servers for the recorded video of a camera between two wall clock times, in ms since
+ * the epoch. Every recorded file overlapping that time is sent back on recording_data_<client_id>.
+ */
+struct SORO_CORE_EXPORT RecordingRequestMessage : public AbstractMessage
+{
+    RecordingRequestMessage();
+    RecordingRequestMessage(const QByteArray& payload);
+    operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
+
+    quint16 camera_index;
+    qint64 start_ms;
+    qint64 end_ms;
+    QString client_id;
+};
+
+} // namespace Soro
+
+#endif // RECORDINGREQUESTMESSAGE_H
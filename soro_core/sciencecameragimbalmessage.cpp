@@ -1,33 +1,44 @@
 #include "sciencecameragimbalmessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
+typedef MessageCodec::Schema<ScienceCameraGimbalMessage, 1,
+        SORO_CODEC_FIELD(ScienceCameraGimbalMessage, xMove),
+        SORO_CODEC_FIELD(ScienceCameraGimbalMessage, yMove)> ScienceCameraGimbalSchema;
+
+// Size of the QDataStream encoding used before ScienceCameraGimbalSchema
+static const int LEGACY_SIZE = 4;
+
 ScienceCameraGimbalMessage::ScienceCameraGimbalMessage()
 {
     xMove = yMove = 0;
 }
 
-ScienceCameraGimbalMessage::ScienceCameraGimbalMessage(const QByteArray &payload)
+ScienceCameraGimbalMessage::ScienceCameraGimbalMessage(const QByteArray &payload) : ScienceCameraGimbalMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream >> xMove;
-    stream >> yMove;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            stream >> xMove >> yMove;
+        });
+    }
+    else
+    {
+        _valid = ScienceCameraGimbalSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 ScienceCameraGimbalMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << xMove
-           << yMove;
+    return ScienceCameraGimbalSchema::encode(*this);
+}
 
-    return payload;
+int ScienceCameraGimbalMessage::encode(char *buffer, int capacity) const
+{
+    return ScienceCameraGimbalSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
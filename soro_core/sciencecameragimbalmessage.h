@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT ScienceCameraGimbalMessage : public AbstractMessage
     ScienceCameraGimbalMessage();
     ScienceCameraGimbalMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     qint16 xMove, yMove;
 };
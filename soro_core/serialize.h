@@ -3,93 +3,128 @@
 
 #include <stdint.h>
 #include <cstring>
+#include <limits>
+#include <type_traits>
+
+/* Big endian encoding of numeric data to and from char arrays.
+ *
+ * Values are copied bit for bit and byte swapped when the host is little endian. Floating point
+ * values are therefore carried as their exact IEEE754 representation, including infinities,
+ * NaNs (with their payload) and denormals.
+ */
+
+static_assert(std::numeric_limits<float>::is_iec559 && std::numeric_limits<double>::is_iec559,
+              "Floating point values are serialized as their IEEE754 representation");
+
+namespace SerializeDetail {
+
+template <int size> struct Bits;
+template <> struct Bits<1> { typedef uint8_t type; };
+template <> struct Bits<2> { typedef uint16_t type; };
+template <> struct Bits<4> { typedef uint32_t type; };
+template <> struct Bits<8> { typedef uint64_t type; };
+
+#if defined(__GNUC__)
+constexpr inline uint8_t byteSwap(uint8_t x) { return x; }
+constexpr inline uint16_t byteSwap(uint16_t x) { return __builtin_bswap16(x); }
+constexpr inline uint32_t byteSwap(uint32_t x) { return __builtin_bswap32(x); }
+constexpr inline uint64_t byteSwap(uint64_t x) { return __builtin_bswap64(x); }
+#else
+constexpr inline uint8_t byteSwap(uint8_t x) { return x; }
+constexpr inline uint16_t byteSwap(uint16_t x)
+{
+    return static_cast<uint16_t>((x >> 8) | (x << 8));
+}
+constexpr inline uint32_t byteSwap(uint32_t x)
+{
+    return (x >> 24) | ((x >> 8) & 0x0000FF00u) | ((x << 8) & 0x00FF0000u) | (x << 24);
+}
+constexpr inline uint64_t byteSwap(uint64_t x)
+{
+    return (static_cast<uint64_t>(byteSwap(static_cast<uint32_t>(x))) << 32) | byteSwap(static_cast<uint32_t>(x >> 32));
+}
+#endif
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+template <typename U>
+constexpr inline U toBigEndian(U x) { return x; }
+#else
+template <typename U>
+constexpr inline U toBigEndian(U x) { return byteSwap(x); }
+#endif
+
+template <typename T>
+struct IsSerializable
+{
+    static const bool value = (std::is_arithmetic<T>::value || std::is_enum<T>::value) &&
+            (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+};
+
+} // namespace SerializeDetail
 
 /* Serializes numeric data into a char array (big endian)
  */
 template <typename T>
 inline void serialize(char *arr, T data) {
-  int max = sizeof(T) - 1;
-  for (int i = 0; i <= max; i++) {
-    arr[max - i] = (data >> (i * 8)) & 0xFF;
-  }
+  static_assert(SerializeDetail::IsSerializable<T>::value, "serialize() only handles numeric types");
+  typedef typename SerializeDetail::Bits<sizeof(T)>::type U;
+  U bits;
+  memcpy(&bits, &data, sizeof(U));
+  bits = SerializeDetail::toBigEndian(bits);
+  memcpy(arr, &bits, sizeof(U));
 }
 
 /* Deseralizes numeric data from a char array to its original value (big endian)
  */
 template <typename T>
 inline T deserialize(const char *arr) {
-  T result = 0;
-  for (unsigned int i = 0; i < sizeof(T); i++) {
-    result = (result << 8) + reinterpret_cast<const unsigned char&>(arr[i]);
-  }
+  static_assert(SerializeDetail::IsSerializable<T>::value, "deserialize() only handles numeric types");
+  typedef typename SerializeDetail::Bits<sizeof(T)>::type U;
+  U bits;
+  memcpy(&bits, arr, sizeof(U));
+  bits = SerializeDetail::toBigEndian(bits);
+  T result;
+  memcpy(&result, &bits, sizeof(T));
   return result;
 }
 
+// Any nonzero byte is true, copying it into a bool would not be safe
+template <>
+inline bool deserialize<bool>(const char *arr) {
+  return arr[0] != 0;
+}
+
+/* Serializes count values from data into a char array (big endian)
+ */
+template <typename T>
+inline void serializeArray(char *arr, const T *data, int count) {
+  for (int i = 0; i < count; i++) {
+    serialize<T>(arr + i * sizeof(T), data[i]);
+  }
+}
+
+/* Deserializes count values from a char array into data (big endian)
+ */
+template <typename T>
+inline void deserializeArray(const char *arr, T *data, int count) {
+  for (int i = 0; i < count; i++) {
+    data[i] = deserialize<T>(arr + i * sizeof(T));
+  }
+}
+
 /* Serializes a float or double as an IEEE754 64-bit representation
  */
-void serializeF(char *arr, double f)
+inline void serializeF(char *arr, double f)
 {
-    long double fnorm;
-    int shift;
-    long long sign, exp, significand;
-    unsigned significandbits = 52; // -1 for sign bit
-
-    if (f == 0.0)
-    {
-        serialize<uint64_t>(arr, 0);
-    }
-    else
-    {
-        // check sign and begin normalization
-        if (f < 0) { sign = 1; fnorm = -f; }
-        else { sign = 0; fnorm = f; }
-
-        // get the normalized form of f and track the exponent
-        shift = 0;
-        while(fnorm >= 2.0) { fnorm /= 2.0; shift++; }
-        while(fnorm < 1.0) { fnorm *= 2.0; shift--; }
-        fnorm = fnorm - 1.0;
-
-        // calculate the binary form (non-float) of the significand data
-        significand = fnorm * ((1LL<<significandbits) + 0.5f);
-
-        // get the biased exponent
-        exp = shift + ((1<<(10)) - 1); // shift + bias
-
-        // serialize the final answer
-        uint64_t result = (sign<<63) | (exp<<52) | significand;
-        serialize<uint64_t>(arr, result);
-    }
+    serialize<double>(arr, f);
 }
 
 /* Deserializes a float or double from a 64-bit IEEE754 representation back
  * into its original value
  */
-double deserializeF(const char *arr)
+inline double deserializeF(const char *arr)
 {
-    uint64_t i = deserialize<uint64_t>(arr);
-    long double result;
-    long long shift;
-    unsigned bias;
-    unsigned significandbits = 52; // -1 for sign bit
-
-    if (i == 0) return 0.0;
-
-    // pull the significand
-    result = (i&((1LL<<significandbits)-1)); // mask
-    result /= (1LL<<significandbits); // convert back to float
-    result += 1.0f; // add the one back on
-
-    // deal with the exponent
-    bias = (1<<(10)) - 1;
-    shift = ((i>>significandbits)&((1LL<<11)-1)) - bias;
-    while(shift > 0) { result *= 2.0; shift--; }
-    while(shift < 0) { result /= 2.0; shift++; }
-
-    // sign it
-    result *= (i>>(63))&1? -1.0: 1.0;
-
-    return result;
+    return deserialize<double>(arr);
 }
 
 #endif
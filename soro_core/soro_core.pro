@@ -37,7 +37,14 @@ SOURCES += \
     drivepathmessage.cpp \
     switchmessage.cpp \
     sciencecameragimbalmessage.cpp \
-    namegen.cpp
+    videostatsmessage.cpp \
+    recordingrequestmessage.cpp \
+    recordingdatamessage.cpp \
+    namegen.cpp \
+    mqtthub.cpp \
+    byteswap.cpp \
+    spectrum.cpp \
+    v4l2util.cpp
 
 HEADERS +=\
     soro_core_global.h \
@@ -67,8 +74,16 @@ HEADERS +=\
     serialize.h \
     switchmessage.h \
     sciencecameragimbalmessage.h \
+    videostatsmessage.h \
+    recordingrequestmessage.h \
+    recordingdatamessage.h \
     namegen.h \
-    latlng.h
+    latlng.h \
+    messagecodec.h \
+    mqtthub.h \
+    byteswap.h \
+    spectrum.h \
+    v4l2util.h
 
 # Link against qmqtt
 LIBS += -L../lib -lqmqtt
@@ -1,49 +1,42 @@
 #include "spectrometermessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
+typedef MessageCodec::Schema<SpectrometerMessage, 1,
+        SORO_CODEC_FIELD(SpectrometerMessage, spectrumWhite),
+        SORO_CODEC_FIELD(SpectrometerMessage, spectrum404)> SpectrometerSchema;
+
+// Size of the QDataStream encoding used before SpectrometerSchema
+static const int LEGACY_SIZE = Spectrum::ENCODED_SIZE * 2;
+
 SpectrometerMessage::SpectrometerMessage() { }
 
 SpectrometerMessage::SpectrometerMessage(const QByteArray &payload)
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    spectrumWhite.clear();
-    spectrum404.clear();
-
-    quint16 temp;
-
-    for (int i = 0; i < SPECTRUM_POINTS; ++i)
+    if (payload.size() == LEGACY_SIZE)
     {
-        stream >> temp;
-        spectrumWhite.append(temp);
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            for (int i = 0; i < SPECTRUM_POINTS; ++i) stream >> spectrumWhite.values[i];
+            for (int i = 0; i < SPECTRUM_POINTS; ++i) stream >> spectrum404.values[i];
+        });
     }
-    for (int i = 0; i < SPECTRUM_POINTS; ++i)
+    else
     {
-        stream >> temp;
-        spectrum404.append(temp);
+        _valid = SpectrometerSchema::decode(*this, payload.constData(), payload.size());
     }
 }
 
 SpectrometerMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    for (int i = 0; i < SPECTRUM_POINTS; ++i)
-    {
-        stream << spectrumWhite.value(i);
-    }
-    for (int i = 0; i < SPECTRUM_POINTS; ++i)
-    {
-        stream << spectrum404.value(i);
-    }
+    return SpectrometerSchema::encode(*this);
+}
 
-    return payload;
+int SpectrometerMessage::encode(char *buffer, int capacity) const
+{
+    return SpectrometerSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
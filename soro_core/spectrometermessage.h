@@ -2,9 +2,9 @@
 #define SPECTROMETERMESSAGE_H
 
 #include <QByteArray>
-#include <QVector>
 
 #include "abstractmessage.h"
+#include "spectrum.h"
 #include "soro_core_global.h"
 
 namespace Soro {
@@ -14,11 +14,12 @@ struct SORO_CORE_EXPORT SpectrometerMessage : public AbstractMessage
     SpectrometerMessage();
     SpectrometerMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
-    static const int SPECTRUM_POINTS = 288;
+    static const int SPECTRUM_POINTS = Spectrum::POINTS;
 
-    QVector<quint16> spectrumWhite;
-    QVector<quint16> spectrum404;
+    Spectrum spectrumWhite;
+    Spectrum spectrum404;
 };
 
 } // namespace Soro
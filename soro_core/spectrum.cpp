@@ -0,0 +1,50 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spectrum.h"
+#include "byteswap.h"
+
+#include <cstring>
+
+namespace Soro {
+
+Spectrum::Spectrum()
+{
+    memset(values, 0, sizeof(values));
+}
+
+void Spectrum::decode(const char *in)
+{
+    ByteSwap::decodeBigEndian16(in, values, POINTS);
+}
+
+void Spectrum::encode(char *out) const
+{
+    ByteSwap::encodeBigEndian16(values, out, POINTS);
+}
+
+QVariantList Spectrum::toVariantList() const
+{
+    QVariantList list;
+    list.reserve(POINTS);
+    for (int i = 0; i < POINTS; ++i)
+    {
+        list.append(values[i]);
+    }
+    return list;
+}
+
+} // namespace Soro
@@ -0,0 +1,37 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <QVariantList>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* One spectrometer reading. The points are stored inline so a spectrum can be decoded
+ * from or encoded to the wire in a single pass, without allocating.
+ */
+struct SORO_CORE_EXPORT Spectrum
+{
+    static const int POINTS = 288;
+    static const int ENCODED_SIZE = POINTS * 2;
+
+    quint16 values[POINTS];
+
+    Spectrum();
+
+    // Reads ENCODED_SIZE bytes of big endian values
+    void decode(const char *in);
+    // Writes ENCODED_SIZE bytes of big endian values
+    void encode(char *out) const;
+
+    QVariantList toVariantList() const;
+
+    inline quint16 operator[](int i) const
+    {
+        return values[i];
+    }
+};
+
+} // namespace Soro
+
+#endif // SPECTRUM_H
@@ -1,33 +1,45 @@
 #include "switchmessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
 
 namespace Soro {
 
+typedef MessageCodec::Schema<SwitchMessage, 1,
+        SORO_CODEC_FIELD(SwitchMessage, on)> SwitchSchema;
+
+// Size of the QDataStream encoding used before SwitchSchema
+static const int LEGACY_SIZE = 1;
+
 SwitchMessage::SwitchMessage()
 {
     on = false;
 }
 
-SwitchMessage::SwitchMessage(const QByteArray &payload)
+SwitchMessage::SwitchMessage(const QByteArray &payload) : SwitchMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    quint8 state;
-    stream >> state;
-    on = state == 1;
+    if (payload.size() == LEGACY_SIZE)
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            quint8 state;
+            stream >> state;
+            on = state == 1;
+        });
+    }
+    else
+    {
+        _valid = SwitchSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 SwitchMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    stream << (quint8)(on ? 1 : 0);
+    return SwitchSchema::encode(*this);
+}
 
-    return payload;
+int SwitchMessage::encode(char *buffer, int capacity) const
+{
+    return SwitchSchema::encode(*this, buffer, capacity);
 }
 
 } // namespace Soro
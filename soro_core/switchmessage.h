@@ -13,6 +13,7 @@ struct SORO_CORE_EXPORT SwitchMessage : public AbstractMessage
     SwitchMessage();
     SwitchMessage(const QByteArray& payload);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
 
     bool on;
 };
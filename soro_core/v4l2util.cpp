@@ -0,0 +1,146 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "v4l2util.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/videodev2.h>
+
+namespace Soro {
+namespace V4L2Util {
+
+// Highest framerate the camera offers at a frame size, or 0 if it can't be found
+static quint16 getMaxFramerate(int fd, quint32 pixelFormat, quint32 width, quint32 height)
+{
+    double best = 0;
+    v4l2_frmivalenum interval;
+    memset(&interval, 0, sizeof(interval));
+    interval.pixel_format = pixelFormat;
+    interval.width = width;
+    interval.height = height;
+
+    while (ioctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &interval) == 0)
+    {
+        // Intervals are in seconds per frame
+        const v4l2_fract &shortest = (interval.type == V4L2_FRMIVAL_TYPE_DISCRETE) ? interval.discrete : interval.stepwise.min;
+        if (shortest.numerator > 0)
+        {
+            best = qMax(best, (double)shortest.denominator / shortest.numerator);
+        }
+        if (interval.type != V4L2_FRMIVAL_TYPE_DISCRETE) break;
+        interval.index++;
+    }
+    return best;
+}
+
+QList<CaptureFormat> probe(QString cameraDevice)
+{
+    QList<CaptureFormat> formats;
+    int fd = open(("/dev/" + cameraDevice).toLatin1().constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return formats;
+
+    v4l2_fmtdesc format;
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    while (ioctl(fd, VIDIOC_ENUM_FMT, &format) == 0)
+    {
+        v4l2_frmsizeenum size;
+        memset(&size, 0, sizeof(size));
+        size.pixel_format = format.pixelformat;
+        while (ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0)
+        {
+            CaptureFormat captureFormat;
+            captureFormat.pixelFormat = format.pixelformat;
+            if (size.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+            {
+                captureFormat.width = size.discrete.width;
+                captureFormat.height = size.discrete.height;
+                captureFormat.upToSize = false;
+            }
+            else
+            {
+                captureFormat.width = size.stepwise.max_width;
+                captureFormat.height = size.stepwise.max_height;
+                captureFormat.upToSize = true;
+            }
+            captureFormat.maxFramerate = getMaxFramerate(fd, format.pixelformat, captureFormat.width, captureFormat.height);
+            formats.append(captureFormat);
+
+            if (size.type != V4L2_FRMSIZE_TYPE_DISCRETE) break;
+            size.index++;
+        }
+        format.index++;
+    }
+
+    close(fd);
+    return formats;
+}
+
+bool supports(const QList<CaptureFormat>& formats, quint32 pixelFormat, quint16 width, quint16 height, quint16 framerate)
+{
+    for (const CaptureFormat &format : formats)
+    {
+        if (format.pixelFormat != pixelFormat) continue;
+        if (format.maxFramerate < framerate) continue;
+
+        if (format.upToSize ? ((width <= format.width) && (height <= format.height))
+                            : ((width == format.width) && (height == format.height)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint8 chooseCapturePath(const QList<CaptureFormat>& formats, GStreamerUtil::VideoProfile profile, bool vaapi, bool passthrough)
+{
+    const quint16 w = profile.width;
+    const quint16 h = profile.height;
+    const quint16 fps = profile.framerate;
+
+    // Raw formats GStreamer can import into VAAPI or convert
+    bool raw = supports(formats, V4L2_PIX_FMT_YUYV, w, h, fps) || supports(formats, V4L2_PIX_FMT_NV12, w, h, fps)
+            || supports(formats, V4L2_PIX_FMT_UYVY, w, h, fps) || supports(formats, V4L2_PIX_FMT_YUV420, w, h, fps);
+    bool mjpeg = supports(formats, V4L2_PIX_FMT_MJPEG, w, h, fps);
+    bool surfaces = vaapi && GStreamerUtil::hasVaapiEncoder(profile.codec);
+
+    // The camera encodes it for us
+    if (passthrough && (profile.codec == GStreamerUtil::VIDEO_CODEC_H264) && supports(formats, V4L2_PIX_FMT_H264, w, h, fps))
+    {
+        return GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH;
+    }
+
+    if (surfaces)
+    {
+        // Frames go straight to the GPU, either as raw buffers or decoded there
+        if (raw) return GStreamerUtil::CAPTURE_PATH_DMABUF;
+        if (mjpeg) return GStreamerUtil::CAPTURE_PATH_MJPEG_DECODE;
+    }
+    else if (!raw && mjpeg)
+    {
+        // Only MJPEG reaches this size and framerate, decoding it is still cheaper than scaling a smaller raw frame
+        return GStreamerUtil::CAPTURE_PATH_MJPEG_DECODE;
+    }
+
+    return GStreamerUtil::CAPTURE_PATH_RAW;
+}
+
+} // namespace V4L2Util
+} // namespace Soro
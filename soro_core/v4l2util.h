@@ -0,0 +1,47 @@
+#ifndef V4L2UTIL_H
+#define V4L2UTIL_H
+
+#include <QString>
+#include <QList>
+
+#include "soro_core_global.h"
+#include "gstreamerutil.h"
+
+/* This namespace has functions for finding out what a V4L2 camera can capture, and for choosing
+ * the cheapest way to get video from it into an encoder
+ */
+namespace Soro {
+namespace V4L2Util {
+
+/* A format a camera can capture in, at one frame size or a range of them
+ */
+struct SORO_CORE_EXPORT CaptureFormat
+{
+    // V4L2 fourcc, such as V4L2_PIX_FMT_MJPEG
+    quint32 pixelFormat;
+    quint16 width;
+    quint16 height;
+    // The camera takes any size up to width x height, rather than only exactly that size
+    bool upToSize;
+    quint16 maxFramerate;
+};
+
+/* Lists the formats and frame sizes a camera device (such as "video0") offers. Returns an empty
+ * list if the device cannot be queried.
+ */
+QList<CaptureFormat> probe(QString cameraDevice);
+
+/* Checks whether a camera can capture in a format at exactly the given size and at least the given framerate
+ */
+bool supports(const QList<CaptureFormat>& formats, quint32 pixelFormat, quint16 width, quint16 height, quint16 framerate);
+
+/* Chooses the cheapest capture path (one of GStreamerUtil's CAPTURE_PATH_* constants) for streaming
+ * a camera with the given formats in the specified video profile. Passthrough can be ruled out for
+ * captures that must be decoded, such as those split into several renditions.
+ */
+quint8 chooseCapturePath(const QList<CaptureFormat>& formats, GStreamerUtil::VideoProfile profile, bool vaapi=false, bool passthrough=true);
+
+} // namespace V4L2Util
+} // namespace Soro
+
+#endif // V4L2UTIL_H
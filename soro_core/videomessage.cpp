@@ -16,10 +16,38 @@
 
 #include "videomessage.h"
 
-#include <QDataStream>
+#include "messagecodec.h"
+#include "constants.h"
 
 namespace Soro {
 
+/* The profile's FEC overhead, which came after the profile's own encoding was fixed
+ */
+struct VideoFecField
+{
+    static const int SIZE = 1;
+    static inline bool encode(const VideoMessage& msg, char *out) { MessageCodec::Traits<quint8>::encode(out, msg.profile.fec_percentage); return true; }
+    static inline bool decode(VideoMessage& msg, const char *in) { MessageCodec::Traits<quint8>::decode(in, msg.profile.fec_percentage); return true; }
+};
+
+typedef MessageCodec::Schema<VideoMessage, 4,
+        SORO_CODEC_FIELD(VideoMessage, profile),
+        SORO_CODEC_FIELD(VideoMessage, camera_computerIndex),
+        SORO_CODEC_FIELD(VideoMessage, camera_index),
+        SORO_CODEC_STRING(VideoMessage, camera_name, VideoMessage::MAX_NAME_BYTES),
+        SORO_CODEC_FIELD(VideoMessage, camera_offset),
+        SORO_CODEC_STRING(VideoMessage, camera_productId, VideoMessage::MAX_ID_BYTES),
+        SORO_CODEC_STRING(VideoMessage, camera_serial, VideoMessage::MAX_SERIAL_BYTES),
+        SORO_CODEC_STRING(VideoMessage, camera_vendorId, VideoMessage::MAX_ID_BYTES),
+        SORO_CODEC_FIELD(VideoMessage, isStereo),
+        SORO_CODEC_FIELD(VideoMessage, camera_offset2),
+        SORO_CODEC_STRING(VideoMessage, camera_productId2, VideoMessage::MAX_ID_BYTES),
+        SORO_CODEC_STRING(VideoMessage, camera_serial2, VideoMessage::MAX_SERIAL_BYTES),
+        SORO_CODEC_STRING(VideoMessage, camera_vendorId2, VideoMessage::MAX_ID_BYTES),
+        SORO_CODEC_FIELD(VideoMessage, capture_path),
+        SORO_CODEC_FIELD(VideoMessage, rendition),
+        VideoFecField> VideoSchema;
+
 VideoMessage::VideoMessage()
 {
     camera_index = 0;
@@ -27,29 +55,39 @@ VideoMessage::VideoMessage()
     camera_computerIndex = 0;
     isStereo = false;
     camera_offset2 = 0;
+    capture_path = GStreamerUtil::CAPTURE_PATH_RAW;
+    rendition = 0;
 }
 
-VideoMessage::VideoMessage(const QByteArray &payload)
+VideoMessage::VideoMessage(const QByteArray &payload) : VideoMessage()
 {
-    QDataStream stream(payload);
-    stream.setByteOrder(QDataStream::BigEndian);
-    QString profileStr;
-
-    stream >> profileStr;
-    stream >> camera_computerIndex;
-    stream >> camera_index;
-    stream >> camera_name;
-    stream >> camera_offset;
-    stream >> camera_productId;
-    stream >> camera_serial;
-    stream >> camera_vendorId;
-    stream >> isStereo;
-    stream >> camera_offset2;
-    stream >> camera_productId2;
-    stream >> camera_serial2;
-    stream >> camera_vendorId2;
-
-    profile = GStreamerUtil::VideoProfile(profileStr);
+    // The QDataStream encoding used before VideoSchema began with the profile as a string, whose
+    // length prefix can never start with the codec's format version
+    if (payload.isEmpty() || (static_cast<quint8>(payload.at(0)) != MessageCodec::FORMAT_VERSION))
+    {
+        _valid = MessageCodec::decodeLegacy(payload, [this](QDataStream &stream)
+        {
+            QString profileStr;
+            stream >> profileStr
+                   >> camera_computerIndex
+                   >> camera_index
+                   >> camera_name
+                   >> camera_offset
+                   >> camera_productId
+                   >> camera_serial
+                   >> camera_vendorId
+                   >> isStereo
+                   >> camera_offset2
+                   >> camera_productId2
+                   >> camera_serial2
+                   >> camera_vendorId2;
+            profile = GStreamerUtil::VideoProfile(profileStr);
+        });
+    }
+    else
+    {
+        _valid = VideoSchema::decode(*this, payload.constData(), payload.size());
+    }
 }
 
 VideoMessage::VideoMessage(quint16 cameraIndex, const CameraSettingsModel::Camera &cam)
@@ -66,29 +104,23 @@ VideoMessage::VideoMessage(quint16 cameraIndex, const CameraSettingsModel::Camer
     camera_productId2 = cam.productId2;
     camera_serial2 = cam.serial2;
     camera_vendorId2 = cam.vendorId2;
+    capture_path = GStreamerUtil::CAPTURE_PATH_RAW;
+    rendition = 0;
 }
 
 VideoMessage::operator QByteArray() const
 {
-    QByteArray payload;
-    QDataStream stream(&payload, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
+    return VideoSchema::encode(*this);
+}
 
-    stream << profile.toString()
-           << camera_computerIndex
-           << camera_index
-           << camera_name
-           << camera_offset
-           << camera_productId
-           << camera_serial
-           << camera_vendorId
-           << isStereo
-           << camera_offset2
-           << camera_productId2
-           << camera_serial2
-           << camera_vendorId2;
+int VideoMessage::encode(char *buffer, int capacity) const
+{
+    return VideoSchema::encode(*this, buffer, capacity);
+}
 
-    return payload;
+quint16 VideoMessage::getStreamIndex() const
+{
+    return camera_index + rendition * SORO_NET_VIDEO_RENDITION_STRIDE;
 }
 
 } // namespace Soro
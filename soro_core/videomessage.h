@@ -16,6 +16,17 @@ struct SORO_CORE_EXPORT VideoMessage : public AbstractMessage
     VideoMessage(const QByteArray& payload);
     VideoMessage(quint16 cameraindex, const CameraSettingsModel::Camera& cam);
     operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
+
+    /* Number of this camera and rendition's video ports and state topic, counted from the first
+     */
+    quint16 getStreamIndex() const;
+
+    // Longest camera name, serial and vendor/product id, in UTF-8 bytes, that fit in an encoded
+    // message. Camera settings with longer values are rejected when they are loaded.
+    static const int MAX_NAME_BYTES = 32;
+    static const int MAX_SERIAL_BYTES = 32;
+    static const int MAX_ID_BYTES = 8;
 
     GStreamerUtil::VideoProfile profile;
     quint8 camera_computerIndex;
@@ -33,6 +44,12 @@ struct SORO_CORE_EXPORT VideoMessage : public AbstractMessage
     QString camera_productId2;
     quint8 camera_offset2;
 
+    // How the server captures this camera, one of GStreamerUtil's CAPTURE_PATH_* constants
+    quint8 capture_path;
+
+    // Which of the camera's simultaneous streams this is. Rendition 0 is the camera's main stream,
+    // the others are encoded from the same capture in their own profiles.
+    quint8 rendition;
 };
 
 } // namespace Soro
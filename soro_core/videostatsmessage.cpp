@@ -0,0 +1,60 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "videostatsmessage.h"
+
+#include "messagecodec.h"
+
+namespace Soro {
+
+typedef MessageCodec::Schema<VideoStatsMessage, 1,
+        SORO_CODEC_FIELD(VideoStatsMessage, camera_index),
+        SORO_CODEC_FIELD(VideoStatsMessage, ssrc),
+        SORO_CODEC_FIELD(VideoStatsMessage, packets_received),
+        SORO_CODEC_FIELD(VideoStatsMessage, packets_lost),
+        SORO_CODEC_FIELD(VideoStatsMessage, packets_reordered),
+        SORO_CODEC_FIELD(VideoStatsMessage, keyframes),
+        SORO_CODEC_FIELD(VideoStatsMessage, jitter_us),
+        SORO_CODEC_FIELD(VideoStatsMessage, loss_rate)> VideoStatsSchema;
+
+VideoStatsMessage::VideoStatsMessage()
+{
+    camera_index = 0;
+    ssrc = 0;
+    packets_received = 0;
+    packets_lost = 0;
+    packets_reordered = 0;
+    keyframes = 0;
+    jitter_us = 0;
+    loss_rate = 0;
+}
+
+VideoStatsMessage::VideoStatsMessage(const QByteArray &payload) : VideoStatsMessage()
+{
+    _valid = VideoStatsSchema::decode(*this, payload.constData(), payload.size());
+}
+
+VideoStatsMessage::operator QByteArray() const
+{
+    return VideoStatsSchema::encode(*this);
+}
+
+int VideoStatsMessage::encode(char *buffer, int capacity) const
+{
+    return VideoStatsSchema::encode(*this, buffer, capacity);
+}
+
+} // namespace Soro
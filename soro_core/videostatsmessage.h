@@ -0,0 +1,34 @@
+#ifndef VIDEOSTATSMESSAGE_H
+#define VIDEOSTATSMESSAGE_H
+
+#include <QByteArray>
+
+#include "abstractmessage.h"
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Reception statistics for a camera's RTP stream, as measured by the master relay
+ */
+struct SORO_CORE_EXPORT VideoStatsMessage : public AbstractMessage
+{
+    VideoStatsMessage();
+    VideoStatsMessage(const QByteArray& payload);
+    operator QByteArray() const override;
+    int encode(char *buffer, int capacity) const override;
+
+    quint16 camera_index;
+    quint32 ssrc;
+    quint64 packets_received;
+    quint64 packets_lost;
+    quint64 packets_reordered;
+    quint64 keyframes;
+    // Interarrival jitter in microseconds
+    quint32 jitter_us;
+    // Share of packets lost since the previous message, in hundredths of a percent
+    quint16 loss_rate;
+};
+
+} // namespace Soro
+
+#endif // VIDEOSTATSMESSAGE_H
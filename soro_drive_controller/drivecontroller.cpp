@@ -19,6 +19,7 @@
 #include "soro_core/serialize.h"
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
+#include "soro_core/drivemessage.h"
 
 #define LogTag "DriveController"
 
@@ -67,8 +68,15 @@ DriveController::DriveController(const SettingsModel *settings, QObject *parent)
     {
         if (message.topic() == "drive")
         {
-            // Retransmit this message over UDP to the science package microcontroller
-            _driveUdpSocket.writeDatagram(message.payload(), QHostAddress("192.168.0.103"), SORO_NET_DRIVE_SYSTEM_PORT);
+            DriveMessage driveMsg(message.payload());
+            if (!driveMsg.isValid())
+            {
+                LOG_W(LogTag, "Received invalid drive message, discarding");
+                return;
+            }
+            // Retransmit this message over UDP to the drive microcontroller, which still reads
+            // the layout from before the message codec
+            _driveUdpSocket.writeDatagram(driveMsg.encodeLegacy(), QHostAddress("192.168.0.103"), SORO_NET_DRIVE_SYSTEM_PORT);
         }
     });
 
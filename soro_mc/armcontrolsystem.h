@@ -7,6 +7,7 @@
 
 #include "settingsmodel.h"
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 namespace Soro {
 
@@ -35,7 +36,7 @@ private:
     bool _enabled;
     quint16 _nextMqttMsgId;
     QUdpSocket _armUdpSocket;
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
     char _buffer[USHRT_MAX];
 };
 
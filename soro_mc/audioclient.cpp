@@ -33,19 +33,11 @@ AudioClient::AudioClient(const SettingsModel *settings, QObject *parent) : QObje
 {
     _settings = settings;
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::received, this, &AudioClient::onMqttMessage);
-    connect(_mqtt, &QMQTT::Client::connected, this, &AudioClient::onMqttConnected);
-    connect(_mqtt, &QMQTT::Client::disconnected, this, &AudioClient::onMqttDisconnected);
-    _mqtt->setClientId("audio_client_" + MainController::getId());
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->setWillMessage(_mqtt->clientId());
-    _mqtt->setWillQos(2);
-    _mqtt->setWillTopic("system_down");
-    _mqtt->setWillRetain(false);
-    _mqtt->connectToHost();
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("audio_client_" + MainController::getId(), this);
+    connect(_mqtt, &MqttEndpoint::received, this, &AudioClient::onMqttMessage);
+    connect(_mqtt, &MqttEndpoint::connected, this, &AudioClient::onMqttConnected);
+    connect(_mqtt, &MqttEndpoint::disconnected, this, &AudioClient::onMqttDisconnected);
 
     _pipelineWatch = nullptr;
 
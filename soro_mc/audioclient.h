@@ -7,6 +7,7 @@
 #include <QTimerEvent>
 
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 #include "soro_core/gstreamerutil.h"
 #include "settingsmodel.h"
@@ -71,7 +72,7 @@ private:
     QGst::BinPtr _bin;
     GStreamerPipelineWatch *_pipelineWatch;
 
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
 
     GStreamerUtil::AudioProfile _profile;
 };
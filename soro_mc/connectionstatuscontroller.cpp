@@ -20,6 +20,7 @@
 #include "soro_core/constants.h"
 #include "soro_core/dataratemessage.h"
 #include "soro_core/latencymessage.h"
+#include "soro_core/videostatsmessage.h"
 
 #define LogTag "ConnectionStatusController"
 
@@ -30,26 +31,23 @@ ConnectionStatusController::ConnectionStatusController(const SettingsModel *sett
     _connectionWatchdog.setInterval(2000);
     _connected = false;
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    _mqtt->setClientId(MainController::getId() + "_connectionstatuscontroller");
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->connectToHost();
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint(MainController::getId() + "_connectionstatuscontroller", this, false);
 
-    connect(_mqtt, &QMQTT::Client::connected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::connected, this, [this]()
     {
         Logger::logInfo(LogTag, "Connected to MQTT broker");
         _mqtt->subscribe("latency", 0);
         _mqtt->subscribe("data_rate", 0);
+        _mqtt->subscribe("video_stats", 0);
     });
 
-    connect(_mqtt, &QMQTT::Client::disconnected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::disconnected, this, [this]()
     {
         Logger::logInfo(LogTag, "Disconnected from to MQTT broker");
     });
 
-    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message &msg)
+    connect(_mqtt, &MqttEndpoint::received, this, [this](const QMQTT::Message &msg)
     {
         if (msg.topic() == "latency")
         {
@@ -62,13 +60,18 @@ ConnectionStatusController::ConnectionStatusController(const SettingsModel *sett
             _connectionWatchdog.start();
 
             LatencyMessage latencyMsg(msg.payload());
-            Q_EMIT latencyUpdate(latencyMsg.latency);
+            if (latencyMsg.isValid()) Q_EMIT latencyUpdate(latencyMsg.latency);
         }
         else if (msg.topic() == "data_rate")
         {
             DataRateMessage dataRateMsg(msg.payload());
             Q_EMIT dataRateUpdate(dataRateMsg.dataRateFromRover);
         }
+        else if (msg.topic() == "video_stats")
+        {
+            VideoStatsMessage statsMsg(msg.payload());
+            if (statsMsg.isValid()) Q_EMIT videoStatsUpdate(statsMsg.camera_index, statsMsg.loss_rate / 100.0f, statsMsg.jitter_us / 1000.0f);
+        }
     });
 
     connect(&_connectionWatchdog, &QTimer::timeout, this, [this]()
@@ -6,6 +6,7 @@
 
 #include "settingsmodel.h"
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 namespace Soro {
 
@@ -23,9 +24,10 @@ Q_SIGNALS:
     void latencyUpdate(quint32 latency);
     void connectedChanged(bool connected);
     void dataRateUpdate(quint64 rateFromRover);
+    void videoStatsUpdate(uint cameraIndex, float lossPercent, float jitterMs);
 
 private:
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
     QTimer _connectionWatchdog;
     bool _connected;
 };
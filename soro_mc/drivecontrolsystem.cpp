@@ -50,14 +50,14 @@ DriveControlSystem::DriveControlSystem(const SettingsModel *settings, QObject *p
 
     setLimit(settings->getDrivePowerLimit());
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::connected, this, [this]()
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("drive_control_system", this);
+    connect(_mqtt, &MqttEndpoint::connected, this, [this]()
     {
         Logger::logInfo(LogTag, "Connected to MQTT broker");
         _mqtt->subscribe("system_down", 2);
     });
-    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message& msg)
+    connect(_mqtt, &MqttEndpoint::received, this, [this](const QMQTT::Message& msg)
     {
         if (msg.topic() == "system_down")
         {
@@ -76,18 +76,10 @@ DriveControlSystem::DriveControlSystem(const SettingsModel *settings, QObject *p
             }
         }
     });
-    connect(_mqtt, &QMQTT::Client::disconnected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::disconnected, this, [this]()
     {
         Logger::logInfo(LogTag, "Disconnected from MQTT broker");
     });
-    _mqtt->setClientId("drive_control_system");
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->setWillMessage(_mqtt->clientId());
-    _mqtt->setWillQos(2);
-    _mqtt->setWillTopic("system_down");
-    _mqtt->setWillRetain(false);
-    _mqtt->connectToHost();
 
     connect(&_timer, &QTimer::timeout, this, [this]()
     {
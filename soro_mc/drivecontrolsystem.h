@@ -9,6 +9,7 @@
 #include "soro_core/drivepathmessage.h"
 
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 namespace Soro {
 
@@ -46,7 +47,7 @@ public Q_SLOTS:
 
 private:
     QTimer _timer;
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
 
     quint16 _nextMqttMsgId;
     float _skidSteerFactor;
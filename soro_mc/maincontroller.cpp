@@ -17,6 +17,8 @@
 #include "maincontroller.h"
 
 #include <QTimer>
+#include <QDateTime>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QtWebEngine>
 
@@ -265,13 +267,23 @@ void MainController::init(QApplication *app)
             LOG_I(LogTag, "Initializing video controller...");
             _self->_videoClient = new VideoClient(_self->_settingsModel, _self->_cameraSettingsModel, _self->_mainWindowController->getVideoSinks(), _self);
 
+            //
+            // Create the onboard recording client
+            //
+            LOG_I(LogTag, "Initializing recording client...");
+            _self->_recordingClient = new RecordingClient(_self->_settingsModel, _self);
+
             //
             // Connect to connection status signals
             //
             connect(_self->_connectionStatusController, &ConnectionStatusController::dataRateUpdate,
                     _self->_mainWindowController, &MainWindowController::onDataRateUpdated);
+            connect(_self->_connectionStatusController, &ConnectionStatusController::videoStatsUpdate,
+                    _self->_mainWindowController, &MainWindowController::onVideoStatsUpdated);
             connect(_self->_connectionStatusController, &ConnectionStatusController::latencyUpdate,
                     _self->_mainWindowController, &MainWindowController::onLatencyUpdated);
+            connect(_self->_connectionStatusController, &ConnectionStatusController::latencyUpdate,
+                    _self->_videoClient, &VideoClient::onLatencyUpdate);
             connect(_self->_connectionStatusController, &ConnectionStatusController::connectedChanged,
                     _self->_mainWindowController, &MainWindowController::onConnectedChanged);
             connect(_self->_connectionStatusController, &ConnectionStatusController::connectedChanged, _self, [](bool connected)
@@ -319,6 +331,10 @@ void MainController::init(QApplication *app)
                 _self->_mainWindowController->onAudioProfileChanged(GStreamerUtil::AudioProfile());
             });
             connect(_self->_videoClient, &VideoClient::playing, _self->_mainWindowController, &MainWindowController::onVideoProfileChanged);
+            connect(_self->_videoClient, &VideoClient::fecStats, _self->_mainWindowController, &MainWindowController::onVideoFecStatsUpdated);
+            connect(_self->_videoClient, &VideoClient::glassToGlassLatency, _self->_mainWindowController, &MainWindowController::onVideoLatencyUpdated);
+            connect(_self->_mainWindowController, &MainWindowController::videoViewChanged, _self->_videoClient, &VideoClient::setView);
+            _self->_mainWindowController->refreshVideoViews();
             connect(_self->_videoClient, &VideoClient::stopped, _self, [](uint cameraIndex)
             {
                 _self->_mainWindowController->onVideoProfileChanged(cameraIndex, GStreamerUtil::VideoProfile());
@@ -341,6 +357,12 @@ void MainController::init(QApplication *app)
                                               "Error playing " + _self->_cameraSettingsModel->getCamera(cameraIndex).name,
                                               "There was an error while decoding the video stream: " + message);
             });
+            connect(_self->_recordingClient, &RecordingClient::fileReceived, _self, [](uint cameraIndex, QString path)
+            {
+                _self->_mainWindowController->notify(NotificationMessage::Level_Info,
+                                              "Recording of " + _self->_cameraSettingsModel->getCamera(cameraIndex).name + " received",
+                                              "Recorded video has been saved to \"" + QFileInfo(path).fileName() + "\" in the recordings folder.");
+            });
             connect(_self->_audioClient, &AudioClient::gstError, _self, [](QString message)
             {
                 _self->_mainWindowController->notify(NotificationMessage::Level_Error,
@@ -463,6 +485,17 @@ void MainController::init(QApplication *app)
                 case Qt::Key_F1:
                     _self->_mainWindowController->takeMainContentViewScreenshot();
                     break;
+                case Qt::Key_F2:
+                {
+                    // Fetch the recent onboard recordings of every camera, only recorded cameras answer
+                    qint64 now = QDateTime::currentMSecsSinceEpoch();
+                    qint64 start = now - _self->_settingsModel->getRecordingFetchMinutes() * 60000ll;
+                    for (int i = 0; i < _self->_cameraSettingsModel->getCameraCount(); ++i)
+                    {
+                        _self->_recordingClient->fetch(i, start, now);
+                    }
+                    break;
+                }
                 case Qt::Key_1:
                     _self->_videoClient->stop(0);
                     break;
@@ -18,6 +18,7 @@
 #include "drivecontrolsystem.h"
 #include "audioclient.h"
 #include "videoclient.h"
+#include "recordingclient.h"
 #include "armcontrolsystem.h"
 //#include "bindssettingsmodel.h"
 #include "sciencecameracontrolsystem.h"
@@ -47,6 +48,7 @@ private:
     SettingsModel* _settingsModel = nullptr;
     AudioClient *_audioClient = nullptr;
     VideoClient *_videoClient = nullptr;
+    RecordingClient *_recordingClient = nullptr;
     CameraSettingsModel *_cameraSettingsModel = nullptr;
     //BindsSettingsModel *_bindsSettingsModel = nullptr;
     MediaProfileSettingsModel *_mediaProfileSettingsModel = nullptr;
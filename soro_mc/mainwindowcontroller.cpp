@@ -104,29 +104,36 @@ MainWindowController::MainWindowController(QQmlEngine *engine, const SettingsMod
     }
 
     connect(_window, SIGNAL(keyPressed(int)), this, SIGNAL(keyPressed(int)));
+    connect(_window, SIGNAL(videoViewChanged(int,int,int,bool)), this, SIGNAL(videoViewChanged(int,int,int,bool)));
 
     //
     // Setup MQTT
     //
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::received, this, &MainWindowController::onMqttMessage);
-    connect(_mqtt, &QMQTT::Client::connected, this, &MainWindowController::onMqttConnected);
-    connect(_mqtt, &QMQTT::Client::disconnected, this, &MainWindowController::onMqttDisconnected);
-    _mqtt->setClientId(MainController::getId() + "_mainwindowcontroller");
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->connectToHost();
+    _mqttDispatcher.addRoute<NotificationMessage>("notification", [this](const NotificationMessage &msg) { onNotificationMessage(msg); });
+    _mqttDispatcher.addRoute<GpsMessage>("gps", [this](const GpsMessage &msg) { onGpsMessage(msg); });
+    _mqttDispatcher.addRoute<CompassMessage>("compass", [this](const CompassMessage &msg) { onCompassMessage(msg); });
+    _mqttDispatcher.addRoute<AtmosphereSensorMessage>("atmosphere", [this](const AtmosphereSensorMessage &msg) { onAtmosphereMessage(msg); });
+    _mqttDispatcher.addRoute<SwitchMessage>("atmosphere_switch", [this](const SwitchMessage &msg) { onAtmosphereSwitchMessage(msg); });
+    _mqttDispatcher.addRoute<SpectrometerMessage>("spectrometer", [this](const SpectrometerMessage &msg) { onSpectrometerMessage(msg); });
+
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint(MainController::getId() + "_mainwindowcontroller", this, false);
+    connect(_mqtt, &MqttEndpoint::received, this, [this](const QMQTT::Message &msg)
+    {
+        _mqttDispatcher.dispatch(msg);
+    });
+    connect(_mqtt, &MqttEndpoint::connected, this, &MainWindowController::onMqttConnected);
+    connect(_mqtt, &MqttEndpoint::disconnected, this, &MainWindowController::onMqttDisconnected);
 }
 
-void MainWindowController::setSpectrometer404Reading(QList<quint16> readings)
+void MainWindowController::setSpectrometer404Reading(const Spectrum &readings)
 {
-   _window->setProperty("spectrometer404Readings", readings);
+   _window->setProperty("spectrometer404Readings", readings.toVariantList());
 }
 
-void MainWindowController::setSpectrometerWhiteReading(QList<quint16> readings)
+void MainWindowController::setSpectrometerWhiteReading(const Spectrum &readings)
 {
-   _window->setProperty("spectrometerWhiteReadings", readings);
+   _window->setProperty("spectrometerWhiteReadings", readings.toVariantList());
 }
 
 void MainWindowController::setO2GasReading(quint32 ppm)
@@ -182,6 +189,7 @@ void MainWindowController::onMqttConnected()
     _mqtt->subscribe("gps", 0);
     _mqtt->subscribe("atmosphere", 0);
     _mqtt->subscribe("atmosphere_switch", 2);
+    _mqtt->subscribe("spectrometer", 0);
     Q_EMIT mqttConnected();
 }
 
@@ -240,62 +248,78 @@ void MainWindowController::takeMainContentViewScreenshot()
     });
 }
 
-void MainWindowController::onMqttMessage(const QMQTT::Message &msg)
+void MainWindowController::onNotificationMessage(const NotificationMessage &notificationMsg)
 {
-    if (msg.topic() == "notification")
+    switch (notificationMsg.level)
     {
-        NotificationMessage notificationMsg(msg.payload());
-
-        switch (notificationMsg.level)
-        {
-        case NotificationMessage::Level_Error:
-            LOG_E(LogTag, QString("Received error notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
-            break;
-        case NotificationMessage::Level_Warning:
-            LOG_W(LogTag, QString("Received warning notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
-            break;
-        case NotificationMessage::Level_Info:
-            LOG_I(LogTag, QString("Received info notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
-            break;
-        }
+    case NotificationMessage::Level_Error:
+        LOG_E(LogTag, QString("Received error notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
+        break;
+    case NotificationMessage::Level_Warning:
+        LOG_W(LogTag, QString("Received warning notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
+        break;
+    case NotificationMessage::Level_Info:
+        LOG_I(LogTag, QString("Received info notification: %1 - %2 ").arg(notificationMsg.title, notificationMsg.message));
+        break;
     }
-    else if (msg.topic() == "gps")
+}
+
+void MainWindowController::onGpsMessage(const GpsMessage &gpsMsg)
+{
+    _window->setProperty("latitude", gpsMsg.location.latitude);
+    _window->setProperty("longitude", gpsMsg.location.longitude);
+    _window->setProperty("gpsSatellites", gpsMsg.satellites);
+    _mapView->updateLocation(gpsMsg.location);
+    _lastLat = gpsMsg.location.latitude;
+    _lastLng = gpsMsg.location.longitude;
+    _lastElevation = gpsMsg.elevation;
+    _lastSatellites = gpsMsg.satellites;
+}
+
+void MainWindowController::onCompassMessage(const CompassMessage &compassMsg)
+{
+    _window->setProperty("compassHeading", compassMsg.heading);
+    _lastCompass = compassMsg.heading;
+    qDebug() << "Compass " << compassMsg.heading;
+}
+
+void MainWindowController::onAtmosphereMessage(const AtmosphereSensorMessage &atmosphereMsg)
+{
+    if (!atmosphereMsg.isValid())
     {
-        GpsMessage gpsMsg(msg.payload());
-        _window->setProperty("latitude", gpsMsg.location.latitude);
-        _window->setProperty("longitude", gpsMsg.location.longitude);
-        _window->setProperty("gpsSatellites", gpsMsg.satellites);
-        _mapView->updateLocation(gpsMsg.location);
-        _lastLat = gpsMsg.location.latitude;
-        _lastLng = gpsMsg.location.longitude;
-        _lastElevation = gpsMsg.elevation;
-        _lastSatellites = gpsMsg.satellites;
+        LOG_W(LogTag, "Received invalid atmosphere sensor message, discarding");
+        return;
     }
-    else if (msg.topic() == "compass")
+    _lastTemperature = atmosphereMsg.temperature;
+    _lastHumidity = atmosphereMsg.humidity;
+    _lastWindDirection = atmosphereMsg.windDirection;
+    _lastWindSpeed = atmosphereMsg.windSpeed;
+}
+
+void MainWindowController::onAtmosphereSwitchMessage(const SwitchMessage &switchMsg)
+{
+    if (!switchMsg.isValid())
     {
-        CompassMessage compassMsg(msg.payload());
-        _window->setProperty("compassHeading", compassMsg.heading);
-        _lastCompass = compassMsg.heading;
-        qDebug() << "Compass " << compassMsg.heading;
+        LOG_W(LogTag, "Received invalid atmosphere switch message, discarding");
+        return;
     }
-    else if (msg.topic() == "atmosphere")
+    if (!switchMsg.on)
     {
-        AtmosphereSensorMessage atmosphereMsg(msg.payload());
-        _lastTemperature = atmosphereMsg.temperature;
-        _lastHumidity = atmosphereMsg.humidity;
-        _lastWindDirection = atmosphereMsg.windDirection;
-        _lastWindSpeed = atmosphereMsg.windSpeed;
+        // This is needed so we don't log stale data for screenshots if atmosphere
+        // sensors are off
+        _logAtmosphere = switchMsg.on;
     }
-    else if (msg.topic() == "atmosphere_switch")
+}
+
+void MainWindowController::onSpectrometerMessage(const SpectrometerMessage &spectrometerMsg)
+{
+    if (!spectrometerMsg.isValid())
     {
-        SwitchMessage switchMsg(msg.payload());
-        if (!switchMsg.on)
-        {
-            // This is needed so we don't log stale data for screenshots if atmosphere
-            // sensors are off
-            _logAtmosphere = switchMsg.on;
-        }
+        LOG_W(LogTag, "Received invalid spectrometer message, discarding");
+        return;
     }
+    setSpectrometerWhiteReading(spectrometerMsg.spectrumWhite);
+    setSpectrometer404Reading(spectrometerMsg.spectrum404);
 }
 
 QVector<QGst::ElementPtr> MainWindowController::getVideoSinks()
@@ -321,6 +345,11 @@ QVector<QGst::ElementPtr> MainWindowController::getVideoSinks()
     return sinks;
 }
 
+void MainWindowController::refreshVideoViews()
+{
+    QMetaObject::invokeMethod(_window, "updateVideoViews");
+}
+
 void MainWindowController::notify(NotificationMessage::Level level, QString title, QString message)
 {
     QString typeString;
@@ -367,6 +396,21 @@ void MainWindowController::onDataRateUpdated(quint64 rateFromRover)
     _window->setProperty("dataRateFromRover", rateFromRover);
 }
 
+void MainWindowController::onVideoStatsUpdated(uint cameraIndex, float lossPercent, float jitterMs)
+{
+    QMetaObject::invokeMethod(_window, "setVideoStats", Q_ARG(QVariant, cameraIndex), Q_ARG(QVariant, lossPercent), Q_ARG(QVariant, jitterMs));
+}
+
+void MainWindowController::onVideoFecStatsUpdated(uint cameraIndex, quint32 recovered, quint32 unrecovered)
+{
+    QMetaObject::invokeMethod(_window, "setVideoFecStats", Q_ARG(QVariant, cameraIndex), Q_ARG(QVariant, recovered), Q_ARG(QVariant, unrecovered));
+}
+
+void MainWindowController::onVideoLatencyUpdated(uint cameraIndex, quint32 latencyMs)
+{
+    QMetaObject::invokeMethod(_window, "setVideoLatency", Q_ARG(QVariant, cameraIndex), Q_ARG(QVariant, latencyMs));
+}
+
 void MainWindowController::toggleSidebar()
 {
     QMetaObject::invokeMethod(_window, "toggleSidebar");
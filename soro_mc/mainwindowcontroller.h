@@ -8,11 +8,17 @@
 #include <SDL2/SDL.h>
 
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 #include "settingsmodel.h"
 #include "mapviewimpl.h"
 #include "soro_core/camerasettingsmodel.h"
 #include "soro_core/notificationmessage.h"
+#include "soro_core/gpsmessage.h"
+#include "soro_core/compassmessage.h"
+#include "soro_core/atmospheresensormessage.h"
+#include "soro_core/switchmessage.h"
+#include "soro_core/spectrometermessage.h"
 #include "soro_core/mediaprofilesettingsmodel.h"
 #include "soro_core/gstreamerutil.h"
 
@@ -30,9 +36,15 @@ public:
     void notifyAll(NotificationMessage::Level level, QString title, QString message);
 
     QVector<QGst::ElementPtr> getVideoSinks();
+    // Emits videoViewChanged() for every video
+    void refreshVideoViews();
 
 Q_SIGNALS:
     void keyPressed(int key);
+    /* Emitted when the size a video is shown at changes, or it becomes or stops being the main view.
+     * A video that cannot be seen at all has a size of zero.
+     */
+    void videoViewChanged(int cameraIndex, int width, int height, bool main);
     void mqttConnected();
     void mqttDisconnected();
 
@@ -46,9 +58,12 @@ public Q_SLOTS:
     void onConnectedChanged(bool connected);
     void onLatencyUpdated(quint32 latency);
     void onDataRateUpdated(quint64 rateFromRover);
+    void onVideoStatsUpdated(uint cameraIndex, float lossPercent, float jitterMs);
+    void onVideoFecStatsUpdated(uint cameraIndex, quint32 recovered, quint32 unrecovered);
+    void onVideoLatencyUpdated(uint cameraIndex, quint32 latencyMs);
     void takeMainContentViewScreenshot();
-    void setSpectrometerWhiteReading(QList<quint16> readings);
-    void setSpectrometer404Reading(QList<quint16> readings);
+    void setSpectrometerWhiteReading(const Spectrum &readings);
+    void setSpectrometer404Reading(const Spectrum &readings);
     void setO2GasReading(quint32 ppm);
     void setCO2GasReading(quint32 ppm);
     void setMQ2GasReading(quint16 raw);
@@ -62,9 +77,15 @@ public Q_SLOTS:
 private Q_SLOTS:
     void onMqttConnected();
     void onMqttDisconnected();
-    void onMqttMessage(const QMQTT::Message &msg);
 
 private:
+    void onNotificationMessage(const NotificationMessage &notificationMsg);
+    void onGpsMessage(const GpsMessage &gpsMsg);
+    void onCompassMessage(const CompassMessage &compassMsg);
+    void onAtmosphereMessage(const AtmosphereSensorMessage &atmosphereMsg);
+    void onAtmosphereSwitchMessage(const SwitchMessage &switchMsg);
+    void onSpectrometerMessage(const SpectrometerMessage &spectrometerMsg);
+
     QQuickWindow *_window;
     MapViewImpl *_mapView;
 
@@ -77,7 +98,8 @@ private:
     double _lastTemperature, _lastHumidity, _lastWindSpeed, _lastWindDirection;
     int _lastSatellites;
 
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
+    QMQTT::TopicDispatcher _mqttDispatcher;
 };
 
 } // namespace Soro
@@ -28,6 +28,7 @@ Rectangle {
     property Rectangle shaderSourceRect
     property string text: ""
     property string streamProfile: ""
+    property string streamStats: ""
     property bool streaming: false
 
     signal clicked()
@@ -106,6 +107,17 @@ Rectangle {
             text: shaderEffectSourceThumbnailView.streamProfile.toUpperCase()
             visible: shaderEffectSourceThumbnailView.streaming
         }
+
+        Text {
+            id: statsLabel
+            anchors.verticalCenter: profileImage.verticalCenter
+            anchors.right: parent.right
+            anchors.margins: 12
+            font.pixelSize: 16
+            color: Theme.foreground
+            text: shaderEffectSourceThumbnailView.streamStats
+            visible: shaderEffectSourceThumbnailView.streaming
+        }
     }
 
     MouseArea {
@@ -54,12 +54,23 @@ Item {
         }
 
         for (var i = 0; i < videoCount; ++i) {
-            var surface = Qt.createQmlObject("import QtQuick 2.7; import Soro 1.0; GStreamerSurface { anchors.fill: parent; z: 0; enabled: false; focus: false; }", mainContentView, "")
+            // Idle surfaces have no pipeline behind them, they show the placeholder image over their last frame instead.
+            // Every surface loads the same url at the same size, so they all share one cached texture.
+            var surface = Qt.createQmlObject("import QtQuick 2.7; import Soro 1.0; GStreamerSurface { anchors.fill: parent; z: 0; enabled: false; focus: false; " +
+                                             "property bool streaming: false; " +
+                                             "Image { anchors.fill: parent; z: 1; visible: !parent.streaming; fillMode: Image.PreserveAspectFit; " +
+                                             "source: \"qrc:/icons/video_placeholder.svg\"; sourceSize.width: 800; sourceSize.height: 600; } }", mainContentView, "")
             videoSurfaces.push(surface)
         }
         activeViewIndex = 0
     }
 
+    function setVideoIsStreaming(index, streaming) {
+        if (index < videoSurfaces.length) {
+            videoSurfaces[index].streaming = streaming
+        }
+    }
+
     /*
       The web view that shows the Google Maps overlay
       */
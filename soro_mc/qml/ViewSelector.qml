@@ -28,6 +28,10 @@ Item {
 
     property int spacing: 10
 
+    // Size each view is shown at in the list
+    readonly property int thumbnailWidth: width
+    readonly property int thumbnailHeight: width / aspectRatio
+
     readonly property string selectedViewTitle: list.selectedViewTitle
     readonly property bool selectedViewIsStreaming: list.selectedViewIsStreaming
     readonly property string selectedViewStreamProfile: list.selectedViewStreamProfile
@@ -35,7 +39,7 @@ Item {
     signal viewClicked(int index)
 
     function addItem(shaderSource, title) {
-        viewListModel.append({"item_title": title, "item_index": viewCount, "item_source": shaderSource, "item_streaming": false, "item_profile": "", "item_selected": false})
+        viewListModel.append({"item_title": title, "item_index": viewCount, "item_source": shaderSource, "item_streaming": false, "item_profile": "", "item_stats": "", "item_selected": false})
         if (viewListModel.count == 1) {
             // This is the first item added
             selectedViewIndex = 0
@@ -86,6 +90,12 @@ Item {
         }
     }
 
+    function setViewStreamStats(viewIndex, stats) {
+        if (viewIndex < viewListModel.count) {
+            viewListModel.get(viewIndex).item_stats = stats
+        }
+    }
+
     ListView
     {
         id: list
@@ -118,6 +128,7 @@ Item {
                 id: thumbnail
                 text: item_title
                 streamProfile: item_profile
+                streamStats: item_stats
                 streaming: item_streaming
                 selected: item_selected
                 shaderSource: item_source
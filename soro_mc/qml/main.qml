@@ -75,12 +75,38 @@ ApplicationWindow {
 
     function setVideoIsStreaming(index, streaming) {
         sidebarViewSelector.setViewIsStreaming(index, streaming)
+        mainContentView.setVideoIsStreaming(index, streaming)
     }
 
+    // What FEC has done for each view's stream and how late its frames are, shown after its loss and jitter
+    property var videoFecStats: []
+    property var videoLatencies: []
+
     function setVideoProfileName(index, name) {
+        videoFecStats[index] = ""
+        videoLatencies[index] = ""
         sidebarViewSelector.setViewStreamProfileName(index, name)
     }
 
+    function setVideoStats(index, lossPercent, jitterMs) {
+        var stats = lossPercent.toFixed(1) + "% loss, " + Math.round(jitterMs) + " ms jitter"
+        if (videoLatencies[index]) {
+            stats += ", " + videoLatencies[index]
+        }
+        if (videoFecStats[index]) {
+            stats += ", " + videoFecStats[index]
+        }
+        sidebarViewSelector.setViewStreamStats(index, stats)
+    }
+
+    function setVideoLatency(index, latencyMs) {
+        videoLatencies[index] = "~" + latencyMs + " ms glass to glass"
+    }
+
+    function setVideoFecStats(index, recovered, unrecovered) {
+        videoFecStats[index] = recovered + " recovered, " + unrecovered + " lost"
+    }
+
     function getVideoSurface(index) {
         return mainContentView.videoSurfaces[index]
     }
@@ -100,6 +126,27 @@ ApplicationWindow {
       */
     signal keyPressed(int key)
 
+    /* Emitted when the size a video is shown at changes, or it becomes or stops being the main view.
+       Videos in the hidden sidebar have a size of zero.
+      */
+    signal videoViewChanged(int index, int width, int height, bool main)
+
+    function updateVideoViews() {
+        for (var i = 0; i < videoCount; ++i) {
+            if (i == selectedViewIndex) {
+                videoViewChanged(i, mainContentView.width, mainContentView.height, true)
+            }
+            else if (sidebarState == "visible") {
+                videoViewChanged(i, sidebarViewSelector.thumbnailWidth, sidebarViewSelector.thumbnailHeight, false)
+            }
+            else {
+                videoViewChanged(i, 0, 0, false)
+            }
+        }
+    }
+
+    onSidebarStateChanged: updateVideoViews()
+
     /* Fullscreen state of the application, boolean
       */
     property bool fullscreen: false;
@@ -160,6 +207,7 @@ ApplicationWindow {
     onSelectedViewIndexChanged: {
         sidebarViewSelector.selectedViewIndex = selectedViewIndex
         mainContentView.activeViewIndex = selectedViewIndex
+        updateVideoViews()
     }
 
     function notify(type, title, text) {
@@ -170,6 +218,9 @@ ApplicationWindow {
         id: mainContentView
         anchors.fill: parent
         //activeViewIndex: sidebarViewSelector.selectedViewIndex
+
+        onWidthChanged: updateVideoViews()
+        onHeightChanged: updateVideoViews()
     }
 
     DropShadow {
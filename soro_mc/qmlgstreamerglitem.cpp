@@ -17,11 +17,11 @@
 #include "qmlgstreamerglitem.h"
 #include "soro_core/logger.h"
 
-#include <QSGFlatColorMaterial>
-#include <QSGGeometryNode>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QSGSimpleRectNode>
 #include <Qt5GStreamer/QGst/ElementFactory>
-#include <Qt5GStreamer/QGlib/Signal>
-#include <Qt5GStreamer/QGlib/Connect>
 
 #define LogTag "QmlGStreamerGlItem"
 
@@ -30,7 +30,7 @@ namespace Soro {
 QmlGStreamerGlItem::QmlGStreamerGlItem(QQuickItem *parent) : QQuickItem(parent)
 {
     setFlag(QQuickItem::ItemHasContents, true);
-    _surfaceDirty = true;
+    _videoItem = nullptr;
 }
 
 QmlGStreamerGlItem::~QmlGStreamerGlItem()
@@ -46,81 +46,48 @@ QSGNode* QmlGStreamerGlItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDa
 {
     Q_UNUSED(data)
 
-    QRectF r = boundingRect();
-    QSGNode *newNode = 0;
-
-    if (_surfaceDirty) {
-        delete oldNode;
-        oldNode = 0;
-        _surfaceDirty = false;
-    }
-
-    if (_sink.isNull())
+    // Black behind the video item, which shows through until the first frame
+    QSGSimpleRectNode *node = static_cast<QSGSimpleRectNode*>(oldNode);
+    if (!node)
     {
-        if (!oldNode)
-        {
-            QSGFlatColorMaterial *material = new QSGFlatColorMaterial;
-            material->setColor(Qt::black);
-
-            QSGGeometryNode *node = new QSGGeometryNode;
-            node->setMaterial(material);
-            node->setFlag(QSGNode::OwnsMaterial);
-            node->setFlag(QSGNode::OwnsGeometry);
-
-            newNode = node;
-            _targetArea = QRectF(); //force geometry to be set
-        }
-        else
-        {
-            newNode = oldNode;
-        }
-
-        if (r != _targetArea)
-        {
-            QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 4);
-            geometry->vertexDataAsPoint2D()[0].set(r.x(), r.y());
-            geometry->vertexDataAsPoint2D()[1].set(r.x(), r.height());
-            geometry->vertexDataAsPoint2D()[2].set(r.width(), r.y());
-            geometry->vertexDataAsPoint2D()[3].set(r.width(), r.height());
-
-            QSGGeometryNode *node = static_cast<QSGGeometryNode*>(newNode);
-            node->setGeometry(geometry);
-
-            _targetArea = r;
-        }
+        node = new QSGSimpleRectNode(boundingRect(), Qt::black);
     }
     else
     {
-        newNode = (QSGNode*) QGlib::emit<void*>(_sink,
-                "update-node", (void*)oldNode,
-                r.x(), r.y(), r.width(), r.height());
+        node->setRect(boundingRect());
     }
-
-    return newNode;
+    return node;
 }
 
 QGst::ElementPtr QmlGStreamerGlItem::videoSink()
 {
+    if (!_sink.isNull()) return _sink;
+
+    // Making the sink loads its plugin, which registers the GstGLVideoItem type with QML
+    _sink = QGst::ElementFactory::make("qmlglsink");
     if (_sink.isNull())
     {
-        _sink = QGst::ElementFactory::make("qtquick2videosink");
+        LOG_E(LogTag, "Failed to create qmlglsink");
+        return _sink;
     }
 
-    if (!_sink.isNull())
-    {
-        QGlib::connect(_sink, "update", this, &QmlGStreamerGlItem::onUpdate);
-    }
-    else
+    QQmlComponent component(qmlEngine(this));
+    component.setData("import QtQuick 2.0\n"
+                      "import org.freedesktop.gstreamer.GLVideoItem 1.0\n"
+                      "GstGLVideoItem { anchors.fill: parent }", QUrl());
+    _videoItem = qobject_cast<QQuickItem*>(component.beginCreate(qmlContext(this)));
+    if (!_videoItem)
     {
-        LOG_E(LogTag, "Failed to create qtquick2videosink");
+        LOG_E(LogTag, "Failed to create GstGLVideoItem: " + component.errorString());
+        _sink.clear();
+        return _sink;
     }
+    _videoItem->setParent(this);
+    _videoItem->setParentItem(this);
+    component.completeCreate();
 
+    _sink->setProperty("widget", static_cast<void*>(_videoItem));
     return _sink;
 }
 
-void QmlGStreamerGlItem::onUpdate()
-{
-    update();
-}
-
 } // namespace Soro
@@ -8,9 +8,11 @@ namespace Soro {
 
 /* QML item that can display GStreamer video.
  *
- * This item is painted on the scene graph by a
- * qtquick2videosink element. Therefore, it uses OpenGL
- * rendering and is more efficient than QmlGStreamerPaintedItem.
+ * The video is drawn by a qmlglsink element into a GstGLVideoItem filling
+ * this item. Frames arrive as GL textures and are handed to the scene graph
+ * as they are, so when the decoder also works on the GPU they never pass
+ * through system memory. This is more efficient than QmlGStreamerPaintedItem,
+ * but the pipeline feeding the sink must upload its video with glupload.
  */
 class QmlGStreamerGlItem : public QQuickItem
 {
@@ -28,12 +30,10 @@ public:
 
 protected:
     QSGNode* updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
-    void onUpdate();
 
 private:
     QGst::ElementPtr _sink;
-    QRectF _targetArea;
-    bool _surfaceDirty;
+    QQuickItem *_videoItem;
 };
 
 } // namespace Soro
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordingclient.h"
+#include "soro_core/logger.h"
+#include "soro_core/recordingrequestmessage.h"
+
+#include <QCoreApplication>
+#include <QDir>
+
+#include "maincontroller.h"
+
+#define LogTag "RecordingClient"
+
+namespace Soro {
+
+RecordingClient::RecordingClient(const SettingsModel *settings, QObject *parent) : QObject(parent)
+{
+    _nextMqttMsgId = 1;
+    _directory = QCoreApplication::applicationDirPath() + "/../recordings";
+    QDir().mkpath(_directory);
+
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("recording_client_" + MainController::getId(), this);
+    connect(_mqtt, &MqttEndpoint::received, this, &RecordingClient::onMqttMessage);
+    connect(_mqtt, &MqttEndpoint::connected, this, &RecordingClient::onMqttConnected);
+    connect(_mqtt, &MqttEndpoint::disconnected, this, &RecordingClient::onMqttDisconnected);
+}
+
+RecordingClient::~RecordingClient()
+{
+    qDeleteAll(_files);
+}
+
+void RecordingClient::onMqttConnected()
+{
+    LOG_I(LogTag, "Connected to MQTT broker");
+    _mqtt->subscribe("recording_data_" + MainController::getId(), 1);
+}
+
+void RecordingClient::onMqttDisconnected()
+{
+    LOG_W(LogTag, "Disconnected from MQTT broker");
+}
+
+void RecordingClient::fetch(uint cameraIndex, qint64 startMs, qint64 endMs)
+{
+    LOG_I(LogTag, QString("Asking for the recordings of camera %1 from %2 to %3")
+          .arg(QString::number(cameraIndex), QString::number(startMs), QString::number(endMs)));
+
+    RecordingRequestMessage requestMsg;
+    requestMsg.camera_index = cameraIndex;
+    requestMsg.start_ms = startMs;
+    requestMsg.end_ms = endMs;
+    requestMsg.client_id = MainController::getId();
+
+    QByteArray payload = requestMsg;
+    if (payload.isEmpty())
+    {
+        LOG_E(LogTag, "This client's id is too long to send in a recording request");
+        return;
+    }
+    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "recording_request", payload, 2));
+}
+
+void RecordingClient::onMqttMessage(const QMQTT::Message &msg)
+{
+    if (msg.topic().startsWith("recording_data_"))
+    {
+        onRecordingData(RecordingDataMessage(msg.payload()));
+    }
+}
+
+void RecordingClient::onRecordingData(const RecordingDataMessage &dataMsg)
+{
+    QString path = QString("%1/cam%2_%3_%4.mkv")
+            .arg(_directory,
+                 QString::number(dataMsg.camera_index),
+                 QString::number(dataMsg.start_ms),
+                 QString::number(dataMsg.end_ms));
+
+    QFile *file = _files.value(path);
+    if (!file)
+    {
+        // Pieces are written where they belong, so one sent twice does no harm
+        file = new QFile(path);
+        // A file is only started over from its first piece, opening it write only would truncate it
+        if (!file->open(dataMsg.offset == 0 ? (QIODevice::WriteOnly | QIODevice::Truncate) : QIODevice::ReadWrite))
+        {
+            LOG_E(LogTag, "Cannot open " + path + " to write a recording into");
+            delete file;
+            return;
+        }
+        _files.insert(path, file);
+    }
+
+    file->seek(dataMsg.offset);
+    file->write(dataMsg.data);
+
+    if (dataMsg.offset + dataMsg.data.size() >= dataMsg.file_size)
+    {
+        LOG_I(LogTag, "Received recording " + path);
+        _files.remove(path);
+        file->close();
+        delete file;
+        Q_EMIT fileReceived(dataMsg.camera_index, path);
+    }
+}
+
+} // namespace Soro
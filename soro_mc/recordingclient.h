@@ -0,0 +1,53 @@
+#ifndef RECORDINGCLIENT_H
+#define RECORDINGCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QFile>
+
+#include "settingsmodel.h"
+#include "soro_core/recordingdatamessage.h"
+
+#include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
+
+namespace Soro {
+
+/* Fetches video recorded onboard the rover.
+ *
+ * Asking for a camera's recordings over a span of time has the video server recording that camera
+ * send every file it has from then. Files arrive in the background, at whatever rate the rover sets
+ * aside for them, and are written to the recordings folder as they come. They keep the names the
+ * rover gave them, after the camera and the wall clock times they cover.
+ */
+class RecordingClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RecordingClient(const SettingsModel *settings, QObject *parent = 0);
+    ~RecordingClient();
+
+    // Times are wall clock times in ms since the epoch
+    void fetch(uint cameraIndex, qint64 startMs, qint64 endMs);
+
+Q_SIGNALS:
+    void fileReceived(uint cameraIndex, QString path);
+
+private Q_SLOTS:
+    void onMqttMessage(const QMQTT::Message &msg);
+    void onMqttConnected();
+    void onMqttDisconnected();
+
+private:
+    void onRecordingData(const RecordingDataMessage &dataMsg);
+
+    MqttEndpoint *_mqtt;
+    quint16 _nextMqttMsgId;
+    QString _directory;
+    // Files still being received, keyed by path
+    QHash<QString, QFile*> _files;
+};
+
+} // namespace Soro
+
+#endif // RECORDINGCLIENT_H
@@ -40,31 +40,23 @@ ScienceArmControlSystem::ScienceArmControlSystem(const SettingsModel *settings,
         MainController::panic(LogTag, "Unable to open master arm UDP socket");
     }
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    _mqtt->setClientId("science_arm_control_system");
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->setWillMessage(_mqtt->clientId());
-    _mqtt->setWillQos(2);
-    _mqtt->setWillTopic("system_down");
-    _mqtt->setWillRetain(false);
-    _mqtt->connectToHost();
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("science_arm_control_system", this);
 
     _watchdogTimer.setInterval(1000); // master arm connection timeout
 
-    connect(_mqtt, &QMQTT::Client::connected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::connected, this, [this]()
     {
         LOG_I(LogTag, "Connected to MQTT broker");
         _mqtt->subscribe("system_down", 2);
     });
 
-    connect(_mqtt, &QMQTT::Client::disconnected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::disconnected, this, [this]()
     {
        LOG_W(LogTag, "Disconnected from MQTT broker");
     });
 
-    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message& message)
+    connect(_mqtt, &MqttEndpoint::received, this, [this](const QMQTT::Message& message)
     {
         if (message.topic() == "system_down")
         {
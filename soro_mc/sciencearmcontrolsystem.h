@@ -7,6 +7,7 @@
 
 #include "settingsmodel.h"
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 namespace Soro {
 
@@ -37,7 +38,7 @@ private:
     bool _masterConnected;
     quint16 _nextMqttMsgId;
     QUdpSocket _armUdpSocket;
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
     char _buffer[USHRT_MAX];
 };
 
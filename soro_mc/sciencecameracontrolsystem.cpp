@@ -22,27 +22,19 @@ ScienceCameraControlSystem::ScienceCameraControlSystem(const SettingsModel *sett
 
     _mode = settings->getCameraGimbalInputMode();
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::connected, this, [this]()
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("science_camera_control_system", this);
+    connect(_mqtt, &MqttEndpoint::connected, this, [this]()
     {
         Logger::logInfo(LogTag, "Connected to MQTT broker");
         _mqtt->subscribe("system_down", 2);
     });
-    connect(_mqtt, &QMQTT::Client::disconnected, this, [this]()
+    connect(_mqtt, &MqttEndpoint::disconnected, this, [this]()
     {
         Logger::logInfo(LogTag, "Disconnected from MQTT broker");
     });
-    _mqtt->setClientId("science_camera_control_system");
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->setWillMessage(_mqtt->clientId());
-    _mqtt->setWillQos(2);
-    _mqtt->setWillTopic("system_down");
-    _mqtt->setWillRetain(false);
-    _mqtt->connectToHost();
-
-    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message& message)
+
+    connect(_mqtt, &MqttEndpoint::received, this, [this](const QMQTT::Message& message)
     {
         if (message.topic() == "system_down")
         {
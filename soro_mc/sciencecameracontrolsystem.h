@@ -7,6 +7,7 @@
 #include "settingsmodel.h"
 
 #include <qmqtt/qmqtt.h>
+#include "soro_core/mqtthub.h"
 #include <SDL2/SDL.h>
 
 namespace Soro {
@@ -36,7 +37,7 @@ public Q_SLOTS:
     void onGamepadAxisUpdate(SDL_GameControllerAxis axis, float value);
 
 private:
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
     QTimer _timer;
     quint16 _nextMqttMsgId;
     SettingsModel::CameraGimbalInputMode _mode;
@@ -17,6 +17,7 @@
 #include "settingsmodel.h"
 #include "soro_core/constants.h"
 #include "soro_core/logger.h"
+#include "soro_core/gstreamerutil.h"
 
 #include <QCoreApplication>
 
@@ -26,6 +27,11 @@
 #define KEY_CAMERA_GIMBAL_SEND_INTERVAL "SORO_CAMERA_GIMBAL_SEND_INTERVAL"
 #define KEY_ENABLE_HWDECODING "SORO_ENABLE_HW_DECODING"
 #define KEY_ENABLE_HWRENDERING "SORO_ENABLE_HW_RENDERING"
+#define KEY_VIDEO_RENDITION "SORO_VIDEO_RENDITION"
+#define KEY_VIDEO_RECEIVE_MODE "SORO_VIDEO_RECEIVE_MODE"
+#define KEY_VIDEO_JITTER_BUFFER_MS "SORO_VIDEO_JITTER_BUFFER_MS"
+#define KEY_VIDEO_THUMBNAIL_KEYFRAMES_ONLY "SORO_VIDEO_THUMBNAIL_KEYFRAMES_ONLY"
+#define KEY_RECORDING_FETCH_MINUTES "SORO_RECORDING_FETCH_MINUTES"
 #define KEY_DRIVE_INPUT_MODE "SORO_DRIVE_INPUT_MODE"
 #define KEY_CAMERA_GIMBAL_INPUT_MODE "SORO_CAMERA_GIMBAL_INPUT_MODE"
 #define KEY_DRIVE_SKIDSTEER_FACTOR "SORO_DRIVE_SKIDSTEER_FACTOR"
@@ -48,6 +54,11 @@ QHash<QString, int> SettingsModel::getKeys() const
     keys.insert(KEY_CAMERA_GIMBAL_SEND_INTERVAL, QMetaType::UInt);
     keys.insert(KEY_ENABLE_HWDECODING, QMetaType::Bool);
     keys.insert(KEY_ENABLE_HWRENDERING, QMetaType::Bool);
+    keys.insert(KEY_VIDEO_RENDITION, QMetaType::UInt);
+    keys.insert(KEY_VIDEO_RECEIVE_MODE, QMetaType::QString);
+    keys.insert(KEY_VIDEO_JITTER_BUFFER_MS, QMetaType::UInt);
+    keys.insert(KEY_VIDEO_THUMBNAIL_KEYFRAMES_ONLY, QMetaType::Bool);
+    keys.insert(KEY_RECORDING_FETCH_MINUTES, QMetaType::UInt);
     keys.insert(KEY_DRIVE_POWER_LIMIT, QMetaType::Float);
     keys.insert(KEY_DRIVE_INPUT_MODE, QMetaType::QString);
     keys.insert(KEY_CAMERA_GIMBAL_INPUT_MODE, QMetaType::QString);
@@ -69,6 +80,11 @@ QHash<QString, QVariant> SettingsModel::getDefaultValues() const
     defaults.insert(KEY_CAMERA_GIMBAL_SEND_INTERVAL, QVariant(50));
     defaults.insert(KEY_ENABLE_HWDECODING, QVariant(false));
     defaults.insert(KEY_ENABLE_HWRENDERING, QVariant(true));
+    defaults.insert(KEY_VIDEO_RENDITION, QVariant(0));
+    defaults.insert(KEY_VIDEO_RECEIVE_MODE, "smooth");
+    defaults.insert(KEY_VIDEO_JITTER_BUFFER_MS, QVariant(150));
+    defaults.insert(KEY_VIDEO_THUMBNAIL_KEYFRAMES_ONLY, QVariant(false));
+    defaults.insert(KEY_RECORDING_FETCH_MINUTES, QVariant(5));
     defaults.insert(KEY_DRIVE_POWER_LIMIT, QVariant(1.0f));
     defaults.insert(KEY_DRIVE_SKIDSTEER_FACTOR, QVariant(0.6f));
     defaults.insert(KEY_DRIVE_INPUT_MODE, "twostick");
@@ -169,4 +185,41 @@ bool SettingsModel::getEnableHwRendering() const
     return _values.value(KEY_ENABLE_HWRENDERING).toBool();
 }
 
+uint SettingsModel::getVideoRendition() const
+{
+    uint rendition = _values.value(KEY_VIDEO_RENDITION).toUInt();
+    if (rendition >= SORO_MAX_VIDEO_RENDITIONS)
+    {
+        LOG_W(LogTag, QString("Invalid value for '%1' for setting '%2', returning '0'").arg(QString::number(rendition), KEY_VIDEO_RENDITION));
+        return 0;
+    }
+    return rendition;
+}
+
+quint8 SettingsModel::getVideoReceiveMode() const
+{
+    QString value = _values.value(KEY_VIDEO_RECEIVE_MODE).toString().toLower();
+    if (value == "lowestlatency") return GStreamerUtil::RECEIVE_MODE_LOWEST_LATENCY;
+    if (value == "smooth") return GStreamerUtil::RECEIVE_MODE_SMOOTH;
+    if (value == "recording") return GStreamerUtil::RECEIVE_MODE_RECORDING;
+
+    LOG_W(LogTag, QString("Invalid value for '%1' for setting '%2', returning 'smooth'").arg(value, KEY_VIDEO_RECEIVE_MODE));
+    return GStreamerUtil::RECEIVE_MODE_SMOOTH;
+}
+
+uint SettingsModel::getVideoJitterBufferMs() const
+{
+    return _values.value(KEY_VIDEO_JITTER_BUFFER_MS).toUInt();
+}
+
+bool SettingsModel::getVideoThumbnailKeyframesOnly() const
+{
+    return _values.value(KEY_VIDEO_THUMBNAIL_KEYFRAMES_ONLY).toBool();
+}
+
+uint SettingsModel::getRecordingFetchMinutes() const
+{
+    return _values.value(KEY_RECORDING_FETCH_MINUTES).toUInt();
+}
+
 } // namespace Soro
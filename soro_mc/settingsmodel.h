@@ -42,6 +42,16 @@ public:
     SettingsModel::Configuration getConfiguration() const;
     bool getEnableHwRendering() const;
     bool getEnableHwDecoding() const;
+    // Which rendition of each camera this mission control requests and plays
+    uint getVideoRendition() const;
+    // How received video is buffered, one of GStreamerUtil's RECEIVE_MODE_* constants
+    quint8 getVideoReceiveMode() const;
+    // How long packets wait in the jitter buffer in the smooth receive mode
+    uint getVideoJitterBufferMs() const;
+    // Whether videos shown as thumbnails decode only their keyframes, as hidden ones always do
+    bool getVideoThumbnailKeyframesOnly() const;
+    // How far back to fetch onboard recordings from when asked
+    uint getRecordingFetchMinutes() const;
     uint getDriveSendInterval() const;
     DriveInputMode getDriveInputMode() const;
     CameraGimbalInputMode getCameraGimbalInputMode() const;
@@ -28,6 +28,7 @@ HEADERS += \
     sciencecameracontrolsystem.h \
     mapviewimpl.h \
     audioclient.h \
+    recordingclient.h \
     pitchrollview.h
 
 SOURCES += main.cpp \
@@ -47,6 +48,7 @@ SOURCES += main.cpp \
     armcontrolsystem.cpp \
     sciencecameracontrolsystem.cpp \
     audioclient.cpp \
+    recordingclient.cpp \
     pitchrollview.cpp
 
 RESOURCES += qml.qrc \
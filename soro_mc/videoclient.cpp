@@ -22,7 +22,10 @@
 #include "soro_core/videostatemessage.h"
 #include "soro_core/addmediabouncemessage.h"
 
+#include <Qt5GStreamer/QGst/Buffer>
 #include <Qt5GStreamer/QGst/Bus>
+#include <Qt5GStreamer/QGst/Caps>
+#include <Qt5GStreamer/QGst/Query>
 
 #include <QNetworkInterface>
 
@@ -37,6 +40,7 @@ VideoClient::VideoClient(const SettingsModel *settings, const CameraSettingsMode
     _settings = settings;
     _cameraSettings = cameraSettings;
     _sinks = sinks;
+    _roundTripLatency = 0;
 
     for (int i = 0; i < cameraSettings->getCameraCount(); ++i)
     {
@@ -44,23 +48,17 @@ VideoClient::VideoClient(const SettingsModel *settings, const CameraSettingsMode
         _bins.append(QGst::BinPtr());
         _pipelineWatches.append(nullptr);
         _videoStates.append(GStreamerUtil::VideoProfile());
+        _viewSizes.append(QSize());
+        _mainViews.append(true);
 
         stopVideoOnSink(i);
     }
 
-    LOG_I(LogTag, "Creating MQTT client...");
-    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::received, this, &VideoClient::onMqttMessage);
-    connect(_mqtt, &QMQTT::Client::connected, this, &VideoClient::onMqttConnected);
-    connect(_mqtt, &QMQTT::Client::disconnected, this, &VideoClient::onMqttDisconnected);
-    _mqtt->setClientId("video_client_" + MainController::getId());
-    _mqtt->setAutoReconnect(true);
-    _mqtt->setAutoReconnectInterval(1000);
-    _mqtt->setWillMessage(_mqtt->clientId());
-    _mqtt->setWillQos(2);
-    _mqtt->setWillTopic("system_down");
-    _mqtt->setWillRetain(false);
-    _mqtt->connectToHost();
+    LOG_I(LogTag, "Creating MQTT endpoint...");
+    _mqtt = MqttHub::getInstance(settings->getMqttBrokerAddress())->createEndpoint("video_client_" + MainController::getId(), this);
+    connect(_mqtt, &MqttEndpoint::received, this, &VideoClient::onMqttMessage);
+    connect(_mqtt, &MqttEndpoint::connected, this, &VideoClient::onMqttConnected);
+    connect(_mqtt, &MqttEndpoint::disconnected, this, &VideoClient::onMqttDisconnected);
 
     _announceTimerId = startTimer(1000);
 }
@@ -78,7 +76,7 @@ void VideoClient::onMqttConnected()
     LOG_I(LogTag, "Connected to MQTT broker");
     for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
     {
-        _mqtt->subscribe("video_state_" + QString::number(i), 1);
+        _mqtt->subscribe("video_state_" + QString::number(i + _settings->getVideoRendition() * SORO_NET_VIDEO_RENDITION_STRIDE), 1);
     }
     _mqtt->subscribe("system_down", 2);
 }
@@ -100,6 +98,11 @@ void VideoClient::onMqttMessage(const QMQTT::Message &msg)
     if (msg.topic().startsWith("video_state_"))
     {
         VideoMessage videoMsg(msg.payload());
+        if (!videoMsg.isValid())
+        {
+            LOG_W(LogTag, "Received invalid video state message, discarding");
+            return;
+        }
 
         LOG_I(LogTag, "Received video state message for camera " + QString::number(videoMsg.camera_index));
         if (videoMsg.camera_index < _videoStates.length())
@@ -107,8 +110,18 @@ void VideoClient::onMqttMessage(const QMQTT::Message &msg)
             if (videoMsg.profile != _videoStates.value(videoMsg.camera_index))
             {
                 // Video state has changed
+                // A stream that starts or stops sending FEC needs a decoder built for it
+                GStreamerUtil::VideoProfile oldProfile = _videoStates.value(videoMsg.camera_index);
+                bool sameCodec = (videoMsg.profile.codec == oldProfile.codec) &&
+                        ((videoMsg.profile.fec_percentage == 0) == (oldProfile.fec_percentage == 0));
                 _videoStates[videoMsg.camera_index] = videoMsg.profile;
-                if (videoMsg.profile.codec != GStreamerUtil::CODEC_NULL)
+                if ((videoMsg.profile.codec != GStreamerUtil::CODEC_NULL) && sameCodec)
+                {
+                    // The stream was reconfigured without stopping, the running decoder handles it
+                    applyView(videoMsg.camera_index);
+                    Q_EMIT playing(videoMsg.camera_index, videoMsg.profile);
+                }
+                else if (videoMsg.profile.codec != GStreamerUtil::CODEC_NULL)
                 {
                     // Video is streaming
                     playVideoOnSink(videoMsg.camera_index, videoMsg.profile);
@@ -162,6 +175,7 @@ void VideoClient::play(uint cameraIndex, GStreamerUtil::VideoProfile profile)
             // Send a request to the rover to start/change a video stream
             VideoMessage msg(cameraIndex, _cameraSettings->getCamera(cameraIndex));
             msg.profile = profile;
+            msg.rendition = _settings->getVideoRendition();
 
             LOG_I(LogTag, QString("Sending video ON request to the rover for camera %1: [Codec %2, %3x%4, %5fps, %6bps, %7q]").arg(
                                 QString::number(cameraIndex), QString::number(profile.codec), QString::number(profile.width), QString::number(profile.height),
@@ -208,6 +222,14 @@ void VideoClient::constructPipelineOnSink(uint cameraIndex, QString sourceBinStr
         _pipelines[cameraIndex]->add(_bins[cameraIndex], _sinks[cameraIndex]);
         _bins[cameraIndex]->link(_sinks[cameraIndex]);
 
+        // The FEC decoder rebuilds lost packets from the ones the storage element holds on to
+        QGst::ElementPtr fecStorage = _bins[cameraIndex]->getElementByName(GStreamerUtil::VIDEO_FEC_STORAGE_NAME);
+        QGst::ElementPtr fecDecoder = _bins[cameraIndex]->getElementByName(GStreamerUtil::VIDEO_FEC_DECODER_NAME);
+        if (fecStorage && fecDecoder)
+        {
+            fecDecoder->setProperty("storage", fecStorage->property("internal-storage"));
+        }
+
         _pipelineWatches[cameraIndex] = new GStreamerPipelineWatch(cameraIndex, _pipelines[cameraIndex], this);
         connect(_pipelineWatches[cameraIndex], &GStreamerPipelineWatch::error, this, &VideoClient::gstError);
 
@@ -219,9 +241,10 @@ void VideoClient::stopVideoOnSink(uint cameraIndex)
 {
     if (cameraIndex < (uint)_cameraSettings->getCameraCount())
     {
-        // Stop the video on the specified sink, and play a placeholder animation
+        // Stop the video on the specified sink. The UI shows its placeholder over the sink, so
+        // nothing is left running for an idle camera
         LOG_I(LogTag, "Stopping video " + QString::number(cameraIndex));
-        constructPipelineOnSink(cameraIndex, GStreamerUtil::createVideoTestSrcString("smpte", true, 800, 600, 10));
+        clearPipeline(cameraIndex);
         _videoStates[cameraIndex] = GStreamerUtil::VideoProfile();
         Q_EMIT stopped(cameraIndex);
     }
@@ -233,12 +256,23 @@ void VideoClient::playVideoOnSink(uint cameraIndex, GStreamerUtil::VideoProfile
     {
         // Play the video on the specified sink
         LOG_I(LogTag, "Playing video " + QString::number(cameraIndex) + " with codec " + GStreamerUtil::getCodecName(profile.codec));
+        quint8 receiveMode = _settings->getVideoReceiveMode();
+        if (!_sinks[cameraIndex].isNull())
+        {
+            // At the lowest latency frames are drawn the moment they are decoded, instead of when the clock says
+            _sinks[cameraIndex]->setProperty("sync", receiveMode != GStreamerUtil::RECEIVE_MODE_LOWEST_LATENCY);
+        }
         constructPipelineOnSink(cameraIndex, GStreamerUtil::createRtpVideoDecodeString(
                                     QHostAddress::Any,
-                                    SORO_NET_MC_FIRST_VIDEO_PORT + cameraIndex,
+                                    SORO_NET_MC_FIRST_VIDEO_PORT + cameraIndex + _settings->getVideoRendition() * SORO_NET_VIDEO_RENDITION_STRIDE,
                                     profile.codec,
-                                    _settings->getEnableHwDecoding()));
+                                    receiveMode,
+                                    _settings->getVideoJitterBufferMs(),
+                                    _settings->getEnableHwDecoding(),
+                                    profile.fec_percentage > 0,
+                                    _settings->getEnableHwRendering()));
         _videoStates[cameraIndex] = profile;
+        applyView(cameraIndex);
         Q_EMIT playing(cameraIndex, profile);
     }
 }
@@ -252,6 +286,7 @@ void VideoClient::stop(uint cameraIndex)
             // Send a request to the rover to stop a video stream
             VideoMessage msg(cameraIndex, _cameraSettings->getCamera(cameraIndex));
             msg.profile = GStreamerUtil::VideoProfile();
+            msg.rendition = _settings->getVideoRendition();
 
             LOG_I(LogTag, QString("Sending video OFF request to the rover for camera %1").arg(cameraIndex));
 
@@ -275,9 +310,28 @@ void VideoClient::stopAll()
 
 void VideoClient::clearPipeline(uint cameraIndex)
 {
+    quint32 recovered, unrecovered;
+    if (getFecStats(cameraIndex, recovered, unrecovered))
+    {
+        LOG_I(LogTag, QString("Video %1 recovered %2 packets with FEC, %3 were lost").arg(
+                  QString::number(cameraIndex), QString::number(recovered), QString::number(unrecovered)));
+    }
     if (!_pipelines.value(cameraIndex).isNull())
     {
+        // Take the sink out of the pipeline in the READY state, so the next stream on it
+        // does not have to set it up (and its GL context) all over again
+        QGst::ElementPtr sink = _sinks.value(cameraIndex);
+        if (!sink.isNull())
+        {
+            sink->setState(QGst::StateReady);
+            sink->setStateLocked(true);
+        }
         _pipelines[cameraIndex]->setState(QGst::StateNull);
+        if (!sink.isNull())
+        {
+            _pipelines[cameraIndex]->remove(sink);
+            sink->setStateLocked(false);
+        }
         _pipelines[cameraIndex].clear();
         _bins[cameraIndex].clear();
     }
@@ -306,9 +360,105 @@ void VideoClient::timerEvent(QTimerEvent *e)
                 break;
             }
         }
+
+        for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
+        {
+            quint32 recovered, unrecovered;
+            if (getFecStats(i, recovered, unrecovered))
+            {
+                Q_EMIT fecStats(i, recovered, unrecovered);
+            }
+            quint32 latency;
+            if (getGlassToGlassLatency(i, latency))
+            {
+                Q_EMIT glassToGlassLatency(i, latency);
+            }
+        }
+    }
+}
+
+void VideoClient::setView(int cameraIndex, int width, int height, bool main)
+{
+    if ((cameraIndex < 0) || (cameraIndex >= _cameraSettings->getCameraCount())) return;
+
+    QSize size(width, height);
+    if ((size == _viewSizes[cameraIndex]) && (main == _mainViews[cameraIndex])) return;
+
+    _viewSizes[cameraIndex] = size;
+    _mainViews[cameraIndex] = main;
+    applyView(cameraIndex);
+}
+
+void VideoClient::applyView(uint cameraIndex)
+{
+    if (!isPlaying(cameraIndex) || _bins.value(cameraIndex).isNull()) return;
+
+    const QSize& size = _viewSizes[cameraIndex];
+    const GStreamerUtil::VideoProfile& profile = _videoStates[cameraIndex];
+
+    QGst::ElementPtr gate = _bins[cameraIndex]->getElementByName(GStreamerUtil::VIDEO_VIEW_GATE_NAME);
+    if (gate)
+    {
+        // Streams that are all keyframes, like MJPEG, pass the gate either way
+        bool hidden = size.isValid() && size.isEmpty();
+        bool keyframesOnly = hidden || (!_mainViews[cameraIndex] && _settings->getVideoThumbnailKeyframesOnly());
+        gate->setProperty("drop-buffer-flags", keyframesOnly ? QGst::BufferFlags(QGst::BufferFlagDeltaUnit)
+                                                             : QGst::BufferFlags(QGst::BufferFlagNone));
+    }
+
+    QGst::ElementPtr capsFilter = _bins[cameraIndex]->getElementByName(GStreamerUtil::VIDEO_VIEW_CAPS_NAME);
+    if (capsFilter)
+    {
+        // Only ever scale down, keeping the stream's shape. Scaling up is left to the sink.
+        QString caps = "video/x-raw";
+        if (!size.isEmpty())
+        {
+            double scale = qMin(static_cast<double>(size.width()) / qMax<quint16>(profile.width, 1),
+                                static_cast<double>(size.height()) / qMax<quint16>(profile.height, 1));
+            if (scale < 1.0)
+            {
+                caps = QString("video/x-raw,width=%1,height=%2").arg(
+                            QString::number(qMax(2, static_cast<int>(profile.width * scale) & ~1)),
+                            QString::number(qMax(2, static_cast<int>(profile.height * scale) & ~1)));
+            }
+        }
+        capsFilter->setProperty("caps", QGst::Caps::fromString(caps));
     }
 }
 
+void VideoClient::onLatencyUpdate(quint32 latency)
+{
+    _roundTripLatency = latency;
+}
+
+bool VideoClient::getGlassToGlassLatency(uint cameraIndex, quint32 &latencyMs) const
+{
+    if (!isPlaying(cameraIndex) || _pipelines.value(cameraIndex).isNull()) return false;
+
+    // The rover's clock is not ours, so the time a frame was captured cannot be read from the stream.
+    // Instead this adds up a frame each for capture and encoding, half the round trip to the rover,
+    // and what our pipeline reports for its jitter buffer, decoder and sink.
+    QGst::LatencyQueryPtr query = QGst::LatencyQuery::create();
+    if (!_pipelines[cameraIndex]->query(query)) return false;
+
+    const GStreamerUtil::VideoProfile& profile = _videoStates[cameraIndex];
+    quint32 frameMs = 1000 / qMax<quint16>(profile.framerate, 1);
+    latencyMs = 2 * frameMs + _roundTripLatency / 2 + static_cast<quint64>(query->minimumLatency()) / 1000000;
+    return true;
+}
+
+bool VideoClient::getFecStats(uint cameraIndex, quint32 &recovered, quint32 &unrecovered) const
+{
+    if (_bins.value(cameraIndex).isNull()) return false;
+
+    QGst::ElementPtr fecDecoder = _bins[cameraIndex]->getElementByName(GStreamerUtil::VIDEO_FEC_DECODER_NAME);
+    if (!fecDecoder) return false;
+
+    recovered = fecDecoder->property("recovered").get<uint>();
+    unrecovered = fecDecoder->property("unrecovered").get<uint>();
+    return true;
+}
+
 bool VideoClient::isPlaying(uint cameraIndex) const
 {
     return _videoStates.value(cameraIndex).codec != GStreamerUtil::CODEC_NULL;
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QUdpSocket>
 #include <QTimerEvent>
+#include <QSize>
 
 #include "soro_core/camerasettingsmodel.h"
 #include "settingsmodel.h"
@@ -16,6 +17,7 @@
 #include "soro_core/gstreamerutil.h"
 
 #include "qmqtt/qmqtt.h"
+#include "soro_core/mqtthub.h"
 
 namespace Soro {
 
@@ -30,8 +32,14 @@ namespace Soro {
  * videos we may receive. These cannot be changed without destroying and recreating the VideoController instance.
  * Videos are assigned to sinks based on their index, so video 0 will play on sink index 0, etc.
  *
- * When no video is being streamed on any particular sink, a placeholder animation will be shown using a
- * videotestsrc animation.
+ * When no video is being streamed on any particular sink, its pipeline is torn down and nothing runs for it.
+ * Showing a placeholder in its place is left to the UI. The sink itself is kept in the READY state, so the
+ * next video played on it starts without setting the sink up again.
+ *
+ * Each video is decoded according to how it is shown, as reported with setView(). Videos smaller on screen
+ * than their stream are scaled down right after the decoder, and videos that cannot be seen only decode their
+ * keyframes. Both change on the running pipeline, so a video is back at full rate as soon as it is shown
+ * without being rebuilt, though one that was only decoding keyframes may smear until its next keyframe.
  *
  * Additionally, the signals gstError() and gstEos() may be emitted if there is an error decoding the video streamed
  * by the rover.
@@ -63,6 +71,20 @@ Q_SIGNALS:
      */
     void videoServerDisconnected(uint computerIndex);
     void masterVideoClientDisconnected();
+    /* Emitted each second for every stream sent with FEC, with the number of its lost packets that
+     * were rebuilt from FEC and the number that could not be, since it started playing
+     */
+    void fecStats(uint cameraIndex, quint32 recovered, quint32 unrecovered);
+    /* Emitted each second for every playing stream, with an estimate of how long it takes a frame to get from
+     * the camera to the screen
+     */
+    void glassToGlassLatency(uint cameraIndex, quint32 latencyMs);
+
+public Q_SLOTS:
+    // Takes the round trip time to the rover, which the latency estimates are based on
+    void onLatencyUpdate(quint32 latency);
+    // Sets the size a camera's video is shown at, zero if it cannot be seen, and whether it is the main view
+    void setView(int cameraIndex, int width, int height, bool main);
 
 protected:
     void timerEvent(QTimerEvent *e);
@@ -77,8 +99,11 @@ private:
     void playVideoOnSink(uint cameraIndex, GStreamerUtil::VideoProfile profile);
     void constructPipelineOnSink(uint cameraIndex, QString sourceBinString);
     void stopVideoOnSink(uint cameraIndex);
+    bool getFecStats(uint cameraIndex, quint32 &recovered, quint32 &unrecovered) const;
+    bool getGlassToGlassLatency(uint cameraIndex, quint32 &latencyMs) const;
+    void applyView(uint cameraIndex);
 
-    QMQTT::Client *_mqtt;
+    MqttEndpoint *_mqtt;
     const SettingsModel *_settings;
     const CameraSettingsModel *_cameraSettings;
 
@@ -89,6 +114,10 @@ private:
     QVector<QGst::ElementPtr> _sinks;
     QVector<GStreamerPipelineWatch*> _pipelineWatches;
     QVector<GStreamerUtil::VideoProfile> _videoStates;
+    quint32 _roundTripLatency;
+    // How each camera is shown, an invalid size until the UI has said
+    QVector<QSize> _viewSizes;
+    QVector<bool> _mainViews;
 };
 
 } // namespace Soro
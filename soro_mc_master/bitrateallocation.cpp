@@ -0,0 +1,136 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bitrateallocation.h"
+
+// A reported bitrate this close to the expected one is what was asked for, encoders round
+// their bitrate to their own units
+#define BITRATE_TOLERANCE 0.05
+// Control intervals a reported bitrate must stay off before it is taken as mission control's
+#define MISMATCH_INTERVALS 3
+
+namespace Soro {
+namespace BitrateAllocation {
+
+bool isAdjustable(const VideoMessage& state)
+{
+    if (state.capture_path == GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH) return false;
+
+    switch (state.profile.codec)
+    {
+    case GStreamerUtil::VIDEO_CODEC_H264:
+    case GStreamerUtil::VIDEO_CODEC_H265:
+    case GStreamerUtil::VIDEO_CODEC_VP8:
+    case GStreamerUtil::VIDEO_CODEC_VP9:
+        return true;
+    default:
+        // Stopped, or an encoder whose bitrate cannot be changed while it runs
+        return false;
+    }
+}
+
+QHash<uint, quint32> divide(quint64 estimate, const QHash<uint, Demand>& demands, quint32 minimum)
+{
+    QHash<uint, quint32> targets;
+    QList<uint> uncapped = demands.keys();
+    quint64 remaining = estimate;
+
+    bool capped = true;
+    while (capped && !uncapped.isEmpty())
+    {
+        capped = false;
+        quint64 totalPriority = 0;
+        for (uint key : uncapped)
+        {
+            totalPriority += demands[key].priority;
+        }
+        for (int i = 0; i < uncapped.size(); ++i)
+        {
+            const Demand &demand = demands[uncapped[i]];
+            quint64 share = totalPriority > 0 ? remaining * demand.priority / totalPriority : 0;
+            if (share >= demand.maxBitrate)
+            {
+                targets.insert(uncapped[i], demand.maxBitrate);
+                remaining -= demand.maxBitrate;
+                uncapped.removeAt(i);
+                capped = true;
+                break;
+            }
+        }
+    }
+
+    quint64 totalPriority = 0;
+    for (uint key : uncapped)
+    {
+        totalPriority += demands[key].priority;
+    }
+    for (uint key : uncapped)
+    {
+        const Demand &demand = demands[key];
+        quint64 share = totalPriority > 0 ? remaining * demand.priority / totalPriority : 0;
+        targets.insert(key, qMin<quint64>(qMax<quint64>(share, minimum), demand.maxBitrate));
+    }
+    return targets;
+}
+
+StreamLimit::StreamLimit(quint32 maxBitrate)
+{
+    _max = maxBitrate;
+    _requested = 0;
+    _mismatchIntervals = 0;
+}
+
+void StreamLimit::setRequested(quint32 bitrate)
+{
+    _requested = bitrate;
+    _mismatchIntervals = 0;
+}
+
+bool StreamLimit::update(quint32 reportedBitrate)
+{
+    quint32 expected = _requested > 0 ? _requested : _max;
+    quint32 difference = reportedBitrate > expected ? reportedBitrate - expected : expected - reportedBitrate;
+    if (difference <= expected * BITRATE_TOLERANCE)
+    {
+        _mismatchIntervals = 0;
+        return false;
+    }
+    if (++_mismatchIntervals < MISMATCH_INTERVALS) return false;
+
+    // Mission control has asked for a different bitrate since
+    _max = reportedBitrate;
+    _requested = 0;
+    _mismatchIntervals = 0;
+    return true;
+}
+
+bool StreamLimit::hasMismatch() const
+{
+    return _mismatchIntervals > 0;
+}
+
+quint32 StreamLimit::getMax() const
+{
+    return _max;
+}
+
+quint32 StreamLimit::getRequested() const
+{
+    return _requested;
+}
+
+} // namespace BitrateAllocation
+} // namespace Soro
@@ -0,0 +1,68 @@
+#ifndef BITRATEALLOCATION_H
+#define BITRATEALLOCATION_H
+
+#include <QtGlobal>
+#include <QHash>
+
+#include "soro_core/videomessage.h"
+
+namespace Soro {
+namespace BitrateAllocation {
+
+struct Demand
+{
+    int priority;
+    // The most this stream will be given
+    quint32 maxBitrate;
+};
+
+/* Returns true if the controller can change the bitrate of a stream in this state while it runs.
+ * H264 passthrough streams are encoded by the camera, so their bitrate is not the server's to change.
+ */
+bool isAdjustable(const VideoMessage& state);
+
+/* Shares an estimate between streams in proportion to their priority, keyed the same as the demands.
+ * Streams that would get more than their maximum are capped, and what they leave is shared again
+ * between the others. No stream is given less than the minimum unless its maximum is lower.
+ */
+QHash<uint, quint32> divide(quint64 estimate, const QHash<uint, Demand>& demands, quint32 minimum);
+
+/* Tracks the most a stream may be given, which is the bitrate mission control last asked for.
+ *
+ * Mission control and the controller both request bitrates, and the server's state only says which
+ * bitrate is running. A reported bitrate is taken as a new maximum only once it has been off from the
+ * one expected by more than the tolerance for several control intervals in a row, since a state
+ * published before the server applied the controller's last request is off too, but only briefly.
+ */
+class StreamLimit
+{
+public:
+    explicit StreamLimit(quint32 maxBitrate = 0);
+
+    // Records a bitrate the controller asked the server for
+    void setRequested(quint32 bitrate);
+
+    /* Checks the bitrate the server reports once per control interval, returning true
+     * if the maximum has changed
+     */
+    bool update(quint32 reportedBitrate);
+
+    /* Returns true while the reported bitrate is off from the expected one but not yet taken as a new
+     * maximum. The controller should not request a bitrate then, it would override mission control's.
+     */
+    bool hasMismatch() const;
+
+    quint32 getMax() const;
+    quint32 getRequested() const;
+
+private:
+    quint32 _max;
+    // 0 if the controller has not changed the bitrate since the maximum was set
+    quint32 _requested;
+    int _mismatchIntervals;
+};
+
+} // namespace BitrateAllocation
+} // namespace Soro
+
+#endif // BITRATEALLOCATION_H
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "bitratecontroller.h"
+#include "soro_core/constants.h"
+#include "soro_core/logger.h"
+#include "soro_core/videostatsmessage.h"
+
+#include <limits>
+
+#define LogTag "BitrateController"
+
+// Congestion thresholds
+#define MAX_LOSS_PERCENT 2.0f
+#define MAX_JITTER_MS 40.0f
+#define MAX_LATENCY_INCREASE_MS 200
+// A stream with no stats for this long has stopped arriving
+#define STATS_TIMEOUT_MS 2500
+
+// On congestion the estimate is cut to this fraction of itself or of the measured downlink rate,
+// whichever is lower, and held there for a few intervals before growing again
+#define DECREASE_FACTOR 0.7
+#define DOWNLINK_FACTOR 0.9
+#define HOLD_INTERVALS 3
+// Fraction of the link budget the estimate grows by each interval without congestion
+#define INCREASE_FACTOR 0.05
+// Bitrate changes smaller than this fraction are not worth reconfiguring an encoder for
+#define MIN_CHANGE_FACTOR 0.1
+
+namespace Soro {
+
+BitrateController::BitrateController(const SettingsModel *settings, const CameraSettingsModel *cameraSettings, QObject *parent) : QObject(parent)
+{
+    _settings = settings;
+    _cameraSettings = cameraSettings;
+    _nextMqttMsgId = 1;
+    _linkEstimate = settings->getVideoLinkBudget();
+    _latency = 0;
+    _baselineLatency = std::numeric_limits<quint32>::max();
+    _rateFromRover = 0;
+    _holdIntervals = 0;
+
+    LOG_I(LogTag, "Creating MQTT client...");
+    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
+    connect(_mqtt, &QMQTT::Client::received, this, &BitrateController::onMqttMessage);
+    connect(_mqtt, &QMQTT::Client::connected, this, &BitrateController::onMqttConnected);
+    connect(_mqtt, &QMQTT::Client::disconnected, this, &BitrateController::onMqttDisconnected);
+    _mqtt->setClientId("master_bitrate_controller");
+    _mqtt->setAutoReconnect(true);
+    _mqtt->setAutoReconnectInterval(1000);
+    _mqtt->setWillMessage(_mqtt->clientId());
+    _mqtt->setWillQos(2);
+    _mqtt->setWillTopic("system_down");
+    _mqtt->setWillRetain(false);
+    _mqtt->connectToHost();
+
+    _controlTimerId = startTimer(1000);
+}
+
+void BitrateController::onMqttConnected()
+{
+    LOG_I(LogTag, "Connected to MQTT broker");
+    _mqtt->subscribe("video_stats", 0);
+    for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
+    {
+        _mqtt->subscribe("video_state_" + QString::number(i), 2);
+    }
+}
+
+void BitrateController::onMqttDisconnected()
+{
+    LOG_W(LogTag, "Disconnected from MQTT broker");
+}
+
+void BitrateController::onMqttMessage(const QMQTT::Message &msg)
+{
+    if (msg.topic().startsWith("video_state_"))
+    {
+        VideoMessage videoMsg(msg.payload());
+        if (!videoMsg.isValid() || (videoMsg.camera_index >= _cameraSettings->getCameraCount())) return;
+
+        if (!BitrateAllocation::isAdjustable(videoMsg))
+        {
+            _streams.remove(videoMsg.camera_index);
+            return;
+        }
+
+        if (!_streams.contains(videoMsg.camera_index))
+        {
+            // A new stream starts at the bitrate mission control asked for
+            Stream stream;
+            stream.limit = BitrateAllocation::StreamLimit(videoMsg.profile.bitrate);
+            stream.lossPercent = 0;
+            stream.jitterMs = 0;
+            stream.sinceStats.start();
+            _streams.insert(videoMsg.camera_index, stream);
+        }
+
+        Stream &stream = _streams[videoMsg.camera_index];
+        stream.state = videoMsg;
+    }
+    else if (msg.topic() == "video_stats")
+    {
+        VideoStatsMessage statsMsg(msg.payload());
+        if (statsMsg.isValid() && _streams.contains(statsMsg.camera_index))
+        {
+            Stream &stream = _streams[statsMsg.camera_index];
+            stream.lossPercent = statsMsg.loss_rate / 100.0f;
+            stream.jitterMs = statsMsg.jitter_us / 1000.0f;
+            stream.sinceStats.restart();
+        }
+    }
+}
+
+void BitrateController::onLatencyUpdate(quint32 latency)
+{
+    _latency = latency;
+
+    // The lowest latency seen is the link's baseline, let it drift up slowly in case the route changes
+    if (latency < _baselineLatency)
+    {
+        _baselineLatency = latency;
+    }
+    else
+    {
+        _baselineLatency += (latency - _baselineLatency) / 64;
+    }
+}
+
+void BitrateController::onDataRateUpdate(quint64 rateFromRover)
+{
+    _rateFromRover = rateFromRover;
+}
+
+quint32 BitrateController::getLinkEstimate() const
+{
+    return _linkEstimate;
+}
+
+bool BitrateController::isCongested() const
+{
+    if ((_baselineLatency != std::numeric_limits<quint32>::max()) && (_latency > _baselineLatency + MAX_LATENCY_INCREASE_MS))
+    {
+        return true;
+    }
+    for (const Stream &stream : _streams)
+    {
+        if ((stream.lossPercent > MAX_LOSS_PERCENT) || (stream.jitterMs > MAX_JITTER_MS) || stream.sinceStats.hasExpired(STATS_TIMEOUT_MS))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BitrateController::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() == _controlTimerId)
+    {
+        if (_streams.isEmpty() || !_mqtt->isConnectedToHost()) return;
+
+        for (Stream &stream : _streams)
+        {
+            if (stream.limit.update(stream.state.profile.bitrate))
+            {
+                LOG_I(LogTag, QString("Camera %1 is limited to %2 bit/s")
+                      .arg(QString::number(stream.state.camera_index), QString::number(stream.limit.getMax())));
+            }
+        }
+
+        quint32 budget = _settings->getVideoLinkBudget();
+        quint32 minimum = qMin<quint64>(budget, (quint64)_settings->getMinVideoBitrate() * _streams.size());
+
+        if (isCongested())
+        {
+            // The link is full, it carries about what arrived
+            quint64 estimate = _linkEstimate * DECREASE_FACTOR;
+            if (_rateFromRover > 0)
+            {
+                estimate = qMin<quint64>(estimate, _rateFromRover * 8 * DOWNLINK_FACTOR);
+            }
+            _linkEstimate = qMax<quint64>(estimate, minimum);
+            _holdIntervals = HOLD_INTERVALS;
+            LOG_W(LogTag, QString("Video link is congested, estimate is now %1 bit/s").arg(_linkEstimate));
+        }
+        else if (_holdIntervals > 0)
+        {
+            _holdIntervals--;
+        }
+        else
+        {
+            _linkEstimate = qMin<quint64>((quint64)_linkEstimate + budget * INCREASE_FACTOR, budget);
+        }
+
+        allocate();
+    }
+}
+
+void BitrateController::allocate()
+{
+    QHash<uint, BitrateAllocation::Demand> demands;
+    for (auto it = _streams.constBegin(); it != _streams.constEnd(); ++it)
+    {
+        BitrateAllocation::Demand demand;
+        demand.priority = _cameraSettings->getCamera(it.key()).priority;
+        demand.maxBitrate = it.value().limit.getMax();
+        demands.insert(it.key(), demand);
+    }
+    QHash<uint, quint32> targets = BitrateAllocation::divide(_linkEstimate, demands, _settings->getMinVideoBitrate());
+
+    for (uint camera : targets.keys())
+    {
+        Stream &stream = _streams[camera];
+        if (stream.limit.hasMismatch()) continue; // Wait to see whose bitrate the server is running
+
+        quint32 current = stream.state.profile.bitrate;
+        quint32 target = targets.value(camera);
+        quint32 difference = target > current ? target - current : current - target;
+        if ((difference > current * MIN_CHANGE_FACTOR) || ((target == stream.limit.getMax()) && (current != target)))
+        {
+            requestBitrate(stream, target);
+        }
+    }
+}
+
+void BitrateController::requestBitrate(Stream &stream, quint32 bitrate)
+{
+    if (stream.limit.getRequested() == bitrate) return; // Already waiting for the server to apply this
+
+    LOG_I(LogTag, QString("Changing bitrate of camera %1 from %2 to %3 bit/s").arg(
+              QString::number(stream.state.camera_index),
+              QString::number(stream.state.profile.bitrate),
+              QString::number(bitrate)));
+
+    VideoMessage msg = stream.state;
+    msg.profile.bitrate = bitrate;
+    stream.limit.setRequested(bitrate);
+    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "video_request", msg, 2));
+}
+
+} // namespace Soro
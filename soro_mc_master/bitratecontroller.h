@@ -0,0 +1,84 @@
+#ifndef BITRATECONTROLLER_H
+#define BITRATECONTROLLER_H
+
+#include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTimerEvent>
+
+#include "qmqtt/qmqtt.h"
+
+#include "soro_core/camerasettingsmodel.h"
+#include "soro_core/videomessage.h"
+#include "settingsmodel.h"
+#include "bitrateallocation.h"
+
+namespace Soro {
+
+/* Adjusts the bitrate of the running video streams to what the link from the rover can carry.
+ *
+ * The controller keeps an estimate of the bits per second available for video. Each second it checks
+ * the RTP loss and jitter of every stream (from video_stats), the ping latency and the measured
+ * downlink rate. When any of them shows congestion the estimate is cut to what actually arrived,
+ * otherwise it creeps back up toward the configured link budget.
+ *
+ * The estimate is divided between the active cameras in proportion to their priority, never giving
+ * a camera more than the bitrate mission control asked for or less than the configured minimum.
+ * H264 passthrough streams are left alone, the camera encodes them.
+ * New bitrates are sent to the video servers as ordinary video requests, which they apply to the
+ * running encoder without restarting the stream.
+ */
+class BitrateController : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BitrateController(const SettingsModel *settings, const CameraSettingsModel *cameraSettings, QObject *parent = 0);
+
+    quint32 getLinkEstimate() const;
+
+public Q_SLOTS:
+    void onLatencyUpdate(quint32 latency);
+    void onDataRateUpdate(quint64 rateFromRover);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private Q_SLOTS:
+    void onMqttMessage(const QMQTT::Message &msg);
+    void onMqttConnected();
+    void onMqttDisconnected();
+
+private:
+    struct Stream
+    {
+        // Latest state reported by the video server
+        VideoMessage state;
+        // Bitrate mission control asked for and the one this controller last asked for
+        BitrateAllocation::StreamLimit limit;
+        float lossPercent;
+        float jitterMs;
+        QElapsedTimer sinceStats;
+    };
+
+    bool isCongested() const;
+    void allocate();
+    void requestBitrate(Stream &stream, quint32 bitrate);
+
+    const SettingsModel *_settings;
+    const CameraSettingsModel *_cameraSettings;
+    QMQTT::Client *_mqtt;
+    quint16 _nextMqttMsgId;
+    int _controlTimerId;
+
+    // Keyed by camera index, only streams whose bitrate can be changed while running
+    QHash<uint, Stream> _streams;
+    quint32 _linkEstimate;
+    quint32 _latency;
+    quint32 _baselineLatency;
+    quint64 _rateFromRover;
+    int _holdIntervals;
+};
+
+} // namespace Soro
+
+#endif // BITRATECONTROLLER_H
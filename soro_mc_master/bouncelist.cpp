@@ -0,0 +1,58 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bouncelist.h"
+
+namespace Soro {
+
+bool BounceList::add(const QString& clientID, const QHostAddress& address)
+{
+    if (_destinations.contains(clientID)) return false;
+    _destinations.insert(clientID, address);
+    return true;
+}
+
+QHash<QString, QHostAddress> BounceList::remove(const QStringList& clientIDs)
+{
+    QHash<QString, QHostAddress> removed;
+    for (const QString& clientID : clientIDs)
+    {
+        auto it = _destinations.find(clientID);
+        if (it != _destinations.end())
+        {
+            removed.insert(clientID, it.value());
+            _destinations.erase(it);
+        }
+    }
+    return removed;
+}
+
+bool BounceList::contains(const QString& clientID) const
+{
+    return _destinations.contains(clientID);
+}
+
+QHostAddress BounceList::getAddress(const QString& clientID) const
+{
+    return _destinations.value(clientID);
+}
+
+const QHash<QString, QHostAddress>& BounceList::getDestinations() const
+{
+    return _destinations;
+}
+
+} // namespace Soro
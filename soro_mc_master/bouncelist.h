@@ -0,0 +1,35 @@
+#ifndef BOUNCELIST_H
+#define BOUNCELIST_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QStringList>
+
+namespace Soro {
+
+/* The mission control stations a relay forwards media to, keyed by the client ID
+ * each station announced itself with
+ */
+class BounceList
+{
+public:
+    /* Adds a client, returning false if it is already on the list
+     */
+    bool add(const QString& clientID, const QHostAddress& address);
+
+    /* Removes the listed clients, as named in a system_down or component_presence message,
+     * returning those that were on the list along with their addresses
+     */
+    QHash<QString, QHostAddress> remove(const QStringList& clientIDs);
+
+    bool contains(const QString& clientID) const;
+    QHostAddress getAddress(const QString& clientID) const;
+    const QHash<QString, QHostAddress>& getDestinations() const;
+
+private:
+    QHash<QString, QHostAddress> _destinations;
+};
+
+} // namespace Soro
+
+#endif // BOUNCELIST_H
@@ -100,6 +100,19 @@ void MainController::init(QApplication *app)
             LOG_I(LogTag, "Initializing master audio controller...");
             _self->_masterAudioController = new MasterAudioController(_self->_settings, _self);
 
+            //
+            // Create the bitrate controller
+            //
+            if (_self->_settings->getEnableBitrateControl())
+            {
+                LOG_I(LogTag, "Initializing bitrate controller...");
+                _self->_bitrateController = new BitrateController(_self->_settings, _self->_cameraSettings, _self);
+                connect(_self->_masterConnectionStatusController, &MasterConnectionStatusController::latencyUpdate,
+                        _self->_bitrateController, &BitrateController::onLatencyUpdate);
+                connect(_self->_masterConnectionStatusController, &MasterConnectionStatusController::dataRateUpdate,
+                        _self->_bitrateController, &BitrateController::onDataRateUpdate);
+            }
+
             //
             // Create the QML application engine
             //
@@ -12,6 +12,7 @@
 #include "masterconnectionstatuscontroller.h"
 #include "mastervideoclient.h"
 #include "masteraudiocontroller.h"
+#include "bitratecontroller.h"
 
 namespace Soro {
 
@@ -35,6 +36,7 @@ private:
     MasterAudioController *_masterAudioController = nullptr;
     MainWindowController *_mainWindowController = nullptr;
     MasterConnectionStatusController *_masterConnectionStatusController = nullptr;
+    BitrateController *_bitrateController = nullptr;
 };
 
 } // namespace Soro
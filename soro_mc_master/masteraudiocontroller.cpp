@@ -18,31 +18,30 @@
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
 #include "soro_core/addmediabouncemessage.h"
+#include "soro_core/mqtthub.h"
 
 #include "maincontroller.h"
 
 #define LogTag "MasterAudioController"
 
+// Audio packets are small and frequent, a short queue keeps a lagging client's delay down
+#define AUDIO_QUEUE_CAPACITY 64
+
 namespace Soro {
 
 MasterAudioController::MasterAudioController(const SettingsModel *settings, QObject *parent) : QObject(parent)
 {
     _settings = settings;
 
-    _audioSocket = new QUdpSocket(this);
-    if (!_audioSocket->bind())
-    {
-        MainController::panic(LogTag, "Cannot bind UDP socket");
-    }
-    if (!_audioSocket->open(QIODevice::ReadWrite))
+    _lastBytesIn = 0;
+    _relay = new MediaRelay(this);
+    if (_relay->addChannel(SORO_NET_MC_AUDIO_PORT, AUDIO_QUEUE_CAPACITY) < 0)
     {
-        MainController::panic(LogTag, "Cannot open UDP socket");
+        MainController::panic(LogTag, "Cannot open UDP audio socket");
     }
-
-    connect(_audioSocket, &QUdpSocket::readyRead, this, [this]()
-    {
-        this->onSocketReadyRead(_audioSocket, SORO_NET_MC_AUDIO_PORT);
-    });
+    // Matches the caps of the AC3 RTP stream from the rover
+    _relay->setClockRate(0, 44100);
+    _relay->start();
     LOG_I(LogTag, "Bound UDP audio socket");
 
     LOG_I(LogTag, "Creating MQTT client...");
@@ -73,34 +72,50 @@ void MasterAudioController::onMqttMessage(const QMQTT::Message &msg)
         }
         else
         {
-            if (!_bounceMap.contains(bounceMsg.clientID))
+            if (_bounceList.add(bounceMsg.clientID, bounceMsg.address))
             {
                 LOG_I(LogTag, "Adding client " + bounceMsg.clientID + " at " + bounceMsg.address.toString() + " to audio bounce list");
-                _bounceMap.insert(bounceMsg.clientID, bounceMsg.address);
-                _bounceAddresses = _bounceMap.values();
-                Q_EMIT bounceAddressesChanged(_bounceMap);
+                onBounceListChanged();
             }
         }
     }
     else if (msg.topic() == "system_down")
     {
-        QString clientID(msg.payload());
+        onComponentsDown(QStringList(QString(msg.payload())));
+    }
+    else if (msg.topic() == "component_presence")
+    {
+        // A process sharing one connection between its components has gone down, its will lists all of them
+        onComponentsDown(MqttHub::parsePresence(msg.payload()));
+    }
+}
 
-        if (_bounceMap.contains(clientID))
+void MasterAudioController::onComponentsDown(const QStringList& clientIDs)
+{
+    QHash<QString, QHostAddress> removed = _bounceList.remove(clientIDs);
+    if (!removed.isEmpty())
+    {
+        for (auto it = removed.constBegin(); it != removed.constEnd(); ++it)
         {
-            LOG_I(LogTag, "Removing client " + clientID + " at " + _bounceMap.value(clientID).toString() + " from audio bounce list");
-            _bounceMap.remove(clientID);
-            _bounceAddresses = _bounceMap.values();
-            Q_EMIT bounceAddressesChanged(_bounceMap);
+            LOG_I(LogTag, "Removing client " + it.key() + " at " + it.value().toString() + " from audio bounce list");
         }
+        onBounceListChanged();
     }
 }
 
+void MasterAudioController::onBounceListChanged()
+{
+    _bounceAddresses = _bounceList.getDestinations().values();
+    _relay->setDestinations(_bounceList.getDestinations());
+    Q_EMIT bounceAddressesChanged(_bounceList.getDestinations());
+}
+
 void MasterAudioController::onMqttConnected()
 {
     LOG_I(LogTag, "Connected to MQTT broker");
     _mqtt->subscribe("audio_bounce", 0);
     _mqtt->subscribe("system_down", 2);
+    _mqtt->subscribe("component_presence", 2);
 }
 
 void MasterAudioController::onMqttDisconnected()
@@ -112,23 +127,23 @@ void MasterAudioController::timerEvent(QTimerEvent *e)
 {
     if (e->timerId() == _announceTimerId)
     {
-        _audioSocket->writeDatagram("audio", 6, _settings->getMqttBrokerAddress(), SORO_NET_AUDIO_PORT);
+        _relay->sendTo(0, "audio", 6, _settings->getMqttBrokerAddress(), SORO_NET_AUDIO_PORT);
+
+        // Report traffic from the relay thread
+        quint64 bytesIn = _relay->getTotalBytesIn();
+        Q_EMIT bytesDown(bytesIn - _lastBytesIn);
+        _lastBytesIn = bytesIn;
     }
 }
 
-void MasterAudioController::onSocketReadyRead(QUdpSocket *socket, quint16 bouncePort)
+MediaRelay::ChannelStats MasterAudioController::getStats() const
 {
-    quint32 totalLen = 0;
-    while (socket->hasPendingDatagrams())
-    {
-        qint64 len = socket->readDatagram(_buffer, 65536);
-        for (QHostAddress bounceAddress : _bounceAddresses)
-        {
-            socket->writeDatagram(_buffer, len, bounceAddress, bouncePort);
-        }
-        totalLen += len;
-    }
-    Q_EMIT bytesDown(totalLen);
+    return _relay->getStats(0);
+}
+
+QList<MediaRelay::SubscriberStats> MasterAudioController::getSubscriberStats() const
+{
+    return _relay->getSubscriberStats(0);
 }
 
 } // namespace Soro
@@ -2,13 +2,14 @@
 #define MASTERAUDIOCONTROLLER_H
 
 #include <QObject>
-#include <QUdpSocket>
 #include <QTimerEvent>
 
 #include "qmqtt/qmqtt.h"
 
 #include "soro_core/camerasettingsmodel.h"
 #include "settingsmodel.h"
+#include "mediarelay.h"
+#include "bouncelist.h"
 
 namespace Soro {
 
@@ -18,6 +19,9 @@ class MasterAudioController : public QObject
 public:
     explicit MasterAudioController(const SettingsModel *settings, QObject *parent = 0);
 
+    MediaRelay::ChannelStats getStats() const;
+    QList<MediaRelay::SubscriberStats> getSubscriberStats() const;
+
 Q_SIGNALS:
     void bytesDown(quint32 bytes);
     void bounceAddressesChanged(const QHash<QString, QHostAddress>& addresses);
@@ -31,14 +35,15 @@ private Q_SLOTS:
     void onMqttDisconnected();
 
 private:
-    void onSocketReadyRead(QUdpSocket *socket, quint16 bouncePort);
+    void onComponentsDown(const QStringList& clientIDs);
+    void onBounceListChanged();
 
-    char _buffer[65536];
     int _announceTimerId;
     QMQTT::Client *_mqtt;
     const SettingsModel *_settings;
-    QUdpSocket *_audioSocket;
-    QHash<QString, QHostAddress> _bounceMap;
+    MediaRelay *_relay;
+    quint64 _lastBytesIn;
+    BounceList _bounceList;
     QList<QHostAddress> _bounceAddresses;
 };
 
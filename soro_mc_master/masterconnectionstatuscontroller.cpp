@@ -66,6 +66,11 @@ MasterConnectionStatusController::MasterConnectionStatusController
         if (msg.topic() == "ping")
         {
             PingMessage pingMsg(msg.payload());
+            if (!pingMsg.isValid())
+            {
+                LOG_W(LogTag, "Received invalid ping message, discarding");
+                return;
+            }
 
             // Remove all ping records older than this one
             while ((_pingIdQueue.first() != pingMsg.pingId) && !_pingIdQueue.isEmpty())
@@ -18,6 +18,8 @@
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
 #include "soro_core/addmediabouncemessage.h"
+#include "soro_core/videostatsmessage.h"
+#include "soro_core/mqtthub.h"
 
 #include "maincontroller.h"
 
@@ -31,38 +33,31 @@ MasterVideoClient::MasterVideoClient(const SettingsModel *settings, const Camera
     _settings = settings;
     _nextMqttMsgId = 1;
 
-    for (int i = 0; i < cameraSettings->getCameraCount(); i++)
+    _lastBytesIn = 0;
+    _renditionCount = SORO_MAX_VIDEO_RENDITIONS;
+    if (cameraSettings->getCameraCount() > SORO_NET_VIDEO_RENDITION_STRIDE)
     {
-        QUdpSocket *socket = new QUdpSocket(this);
+        LOG_W(LogTag, "Too many cameras to forward more than one rendition of each");
+        _renditionCount = 1;
+    }
 
-        if (!socket->bind())
-        {
-            MainController::panic(LogTag, "Cannot bind UDP socket");
-        }
-        if (!socket->open(QIODevice::ReadWrite))
-        {
-            MainController::panic(LogTag, "Cannot open UDP socket");
-        }
-        connect(socket, &QUdpSocket::readyRead, this, [this, socket, i]()
+    // One channel for each rendition of each camera, main streams first so their channel is the camera index
+    _relay = new MediaRelay(this);
+    for (int rendition = 0; rendition < _renditionCount; rendition++)
+    {
+        for (int camera = 0; camera < cameraSettings->getCameraCount(); camera++)
         {
-            quint32 totalLen = 0;
-            while (socket->hasPendingDatagrams())
+            int channel = _relay->addChannel(SORO_NET_MC_FIRST_VIDEO_PORT + camera + rendition * SORO_NET_VIDEO_RENDITION_STRIDE);
+            if (channel < 0)
             {
-                qint64 len = socket->readDatagram(_buffer, 65536);
-                if (len > 0)
-                {
-                    for (QHostAddress bounceAddress : _bounceAddresses)
-                    {
-                        socket->writeDatagram(_buffer, len, bounceAddress, SORO_NET_MC_FIRST_VIDEO_PORT + i);
-                    }
-                    totalLen += len;
-                }
+                MainController::panic(LogTag, "Cannot open UDP video socket");
             }
-            Q_EMIT bytesDown(totalLen);
-        });
-        _videoSockets.append(socket);
-        LOG_I(LogTag, "Bound UDP video socket");
+            _relay->setDropPolicy(channel, MediaRelay::DropToKeyframe);
+        }
     }
+    LOG_I(LogTag, "Bound " + QString::number(_relay->getChannelCount()) + " UDP video sockets");
+    _relay->start();
+    _lastRtpStats.resize(cameraSettings->getCameraCount());
 
     LOG_I(LogTag, "Creating MQTT client...");
     _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
@@ -95,59 +90,89 @@ void MasterVideoClient::onMqttMessage(const QMQTT::Message &msg)
         }
         else
         {
-            if (!_bounceMap.contains(bounceMsg.clientID))
+            if (_bounceList.add(bounceMsg.clientID, bounceMsg.address))
             {
                 LOG_I(LogTag, "Adding client " + bounceMsg.clientID + " at " + bounceMsg.address.toString() + " to video bounce list");
-                _bounceMap.insert(bounceMsg.clientID, bounceMsg.address);
-                _bounceAddresses = _bounceMap.values();
-                Q_EMIT bounceAddressesChanged(_bounceMap);
+                onBounceListChanged();
             }
         }
     }
     else if (msg.topic() == "system_down")
     {
-        QString clientID(msg.payload());
+        onComponentsDown(QStringList(QString(msg.payload())));
+    }
+    else if (msg.topic() == "component_presence")
+    {
+        // A process sharing one connection between its components has gone down, its will lists all of them
+        onComponentsDown(MqttHub::parsePresence(msg.payload()));
+    }
+    else if (msg.topic().startsWith("video_state_"))
+    {
+        VideoMessage videoMsg(msg.payload());
+        if (!videoMsg.isValid())
+        {
+            LOG_W(LogTag, "Received invalid video state message, discarding");
+            return;
+        }
+        _videoStateMessages[videoMsg.getStreamIndex()] = videoMsg;
+
+        // Lets the relay find keyframes in H264 and H265 streams
+        int channel = getChannel(videoMsg.camera_index, videoMsg.rendition);
+        if (channel >= 0)
+        {
+            _relay->setCodec(channel, videoMsg.profile.codec);
+        }
+    }
+}
+
+void MasterVideoClient::onComponentsDown(const QStringList& clientIDs)
+{
+    QHash<QString, QHostAddress> removed = _bounceList.remove(clientIDs);
+    if (!removed.isEmpty())
+    {
+        //
+        // Video clients have exited, remove them from our forwarding list
+        //
+        for (auto it = removed.constBegin(); it != removed.constEnd(); ++it)
+        {
+            LOG_I(LogTag, "Removing client " + it.key() + " at " + it.value().toString() + " from video bounce list");
+        }
+        onBounceListChanged();
+    }
 
-        if (_bounceMap.contains(clientID))
+    for (const QString& clientID : clientIDs)
+    {
+        if (!clientID.startsWith("video_server_")) continue;
+
+        bool ok;
+        int serverIndex = clientID.mid(clientID.lastIndexOf("_") + 1).toInt(&ok);
+        if (ok && serverIndex >= 0)
         {
             //
-            // A video client has exited, remove it from our forwarding list
+            // One of the video servers has gone down
             //
-            LOG_I(LogTag, "Removing client " + clientID + " at " + _bounceMap.value(clientID).toString() + " from video bounce list");
-            _bounceMap.remove(clientID);
-            _bounceAddresses = _bounceMap.values();
-            Q_EMIT bounceAddressesChanged(_bounceMap);
-        }
-        else if (clientID.startsWith("video_server_"))
-        {
-            bool ok;
-            int serverIndex = clientID.mid(clientID.lastIndexOf("_") + 1).toInt(&ok);
-            if (ok && serverIndex >= 0)
+            LOG_W(LogTag, "Video server " + QString::number(serverIndex) + " has disconnected");
+            for (int streamIndex : _videoStateMessages.keys())
             {
-                //
-                // One of the video servers has gone down
-                //
-                LOG_W(LogTag, "Video server " + QString::number(serverIndex) + " has disconnected");
-                for (int cameraIndex : _videoStateMessages.keys())
+                if (_videoStateMessages[streamIndex].camera_computerIndex == serverIndex)
                 {
-                    if (_videoStateMessages[cameraIndex].camera_computerIndex == serverIndex)
-                    {
-                        _videoStateMessages[cameraIndex].profile.codec = GStreamerUtil::CODEC_NULL;
-                        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++,
-                                                      "video_state_" + QString::number(cameraIndex),
-                                                      _videoStateMessages[cameraIndex],
-                                                      2,
-                                                      true)); // <-- Retain message
-                    }
+                    _videoStateMessages[streamIndex].profile.codec = GStreamerUtil::CODEC_NULL;
+                    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++,
+                                                  "video_state_" + QString::number(streamIndex),
+                                                  _videoStateMessages[streamIndex],
+                                                  2,
+                                                  true)); // <-- Retain message
                 }
             }
         }
     }
-    else if (msg.topic().startsWith("video_state_"))
-    {
-        VideoMessage videoMsg(msg.payload());
-        _videoStateMessages[videoMsg.camera_index] = videoMsg;
-    }
+}
+
+void MasterVideoClient::onBounceListChanged()
+{
+    _bounceAddresses = _bounceList.getDestinations().values();
+    _relay->setDestinations(_bounceList.getDestinations());
+    Q_EMIT bounceAddressesChanged(_bounceList.getDestinations());
 }
 
 void MasterVideoClient::onMqttConnected()
@@ -155,9 +180,13 @@ void MasterVideoClient::onMqttConnected()
     LOG_I(LogTag, "Connected to MQTT broker");
     _mqtt->subscribe("video_bounce", 0);
     _mqtt->subscribe("system_down", 2);
-    for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
+    _mqtt->subscribe("component_presence", 2);
+    for (int rendition = 0; rendition < _renditionCount; ++rendition)
     {
-        _mqtt->subscribe("video_state_" + QString::number(i), 2);
+        for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
+        {
+            _mqtt->subscribe("video_state_" + QString::number(i + rendition * SORO_NET_VIDEO_RENDITION_STRIDE), 2);
+        }
     }
 }
 
@@ -170,12 +199,72 @@ void MasterVideoClient::timerEvent(QTimerEvent *e)
 {
     if (e->timerId() == _announceTimerId)
     {
-        for (int i = 0; i < _videoSockets.size(); ++i)
+        int cameraCount = _cameraSettings->getCameraCount();
+        for (int i = 0; i < _relay->getChannelCount(); ++i)
+        {
+            _relay->sendTo(i, "video", 6, _settings->getMqttBrokerAddress(),
+                           SORO_NET_FIRST_VIDEO_PORT + (i % cameraCount) + (i / cameraCount) * SORO_NET_VIDEO_RENDITION_STRIDE);
+        }
+
+        // Report traffic from the relay thread
+        quint64 bytesIn = _relay->getTotalBytesIn();
+        Q_EMIT bytesDown(bytesIn - _lastBytesIn);
+        _lastBytesIn = bytesIn;
+
+        publishVideoStats();
+    }
+}
+
+int MasterVideoClient::getChannel(int cameraIndex, int rendition) const
+{
+    if ((cameraIndex >= _cameraSettings->getCameraCount()) || (rendition >= _renditionCount)) return -1;
+    return cameraIndex + rendition * _cameraSettings->getCameraCount();
+}
+
+void MasterVideoClient::publishVideoStats()
+{
+    // Stats are only published for main streams, whose channel is the camera index
+    for (int i = 0; i < _cameraSettings->getCameraCount(); ++i)
+    {
+        RtpUtil::StreamMonitor::Stats stats = _relay->getRtpStats(i);
+        RtpUtil::StreamMonitor::Stats &last = _lastRtpStats[i];
+        if (stats.packetsReceived == last.packetsReceived)
         {
-            _videoSockets[i]->writeDatagram("video", 6, _settings->getMqttBrokerAddress(), SORO_NET_FIRST_VIDEO_PORT + i);
+            // Nothing received from this camera since the last update
+            continue;
         }
+
+        VideoStatsMessage msg;
+        msg.camera_index = i;
+        msg.ssrc = stats.ssrc;
+        msg.packets_received = stats.packetsReceived;
+        msg.packets_lost = stats.packetsLost;
+        msg.packets_reordered = stats.packetsReordered;
+        msg.keyframes = stats.keyframes;
+        msg.jitter_us = stats.jitterMs * 1000;
+
+        // Counters restart with a new SSRC, in which case there is no interval to compare
+        if ((stats.ssrc == last.ssrc) && (stats.packetsReceived > last.packetsReceived) && (stats.packetsLost >= last.packetsLost))
+        {
+            quint64 received = stats.packetsReceived - last.packetsReceived;
+            quint64 lost = stats.packetsLost - last.packetsLost;
+            msg.loss_rate = lost * 10000 / (received + lost);
+        }
+        last = stats;
+
+        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "video_stats", msg, 0));
     }
 }
 
+MediaRelay::ChannelStats MasterVideoClient::getCameraStats(int cameraIndex) const
+{
+    return _relay->getStats(cameraIndex);
+}
+
+QList<MediaRelay::SubscriberStats> MasterVideoClient::getSubscriberStats(int cameraIndex) const
+{
+    return _relay->getSubscriberStats(cameraIndex);
+}
+
 
 } // namespace Soro
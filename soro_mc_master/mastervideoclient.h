@@ -2,17 +2,15 @@
 #define MASTERVIDEOCLIENT_H
 
 #include <QObject>
-#include <QUdpSocket>
 #include <QTimerEvent>
 
-#include <Qt5GStreamer/QGst/Pipeline>
-#include <Qt5GStreamer/QGst/Bin>
-
 #include "qmqtt/qmqtt.h"
 
 #include "soro_core/camerasettingsmodel.h"
 #include "soro_core/videomessage.h"
 #include "settingsmodel.h"
+#include "mediarelay.h"
+#include "bouncelist.h"
 
 namespace Soro {
 
@@ -22,6 +20,9 @@ class MasterVideoClient : public QObject
 public:
     explicit MasterVideoClient(const SettingsModel *settings, const CameraSettingsModel *cameraSettings, QObject *parent = 0);
 
+    MediaRelay::ChannelStats getCameraStats(int cameraIndex) const;
+    QList<MediaRelay::SubscriberStats> getSubscriberStats(int cameraIndex) const;
+
 Q_SIGNALS:
     void bytesDown(quint32 bytes);
     void bounceAddressesChanged(const QHash<QString, QHostAddress>& addresses);
@@ -35,18 +36,23 @@ private Q_SLOTS:
     void onMqttDisconnected();
 
 private:
-    char _buffer[65536];
+    void onComponentsDown(const QStringList& clientIDs);
+    void onBounceListChanged();
+    void publishVideoStats();
+    int getChannel(int cameraIndex, int rendition) const;
+
     int _announceTimerId;
     quint16 _nextMqttMsgId;
     QMQTT::Client *_mqtt;
     const SettingsModel *_settings;
     const CameraSettingsModel *_cameraSettings;
-    QVector<QUdpSocket*> _videoSockets;
-    QVector<QGst::PipelinePtr> _recordPipelines;
-    QVector<QGst::BinPtr> _recordBins;
-    QUdpSocket *_audioSocket;
-    QHash<QString, QHostAddress> _bounceMap;
+    MediaRelay *_relay;
+    int _renditionCount;
+    quint64 _lastBytesIn;
+    QVector<RtpUtil::StreamMonitor::Stats> _lastRtpStats;
+    BounceList _bounceList;
     QList<QHostAddress> _bounceAddresses;
+    // Keyed by stream index
     QHash<uint, VideoMessage> _videoStateMessages;
 };
 
@@ -0,0 +1,737 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mediarelay.h"
+#include "soro_core/logger.h"
+#include "soro_core/gstreamerutil.h"
+
+#include <QMutexLocker>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LogTag "MediaRelay"
+
+namespace Soro {
+
+// Receive buffer requested for each channel socket, to ride out scheduling hiccups
+static const int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+
+static const int MAX_EPOLL_EVENTS = 64;
+
+// Ancillary data space for the kernel's receive timestamp of each packet
+static const int RECV_CONTROL_SIZE = CMSG_SPACE(sizeof(timespec));
+
+static const int DEFAULT_CLOCK_RATE = 90000;
+
+MediaRelay::MediaRelay(QObject *parent) : QThread(parent)
+{
+    _stopping = false;
+    _loadedDestinationsVersion = -1;
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    // The wakeup eventfd is the only thing registered without a pointer
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event);
+
+    _recvBuffer.resize(BATCH_SIZE * MAX_DATAGRAM_SIZE);
+    _recvIovecs.resize(BATCH_SIZE);
+    _recvMsgs.resize(BATCH_SIZE);
+    _recvControl.resize(BATCH_SIZE * RECV_CONTROL_SIZE);
+    memset(_recvMsgs.data(), 0, BATCH_SIZE * sizeof(mmsghdr));
+    for (int i = 0; i < BATCH_SIZE; ++i)
+    {
+        _recvIovecs[i].iov_base = _recvBuffer.data() + i * MAX_DATAGRAM_SIZE;
+        _recvIovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+        _recvMsgs[i].msg_hdr.msg_iov = &_recvIovecs[i];
+        _recvMsgs[i].msg_hdr.msg_iovlen = 1;
+        _recvMsgs[i].msg_hdr.msg_control = _recvControl.data() + i * RECV_CONTROL_SIZE;
+    }
+    _batch.reserve(BATCH_SIZE);
+    _batchKeyframes.resize(BATCH_SIZE);
+    _sendIovecs.resize(BATCH_SIZE);
+    _sendMsgs.resize(BATCH_SIZE);
+}
+
+MediaRelay::~MediaRelay()
+{
+    stop();
+    wait();
+
+    for (Channel *channel : _channels)
+    {
+        for (Output *output : channel->outputs)
+        {
+            destroyOutput(output);
+        }
+        close(channel->fd);
+        delete channel;
+    }
+    close(_wakeFd);
+    close(_epollFd);
+}
+
+int MediaRelay::addChannel(quint16 destinationPort, int queueCapacity)
+{
+    if (isRunning())
+    {
+        LOG_E(LogTag, "Cannot add a channel while the relay is running");
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        LOG_E(LogTag, QString("Cannot create UDP socket: %1").arg(strerror(errno)));
+        return -1;
+    }
+
+    sockaddr_in bindAddress;
+    memset(&bindAddress, 0, sizeof(bindAddress));
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+    bindAddress.sin_port = 0;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) < 0)
+    {
+        LOG_E(LogTag, QString("Cannot bind UDP socket: %1").arg(strerror(errno)));
+        close(fd);
+        return -1;
+    }
+
+    int bufferSize = SOCKET_BUFFER_SIZE;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize)) < 0)
+    {
+        LOG_W(LogTag, QString("Cannot enlarge UDP receive buffer: %1").arg(strerror(errno)));
+    }
+
+    // Have the kernel timestamp each packet, batching would otherwise skew the jitter measurement
+    int enable = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+    {
+        LOG_W(LogTag, QString("Cannot enable UDP receive timestamps: %1").arg(strerror(errno)));
+    }
+
+    Channel *channel = new Channel;
+    channel->fd = fd;
+    channel->isOutput = false;
+    channel->destinationPort = destinationPort;
+    channel->queueCapacity = qMax(queueCapacity, 1);
+    channel->dropPolicy.store(DropOldest);
+    channel->codec.store(GStreamerUtil::CODEC_NULL);
+    channel->clockRate.store(DEFAULT_CLOCK_RATE);
+    channel->keyframeFormat = NoKeyframes;
+    channel->keyframeAware = false;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = static_cast<Pollable*>(channel);
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+
+    _channels.append(channel);
+    return _channels.size() - 1;
+}
+
+int MediaRelay::getChannelCount() const
+{
+    return _channels.size();
+}
+
+void MediaRelay::setDropPolicy(int channel, DropPolicy policy)
+{
+    _channels[channel]->dropPolicy.store(policy);
+}
+
+void MediaRelay::setCodec(int channel, quint8 codec)
+{
+    _channels[channel]->codec.store(codec);
+}
+
+void MediaRelay::setClockRate(int channel, int clockRate)
+{
+    _channels[channel]->clockRate.store(clockRate);
+}
+
+void MediaRelay::setDestinations(const QHash<QString, QHostAddress>& destinations)
+{
+    QMutexLocker locker(&_destinationsMutex);
+    _destinations.clear();
+    for (auto it = destinations.constBegin(); it != destinations.constEnd(); ++it)
+    {
+        bool ok;
+        quint32 ipv4 = it.value().toIPv4Address(&ok);
+        if (!ok)
+        {
+            LOG_W(LogTag, "Ignoring non-IPv4 destination " + it.value().toString() + " for " + it.key());
+            continue;
+        }
+        _destinations.insert(it.key(), ipv4);
+    }
+    _destinationsVersion.fetchAndAddRelease(1);
+
+    // Wake the relay thread so it picks up the change
+    quint64 one = 1;
+    if (write(_wakeFd, &one, sizeof(one)) < 0)
+    {
+        LOG_W(LogTag, "Cannot wake relay thread");
+    }
+}
+
+bool MediaRelay::sendTo(int channel, const char *data, int length, const QHostAddress& address, quint16 port)
+{
+    bool ok;
+    quint32 ipv4 = address.toIPv4Address(&ok);
+    if (!ok || (channel < 0) || (channel >= _channels.size())) return false;
+
+    sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(ipv4);
+    dest.sin_port = htons(port);
+    return sendto(_channels[channel]->fd, data, length, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) == length;
+}
+
+MediaRelay::ChannelStats MediaRelay::getStats(int channel) const
+{
+    ChannelStats stats;
+    const Channel *c = _channels[channel];
+    stats.packetsIn = c->packetsIn.load();
+    stats.bytesIn = c->bytesIn.load();
+    stats.packetsOut = c->packetsOut.load();
+    stats.bytesOut = c->bytesOut.load();
+    stats.packetsDropped = c->packetsDropped.load();
+    return stats;
+}
+
+QList<MediaRelay::SubscriberStats> MediaRelay::getSubscriberStats(int channel) const
+{
+    QList<SubscriberStats> list;
+    QMutexLocker locker(&_outputsMutex);
+    for (const Output *output : _channels[channel]->outputs)
+    {
+        SubscriberStats stats;
+        stats.clientId = output->clientId;
+        stats.address = QHostAddress(output->address);
+        stats.packetsOut = output->packetsOut.load();
+        stats.bytesOut = output->bytesOut.load();
+        stats.packetsDropped = output->packetsDropped.load();
+        stats.sendErrors = output->sendErrors.load();
+        stats.queueDepth = output->queueDepth.load();
+        list.append(stats);
+    }
+    return list;
+}
+
+RtpUtil::StreamMonitor::Stats MediaRelay::getRtpStats(int channel) const
+{
+    const Channel *c = _channels[channel];
+    QMutexLocker locker(&c->monitorMutex);
+    return c->monitor.getStats();
+}
+
+quint64 MediaRelay::getTotalBytesIn() const
+{
+    quint64 total = 0;
+    for (const Channel *channel : _channels)
+    {
+        total += channel->bytesIn.load();
+    }
+    return total;
+}
+
+void MediaRelay::stop()
+{
+    _stopping = true;
+    quint64 one = 1;
+    if (write(_wakeFd, &one, sizeof(one)) < 0)
+    {
+        LOG_W(LogTag, "Cannot wake relay thread");
+    }
+}
+
+void MediaRelay::run()
+{
+    LOG_I(LogTag, "Relay thread started with " + QString::number(_channels.size()) + " channels");
+    epoll_event events[MAX_EPOLL_EVENTS];
+
+    while (!_stopping)
+    {
+        // Outputs are only created and destroyed here, so no event below refers to a deleted one
+        if (_destinationsVersion.loadAcquire() != _loadedDestinationsVersion)
+        {
+            reloadDestinations();
+        }
+
+        int count = epoll_wait(_epollFd, events, MAX_EPOLL_EVENTS, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR) continue;
+            LOG_E(LogTag, QString("epoll_wait() failed: %1").arg(strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            Pollable *pollable = static_cast<Pollable*>(events[i].data.ptr);
+            if (!pollable)
+            {
+                quint64 value;
+                while (read(_wakeFd, &value, sizeof(value)) > 0) { }
+            }
+            else if (pollable->isOutput)
+            {
+                onOutputEvent(static_cast<Output*>(pollable), events[i].events);
+            }
+            else
+            {
+                receive(static_cast<Channel*>(pollable));
+            }
+        }
+    }
+    LOG_I(LogTag, "Relay thread stopped");
+}
+
+void MediaRelay::reloadDestinations()
+{
+    QHash<QString, quint32> destinations;
+    {
+        QMutexLocker locker(&_destinationsMutex);
+        _loadedDestinationsVersion = _destinationsVersion.load();
+        destinations = _destinations;
+    }
+
+    QMutexLocker locker(&_outputsMutex);
+    for (Channel *channel : _channels)
+    {
+        for (int i = channel->outputs.size() - 1; i >= 0; --i)
+        {
+            Output *output = channel->outputs[i];
+            auto it = destinations.constFind(output->clientId);
+            if ((it == destinations.constEnd()) || (it.value() != output->address))
+            {
+                destroyOutput(output);
+                channel->outputs.remove(i);
+            }
+        }
+        for (auto it = destinations.constBegin(); it != destinations.constEnd(); ++it)
+        {
+            bool exists = false;
+            for (const Output *output : channel->outputs)
+            {
+                if (output->clientId == it.key())
+                {
+                    exists = true;
+                    break;
+                }
+            }
+            if (!exists)
+            {
+                Output *output = createOutput(channel, it.key(), it.value());
+                if (output) channel->outputs.append(output);
+            }
+        }
+    }
+}
+
+MediaRelay::Output* MediaRelay::createOutput(Channel *channel, const QString& clientId, quint32 address)
+{
+    // Each destination gets its own connected socket, so a full send buffer or an ICMP error
+    // from one destination is only ever reported against that destination
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        LOG_E(LogTag, QString("Cannot create UDP socket for %1: %2").arg(clientId, strerror(errno)));
+        return nullptr;
+    }
+
+    sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(address);
+    dest.sin_port = htons(channel->destinationPort);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&dest), sizeof(dest)) < 0)
+    {
+        LOG_E(LogTag, QString("Cannot connect UDP socket for %1: %2").arg(clientId, strerror(errno)));
+        close(fd);
+        return nullptr;
+    }
+
+    Output *output = new Output;
+    output->fd = fd;
+    output->isOutput = true;
+    output->clientId = clientId;
+    output->address = address;
+    output->channel = channel;
+    output->queue.resize(channel->queueCapacity);
+    output->queueHead = 0;
+    output->queueCount = 0;
+    // Start a new destination at a keyframe so its decoder has something to work from
+    output->awaitingKeyframe = channel->keyframeAware;
+    output->watchingWritable = false;
+
+    // Registered without any events until it has a backlog, errors are always reported
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = 0;
+    event.data.ptr = static_cast<Pollable*>(output);
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event);
+
+    return output;
+}
+
+void MediaRelay::destroyOutput(Output *output)
+{
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, output->fd, nullptr);
+    close(output->fd);
+    delete output;
+}
+
+void MediaRelay::receive(Channel *channel)
+{
+    forever
+    {
+        for (int i = 0; i < BATCH_SIZE; ++i)
+        {
+            _recvMsgs[i].msg_hdr.msg_flags = 0;
+            _recvMsgs[i].msg_hdr.msg_controllen = RECV_CONTROL_SIZE;
+        }
+        int received = recvmmsg(channel->fd, _recvMsgs.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+        if (received <= 0) return;
+
+        const int codec = channel->codec.load();
+        channel->keyframeFormat = codec == GStreamerUtil::VIDEO_CODEC_H264 ? H264Keyframes :
+                                  codec == GStreamerUtil::VIDEO_CODEC_H265 ? H265Keyframes : NoKeyframes;
+        channel->keyframeAware = (channel->keyframeFormat != NoKeyframes) && (channel->dropPolicy.load() == DropToKeyframe);
+
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        const qint64 batchTime = static_cast<qint64>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+        QMutexLocker monitorLocker(&channel->monitorMutex);
+        channel->monitor.setClockRate(channel->clockRate.load());
+
+        _batch.clear();
+        for (int i = 0; i < received; ++i)
+        {
+            mmsghdr &packet = _recvMsgs[i];
+            channel->packetsIn.fetchAndAddRelaxed(1);
+            channel->bytesIn.fetchAndAddRelaxed(packet.msg_len);
+
+            if (packet.msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                channel->packetsDropped.fetchAndAddRelaxed(1);
+                continue;
+            }
+
+            // Cut the receive iovec down to this packet so it can be sent as is
+            _recvIovecs[i].iov_len = packet.msg_len;
+            _batchKeyframes[i] = false;
+            _batch.append(i);
+
+            const char *data = static_cast<const char*>(_recvIovecs[i].iov_base);
+            RtpUtil::RtpHeader header;
+            if (!RtpUtil::parseHeader(data, packet.msg_len, header)) continue;
+
+            qint64 arrival = batchTime;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&packet.msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&packet.msg_hdr, cmsg))
+            {
+                if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+                {
+                    timespec stamp;
+                    memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+                    arrival = static_cast<qint64>(stamp.tv_sec) * 1000000000 + stamp.tv_nsec;
+                }
+            }
+            channel->monitor.update(header, arrival);
+
+            // ULPFEC packets share the stream's sequence numbers, but their payload is not video
+            if (header.payloadType == GStreamerUtil::VIDEO_FEC_PAYLOAD_TYPE) continue;
+
+            const char *payload = data + header.payloadOffset;
+            const int payloadLength = packet.msg_len - header.payloadOffset;
+            switch (channel->keyframeFormat)
+            {
+            case H264Keyframes:
+                _batchKeyframes[i] = RtpUtil::isH264KeyframeStart(payload, payloadLength);
+                break;
+            case H265Keyframes:
+                _batchKeyframes[i] = RtpUtil::isH265KeyframeStart(payload, payloadLength);
+                break;
+            default:
+                break;
+            }
+            if (_batchKeyframes[i]) channel->monitor.countKeyframe();
+        }
+        monitorLocker.unlock();
+
+        for (Output *output : channel->outputs)
+        {
+            int sent = 0;
+            if ((output->queueCount == 0) && !output->awaitingKeyframe)
+            {
+                // Nothing is waiting for this destination, send straight from the receive buffers
+                for (int j = 0; j < _batch.size(); ++j)
+                {
+                    memset(&_sendMsgs[j], 0, sizeof(mmsghdr));
+                    _sendMsgs[j].msg_hdr.msg_iov = &_recvIovecs[_batch[j]];
+                    _sendMsgs[j].msg_hdr.msg_iovlen = 1;
+                }
+                bool frameLost;
+                sent = send(output, _sendMsgs.data(), _batch.size(), frameLost);
+            }
+            for (int j = sent; j < _batch.size(); ++j)
+            {
+                const iovec &packet = _recvIovecs[_batch[j]];
+                enqueue(output, static_cast<const char*>(packet.iov_base), packet.iov_len, _batchKeyframes[_batch[j]]);
+            }
+            if (!output->watchingWritable)
+            {
+                flush(output);
+            }
+        }
+
+        // Restore the full receive buffer sizes for the next batch
+        for (int i = 0; i < received; ++i)
+        {
+            _recvIovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+        }
+
+        if (received < BATCH_SIZE) return;
+    }
+}
+
+void MediaRelay::onOutputEvent(Output *output, quint32 events)
+{
+    if (events & EPOLLERR)
+    {
+        // Reading the pending error clears it
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(output->fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        output->sendErrors.fetchAndAddRelaxed(1);
+    }
+    if (events & EPOLLOUT)
+    {
+        flush(output);
+    }
+}
+
+int MediaRelay::send(Output *output, mmsghdr *msgs, int count, bool &frameLost)
+{
+    Channel *channel = output->channel;
+    int consumed = 0;
+    frameLost = false;
+    while (consumed < count)
+    {
+        int result = sendmmsg(output->fd, msgs + consumed, count - consumed, MSG_DONTWAIT);
+        if (result > 0)
+        {
+            quint64 bytes = 0;
+            for (int i = consumed; i < consumed + result; ++i)
+            {
+                bytes += msgs[i].msg_len;
+            }
+            output->packetsOut.fetchAndAddRelaxed(result);
+            output->bytesOut.fetchAndAddRelaxed(bytes);
+            channel->packetsOut.fetchAndAddRelaxed(result);
+            channel->bytesOut.fetchAndAddRelaxed(bytes);
+            consumed += result;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS))
+        {
+            // The socket buffer is full, the rest has to wait
+            break;
+        }
+        else
+        {
+            // Usually ECONNREFUSED, reporting an ICMP error for an earlier packet. Drop this
+            // packet rather than retrying it forever, and resume at a keyframe if possible.
+            output->sendErrors.fetchAndAddRelaxed(1);
+            countDropped(output, 1);
+            consumed++;
+            if (channel->keyframeAware)
+            {
+                // The rest of this frame is no use, leave it to the caller to skip
+                output->awaitingKeyframe = true;
+                frameLost = true;
+                break;
+            }
+        }
+    }
+    return consumed;
+}
+
+void MediaRelay::enqueue(Output *output, const char *data, int length, bool keyframe)
+{
+    if (output->awaitingKeyframe)
+    {
+        if (!keyframe)
+        {
+            countDropped(output, 1);
+            return;
+        }
+        output->awaitingKeyframe = false;
+    }
+
+    const int capacity = output->queue.size();
+    if (output->queueCount == capacity)
+    {
+        if (output->channel->keyframeAware)
+        {
+            // Skip ahead to the newest queued keyframe
+            int skip = 0;
+            for (int i = output->queueCount - 1; i > 0; --i)
+            {
+                if (output->queue[(output->queueHead + i) % capacity].keyframe)
+                {
+                    skip = i;
+                    break;
+                }
+            }
+            if (skip > 0)
+            {
+                dropQueued(output, skip);
+            }
+            else if (output->queue[output->queueHead].keyframe && !keyframe)
+            {
+                // The queue starts at the only keyframe it holds, so it can still be decoded. Keep it
+                // and skip what arrives until the next keyframe instead.
+                output->awaitingKeyframe = true;
+                countDropped(output, 1);
+                return;
+            }
+            else
+            {
+                // The whole queue is one partial frame, discard it and resume at the next keyframe
+                dropQueued(output, output->queueCount);
+                if (!keyframe)
+                {
+                    output->awaitingKeyframe = true;
+                    countDropped(output, 1);
+                    return;
+                }
+            }
+        }
+        else
+        {
+            dropQueued(output, 1);
+        }
+    }
+
+    // Slots keep their allocation, so this only allocates while the queue first fills up
+    Packet &packet = output->queue[(output->queueHead + output->queueCount) % capacity];
+    packet.data.resize(length);
+    memcpy(packet.data.data(), data, length);
+    packet.keyframe = keyframe;
+    output->queueCount++;
+    output->queueDepth.store(output->queueCount);
+}
+
+void MediaRelay::dropQueued(Output *output, int count)
+{
+    output->queueHead = (output->queueHead + count) % output->queue.size();
+    output->queueCount -= count;
+    output->queueDepth.store(output->queueCount);
+    countDropped(output, count);
+}
+
+void MediaRelay::dropToFirstKeyframe(Output *output)
+{
+    const int capacity = output->queue.size();
+    for (int i = 0; i < output->queueCount; ++i)
+    {
+        if (output->queue[(output->queueHead + i) % capacity].keyframe)
+        {
+            dropQueued(output, i);
+            output->awaitingKeyframe = false;
+            return;
+        }
+    }
+    // No keyframe queued, wait for one to arrive
+    dropQueued(output, output->queueCount);
+}
+
+void MediaRelay::countDropped(Output *output, int count)
+{
+    output->packetsDropped.fetchAndAddRelaxed(count);
+    output->channel->packetsDropped.fetchAndAddRelaxed(count);
+}
+
+void MediaRelay::flush(Output *output)
+{
+    const int capacity = output->queue.size();
+    while (output->queueCount > 0)
+    {
+        const int count = qMin(output->queueCount, static_cast<int>(BATCH_SIZE));
+        for (int i = 0; i < count; ++i)
+        {
+            Packet &packet = output->queue[(output->queueHead + i) % capacity];
+            _sendIovecs[i].iov_base = packet.data.data();
+            _sendIovecs[i].iov_len = packet.data.size();
+            memset(&_sendMsgs[i], 0, sizeof(mmsghdr));
+            _sendMsgs[i].msg_hdr.msg_iov = &_sendIovecs[i];
+            _sendMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        bool frameLost;
+        int consumed = send(output, _sendMsgs.data(), count, frameLost);
+        output->queueHead = (output->queueHead + consumed) % capacity;
+        output->queueCount -= consumed;
+        output->queueDepth.store(output->queueCount);
+
+        if (frameLost)
+        {
+            // A packet was lost on the way out, the rest of this frame is no use
+            dropToFirstKeyframe(output);
+            continue;
+        }
+
+        if (consumed < count)
+        {
+            // Resume once the socket has room again
+            watchWritable(output, true);
+            return;
+        }
+    }
+    watchWritable(output, false);
+}
+
+void MediaRelay::watchWritable(Output *output, bool watch)
+{
+    if (output->watchingWritable == watch) return;
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = watch ? static_cast<quint32>(EPOLLOUT) : 0;
+    event.data.ptr = static_cast<Pollable*>(output);
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, output->fd, &event);
+    output->watchingWritable = watch;
+}
+
+} // namespace Soro
@@ -0,0 +1,202 @@
+#ifndef MEDIARELAY_H
+#define MEDIARELAY_H
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QAtomicInteger>
+
+#include "rtputil.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace Soro {
+
+/* Forwards UDP media streams from the rover to every mission control computer.
+ *
+ * Each channel is a UDP socket on an ephemeral port. Everything received on it is sent to each
+ * destination address on the channel's destination port. The relay runs on its own thread and
+ * moves packets in batches with recvmmsg() and sendmmsg(), so the Qt event loop is not involved
+ * per packet.
+ *
+ * Every destination gets its own socket and a bounded packet queue for each channel. Packets a
+ * destination cannot take right away wait in its queue, and when the queue is full packets are
+ * dropped according to the channel's drop policy. A slow or unreachable destination therefore
+ * only loses its own packets, it never delays the others.
+ *
+ * Packets are also parsed as RTP to measure each channel's loss and jitter. For H264 and H265
+ * channels the relay finds where keyframes begin, so a destination that joins late or has just
+ * lost packets can be started at the next keyframe instead of in the middle of a frame.
+ */
+class MediaRelay : public QThread
+{
+    Q_OBJECT
+public:
+    enum DropPolicy
+    {
+        // Drop the oldest queued packet to make room
+        DropOldest,
+        // Skip ahead to the newest queued keyframe, or wait for the next one, so the destination's
+        // decoder never receives a partial frame. Behaves like DropOldest unless the channel's
+        // codec is one the relay can find keyframes in.
+        DropToKeyframe
+    };
+
+    struct ChannelStats
+    {
+        quint64 packetsIn;
+        quint64 bytesIn;
+        quint64 packetsOut;
+        quint64 bytesOut;
+        quint64 packetsDropped;
+    };
+
+    struct SubscriberStats
+    {
+        QString clientId;
+        QHostAddress address;
+        quint64 packetsOut;
+        quint64 bytesOut;
+        quint64 packetsDropped;
+        quint64 sendErrors;
+        int queueDepth;
+    };
+
+    static const int DEFAULT_QUEUE_CAPACITY = 256;
+
+    explicit MediaRelay(QObject *parent = 0);
+    ~MediaRelay();
+
+    /* Opens a new channel forwarding to destinationPort, returning its index or -1 on failure.
+     * Each destination may have up to queueCapacity packets waiting on this channel.
+     * Channels must be added before the relay is started.
+     */
+    int addChannel(quint16 destinationPort, int queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    int getChannelCount() const;
+
+    // These may be called from any thread
+    void setDropPolicy(int channel, DropPolicy policy);
+    // Sets the codec a channel carries, one of GStreamerUtil's VIDEO_CODEC_* constants
+    void setCodec(int channel, quint8 codec);
+    void setClockRate(int channel, int clockRate);
+    void setDestinations(const QHash<QString, QHostAddress>& destinations);
+    bool sendTo(int channel, const char *data, int length, const QHostAddress& address, quint16 port);
+    ChannelStats getStats(int channel) const;
+    QList<SubscriberStats> getSubscriberStats(int channel) const;
+    RtpUtil::StreamMonitor::Stats getRtpStats(int channel) const;
+    quint64 getTotalBytesIn() const;
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    static const int BATCH_SIZE = 32;
+    static const int MAX_DATAGRAM_SIZE = 65536;
+
+    struct Channel;
+
+    // Anything registered with epoll
+    struct Pollable
+    {
+        int fd;
+        bool isOutput;
+    };
+
+    struct Packet
+    {
+        QByteArray data;
+        bool keyframe;
+    };
+
+    // A destination's socket and queue for one channel
+    struct Output : Pollable
+    {
+        QString clientId;
+        quint32 address;
+        Channel *channel;
+        QVector<Packet> queue;
+        int queueHead;
+        int queueCount;
+        bool awaitingKeyframe;
+        bool watchingWritable;
+        QAtomicInteger<quint64> packetsOut;
+        QAtomicInteger<quint64> bytesOut;
+        QAtomicInteger<quint64> packetsDropped;
+        QAtomicInteger<quint64> sendErrors;
+        QAtomicInt queueDepth;
+    };
+
+    enum KeyframeFormat
+    {
+        NoKeyframes,
+        H264Keyframes,
+        H265Keyframes
+    };
+
+    struct Channel : Pollable
+    {
+        quint16 destinationPort;
+        int queueCapacity;
+        QAtomicInt dropPolicy;
+        QAtomicInt codec;
+        QAtomicInt clockRate;
+        // Refreshed from the above by the relay thread for each batch
+        KeyframeFormat keyframeFormat;
+        bool keyframeAware;
+        QVector<Output*> outputs;
+        mutable QMutex monitorMutex;
+        RtpUtil::StreamMonitor monitor;
+        QAtomicInteger<quint64> packetsIn;
+        QAtomicInteger<quint64> bytesIn;
+        QAtomicInteger<quint64> packetsOut;
+        QAtomicInteger<quint64> bytesOut;
+        QAtomicInteger<quint64> packetsDropped;
+    };
+
+    void receive(Channel *channel);
+    void onOutputEvent(Output *output, quint32 events);
+    // Sets frameLost if a keyframe aware output lost a packet and skipped the rest of the batch
+    int send(Output *output, mmsghdr *msgs, int count, bool &frameLost);
+    void enqueue(Output *output, const char *data, int length, bool keyframe);
+    void dropQueued(Output *output, int count);
+    void dropToFirstKeyframe(Output *output);
+    void countDropped(Output *output, int count);
+    void flush(Output *output);
+    void watchWritable(Output *output, bool watch);
+    void reloadDestinations();
+    Output* createOutput(Channel *channel, const QString& clientId, quint32 address);
+    void destroyOutput(Output *output);
+
+    QVector<Channel*> _channels;
+    int _epollFd;
+    int _wakeFd;
+    volatile bool _stopping;
+
+    QMutex _destinationsMutex;
+    QHash<QString, quint32> _destinations;
+    QAtomicInt _destinationsVersion;
+    int _loadedDestinationsVersion;
+
+    // Held by the relay thread while it adds or removes outputs
+    mutable QMutex _outputsMutex;
+
+    // Only touched by the relay thread
+    QVector<char> _recvBuffer;
+    QVector<iovec> _recvIovecs;
+    QVector<mmsghdr> _recvMsgs;
+    QVector<char> _recvControl;
+    QVector<int> _batch;
+    QVector<bool> _batchKeyframes;
+    QVector<iovec> _sendIovecs;
+    QVector<mmsghdr> _sendMsgs;
+};
+
+} // namespace Soro
+
+#endif // MEDIARELAY_H
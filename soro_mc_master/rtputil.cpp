@@ -0,0 +1,245 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rtputil.h"
+
+namespace Soro {
+namespace RtpUtil {
+
+static const int RTP_HEADER_SIZE = 12;
+
+static const int H264_NAL_IDR = 5;
+static const int H264_NAL_SPS = 7;
+static const int H264_NAL_STAP_A = 24;
+static const int H264_NAL_FU_A = 28;
+
+static const int H265_NAL_IRAP_FIRST = 16;
+static const int H265_NAL_IRAP_LAST = 21;
+static const int H265_NAL_VPS = 32;
+static const int H265_NAL_SPS = 33;
+static const int H265_NAL_AP = 48;
+static const int H265_NAL_FU = 49;
+
+// Reordering tolerated before a sequence number jump is treated as a restarted stream
+static const int MAX_MISORDER = 100;
+static const int MAX_DROPOUT = 3000;
+
+bool parseHeader(const char *packet, int length, RtpHeader& header)
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(packet);
+    if ((length < RTP_HEADER_SIZE) || ((data[0] >> 6) != 2)) return false;
+
+    int offset = RTP_HEADER_SIZE + (data[0] & 0x0F) * 4;
+    if (data[0] & 0x10)
+    {
+        // Header extension, its length is given in 32-bit words
+        if (length < offset + 4) return false;
+        offset += 4 + ((data[offset + 2] << 8) | data[offset + 3]) * 4;
+    }
+    if (offset >= length) return false;
+
+    header.marker = data[1] & 0x80;
+    header.payloadType = data[1] & 0x7F;
+    header.sequence = (data[2] << 8) | data[3];
+    header.timestamp = (quint32(data[4]) << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+    header.ssrc = (quint32(data[8]) << 24) | (data[9] << 16) | (data[10] << 8) | data[11];
+    header.payloadOffset = offset;
+    return true;
+}
+
+static inline bool isH264KeyframeNal(int type)
+{
+    return (type == H264_NAL_IDR) || (type == H264_NAL_SPS);
+}
+
+bool isH264KeyframeStart(const char *payload, int length)
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(payload);
+    if (length < 1) return false;
+    const int type = data[0] & 0x1F;
+
+    if (type == H264_NAL_STAP_A)
+    {
+        // Aggregation packet, a list of 16-bit sizes each followed by a NAL unit
+        int i = 1;
+        while (i + 2 < length)
+        {
+            const int size = (data[i] << 8) | data[i + 1];
+            if (isH264KeyframeNal(data[i + 2] & 0x1F)) return true;
+            i += 2 + size;
+        }
+        return false;
+    }
+    if (type == H264_NAL_FU_A)
+    {
+        // Fragmentation unit, only the fragment with the start bit begins the NAL unit
+        return (length > 1) && (data[1] & 0x80) && isH264KeyframeNal(data[1] & 0x1F);
+    }
+    return isH264KeyframeNal(type);
+}
+
+static inline bool isH265KeyframeNal(int type)
+{
+    return ((type >= H265_NAL_IRAP_FIRST) && (type <= H265_NAL_IRAP_LAST)) ||
+            (type == H265_NAL_VPS) || (type == H265_NAL_SPS);
+}
+
+bool isH265KeyframeStart(const char *payload, int length)
+{
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(payload);
+    if (length < 2) return false;
+    const int type = (data[0] >> 1) & 0x3F;
+
+    if (type == H265_NAL_AP)
+    {
+        // Aggregation packet, a list of 16-bit sizes each followed by a NAL unit. rtph265pay
+        // does not send decoding order numbers, so there are no DONL fields to skip.
+        int i = 2;
+        while (i + 2 < length)
+        {
+            const int size = (data[i] << 8) | data[i + 1];
+            if (isH265KeyframeNal((data[i + 2] >> 1) & 0x3F)) return true;
+            i += 2 + size;
+        }
+        return false;
+    }
+    if (type == H265_NAL_FU)
+    {
+        return (length > 2) && (data[2] & 0x80) && isH265KeyframeNal(data[2] & 0x3F);
+    }
+    return isH265KeyframeNal(type);
+}
+
+StreamMonitor::StreamMonitor(int clockRate)
+{
+    _clockRate = clockRate;
+    reset();
+}
+
+void StreamMonitor::setClockRate(int clockRate)
+{
+    if (clockRate != _clockRate)
+    {
+        _clockRate = clockRate;
+        reset();
+    }
+}
+
+void StreamMonitor::reset()
+{
+    _initialized = false;
+    _ssrc = 0;
+    _baseSequence = _maxSequence = 0;
+    _cycles = 0;
+    _received = 0;
+    _lostBeforeRestart = 0;
+    _receivedBeforeRestart = 0;
+    _reordered = 0;
+    _keyframes = 0;
+    _lastArrival = 0;
+    _lastTimestamp = 0;
+    _jitter = 0;
+}
+
+void StreamMonitor::restart(const RtpHeader& header)
+{
+    // Keep the totals of the previous run of sequence numbers
+    if (_initialized)
+    {
+        const qint64 expected = _cycles + _maxSequence - _baseSequence + 1;
+        _lostBeforeRestart += qMax<qint64>(expected - _received, 0);
+        _receivedBeforeRestart += _received;
+    }
+    _initialized = true;
+    _ssrc = header.ssrc;
+    _baseSequence = _maxSequence = header.sequence;
+    _cycles = 0;
+    _received = 0;
+}
+
+void StreamMonitor::update(const RtpHeader& header, qint64 arrivalNs)
+{
+    if (!_initialized || (header.ssrc != _ssrc))
+    {
+        // New stream, the sender was probably restarted
+        restart(header);
+        _jitter = 0;
+    }
+    else
+    {
+        const quint16 delta = header.sequence - _maxSequence;
+        if (delta == 0)
+        {
+            // Duplicate
+            _reordered++;
+        }
+        else if (delta < MAX_DROPOUT)
+        {
+            // In order, possibly with a gap
+            if (header.sequence < _maxSequence) _cycles += 65536;
+            _maxSequence = header.sequence;
+        }
+        else if (delta > 65536 - MAX_MISORDER)
+        {
+            // Arrived late, it was already counted as lost
+            _reordered++;
+        }
+        else
+        {
+            // A jump too large to be loss, the sequence was restarted
+            restart(header);
+        }
+    }
+    _received++;
+
+    // Interarrival jitter, in timestamp units. The timestamp difference is taken modulo 2^32 so
+    // the jitter does not spike when the timestamp wraps.
+    const double arrival = static_cast<double>(arrivalNs) * _clockRate / 1000000000.0;
+    if (_received > 1)
+    {
+        const qint32 sent = static_cast<qint32>(header.timestamp - _lastTimestamp);
+        double d = (arrival - _lastArrival) - sent;
+        if (d < 0) d = -d;
+        _jitter += (d - _jitter) / 16.0;
+    }
+    _lastArrival = arrival;
+    _lastTimestamp = header.timestamp;
+}
+
+void StreamMonitor::countKeyframe()
+{
+    _keyframes++;
+}
+
+StreamMonitor::Stats StreamMonitor::getStats() const
+{
+    Stats stats;
+    stats.ssrc = _ssrc;
+    stats.packetsReceived = _receivedBeforeRestart + _received;
+    stats.packetsLost = _lostBeforeRestart;
+    if (_initialized)
+    {
+        const qint64 expected = _cycles + _maxSequence - _baseSequence + 1;
+        stats.packetsLost += qMax<qint64>(expected - _received, 0);
+    }
+    stats.packetsReordered = _reordered;
+    stats.keyframes = _keyframes;
+    stats.jitterMs = _clockRate > 0 ? _jitter * 1000.0 / _clockRate : 0;
+    return stats;
+}
+
+} // namespace RtpUtil
+} // namespace Soro
@@ -0,0 +1,82 @@
+#ifndef RTPUTIL_H
+#define RTPUTIL_H
+
+#include <QtGlobal>
+
+namespace Soro {
+namespace RtpUtil {
+
+struct RtpHeader
+{
+    bool marker;
+    quint8 payloadType;
+    quint16 sequence;
+    quint32 timestamp;
+    quint32 ssrc;
+    int payloadOffset;
+};
+
+/* Parses the fixed RTP header (RFC 3550), returning false if the packet is not RTP
+ * or has no payload
+ */
+bool parseHeader(const char *packet, int length, RtpHeader& header);
+
+/* Returns true if an RTP payload carrying H264 (RFC 6184, as produced by rtph264pay) starts a
+ * keyframe, meaning it holds an SPS or the first fragment of an IDR slice.
+ */
+bool isH264KeyframeStart(const char *payload, int length);
+
+/* Returns true if an RTP payload carrying H265 (RFC 7798, as produced by rtph265pay) starts a
+ * keyframe, meaning it holds a VPS or SPS or the first fragment of an IRAP picture.
+ */
+bool isH265KeyframeStart(const char *payload, int length);
+
+/* Tracks the sequence numbers and timing of an RTP stream to measure loss and jitter
+ * as described in RFC 3550 appendix A
+ */
+class StreamMonitor
+{
+public:
+    struct Stats
+    {
+        quint32 ssrc;
+        quint64 packetsReceived;
+        quint64 packetsLost;
+        quint64 packetsReordered;
+        quint64 keyframes;
+        double jitterMs;
+    };
+
+    explicit StreamMonitor(int clockRate = 90000);
+
+    void setClockRate(int clockRate);
+    void reset();
+
+    // arrivalNs is the time the packet was received in nanoseconds, on any clock
+    void update(const RtpHeader& header, qint64 arrivalNs);
+    void countKeyframe();
+    Stats getStats() const;
+
+private:
+    void restart(const RtpHeader& header);
+
+    int _clockRate;
+    bool _initialized;
+    quint32 _ssrc;
+    quint16 _baseSequence;
+    quint16 _maxSequence;
+    quint64 _cycles;
+    quint64 _received;
+    quint64 _lostBeforeRestart;
+    quint64 _receivedBeforeRestart;
+    quint64 _reordered;
+    quint64 _keyframes;
+    double _lastArrival;
+    quint32 _lastTimestamp;
+    double _jitter;
+};
+
+} // namespace RtpUtil
+} // namespace Soro
+
+#endif // RTPUTIL_H
@@ -25,6 +25,9 @@
 #define KEY_PING_INTERVAL "SORO_PING_INTERVAL"
 #define KEY_MQTT_BROKER_IP "SORO_MQTT_BROKER_IP"
 #define KEY_DATA_RATE_CALC_INTERVAL "SORO_DATARATE_CALC_INTERVAL"
+#define KEY_ENABLE_BITRATE_CONTROL "SORO_ENABLE_BITRATE_CONTROL"
+#define KEY_VIDEO_LINK_BUDGET "SORO_VIDEO_LINK_BUDGET"
+#define KEY_MIN_VIDEO_BITRATE "SORO_MIN_VIDEO_BITRATE"
 
 namespace Soro {
 
@@ -34,6 +37,9 @@ QHash<QString, int> SettingsModel::getKeys() const
     keys.insert(KEY_PING_INTERVAL, QMetaType::UInt);
     keys.insert(KEY_DATA_RATE_CALC_INTERVAL, QMetaType::UInt);
     keys.insert(KEY_MQTT_BROKER_IP, QMetaType::QString);
+    keys.insert(KEY_ENABLE_BITRATE_CONTROL, QMetaType::Bool);
+    keys.insert(KEY_VIDEO_LINK_BUDGET, QMetaType::UInt);
+    keys.insert(KEY_MIN_VIDEO_BITRATE, QMetaType::UInt);
     return keys;
 }
 
@@ -43,6 +49,9 @@ QHash<QString, QVariant> SettingsModel::getDefaultValues() const
     defaults.insert(KEY_PING_INTERVAL, QVariant(500));
     defaults.insert(KEY_DATA_RATE_CALC_INTERVAL, QVariant(1000));
     defaults.insert(KEY_MQTT_BROKER_IP, "127.0.0.1");
+    defaults.insert(KEY_ENABLE_BITRATE_CONTROL, QVariant(true));
+    defaults.insert(KEY_VIDEO_LINK_BUDGET, QVariant(12000000));
+    defaults.insert(KEY_MIN_VIDEO_BITRATE, QVariant(250000));
     return defaults;
 }
 
@@ -61,4 +70,19 @@ QHostAddress SettingsModel::getMqttBrokerAddress() const
     return QHostAddress(_values.value(KEY_MQTT_BROKER_IP).toString());
 }
 
+bool SettingsModel::getEnableBitrateControl() const
+{
+    return _values.value(KEY_ENABLE_BITRATE_CONTROL).toBool();
+}
+
+uint SettingsModel::getVideoLinkBudget() const
+{
+    return _values.value(KEY_VIDEO_LINK_BUDGET).toUInt();
+}
+
+uint SettingsModel::getMinVideoBitrate() const
+{
+    return _values.value(KEY_MIN_VIDEO_BITRATE).toUInt();
+}
+
 } // namespace Soro
@@ -17,6 +17,11 @@ public:
     uint getPingInterval() const;
     uint getDataRateCalcInterval() const;
     QHostAddress getMqttBrokerAddress() const;
+    bool getEnableBitrateControl() const;
+    // Bits per second available for video from the rover, shared by all cameras
+    uint getVideoLinkBudget() const;
+    // Bits per second no camera will be turned down below
+    uint getMinVideoBitrate() const;
 
 protected:
     QHash<QString, int> getKeys() const override;
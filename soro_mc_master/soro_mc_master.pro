@@ -18,7 +18,12 @@ SOURCES += main.cpp \
     masterconnectionstatuscontroller.cpp \
     settingsmodel.cpp \
     masteraudiocontroller.cpp \
-    mastervideoclient.cpp
+    mastervideoclient.cpp \
+    mediarelay.cpp \
+    rtputil.cpp \
+    bitratecontroller.cpp \
+    bitrateallocation.cpp \
+    bouncelist.cpp
 
 HEADERS += \
     mainwindowcontroller.h \
@@ -26,7 +31,12 @@ HEADERS += \
     masterconnectionstatuscontroller.h \
     settingsmodel.h \
     masteraudiocontroller.h \
-    mastervideoclient.h
+    mastervideoclient.h \
+    mediarelay.h \
+    rtputil.h \
+    bitratecontroller.h \
+    bitrateallocation.h \
+    bouncelist.h
 
 RESOURCES += \
     qml.qrc \
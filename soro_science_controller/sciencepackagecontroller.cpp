@@ -64,6 +64,7 @@ SciencePackageController::SciencePackageController(const SettingsModel *settings
         _mqtt->subscribe("spectrometer_switch", 2);
         _mqtt->subscribe("geiger_switch", 2);
         _mqtt->subscribe("probe_switch", 2);
+        _mqtt->subscribe("drill_switch", 2);
     });
 
     connect(_mqtt, &QMQTT::Client::disconnected, this, [this]()
@@ -73,103 +74,29 @@ SciencePackageController::SciencePackageController(const SettingsModel *settings
 
     _watchdogTimer.setInterval(1000); // Science package connection timeout
 
-    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message& message)
+    _mqttDispatcher.addRoute<CompassMessage>("compass", [this](const CompassMessage& msg)
     {
-        if (message.topic() == "compass")
-        {
-            CompassMessage msg(message.payload());
-            _lastCompassHeading = msg.heading;
-        }
-        else if (message.topic() == "science_arm")
-        {
-            // Retransmit this message over UDP to the science package microcontroller
-            if (message.payload().at(0) != SORO_HEADER_SCIENCE_MASTER_ARM_MSG)
-            {
-                LOG_W(LogTag, "Received invalid MQTT master science arm message, discarding");
-                return;
-            }
-            _packageUdpSocket.writeDatagram(message.payload(), QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
-        }
-        else if (message.topic() == "atmosphere_switch")
-        {
-            SwitchMessage msg(message.payload());
-            _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
-            if (msg.on)
-            {
-                LOG_I(LogTag, "Setting atmosphere sensors ON");
-                _buffer[1] = SORO_HEADER_SCIENCE_ATMOSPHERE_ON;
-            }
-            else
-            {
-                LOG_I(LogTag, "Setting atmosphere sensors OFF");
-                _buffer[1] = SORO_HEADER_SCIENCE_ATMOSPHERE_OFF;
-            }
-            _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
-        }
-        else if (message.topic() == "geiger_switch")
-        {
-            SwitchMessage msg(message.payload());
-            _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
-            if (msg.on)
-            {
-                LOG_I(LogTag, "Setting geiger counter ON");
-                _buffer[1] = SORO_HEADER_SCIENCE_GEIGER_ON;
-            }
-            else
-            {
-                LOG_I(LogTag, "Setting geiger counter OFF");
-                _buffer[1] = SORO_HEADER_SCIENCE_GEIGER_OFF;
-            }
-            _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
-        }
-        else if (message.topic() == "spectrometer_switch")
-        {
-            SwitchMessage msg(message.payload());
-            _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
-            if (msg.on)
-            {
-                LOG_I(LogTag, "Setting spectrometer ON");
-                _buffer[1] = SORO_HEADER_SCIENCE_SPEC_ON;
-            }
-            else
-            {
-                LOG_I(LogTag, "Setting spectrometer OFF");
-                _buffer[1] = SORO_HEADER_SCIENCE_SPEC_OFF;
-            }
-            _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
-        }
-        else if (message.topic() == "probe_switch")
-        {
-            SwitchMessage msg(message.payload());
-            _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
-            if (msg.on)
-            {
-                LOG_I(LogTag, "Setting ground probe ON");
-                _buffer[1] = SORO_HEADER_SCIENCE_PROBE_ON;
-            }
-            else
-            {
-                LOG_I(LogTag, "Setting ground probe OFF");
-                _buffer[1] = SORO_HEADER_SCIENCE_PROBE_OFF;
-            }
-            _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
-        }
-        else if (message.topic() == "drill_switch")
+        _lastCompassHeading = msg.heading;
+    });
+    _mqttDispatcher.addRoute("science_arm", [this](const QMQTT::Message& message)
+    {
+        // Retransmit this message over UDP to the science package microcontroller
+        if (message.payload().at(0) != SORO_HEADER_SCIENCE_MASTER_ARM_MSG)
         {
-            SwitchMessage msg(message.payload());
-            _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
-            if (msg.on)
-            {
-                LOG_I(LogTag, "Setting core drill ON");
-                _buffer[1] = SORO_HEADER_SCIENCE_DRILL_ON;
-            }
-            else
-            {
-                LOG_I(LogTag, "Setting core drill OFF");
-                _buffer[1] = SORO_HEADER_SCIENCE_DRILL_OFF;
-            }
-            _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
+            LOG_W(LogTag, "Received invalid MQTT master science arm message, discarding");
+            return;
         }
+        _packageUdpSocket.writeDatagram(message.payload(), QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
+    });
+    addSwitchRoute("atmosphere_switch", "atmosphere sensors", SORO_HEADER_SCIENCE_ATMOSPHERE_ON, SORO_HEADER_SCIENCE_ATMOSPHERE_OFF);
+    addSwitchRoute("geiger_switch", "geiger counter", SORO_HEADER_SCIENCE_GEIGER_ON, SORO_HEADER_SCIENCE_GEIGER_OFF);
+    addSwitchRoute("spectrometer_switch", "spectrometer", SORO_HEADER_SCIENCE_SPEC_ON, SORO_HEADER_SCIENCE_SPEC_OFF);
+    addSwitchRoute("probe_switch", "ground probe", SORO_HEADER_SCIENCE_PROBE_ON, SORO_HEADER_SCIENCE_PROBE_OFF);
+    addSwitchRoute("drill_switch", "core drill", SORO_HEADER_SCIENCE_DRILL_ON, SORO_HEADER_SCIENCE_DRILL_OFF);
+
+    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message& message)
+    {
+        _mqttDispatcher.dispatch(message);
     });
 
     connect(&_packageUdpSocket, &QUdpSocket::readyRead, this,[this]()
@@ -241,17 +168,11 @@ SciencePackageController::SciencePackageController(const SettingsModel *settings
                     }
                     else if (_buffer[1] == SORO_HEADER_SCIENCE_SPEC)
                     {
-                        if (len >= 2 + SpectrometerMessage::SPECTRUM_POINTS * 4)
+                        if (len >= 2 + Spectrum::ENCODED_SIZE * 2)
                         {
                             SpectrometerMessage msg;
-                            for (int i = 0; i < SpectrometerMessage::SPECTRUM_POINTS * 2; i += 2)
-                            {
-                                msg.spectrumWhite.append(deserialize<quint16>(_buffer + 2 + i));
-                            }
-                            for (int i = 0; i < SpectrometerMessage::SPECTRUM_POINTS * 2; i += 2)
-                            {
-                                msg.spectrum404.append(deserialize<quint16>(_buffer + 2 + (SpectrometerMessage::SPECTRUM_POINTS * 2) + i));
-                            }
+                            msg.spectrumWhite.decode(_buffer + 2);
+                            msg.spectrum404.decode(_buffer + 2 + Spectrum::ENCODED_SIZE);
                             _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "spectrometer", msg, 0));
                         }
                         else
@@ -283,4 +204,28 @@ SciencePackageController::SciencePackageController(const SettingsModel *settings
     });
 }
 
+void SciencePackageController::addSwitchRoute(const QString& topic, const QString& name, char onHeader, char offHeader)
+{
+    _mqttDispatcher.addRoute<SwitchMessage>(topic, [this, name, onHeader, offHeader](const SwitchMessage& msg)
+    {
+        if (!msg.isValid())
+        {
+            LOG_W(LogTag, "Received invalid " + name + " switch message, discarding");
+            return;
+        }
+        _buffer[0] = SORO_HEADER_SCIENCE_CONTROLLER_MSG;
+        if (msg.on)
+        {
+            LOG_I(LogTag, "Setting " + name + " ON");
+            _buffer[1] = onHeader;
+        }
+        else
+        {
+            LOG_I(LogTag, "Setting " + name + " OFF");
+            _buffer[1] = offHeader;
+        }
+        _packageUdpSocket.writeDatagram(_buffer, 3, QHostAddress::Broadcast, SORO_NET_SCIENCE_SYSTEM_PORT);
+    });
+}
+
 } // namespace Soro
@@ -21,11 +21,14 @@ Q_SIGNALS:
     void sciencePackageConnectedChanged(bool connected);
 
 private:
+    void addSwitchRoute(const QString& topic, const QString& name, char onHeader, char offHeader);
+
     bool _packageConnected;
     QTimer _watchdogTimer;
     quint16 _nextMqttMsgId;
     QUdpSocket _packageUdpSocket;
     QMQTT::Client *_mqtt;
+    QMQTT::TopicDispatcher _mqttDispatcher;
     float _lastCompassHeading = 0;
     char _buffer[USHRT_MAX];
 };
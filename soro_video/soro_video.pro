@@ -0,0 +1,32 @@
+QT       += network
+
+TARGET = soro_video
+TEMPLATE = lib
+
+# NO_KEYWORDS: signal, slot, emit, etc. will not compile. Use Q_SIGNALS, Q_SLOTS, Q_EMIT instead
+CONFIG += no_keywords c++11
+
+DEFINES += SORO_VIDEO_LIBRARY
+
+BUILD_DIR = ../build/soro_video
+DESTDIR = ../lib
+
+INCLUDEPATH += $$PWD/..
+
+# Video code that runs GStreamer itself, kept out of soro_core so only the video programs link GStreamer
+SOURCES += \
+    videopipeline.cpp
+
+HEADERS +=\
+    soro_video_global.h \
+    videopipeline.h
+
+# Link against soro_core
+LIBS += -L../lib -lsoro_core
+
+#Link Qt5GStreamer
+LIBS += -lQt5GStreamer-1.0 -lQt5GLib-2.0
+
+# GStreamer's own headers, for the parameter flags and specs Qt5GStreamer does not wrap
+CONFIG += link_pkgconfig
+PKGCONFIG += gstreamer-1.0
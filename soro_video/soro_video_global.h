@@ -0,0 +1,12 @@
+#ifndef SORO_VIDEO_GLOBAL_H
+#define SORO_VIDEO_GLOBAL_H
+
+#include <QtCore/qglobal.h>
+
+#if defined(SORO_VIDEO_LIBRARY)
+#  define SORO_VIDEO_EXPORT Q_DECL_EXPORT
+#else
+#  define SORO_VIDEO_EXPORT Q_DECL_IMPORT
+#endif
+
+#endif // SORO_VIDEO_GLOBAL_H
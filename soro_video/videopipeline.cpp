@@ -0,0 +1,649 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "videopipeline.h"
+#include "soro_core/gstreamerutil.h"
+
+#include <QHostAddress>
+#include <QMutexLocker>
+#include <QDateTime>
+
+#include <Qt5GStreamer/QGlib/Connect>
+#include <Qt5GStreamer/QGlib/Signal>
+#include <Qt5GStreamer/QGst/Bus>
+#include <Qt5GStreamer/QGst/Bin>
+#include <Qt5GStreamer/QGst/Caps>
+#include <Qt5GStreamer/QGst/Element>
+#include <Qt5GStreamer/QGst/Structure>
+
+#include <gst/gst.h>
+
+#define LogTag "VideoPipeline"
+
+namespace Soro {
+
+/* Puts setting in value as the type of the property described by spec, clamped to the
+ * range the property allows. Returns false if the property is not one a number can be set on.
+ */
+static bool makePropertyValue(GParamSpec *spec, quint32 setting, QGlib::Value &value)
+{
+    value.init(QGlib::Type(G_PARAM_SPEC_VALUE_TYPE(spec)));
+    GValue *gvalue = value;
+    if (G_IS_PARAM_SPEC_UINT(spec))
+    {
+        GParamSpecUInt *range = G_PARAM_SPEC_UINT(spec);
+        g_value_set_uint(gvalue, qBound<guint>(range->minimum, setting, range->maximum));
+    }
+    else if (G_IS_PARAM_SPEC_INT(spec))
+    {
+        GParamSpecInt *range = G_PARAM_SPEC_INT(spec);
+        g_value_set_int(gvalue, static_cast<gint>(qBound<gint64>(range->minimum, setting, range->maximum)));
+    }
+    else if (G_IS_PARAM_SPEC_UINT64(spec))
+    {
+        GParamSpecUInt64 *range = G_PARAM_SPEC_UINT64(spec);
+        g_value_set_uint64(gvalue, qBound<guint64>(range->minimum, setting, range->maximum));
+    }
+    else if (G_IS_PARAM_SPEC_INT64(spec))
+    {
+        GParamSpecInt64 *range = G_PARAM_SPEC_INT64(spec);
+        g_value_set_int64(gvalue, qBound<gint64>(range->minimum, setting, range->maximum));
+    }
+    else if (G_IS_PARAM_SPEC_ENUM(spec))
+    {
+        // There is no range to clamp to, only values the enum defines will do
+        if (!g_enum_get_value(G_PARAM_SPEC_ENUM(spec)->enum_class, static_cast<gint>(setting))) return false;
+        g_value_set_enum(gvalue, static_cast<gint>(setting));
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+VideoPipeline::VideoPipeline(QObject *parent) : QObject(parent)
+{
+    _port = 0;
+    _bindPort = 0;
+    _vaapi = false;
+    _capturePath = GStreamerUtil::CAPTURE_PATH_RAW;
+    _skewTimerId = -1;
+}
+
+VideoPipeline::~VideoPipeline()
+{
+    stopPrivate(false);
+}
+
+bool VideoPipeline::isStreaming() const
+{
+    return !_pipeline.isNull() && !_address.isEmpty();
+}
+
+bool VideoPipeline::isWarm() const
+{
+    return !_pipeline.isNull() && _address.isEmpty();
+}
+
+void VideoPipeline::stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi, int capturePath)
+{
+    configure(device, "", address, port, bindPort, GStreamerUtil::VideoProfile(profile), vaapi, capturePath);
+}
+
+void VideoPipeline::streamStereo(const QString &leftDevice, const QString &rightDevice, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
+{
+    configure(leftDevice, rightDevice, address, port, bindPort, GStreamerUtil::VideoProfile(profile), vaapi, GStreamerUtil::CAPTURE_PATH_RAW);
+}
+
+void VideoPipeline::warm(const QString &device, int bindPort, const QString &profile, bool vaapi, int capturePath)
+{
+    configure(device, "", "", 0, bindPort, GStreamerUtil::VideoProfile(profile), vaapi, capturePath);
+}
+
+void VideoPipeline::standby()
+{
+    if (isStreaming())
+    {
+        Q_EMIT logInfo(LogTag, "Standing by");
+        retarget("", 0);
+        Q_EMIT stopped();
+    }
+}
+
+void VideoPipeline::configure(const QString &device, const QString &device2, const QString &address, int port, int bindPort,
+                              const GStreamerUtil::VideoProfile &profile, bool vaapi, quint8 capturePath)
+{
+    bool running = !_pipeline.isNull();
+    _reconfigurationTimer.start();
+    _pendingReconfiguration.clear();
+
+    if (running && (device == _device) && (device2 == _device2) && (bindPort == _bindPort)
+            && (vaapi == _vaapi) && (capturePath == _capturePath) && (profile.codec == _profile.codec))
+    {
+        // Same cameras, capture path and codec, try to change the profile and destination without stopping
+        if (reconfigure(profile))
+        {
+            retarget(address, port);
+            return;
+        }
+        Q_EMIT logInfo(LogTag, "Profile change cannot be applied to the running pipeline, rebuilding it");
+    }
+
+    _device = device;
+    _device2 = device2;
+    _address = address;
+    _port = port;
+    _bindPort = bindPort;
+    _vaapi = vaapi;
+    _capturePath = capturePath;
+    _profile = profile;
+
+    // A warm pipeline is built with a placeholder destination, which is cleared before it starts
+    QHostAddress host = address.isEmpty() ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(address);
+    if (device2.isEmpty())
+    {
+        Q_EMIT logInfo(LogTag, "Capturing on the " + GStreamerUtil::getCapturePathName(capturePath) + " path");
+        start(GStreamerUtil::createRtpV4L2EncodeString(device, bindPort, host, port, profile, vaapi, capturePath), !address.isEmpty());
+    }
+    else
+    {
+        start(GStreamerUtil::createRtpStereoV4L2EncodeString(device, device2, bindPort, host, port, profile, vaapi), !address.isEmpty());
+    }
+
+    if (running)
+    {
+        // Report once the new pipeline is playing
+        _pendingReconfiguration = "rebuild";
+    }
+}
+
+bool VideoPipeline::reconfigure(const GStreamerUtil::VideoProfile &profile)
+{
+    if (profile == _profile) return true;
+
+    bool capsChanged = (profile.width != _profile.width) || (profile.height != _profile.height)
+            || (profile.framerate != _profile.framerate);
+
+    // The stereo pipeline scales each camera to half the width before mixing, which is fixed when it is built
+    if (capsChanged && !_device2.isEmpty()) return false;
+
+    // The FEC encoder is only in the pipeline if it was built with FEC, but its overhead can be changed
+    if ((profile.fec_percentage == 0) != (_profile.fec_percentage == 0)) return false;
+    if (profile.fec_percentage != _profile.fec_percentage)
+    {
+        QGst::ElementPtr fecEncoder = _pipeline->getElementByName(GStreamerUtil::VIDEO_FEC_ENCODER_NAME);
+        if (!fecEncoder) return false;
+        fecEncoder->setProperty("percentage", static_cast<uint>(profile.fec_percentage));
+        Q_EMIT logInfo(LogTag, QString("Set FEC overhead to %1%").arg(QString::number(profile.fec_percentage)));
+    }
+
+    if ((_capturePath == GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH) && (_profile.codec == GStreamerUtil::VIDEO_CODEC_H264))
+    {
+        // There is no encoder to adjust, and the camera only changes its format when it is opened again
+        if (capsChanged) return false;
+        Q_EMIT logInfo(LogTag, "Camera encodes this stream itself, ignoring the new bitrate and quality");
+        _profile = profile;
+        return true;
+    }
+
+    QGst::ElementPtr encoder = _pipeline->getElementByName(GStreamerUtil::VIDEO_ENCODER_NAME);
+    QGst::ElementPtr capsFilter = _pipeline->getElementByName(GStreamerUtil::VIDEO_ENCODE_CAPS_NAME);
+    if (!encoder || !capsFilter) return false;
+
+    // Find the encoder properties that differ, and make sure all of them can be changed while playing
+    // before touching any
+    QList<GStreamerUtil::EncoderProperty> oldProperties = GStreamerUtil::getVideoEncodeProperties(_profile, _vaapi);
+    QList<QPair<QString, QGlib::Value>> changedProperties;
+    for (const GStreamerUtil::EncoderProperty& property : GStreamerUtil::getVideoEncodeProperties(profile, _vaapi))
+    {
+        if (oldProperties.contains(property)) continue;
+
+        QGlib::ParamSpecPtr spec = encoder->findProperty(property.first.toLatin1().constData());
+        if (!spec || !(static_cast<int>(spec->flags()) & GST_PARAM_MUTABLE_PLAYING)) return false;
+        QGlib::Value value;
+        if (!makePropertyValue(spec, property.second, value)) return false;
+        changedProperties.append(qMakePair(property.first, value));
+    }
+
+    for (const QPair<QString, QGlib::Value>& property : changedProperties)
+    {
+        encoder->setProperty(property.first.toLatin1().constData(), property.second);
+        Q_EMIT logInfo(LogTag, QString("Set encoder property %1 to %2").arg(property.first, property.second.get<QString>()));
+    }
+
+    _profile = profile;
+
+    if (capsChanged)
+    {
+        // Upstream scales to the new caps and the encoder restarts with them, report when they reach it
+        QString caps = GStreamerUtil::getVideoEncodeCapsString(profile,
+                GStreamerUtil::capturePathUsesSurfaces(_capturePath, profile, _vaapi));
+        Q_EMIT logInfo(LogTag, "Renegotiating caps to " + caps);
+        _pendingReconfiguration = "caps";
+        capsFilter->setProperty("caps", QGst::Caps::fromString(caps));
+    }
+    else
+    {
+        finishReconfiguration("encoder");
+    }
+    return true;
+}
+
+void VideoPipeline::retarget(const QString &address, int port)
+{
+    if ((address == _address) && (port == _port)) return;
+
+    QGst::ElementPtr sink = _pipeline->getElementByName(GStreamerUtil::VIDEO_SINK_NAME);
+    bool wasWarm = _address.isEmpty();
+    _address = address;
+    _port = port;
+
+    if (address.isEmpty())
+    {
+        // Keep encoding, but send nowhere
+        QGlib::emit<void>(sink, "clear");
+    }
+    else
+    {
+        Q_EMIT logInfo(LogTag, QString("Sending to %1:%2").arg(address, QString::number(port)));
+        sink->setProperty("host", address);
+        sink->setProperty("port", port);
+        if (wasWarm)
+        {
+            Q_EMIT streaming();
+        }
+    }
+}
+
+void VideoPipeline::finishReconfiguration(const QString &method)
+{
+    _pendingReconfiguration.clear();
+    int latency = _reconfigurationTimer.elapsed();
+    Q_EMIT logInfo(LogTag, QString("Reconfigured by %1 in %2 ms").arg(method, QString::number(latency)));
+    Q_EMIT reconfigured(method, latency);
+}
+
+void VideoPipeline::onEncoderSinkPadNotify(const QGlib::ParamSpecPtr &property)
+{
+    Q_UNUSED(property);
+    QMetaObject::invokeMethod(this, "onEncoderCapsChanged", Qt::QueuedConnection);
+}
+
+void VideoPipeline::onEncoderCapsChanged()
+{
+    if (_pendingReconfiguration == "caps")
+    {
+        finishReconfiguration(_pendingReconfiguration);
+    }
+}
+
+void VideoPipeline::onLeftEyeHandoff(const QGst::BufferPtr &buffer)
+{
+    recordEyeTimestamp(0, buffer);
+}
+
+void VideoPipeline::onRightEyeHandoff(const QGst::BufferPtr &buffer)
+{
+    recordEyeTimestamp(1, buffer);
+}
+
+void VideoPipeline::recordEyeTimestamp(int eye, const QGst::BufferPtr &buffer)
+{
+    QGst::ClockTime timestamp = buffer->presentationTimeStamp();
+    if (!timestamp.isValid()) return;
+
+    QMutexLocker locker(&_skewMutex);
+    _eyeTimestamps[eye] = static_cast<quint64>(timestamp);
+    qint64 other = _eyeTimestamps[1 - eye];
+    if (other < 0) return;
+
+    // The compositor pairs each frame with the nearest frame of the other eye, so the skew is how far
+    // apart their frame phases are, not how many frames one eye is ahead
+    qint64 offset = qAbs(_eyeTimestamps[eye] - other) % _frameIntervalNs;
+    qint64 skew = qMin(offset, _frameIntervalNs - offset);
+    _skewTotalNs += skew;
+    _skewMaxNs = qMax(_skewMaxNs, skew);
+    _skewCount++;
+}
+
+void VideoPipeline::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() == _skewTimerId)
+    {
+        QMutexLocker locker(&_skewMutex);
+        if (_skewCount == 0) return;
+
+        int averageUs = _skewTotalNs / _skewCount / 1000;
+        int maxUs = _skewMaxNs / 1000;
+        _skewTotalNs = 0;
+        _skewMaxNs = 0;
+        _skewCount = 0;
+        locker.unlock();
+
+        Q_EMIT stereoSkew(averageUs, maxUs);
+    }
+}
+
+void VideoPipeline::stop()
+{
+    _renditions.clear();
+    stopPrivate(true);
+}
+
+void VideoPipeline::addRendition(int rendition, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
+{
+    if (!_pipeline || !_bin->getElementByName(GStreamerUtil::CAPTURE_TEE_NAME))
+    {
+        Q_EMIT logInfo(LogTag, "Cannot add rendition " + QString::number(rendition) + ", this pipeline has no capture to split (stereo or H264 passthrough)");
+        return;
+    }
+
+    // A changed rendition is simply replaced, the capture keeps running either way
+    if (_renditions.contains(rendition))
+    {
+        unlinkRendition(rendition);
+    }
+
+    Rendition &entry = _renditions[rendition];
+    entry.address = address;
+    entry.port = port;
+    entry.bindPort = bindPort;
+    entry.profile = GStreamerUtil::VideoProfile(profile);
+    entry.vaapi = vaapi;
+
+    if (linkRendition(rendition))
+    {
+        entry.bin->syncStateWithParent();
+        Q_EMIT logInfo(LogTag, QString("Added rendition %1 sending to %2:%3").arg(QString::number(rendition), address, QString::number(port)));
+    }
+    else
+    {
+        _renditions.remove(rendition);
+    }
+}
+
+void VideoPipeline::removeRendition(int rendition)
+{
+    if (!_renditions.contains(rendition)) return;
+
+    unlinkRendition(rendition);
+    _renditions.remove(rendition);
+    Q_EMIT logInfo(LogTag, "Removed rendition " + QString::number(rendition));
+}
+
+void VideoPipeline::startRecording(const QString &locationPrefix, const QString &profile, bool vaapi, int segmentSeconds)
+{
+    stopRecording();
+
+    _recording.locationPrefix = locationPrefix;
+    _recording.profile = GStreamerUtil::VideoProfile(profile);
+    _recording.vaapi = vaapi;
+    _recording.segmentSeconds = segmentSeconds;
+
+    if (!_pipeline)
+    {
+        // Started along with the next pipeline
+        return;
+    }
+    if (linkRecording())
+    {
+        _recording.bin->syncStateWithParent();
+    }
+    else
+    {
+        Q_EMIT logInfo(LogTag, "This pipeline has no capture to record, recording will start with the next one that does");
+    }
+}
+
+void VideoPipeline::stopRecording()
+{
+    if (_recording.locationPrefix.isEmpty()) return;
+
+    // The file being written is left as it is, and is not reported as complete
+    unlinkBranch(_recording.bin, _recording.teePad);
+    _recording.locationPrefix.clear();
+    _segmentStarts.clear();
+    Q_EMIT logInfo(LogTag, "Stopped recording");
+}
+
+bool VideoPipeline::linkBranch(const QString &description, QGst::BinPtr &bin, QGst::PadPtr &teePad)
+{
+    QGst::ElementPtr tee = _bin->getElementByName(GStreamerUtil::CAPTURE_TEE_NAME);
+    if (!tee) return false;
+
+    // The branch goes in the same bin as the tee, pads can only be linked between siblings
+    bin = QGst::Bin::fromDescription(description);
+    _bin->add(bin);
+    teePad = tee->getRequestPad("src_%u");
+    if (teePad->link(bin->getStaticPad("sink")) != QGst::PadLinkOk)
+    {
+        unlinkBranch(bin, teePad);
+        return false;
+    }
+    return true;
+}
+
+void VideoPipeline::unlinkBranch(QGst::BinPtr &bin, QGst::PadPtr &teePad)
+{
+    if (teePad)
+    {
+        // The tee stops pushing into a released pad, after which the branch can be shut down
+        QGst::ElementPtr tee = _bin->getElementByName(GStreamerUtil::CAPTURE_TEE_NAME);
+        tee->releaseRequestPad(teePad);
+        teePad.clear();
+    }
+    if (bin)
+    {
+        bin->setState(QGst::StateNull);
+        _bin->remove(bin);
+        bin.clear();
+    }
+}
+
+bool VideoPipeline::linkRendition(int rendition)
+{
+    if (!_bin->getElementByName(GStreamerUtil::CAPTURE_TEE_NAME)) return false;
+
+    Rendition &entry = _renditions[rendition];
+    QString description = GStreamerUtil::createRtpVideoRenditionString(entry.bindPort, QHostAddress(entry.address), entry.port, entry.profile, entry.vaapi,
+                                                                       GStreamerUtil::capturePathUsesSurfaces(_capturePath, _profile, _vaapi));
+    Q_EMIT logInfo(LogTag, "Starting rendition " + QString::number(rendition) + " with command " + description);
+
+    if (!linkBranch(description, entry.bin, entry.teePad))
+    {
+        Q_EMIT logInfo(LogTag, "Cannot link rendition " + QString::number(rendition) + " to the capture");
+        return false;
+    }
+    return true;
+}
+
+void VideoPipeline::unlinkRendition(int rendition)
+{
+    Rendition &entry = _renditions[rendition];
+    unlinkBranch(entry.bin, entry.teePad);
+}
+
+bool VideoPipeline::linkRecording()
+{
+    if (!_bin->getElementByName(GStreamerUtil::CAPTURE_TEE_NAME)) return false;
+
+    // Every new branch gets its own file names, so a rebuilt pipeline never writes over the files of the last
+    QString locationPattern = _recording.locationPrefix + "_" + QString::number(QDateTime::currentMSecsSinceEpoch()) + "_%05d.part.mkv";
+    QString description = GStreamerUtil::createVideoRecordString(locationPattern, _recording.segmentSeconds, _recording.profile, _recording.vaapi,
+                                                                 GStreamerUtil::capturePathUsesSurfaces(_capturePath, _profile, _vaapi));
+    Q_EMIT logInfo(LogTag, "Starting recording with command " + description);
+
+    if (!linkBranch(description, _recording.bin, _recording.teePad))
+    {
+        Q_EMIT logInfo(LogTag, "Cannot link recording to the capture");
+        return false;
+    }
+    return true;
+}
+
+void VideoPipeline::start(const QString &description, bool sending)
+{
+    stopPrivate(false);
+
+    Q_EMIT logInfo(LogTag, "Starting GStreamer with command " + description);
+
+    _pipeline = QGst::Pipeline::create();
+    _pipeline->bus()->addSignalWatch();
+    QGlib::connect(_pipeline->bus(), "message", this, &VideoPipeline::onBusMessage);
+
+    _bin = QGst::Bin::fromDescription(description);
+    _pipeline->add(_bin);
+
+    QGst::ElementPtr videoEncoder = _pipeline->getElementByName(GStreamerUtil::VIDEO_ENCODER_NAME);
+    if (videoEncoder)
+    {
+        _encoderSinkPad = videoEncoder->getStaticPad("sink");
+        QGlib::connect(_encoderSinkPad, "notify::caps", this, &VideoPipeline::onEncoderSinkPadNotify);
+    }
+
+    _leftEye = _pipeline->getElementByName(GStreamerUtil::STEREO_LEFT_EYE_NAME);
+    _rightEye = _pipeline->getElementByName(GStreamerUtil::STEREO_RIGHT_EYE_NAME);
+    if (_leftEye && _rightEye)
+    {
+        _eyeTimestamps[0] = -1;
+        _eyeTimestamps[1] = -1;
+        _frameIntervalNs = 1000000000ll / qMax<int>(_profile.framerate, 1);
+        _skewTotalNs = 0;
+        _skewMaxNs = 0;
+        _skewCount = 0;
+        QGlib::connect(_leftEye, "handoff", this, &VideoPipeline::onLeftEyeHandoff);
+        QGlib::connect(_rightEye, "handoff", this, &VideoPipeline::onRightEyeHandoff);
+        _skewTimerId = startTimer(5000);
+    }
+
+    if (!sending)
+    {
+        QGlib::emit<void>(_pipeline->getElementByName(GStreamerUtil::VIDEO_SINK_NAME), "clear");
+    }
+
+    // Renditions outlive a rebuild of the main stream, as long as the new pipeline can have them
+    for (int rendition : _renditions.keys())
+    {
+        if (!linkRendition(rendition))
+        {
+            Q_EMIT logInfo(LogTag, "New pipeline cannot have renditions, dropping rendition " + QString::number(rendition));
+            _renditions.remove(rendition);
+        }
+    }
+    if (!_recording.locationPrefix.isEmpty() && !linkRecording())
+    {
+        Q_EMIT logInfo(LogTag, "New pipeline has no capture to record, recording is paused until one does");
+    }
+
+    _pipeline->setState(QGst::StatePlaying);
+
+    if (sending)
+    {
+        Q_EMIT streaming();
+    }
+}
+
+void VideoPipeline::stopPrivate(bool notify)
+{
+    if (_pipeline)
+    {
+        Q_EMIT logInfo(LogTag, "Freeing pipeline");
+        QGlib::disconnect(_pipeline->bus(), "message", this, &VideoPipeline::onBusMessage);
+        _pipeline->bus()->removeSignalWatch();
+        if (_encoderSinkPad)
+        {
+            QGlib::disconnect(_encoderSinkPad, "notify::caps", this, &VideoPipeline::onEncoderSinkPadNotify);
+            _encoderSinkPad.clear();
+        }
+        if (_leftEye && _rightEye)
+        {
+            QGlib::disconnect(_leftEye, "handoff", this, &VideoPipeline::onLeftEyeHandoff);
+            QGlib::disconnect(_rightEye, "handoff", this, &VideoPipeline::onRightEyeHandoff);
+        }
+        _leftEye.clear();
+        _rightEye.clear();
+        for (Rendition &rendition : _renditions)
+        {
+            rendition.bin.clear();
+            rendition.teePad.clear();
+        }
+        _recording.bin.clear();
+        _recording.teePad.clear();
+        _segmentStarts.clear();
+        if (_skewTimerId != -1)
+        {
+            killTimer(_skewTimerId);
+            _skewTimerId = -1;
+        }
+        _pendingReconfiguration.clear();
+        _pipeline->setState(QGst::StateNull);
+        _pipeline.clear();
+        _bin.clear();
+        if (notify)
+        {
+            Q_EMIT stopped();
+        }
+    }
+}
+
+void VideoPipeline::onBusMessage(const QGst::MessagePtr &message)
+{
+    switch (message->type())
+    {
+    case QGst::MessageEos:
+        Q_EMIT error("Received EOS message from GStreamer");
+        _renditions.clear();
+        stopPrivate(true);
+        break;
+    case QGst::MessageError:
+        Q_EMIT error(message.staticCast<QGst::ErrorMessage>()->error().message());
+        _renditions.clear();
+        stopPrivate(true);
+        break;
+    case QGst::MessageElement:
+        onElementMessage(message);
+        break;
+    case QGst::MessageStateChanged:
+        if ((_pendingReconfiguration == "rebuild") && (message->source() == _pipeline)
+                && (message.staticCast<QGst::StateChangedMessage>()->newState() == QGst::StatePlaying))
+        {
+            finishReconfiguration(_pendingReconfiguration);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void VideoPipeline::onElementMessage(const QGst::MessagePtr &message)
+{
+    // Posted by the recording's splitmuxsink as it moves from one file to the next
+    QGst::StructureConstPtr structure = message->internalStructure();
+    if (!structure) return;
+
+    QString location = structure->value("location").get<QString>();
+    if (structure->name() == "splitmuxsink-fragment-opened")
+    {
+        _segmentStarts.insert(location, QDateTime::currentMSecsSinceEpoch());
+    }
+    else if ((structure->name() == "splitmuxsink-fragment-closed") && _segmentStarts.contains(location))
+    {
+        Q_EMIT recordingSegment(location, _segmentStarts.take(location), QDateTime::currentMSecsSinceEpoch());
+    }
+}
+
+} // namespace Soro
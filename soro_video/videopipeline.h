@@ -0,0 +1,186 @@
+#ifndef VIDEOPIPELINE_H
+#define VIDEOPIPELINE_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QTimerEvent>
+
+#include <Qt5GStreamer/QGst/Pipeline>
+#include <Qt5GStreamer/QGst/Bin>
+#include <Qt5GStreamer/QGst/Message>
+#include <Qt5GStreamer/QGst/Pad>
+#include <Qt5GStreamer/QGst/Buffer>
+#include <Qt5GStreamer/QGlib/ParamSpec>
+
+#include "soro_video_global.h"
+#include "soro_core/gstreamerutil.h"
+
+namespace Soro {
+
+/* Runs the GStreamer pipeline that encodes and streams a single camera (or stereo camera pair).
+ *
+ * This is used both by the soro_videostreamer child process and directly inside the video server
+ * when it is configured to stream in-process. The pipeline's bus is watched from the thread the
+ * stream is started on, so an instance should only be used from the thread it lives in.
+ *
+ * Asking a running pipeline to stream the same camera to the same address with a different profile
+ * changes it in place where possible. Bitrate and quality are set on the running encoder, and a new
+ * resolution or framerate is renegotiated through the caps in front of it. Only a change of codec (or
+ * anything the encoder cannot change while playing) tears the pipeline down and builds a new one.
+ *
+ * Single cameras are captured on the path chosen by the caller (one of GStreamerUtil's CAPTURE_PATH_*
+ * constants). When the camera encodes H264 itself the pipeline only passes it through, so the bitrate
+ * and quality of the profile have no effect and a new resolution or framerate needs a rebuild.
+ *
+ * The capture of a single camera is split with a tee, and more renditions of it can be added as branches
+ * from there, each encoding its own profile to its own destination. Branches are added and removed
+ * while the capture runs, and are rebuilt along with it if the main stream needs a new pipeline.
+ * Stereo and H264 passthrough pipelines have no tee and cannot have renditions.
+ *
+ * The capture can also be recorded, encoded in its own profile into a series of files of a fixed length.
+ * A recording lasts until it is stopped: it is picked up again by every new pipeline with a tee, so it
+ * only pauses while the camera is used for something that cannot have one.
+ *
+ * Stereo pipelines composite the two cameras side by side. While one is running, the skew between
+ * the timestamps of the two eyes is measured and reported every few seconds.
+ *
+ * A pipeline can also be kept warm: capturing and encoding, but sending nowhere. Streaming from a warm
+ * pipeline only points its sink at the destination, so the first frame goes out with the next keyframe
+ * instead of after the camera and encoder start up.
+ */
+class SORO_VIDEO_EXPORT VideoPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VideoPipeline(QObject *parent = 0);
+    ~VideoPipeline();
+
+    bool isStreaming() const;
+    bool isWarm() const;
+
+public Q_SLOTS:
+    void stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi, int capturePath);
+    void streamStereo(const QString &leftDevice, const QString &rightDevice, const QString &address, int port, int bindPort, const QString &profile, bool vaapi);
+    // Starts capturing and encoding without sending anything
+    void warm(const QString &device, int bindPort, const QString &profile, bool vaapi, int capturePath);
+    // Stops sending, but keeps the pipeline running so it can resume immediately
+    void standby();
+    void stop();
+    // Adds a rendition encoding the running capture in another profile, or replaces it if it exists.
+    // Renditions and recordings need a capture tee, which stereo and H264 passthrough captures do not have.
+    void addRendition(int rendition, const QString &address, int port, int bindPort, const QString &profile, bool vaapi);
+    void removeRendition(int rendition);
+    // Starts recording the capture into files named from locationPrefix, replacing any running recording
+    void startRecording(const QString &locationPrefix, const QString &profile, bool vaapi, int segmentSeconds);
+    void stopRecording();
+
+Q_SIGNALS:
+    void logInfo(const QString &tag, const QString &message);
+    // Emitted when the pipeline starts sending to a destination
+    void streaming();
+    // Emitted when the pipeline fails, it will already have been stopped
+    void error(const QString &message);
+    // Emitted whenever a running pipeline stops sending, other than to start a new stream, whether
+    // it was freed or left warm
+    void stopped();
+    // Emitted when a running stream has been moved to a new profile, with the method used ("encoder",
+    // "caps" or "rebuild") and the time it took for the new profile to take effect
+    void reconfigured(const QString &method, int latencyMs);
+    // Emitted periodically while streaming stereo, with the average and largest offset between the
+    // frames of the two eyes
+    void stereoSkew(int averageUs, int maxUs);
+    // Emitted when a recorded file is complete, with the wall clock times (in ms since the epoch) it was
+    // opened and closed at
+    void recordingSegment(const QString &location, qint64 startMs, qint64 endMs);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private Q_SLOTS:
+    void onEncoderCapsChanged();
+
+private:
+    void configure(const QString &device, const QString &device2, const QString &address, int port, int bindPort,
+                   const GStreamerUtil::VideoProfile &profile, bool vaapi, quint8 capturePath);
+    bool reconfigure(const GStreamerUtil::VideoProfile &profile);
+    void retarget(const QString &address, int port);
+    void finishReconfiguration(const QString &method);
+    void start(const QString &description, bool sending);
+    // Called on a streaming thread
+    void onEncoderSinkPadNotify(const QGlib::ParamSpecPtr &property);
+    void onLeftEyeHandoff(const QGst::BufferPtr &buffer);
+    void onRightEyeHandoff(const QGst::BufferPtr &buffer);
+    void recordEyeTimestamp(int eye, const QGst::BufferPtr &buffer);
+    bool linkBranch(const QString &description, QGst::BinPtr &bin, QGst::PadPtr &teePad);
+    void unlinkBranch(QGst::BinPtr &bin, QGst::PadPtr &teePad);
+    bool linkRendition(int rendition);
+    void unlinkRendition(int rendition);
+    bool linkRecording();
+    void stopPrivate(bool notify);
+    void onBusMessage(const QGst::MessagePtr &message);
+    void onElementMessage(const QGst::MessagePtr &message);
+
+    struct Rendition
+    {
+        QString address;
+        int port;
+        int bindPort;
+        GStreamerUtil::VideoProfile profile;
+        bool vaapi;
+        // Only set while the branch is part of the running pipeline
+        QGst::BinPtr bin;
+        QGst::PadPtr teePad;
+    };
+
+    struct Recording
+    {
+        // Empty while nothing is being recorded
+        QString locationPrefix;
+        GStreamerUtil::VideoProfile profile;
+        bool vaapi;
+        int segmentSeconds;
+        // Only set while the branch is part of the running pipeline
+        QGst::BinPtr bin;
+        QGst::PadPtr teePad;
+    };
+
+    QGst::PipelinePtr _pipeline;
+    QGst::BinPtr _bin;
+    QGst::PadPtr _encoderSinkPad;
+    QGst::ElementPtr _leftEye;
+    QGst::ElementPtr _rightEye;
+
+    // What the running pipeline is streaming, the address is empty while it is warm
+    QString _device;
+    QString _device2;
+    QString _address;
+    int _port;
+    int _bindPort;
+    bool _vaapi;
+    quint8 _capturePath;
+    GStreamerUtil::VideoProfile _profile;
+    QHash<int, Rendition> _renditions;
+    Recording _recording;
+    // Wall clock time each open recording file was started at, keyed by its location
+    QHash<QString, qint64> _segmentStarts;
+
+    // Method of the reconfiguration still waiting to take effect, if any
+    QString _pendingReconfiguration;
+    QElapsedTimer _reconfigurationTimer;
+
+    // Skew between the eyes of a stereo pipeline, written on the streaming threads
+    QMutex _skewMutex;
+    qint64 _eyeTimestamps[2];
+    qint64 _frameIntervalNs;
+    qint64 _skewTotalNs;
+    qint64 _skewMaxNs;
+    int _skewCount;
+    int _skewTimerId;
+};
+
+} // namespace Soro
+
+#endif // VIDEOPIPELINE_H
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordingstore.h"
+#include "soro_core/logger.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QStringList>
+
+#include <algorithm>
+
+#define LogTag "RecordingStore"
+
+#define SEGMENT_SUFFIX ".mkv"
+#define PART_SUFFIX ".part.mkv"
+
+namespace Soro {
+
+/* Reads the three numbers from a file name of the form cam<a>_<b>_<c><suffix>
+ */
+static bool parseName(const QString &fileName, const QString &suffix, qint64 *fields)
+{
+    if (!fileName.startsWith("cam") || !fileName.endsWith(suffix)) return false;
+
+    QStringList items = fileName.mid(3, fileName.length() - 3 - suffix.length()).split('_');
+    if (items.size() != 3) return false;
+    for (int i = 0; i < 3; ++i)
+    {
+        bool ok;
+        fields[i] = items[i].toLongLong(&ok);
+        if (!ok || (fields[i] < 0)) return false;
+    }
+    return true;
+}
+
+RecordingStore::RecordingStore(const QString &directory, quint64 quotaBytes, int segmentSeconds, QObject *parent) : QObject(parent)
+{
+    _dir = QDir(directory);
+    _quotaBytes = quotaBytes;
+    _segmentSeconds = qMax(segmentSeconds, 1);
+    _valid = _dir.mkpath(".");
+    _sweepTimerId = -1;
+
+    if (!_valid)
+    {
+        LOG_E(LogTag, "Cannot create recording directory " + _dir.absolutePath());
+        return;
+    }
+
+    QList<Segment> segments = getSegments();
+    LOG_I(LogTag, QString("Recording to %1, which holds %2 files, within %3 MB")
+          .arg(_dir.absolutePath(), QString::number(segments.size()), QString::number(_quotaBytes / 1024 / 1024)));
+
+    // Whatever the last run left unfinished can be finished right away
+    finishStaleSegments();
+    enforceQuota();
+    _sweepTimerId = startTimer(_segmentSeconds * 1000);
+}
+
+bool RecordingStore::isValid() const
+{
+    return _valid;
+}
+
+QString RecordingStore::getLocationPrefix(quint16 cameraIndex) const
+{
+    return _dir.absoluteFilePath("cam" + QString::number(cameraIndex));
+}
+
+QList<RecordingStore::Segment> RecordingStore::find(quint16 cameraIndex, qint64 startMs, qint64 endMs) const
+{
+    QList<Segment> found;
+    for (const Segment &segment : getSegments())
+    {
+        if ((segment.cameraIndex == cameraIndex) && (segment.endMs >= startMs) && (segment.startMs <= endMs))
+        {
+            found.append(segment);
+        }
+    }
+    return found;
+}
+
+void RecordingStore::onSegmentComplete(const QString &location, qint64 startMs, qint64 endMs)
+{
+    if (finish(location, startMs, endMs))
+    {
+        enforceQuota();
+    }
+}
+
+void RecordingStore::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() == _sweepTimerId)
+    {
+        // Files still being written count against the quota too
+        finishStaleSegments();
+        enforceQuota();
+    }
+}
+
+bool RecordingStore::finish(const QString &location, qint64 startMs, qint64 endMs)
+{
+    QFileInfo info(location);
+    qint64 fields[3];
+    if (!parseName(info.fileName(), PART_SUFFIX, fields))
+    {
+        LOG_W(LogTag, "Ignoring recorded file with an unexpected name: " + location);
+        return false;
+    }
+
+    QString name = QString("cam%1_%2_%3" SEGMENT_SUFFIX).arg(QString::number(fields[0]), QString::number(startMs), QString::number(endMs));
+    if (!_dir.rename(info.fileName(), name))
+    {
+        LOG_E(LogTag, "Cannot rename recorded file " + info.fileName() + " to " + name);
+        return false;
+    }
+    return true;
+}
+
+void RecordingStore::finishStaleSegments()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 segmentMs = _segmentSeconds * 1000ll;
+
+    for (const QFileInfo &info : _dir.entryInfoList(QStringList() << "*" PART_SUFFIX, QDir::Files))
+    {
+        qint64 lastWritten = info.lastModified().toMSecsSinceEpoch();
+        if (now - lastWritten < 2 * segmentMs) continue;
+
+        // Files of a recording follow each other from when it started
+        qint64 fields[3];
+        if (!parseName(info.fileName(), PART_SUFFIX, fields)) continue;
+        qint64 startMs = fields[1] + fields[2] * segmentMs;
+        qint64 endMs = qMax(startMs, lastWritten);
+        LOG_W(LogTag, "Finishing recorded file " + info.fileName() + ", which was left incomplete");
+        finish(info.absoluteFilePath(), startMs, endMs);
+    }
+}
+
+void RecordingStore::enforceQuota()
+{
+    quint64 total = 0;
+    for (const QFileInfo &info : _dir.entryInfoList(QStringList() << "cam*" SEGMENT_SUFFIX, QDir::Files))
+    {
+        total += info.size();
+    }
+    if (total <= _quotaBytes) return;
+
+    QList<Segment> segments = getSegments();
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b)
+    {
+        return a.startMs < b.startMs;
+    });
+
+    int deleted = 0;
+    for (const Segment &segment : segments)
+    {
+        if (total <= _quotaBytes) break;
+        if (QFile::remove(segment.path))
+        {
+            total -= segment.size;
+            deleted++;
+        }
+    }
+
+    if (deleted > 0)
+    {
+        LOG_I(LogTag, QString("Deleted the %1 oldest recorded files to stay within the quota").arg(deleted));
+    }
+    if (total > _quotaBytes)
+    {
+        LOG_W(LogTag, "Recordings in progress alone are over the quota");
+    }
+}
+
+QList<RecordingStore::Segment> RecordingStore::getSegments() const
+{
+    QList<Segment> segments;
+    for (const QFileInfo &info : _dir.entryInfoList(QStringList() << "cam*" SEGMENT_SUFFIX, QDir::Files))
+    {
+        qint64 fields[3];
+        // Files still being written match the pattern above, but not this
+        if (!parseName(info.fileName(), SEGMENT_SUFFIX, fields)) continue;
+
+        Segment segment;
+        segment.cameraIndex = fields[0];
+        segment.startMs = fields[1];
+        segment.endMs = fields[2];
+        segment.path = info.absoluteFilePath();
+        segment.size = info.size();
+        segments.append(segment);
+    }
+    return segments;
+}
+
+} // namespace Soro
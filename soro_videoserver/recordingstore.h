@@ -0,0 +1,67 @@
+#ifndef RECORDINGSTORE_H
+#define RECORDINGSTORE_H
+
+#include <QObject>
+#include <QDir>
+#include <QList>
+#include <QString>
+#include <QTimerEvent>
+
+namespace Soro {
+
+/* The recorded video of the cameras on this computer, kept in one directory within a disk quota.
+ *
+ * Pipelines write each recording as a series of <prefix>_<n>.part.mkv files. Once a file is complete
+ * it is renamed to cam<camera>_<start>_<end>.mkv, after the wall clock times it covers in ms since the
+ * epoch, so the directory listing is the index and it survives restarts. Files a pipeline never
+ * finished (because it was stopped or crashed) are renamed the same way once they have not been written
+ * to for two file lengths, with their times estimated from their names and when they were last written.
+ *
+ * Whenever the directory is over its quota, the oldest complete files are deleted to make room.
+ */
+class RecordingStore : public QObject
+{
+    Q_OBJECT
+public:
+    struct Segment
+    {
+        quint16 cameraIndex;
+        qint64 startMs;
+        qint64 endMs;
+        QString path;
+        qint64 size;
+    };
+
+    explicit RecordingStore(const QString &directory, quint64 quotaBytes, int segmentSeconds, QObject *parent = 0);
+
+    // False if the directory cannot be created
+    bool isValid() const;
+
+    // Gets the file name prefix for a pipeline recording the specified camera
+    QString getLocationPrefix(quint16 cameraIndex) const;
+
+    // Gets the complete files of a camera that overlap the specified time, oldest first
+    QList<Segment> find(quint16 cameraIndex, qint64 startMs, qint64 endMs) const;
+
+public Q_SLOTS:
+    void onSegmentComplete(const QString &location, qint64 startMs, qint64 endMs);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    bool finish(const QString &location, qint64 startMs, qint64 endMs);
+    void finishStaleSegments();
+    void enforceQuota();
+    QList<Segment> getSegments() const;
+
+    QDir _dir;
+    bool _valid;
+    quint64 _quotaBytes;
+    int _segmentSeconds;
+    int _sweepTimerId;
+};
+
+} // namespace Soro
+
+#endif // RECORDINGSTORE_H
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordinguploader.h"
+#include "soro_core/constants.h"
+#include "soro_core/logger.h"
+#include "soro_core/notificationmessage.h"
+#include "soro_core/recordingdatamessage.h"
+
+#define LogTag "RecordingUploader"
+
+// A piece is sent every tick of the send timer
+#define SEND_INTERVAL_MS 100
+// Loss on a live stream above this, in hundredths of a percent, pauses the upload
+#define LOSS_THRESHOLD 100
+#define LOSS_BACKOFF_MS 5000
+
+namespace Soro {
+
+RecordingUploader::RecordingUploader(const SettingsModel *settings, const RecordingStore *store, QObject *parent) : QObject(parent)
+{
+    _settings = settings;
+    _store = store;
+    _sendTimerId = -1;
+    _nextMqttMsgId = 1;
+    _pieceSize = qMax<int>(settings->getRecordUploadRateKbps() * 1024 * SEND_INTERVAL_MS / 1000, 1024);
+
+    LOG_I(LogTag, "Creating MQTT client...");
+    _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
+    _mqttDispatcher.addRoute<RecordingRequestMessage>("recording_request", [this](const RecordingRequestMessage &requestMsg) { onRecordingRequest(requestMsg); });
+    _mqttDispatcher.addRoute<VideoStatsMessage>("video_stats", [this](const VideoStatsMessage &statsMsg) { onVideoStats(statsMsg); });
+    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message &msg)
+    {
+        _mqttDispatcher.dispatch(msg);
+    });
+    connect(_mqtt, &QMQTT::Client::connected, this, &RecordingUploader::onMqttConnected);
+    connect(_mqtt, &QMQTT::Client::disconnected, this, &RecordingUploader::onMqttDisconnected);
+    _mqtt->setClientId("recording_uploader_" + QString::number(settings->getComputerIndex()));
+    _mqtt->setAutoReconnect(true);
+    _mqtt->setAutoReconnectInterval(1000);
+    _mqtt->setWillMessage(_mqtt->clientId());
+    _mqtt->setWillQos(2);
+    _mqtt->setWillTopic("system_down");
+    _mqtt->setWillRetain(false);
+    _mqtt->connectToHost();
+}
+
+void RecordingUploader::onMqttConnected()
+{
+    LOG_I(LogTag, "Connected to MQTT broker");
+    _mqtt->subscribe("recording_request", 2);
+    _mqtt->subscribe("video_stats", 0);
+}
+
+void RecordingUploader::onMqttDisconnected()
+{
+    LOG_W(LogTag, "Disconnected from MQTT broker");
+}
+
+void RecordingUploader::onRecordingRequest(const RecordingRequestMessage &requestMsg)
+{
+    if (!requestMsg.isValid())
+    {
+        LOG_W(LogTag, "Received invalid recording request, discarding");
+        return;
+    }
+
+    // Every server sees every request, only the one recording this camera answers
+    if (!_settings->getRecordCameras().contains(requestMsg.camera_index)) return;
+
+    QList<RecordingStore::Segment> segments = _store->find(requestMsg.camera_index, requestMsg.start_ms, requestMsg.end_ms);
+    LOG_I(LogTag, QString("%1 asked for camera %2 from %3 to %4, %5 recorded files match")
+          .arg(requestMsg.client_id,
+               QString::number(requestMsg.camera_index),
+               QString::number(requestMsg.start_ms),
+               QString::number(requestMsg.end_ms),
+               QString::number(segments.size())));
+
+    NotificationMessage notifyMsg;
+    notifyMsg.level = NotificationMessage::Level_Info;
+    notifyMsg.title = "Recording of camera " + QString::number(requestMsg.camera_index);
+    if (segments.isEmpty())
+    {
+        notifyMsg.message = "Nothing was recorded from this camera at the requested time.";
+        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+        return;
+    }
+
+    qint64 bytes = 0;
+    for (const RecordingStore::Segment &segment : segments)
+    {
+        // A file already on its way to this client is not sent twice
+        bool queued = false;
+        for (const Upload &upload : _uploads)
+        {
+            if ((upload.clientId == requestMsg.client_id) && (upload.segment.path == segment.path))
+            {
+                queued = true;
+                break;
+            }
+        }
+        if (queued) continue;
+
+        Upload upload;
+        upload.clientId = requestMsg.client_id;
+        upload.segment = segment;
+        _uploads.enqueue(upload);
+        bytes += segment.size;
+    }
+
+    notifyMsg.message = QString("Sending %1 MB of recorded video in the background, at up to %2 KB/s.")
+            .arg(QString::number(bytes / 1024.0 / 1024.0, 'f', 1), QString::number(_settings->getRecordUploadRateKbps()));
+    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+
+    if ((_sendTimerId == -1) && !_uploads.isEmpty())
+    {
+        _sendTimerId = startTimer(SEND_INTERVAL_MS);
+    }
+}
+
+void RecordingUploader::onVideoStats(const VideoStatsMessage &statsMsg)
+{
+    if (!statsMsg.isValid()) return;
+    if (statsMsg.loss_rate > LOSS_THRESHOLD)
+    {
+        if (!_uploads.isEmpty() && (!_sinceLoss.isValid() || (_sinceLoss.elapsed() > LOSS_BACKOFF_MS)))
+        {
+            LOG_I(LogTag, "Live video is losing packets, pausing the upload");
+        }
+        _sinceLoss.start();
+    }
+}
+
+void RecordingUploader::timerEvent(QTimerEvent *e)
+{
+    if (e->timerId() == _sendTimerId)
+    {
+        if (!_mqtt->isConnectedToHost()) return;
+        if (_sinceLoss.isValid() && (_sinceLoss.elapsed() < LOSS_BACKOFF_MS)) return;
+        sendPiece();
+    }
+}
+
+void RecordingUploader::sendPiece()
+{
+    const Upload &upload = _uploads.head();
+    if (!_file.isOpen())
+    {
+        _file.setFileName(upload.segment.path);
+        if (!_file.open(QIODevice::ReadOnly))
+        {
+            // Deleted to stay within the quota since it was requested
+            LOG_W(LogTag, "Recorded file " + upload.segment.path + " is no longer available, skipping it");
+            finishUpload();
+            return;
+        }
+        LOG_I(LogTag, "Sending " + upload.segment.path + " to " + upload.clientId);
+    }
+
+    RecordingDataMessage dataMsg;
+    dataMsg.camera_index = upload.segment.cameraIndex;
+    dataMsg.start_ms = upload.segment.startMs;
+    dataMsg.end_ms = upload.segment.endMs;
+    dataMsg.file_size = _file.size();
+    dataMsg.offset = _file.pos();
+    dataMsg.data = _file.read(_pieceSize);
+    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "recording_data_" + upload.clientId, dataMsg, 1));
+
+    if (_file.atEnd())
+    {
+        LOG_I(LogTag, "Finished sending " + upload.segment.path);
+        finishUpload();
+    }
+}
+
+void RecordingUploader::finishUpload()
+{
+    _file.close();
+    _uploads.dequeue();
+    if (_uploads.isEmpty())
+    {
+        killTimer(_sendTimerId);
+        _sendTimerId = -1;
+    }
+}
+
+} // namespace Soro
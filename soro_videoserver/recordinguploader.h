@@ -0,0 +1,68 @@
+#ifndef RECORDINGUPLOADER_H
+#define RECORDINGUPLOADER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTimerEvent>
+
+#include "qmqtt/qmqtt.h"
+
+#include "settingsmodel.h"
+#include "recordingstore.h"
+#include "soro_core/recordingrequestmessage.h"
+#include "soro_core/videostatsmessage.h"
+
+namespace Soro {
+
+/* Sends recorded video to mission control when it asks for it, in the background.
+ *
+ * Requested files are queued and sent in pieces, paced to the configured upload rate so the upload
+ * only ever takes the bandwidth set aside for it. Whenever the master reports loss on any live video
+ * stream the upload holds off for a few seconds, so it does not compete with the live video on a
+ * congested link. It has its own connection to the broker, so a long upload never delays the video
+ * server's own messages.
+ */
+class RecordingUploader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RecordingUploader(const SettingsModel *settings, const RecordingStore *store, QObject *parent = 0);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private Q_SLOTS:
+    void onMqttConnected();
+    void onMqttDisconnected();
+
+private:
+    struct Upload
+    {
+        QString clientId;
+        RecordingStore::Segment segment;
+    };
+
+    void onRecordingRequest(const RecordingRequestMessage &requestMsg);
+    void onVideoStats(const VideoStatsMessage &statsMsg);
+    void sendPiece();
+    void finishUpload();
+
+    const SettingsModel *_settings;
+    const RecordingStore *_store;
+    QQueue<Upload> _uploads;
+    // The file at the head of the queue, open while it is being sent
+    QFile _file;
+    int _sendTimerId;
+    int _pieceSize;
+    QElapsedTimer _sinceLoss;
+
+    QMQTT::Client *_mqtt;
+    QMQTT::TopicDispatcher _mqttDispatcher;
+    quint16 _nextMqttMsgId;
+};
+
+} // namespace Soro
+
+#endif // RECORDINGUPLOADER_H
@@ -29,6 +29,18 @@
 #define KEY_USE_MPEG2_VAAPI "SORO_GST_USE_MPEG2_VAAPI"
 #define KEY_USE_H265_VAAPI "SORO_GST_USE_H265_VAAPI"
 #define KEY_USE_JPEG_VAAPI "SORO_GST_USE_JPEG_VAAPI"
+#define KEY_STREAM_IN_PROCESS "SORO_VIDEO_STREAM_IN_PROCESS"
+#define KEY_STREAM_WORKER_THREADS "SORO_VIDEO_STREAM_WORKER_THREADS"
+#define KEY_WARM_CAMERAS "SORO_VIDEO_WARM_CAMERAS"
+#define KEY_WARM_PROFILE "SORO_VIDEO_WARM_PROFILE"
+#define KEY_WARM_MEMORY_BUDGET "SORO_VIDEO_WARM_MEMORY_BUDGET"
+#define KEY_WARM_CPU_BUDGET "SORO_VIDEO_WARM_CPU_BUDGET"
+#define KEY_RECORD_CAMERAS "SORO_VIDEO_RECORD_CAMERAS"
+#define KEY_RECORD_PROFILE "SORO_VIDEO_RECORD_PROFILE"
+#define KEY_RECORD_DIRECTORY "SORO_VIDEO_RECORD_DIRECTORY"
+#define KEY_RECORD_QUOTA "SORO_VIDEO_RECORD_QUOTA"
+#define KEY_RECORD_SEGMENT_LENGTH "SORO_VIDEO_RECORD_SEGMENT_LENGTH"
+#define KEY_RECORD_UPLOAD_RATE "SORO_VIDEO_RECORD_UPLOAD_RATE"
 
 namespace Soro {
 
@@ -41,6 +53,18 @@ QHash<QString, int> SettingsModel::getKeys() const
     keys.insert(KEY_USE_H265_VAAPI, QMetaType::Bool);
     keys.insert(KEY_USE_JPEG_VAAPI, QMetaType::Bool);
     keys.insert(KEY_MQTT_BROKER_IP, QMetaType::QString);
+    keys.insert(KEY_STREAM_IN_PROCESS, QMetaType::Bool);
+    keys.insert(KEY_STREAM_WORKER_THREADS, QMetaType::Int);
+    keys.insert(KEY_WARM_CAMERAS, QMetaType::QString);
+    keys.insert(KEY_WARM_PROFILE, QMetaType::QString);
+    keys.insert(KEY_WARM_MEMORY_BUDGET, QMetaType::UInt);
+    keys.insert(KEY_WARM_CPU_BUDGET, QMetaType::UInt);
+    keys.insert(KEY_RECORD_CAMERAS, QMetaType::QString);
+    keys.insert(KEY_RECORD_PROFILE, QMetaType::QString);
+    keys.insert(KEY_RECORD_DIRECTORY, QMetaType::QString);
+    keys.insert(KEY_RECORD_QUOTA, QMetaType::UInt);
+    keys.insert(KEY_RECORD_SEGMENT_LENGTH, QMetaType::UInt);
+    keys.insert(KEY_RECORD_UPLOAD_RATE, QMetaType::UInt);
     return keys;
 }
 
@@ -54,6 +78,18 @@ QHash<QString, QVariant> SettingsModel::getDefaultValues() const
     defaults.insert(KEY_USE_H265_VAAPI, QVariant(false));
     defaults.insert(KEY_USE_JPEG_VAAPI, QVariant(false));
     defaults.insert(KEY_MQTT_BROKER_IP, QVariant("127.0.0.1"));
+    defaults.insert(KEY_STREAM_IN_PROCESS, QVariant(false));
+    defaults.insert(KEY_STREAM_WORKER_THREADS, QVariant(2));
+    defaults.insert(KEY_WARM_CAMERAS, QVariant(""));
+    defaults.insert(KEY_WARM_PROFILE, QVariant("VP,0,640,480,30,2048000,50"));
+    defaults.insert(KEY_WARM_MEMORY_BUDGET, QVariant(1024));
+    defaults.insert(KEY_WARM_CPU_BUDGET, QVariant(200));
+    defaults.insert(KEY_RECORD_CAMERAS, QVariant(""));
+    defaults.insert(KEY_RECORD_PROFILE, QVariant("VP,0,1280,720,30,8192000,90"));
+    defaults.insert(KEY_RECORD_DIRECTORY, QVariant(QCoreApplication::applicationDirPath() + "/../recordings"));
+    defaults.insert(KEY_RECORD_QUOTA, QVariant(16384));
+    defaults.insert(KEY_RECORD_SEGMENT_LENGTH, QVariant(60));
+    defaults.insert(KEY_RECORD_UPLOAD_RATE, QVariant(64));
     return defaults;
 }
 
@@ -92,4 +128,80 @@ QHostAddress SettingsModel::getMqttBrokerAddress() const
     return QHostAddress(_values.value(KEY_MQTT_BROKER_IP).toString());
 }
 
+bool SettingsModel::getStreamInProcess() const
+{
+    return _values.value(KEY_STREAM_IN_PROCESS).toBool();
+}
+
+int SettingsModel::getStreamWorkerThreads() const
+{
+    return _values.value(KEY_STREAM_WORKER_THREADS).toInt();
+}
+
+QList<int> SettingsModel::getWarmCameras() const
+{
+    // Comma separated camera indices
+    QList<int> cameras;
+    for (QString item : _values.value(KEY_WARM_CAMERAS).toString().split(',', QString::SkipEmptyParts))
+    {
+        bool ok;
+        int index = item.trimmed().toInt(&ok);
+        if (ok && (index >= 0)) cameras.append(index);
+    }
+    return cameras;
+}
+
+GStreamerUtil::VideoProfile SettingsModel::getWarmProfile() const
+{
+    return GStreamerUtil::VideoProfile(_values.value(KEY_WARM_PROFILE).toString());
+}
+
+uint SettingsModel::getWarmMemoryBudgetMb() const
+{
+    return _values.value(KEY_WARM_MEMORY_BUDGET).toUInt();
+}
+
+uint SettingsModel::getWarmCpuBudgetPercent() const
+{
+    return _values.value(KEY_WARM_CPU_BUDGET).toUInt();
+}
+
+QList<int> SettingsModel::getRecordCameras() const
+{
+    // Comma separated camera indices
+    QList<int> cameras;
+    for (QString item : _values.value(KEY_RECORD_CAMERAS).toString().split(',', QString::SkipEmptyParts))
+    {
+        bool ok;
+        int index = item.trimmed().toInt(&ok);
+        if (ok && (index >= 0)) cameras.append(index);
+    }
+    return cameras;
+}
+
+GStreamerUtil::VideoProfile SettingsModel::getRecordProfile() const
+{
+    return GStreamerUtil::VideoProfile(_values.value(KEY_RECORD_PROFILE).toString());
+}
+
+QString SettingsModel::getRecordDirectory() const
+{
+    return _values.value(KEY_RECORD_DIRECTORY).toString();
+}
+
+uint SettingsModel::getRecordQuotaMb() const
+{
+    return _values.value(KEY_RECORD_QUOTA).toUInt();
+}
+
+uint SettingsModel::getRecordSegmentSeconds() const
+{
+    return _values.value(KEY_RECORD_SEGMENT_LENGTH).toUInt();
+}
+
+uint SettingsModel::getRecordUploadRateKbps() const
+{
+    return _values.value(KEY_RECORD_UPLOAD_RATE).toUInt();
+}
+
 } // namespace Soro
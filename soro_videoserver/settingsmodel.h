@@ -4,8 +4,10 @@
 #include <QSettings>
 #include <QString>
 #include <QHostAddress>
+#include <QList>
 
 #include "soro_core/abstractsettingsmodel.h"
+#include "soro_core/gstreamerutil.h"
 
 namespace Soro {
 
@@ -21,6 +23,22 @@ public:
     bool getUseH265Vaapi() const;
     bool getUseJpegVaapi() const;
     QHostAddress getMqttBrokerAddress() const;
+    bool getStreamInProcess() const;
+    int getStreamWorkerThreads() const;
+    // Indices of the cameras to keep capturing and encoding while they are not streaming
+    QList<int> getWarmCameras() const;
+    GStreamerUtil::VideoProfile getWarmProfile() const;
+    // Cameras are only kept warm while the server stays within these budgets
+    uint getWarmMemoryBudgetMb() const;
+    uint getWarmCpuBudgetPercent() const;
+    // Indices of the cameras to record onboard whenever they are connected
+    QList<int> getRecordCameras() const;
+    GStreamerUtil::VideoProfile getRecordProfile() const;
+    QString getRecordDirectory() const;
+    uint getRecordQuotaMb() const;
+    uint getRecordSegmentSeconds() const;
+    // Rate recordings are sent to mission control at, in KB/s
+    uint getRecordUploadRateKbps() const;
 
 protected:
     QHash<QString, int> getKeys() const override;
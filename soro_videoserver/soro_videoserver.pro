@@ -15,7 +15,10 @@ TEMPLATE = app
 SOURCES += main.cpp \
     videoserver.cpp \
     maincontroller.cpp \
-    settingsmodel.cpp
+    settingsmodel.cpp \
+    usbcameraindex.cpp \
+    recordingstore.cpp \
+    recordinguploader.cpp
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked deprecated (the exact warnings
@@ -26,13 +29,16 @@ DEFINES += QT_DEPRECATED_WARNINGS
 HEADERS += \
     videoserver.h \
     maincontroller.h \
-    settingsmodel.h
+    settingsmodel.h \
+    usbcameraindex.h \
+    recordingstore.h \
+    recordinguploader.h
     
 # Include headers from other subprojects
 INCLUDEPATH += $$PWD/..
 
-# Link against soro_core
-LIBS += -L../lib -lsoro_core
+# Link against soro_core and soro_video
+LIBS += -L../lib -lsoro_core -lsoro_video
 
 #Link Qt5GStreamer
 LIBS += -lQt5GStreamer-1.0 -lQt5GLib-2.0
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "usbcameraindex.h"
+#include "soro_core/logger.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#define LogTag "UsbCameraIndex"
+
+// How far above a video node's device link to look for the USB device
+#define MAX_USB_DEVICE_DEPTH 4
+
+namespace Soro {
+
+UsbCameraIndex::UsbCameraIndex(const QString &sysfsRoot, QObject *parent) : QObject(parent)
+{
+    _sysfsRoot = sysfsRoot;
+    _ueventNotifier = nullptr;
+
+    // Subscribe to kernel device events
+    int error = 0;
+    _ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (_ueventFd >= 0)
+    {
+        sockaddr_nl addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1;
+        if (bind(_ueventFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            error = errno;
+            close(_ueventFd);
+            _ueventFd = -1;
+        }
+    }
+    else
+    {
+        error = errno;
+    }
+
+    if (_ueventFd >= 0)
+    {
+        _ueventNotifier = new QSocketNotifier(_ueventFd, QSocketNotifier::Read, this);
+        connect(_ueventNotifier, SIGNAL(activated(int)), this, SLOT(onUevent()));
+    }
+    else
+    {
+        LOG_W(LogTag, QString("Cannot monitor device events (%1), cameras will only be rescanned when one is not found")
+              .arg(strerror(error)));
+    }
+
+    rebuild();
+}
+
+UsbCameraIndex::~UsbCameraIndex()
+{
+    if (_ueventFd >= 0)
+    {
+        delete _ueventNotifier;
+        close(_ueventFd);
+    }
+}
+
+QString UsbCameraIndex::find(const QString &vendorId, const QString &productId, const QString &serial, int offset)
+{
+    QString key = makeKey(vendorId, productId, serial);
+    if (offset >= _nodes.value(key).size())
+    {
+        // The camera may have been plugged in without us hearing about it
+        rebuild();
+    }
+    return _nodes.value(key).value(offset);
+}
+
+void UsbCameraIndex::rebuild()
+{
+    _nodes.clear();
+
+    QDir classDir(_sysfsRoot + "/class/video4linux");
+    for (QString node : classDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::System))
+    {
+        // The device link points at the USB interface, the USB device is the nearest parent with IDs
+        QString devicePath = QFileInfo(classDir.filePath(node) + "/device").canonicalFilePath();
+        if (devicePath.isEmpty()) continue;
+
+        QDir device(devicePath);
+        int depth = 0;
+        while (!device.exists("idVendor") && (depth < MAX_USB_DEVICE_DEPTH) && device.cdUp())
+        {
+            depth++;
+        }
+        if (!device.exists("idVendor")) continue; // Not a USB camera
+
+        QString key = makeKey(readAttribute(device.path(), "idVendor"),
+                              readAttribute(device.path(), "idProduct"),
+                              readAttribute(device.path(), "serial"));
+        _nodes[key].append(node);
+    }
+
+    int count = 0;
+    for (const QStringList &nodes : _nodes)
+    {
+        count += nodes.size();
+    }
+    LOG_I(LogTag, QString("Indexed %1 USB video nodes").arg(count));
+    Q_EMIT changed();
+}
+
+void UsbCameraIndex::onUevent()
+{
+    char buffer[8192];
+    bool changed = false;
+    ssize_t length;
+    while ((length = recv(_ueventFd, buffer, sizeof(buffer) - 1, MSG_DONTWAIT)) > 0)
+    {
+        // A header line followed by NUL separated KEY=value fields
+        buffer[length] = '\0';
+        for (char *field = buffer; field < buffer + length; field += strlen(field) + 1)
+        {
+            if (strcmp(field, "SUBSYSTEM=video4linux") == 0)
+            {
+                changed = true;
+                break;
+            }
+        }
+    }
+
+    if (changed)
+    {
+        LOG_I(LogTag, "Video devices have changed");
+        rebuild();
+    }
+}
+
+QString UsbCameraIndex::makeKey(const QString &vendorId, const QString &productId, const QString &serial)
+{
+    return vendorId.trimmed() + ":" + productId.trimmed() + ":" + serial.trimmed();
+}
+
+QString UsbCameraIndex::readAttribute(const QString &dir, const QString &name)
+{
+    QFile file(dir + "/" + name);
+    if (!file.open(QIODevice::ReadOnly)) return "";
+    return QString(file.readAll()).trimmed();
+}
+
+} // namespace Soro
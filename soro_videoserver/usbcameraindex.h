@@ -0,0 +1,57 @@
+#ifndef USBCAMERAINDEX_H
+#define USBCAMERAINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QSocketNotifier>
+
+namespace Soro {
+
+/* Index of the USB cameras attached to this computer, by vendor ID, product ID and serial number.
+ *
+ * The index is read from sysfs, where each video4linux node links to its USB interface and the
+ * USB device above it holds the idVendor, idProduct and serial attributes. It is rebuilt whenever
+ * the kernel reports a video4linux device being added or removed (over a netlink uevent socket),
+ * so looking up a camera never has to scan the devices.
+ *
+ * The sysfs root can be changed to point the index at a different tree.
+ */
+class UsbCameraIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit UsbCameraIndex(const QString &sysfsRoot = "/sys", QObject *parent = 0);
+    ~UsbCameraIndex();
+
+    /* Finds the video node (such as "video2") of a camera. Offset selects between several cameras with
+     * the same IDs, in order of their node names. Returns an empty string if there is no such camera.
+     */
+    QString find(const QString &vendorId, const QString &productId, const QString &serial, int offset);
+
+    /* Reads all cameras from sysfs again
+     */
+    void rebuild();
+
+Q_SIGNALS:
+    // Emitted after the index has been rebuilt, the cameras behind each node may have changed
+    void changed();
+
+private Q_SLOTS:
+    void onUevent();
+
+private:
+    static QString makeKey(const QString &vendorId, const QString &productId, const QString &serial);
+    static QString readAttribute(const QString &dir, const QString &name);
+
+    QString _sysfsRoot;
+    // Nodes of all cameras with the same IDs, keyed by makeKey()
+    QHash<QString, QStringList> _nodes;
+    int _ueventFd;
+    QSocketNotifier *_ueventNotifier;
+};
+
+} // namespace Soro
+
+#endif // USBCAMERAINDEX_H
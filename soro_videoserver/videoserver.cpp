@@ -22,6 +22,10 @@
 
 #include "maincontroller.h"
 
+#include <Qt5GStreamer/QGst/Init>
+
+#include <unistd.h>
+
 #define LogTag "VideoServer"
 
 namespace Soro {
@@ -29,10 +33,26 @@ namespace Soro {
 VideoServer::VideoServer(const SettingsModel *settings, QObject *parent) : QObject(parent)
 {
     _settings = settings;
+    _nextWorkerThread = 0;
+    _cameraIndex = new UsbCameraIndex("/sys", this);
+    connect(_cameraIndex, &UsbCameraIndex::changed, this, &VideoServer::onCamerasChanged);
 
-    // Ensure child process executable exits
-    if (!QFile(SORO_ROVER_VIDEO_STREAM_PROCESS_PATH).exists())
+    if (settings->getStreamInProcess())
+    {
+        // Streams run in this process, a crashing pipeline takes the whole server down with it
+        LOG_I(LogTag, "Streaming in-process on " + QString::number(qMax(settings->getStreamWorkerThreads(), 1)) + " worker threads");
+        QGst::init();
+        for (int i = 0; i < qMax(settings->getStreamWorkerThreads(), 1); ++i)
+        {
+            QThread *thread = new QThread(this);
+            thread->setObjectName("video_worker_" + QString::number(i));
+            thread->start();
+            _workerThreads.append(thread);
+        }
+    }
+    else if (!QFile(SORO_ROVER_VIDEO_STREAM_PROCESS_PATH).exists())
     {
+        // Ensure child process executable exits
         MainController::panic(LogTag, "Video stream process is not at the correct path");
     }
 
@@ -83,6 +103,20 @@ VideoServer::VideoServer(const SettingsModel *settings, QObject *parent) : QObje
                                     break;
                                 }
                             }
+                            for (QString device : _renditions.keys())
+                            {
+                                for (quint8 rendition : _renditions[device].keys())
+                                {
+                                    Assignment &assignment = _renditions[device][rendition];
+                                    if (assignment.message.getStreamIndex() == i - SORO_NET_FIRST_VIDEO_PORT)
+                                    {
+                                        LOG_W(LogTag, "Client has changed addresses while a rendition is in progress, restarting it");
+                                        assignment.address = host;
+                                        assignment.port = port;
+                                        giveRendition(assignment);
+                                    }
+                                }
+                            }
                         }
                     }
                     _clientAddresses.insert(i, host);
@@ -113,9 +147,38 @@ VideoServer::VideoServer(const SettingsModel *settings, QObject *parent) : QObje
     // Start heartbeat timer so children still know we're running
     _heartbeatTimerId = startTimer(1000);
 
+    _recordingStore = nullptr;
+    _recordingUploader = nullptr;
+    if (!settings->getRecordCameras().isEmpty())
+    {
+        _recordingStore = new RecordingStore(settings->getRecordDirectory(),
+                                             (quint64)settings->getRecordQuotaMb() * 1024 * 1024,
+                                             settings->getRecordSegmentSeconds(),
+                                             this);
+        if (_recordingStore->isValid())
+        {
+            _recordingUploader = new RecordingUploader(settings, _recordingStore, this);
+        }
+        else
+        {
+            LOG_E(LogTag, "Cannot record any cameras without a recording directory");
+            delete _recordingStore;
+            _recordingStore = nullptr;
+        }
+    }
+
+    _warmBudgetTimerId = -1;
+    _lastCpuTicks = 0;
+    startWarmCameras();
+
     LOG_I(LogTag, "Creating MQTT client...");
     _mqtt = new QMQTT::Client(settings->getMqttBrokerAddress(), SORO_NET_MQTT_BROKER_PORT, this);
-    connect(_mqtt, &QMQTT::Client::received, this, &VideoServer::onMqttMessage);
+    _mqttDispatcher.addRoute<VideoMessage>("video_request", [this](const VideoMessage &videoMsg) { onVideoRequest(videoMsg); });
+    _mqttDispatcher.addRoute("system_down", [this](const QMQTT::Message &msg) { onSystemDown(msg); });
+    connect(_mqtt, &QMQTT::Client::received, this, [this](const QMQTT::Message &msg)
+    {
+        _mqttDispatcher.dispatch(msg);
+    });
     connect(_mqtt, &QMQTT::Client::connected, this, &VideoServer::onMqttConnected);
     connect(_mqtt, &QMQTT::Client::disconnected, this, &VideoServer::onMqttDisconnected);
     _mqtt->setClientId("video_server_" + QString::number(settings->getComputerIndex()));
@@ -142,172 +205,167 @@ void VideoServer::onMqttDisconnected()
     Q_EMIT mqttDisconnected();
 }
 
-void VideoServer::onMqttMessage(const QMQTT::Message &msg)
+void VideoServer::onVideoRequest(const VideoMessage &videoMsg)
 {
-    if (msg.topic() == "video_request")
+    if (!videoMsg.isValid())
+    {
+        LOG_W(LogTag, "Received invalid video request, discarding");
+        return;
+    }
+    if (videoMsg.camera_computerIndex == _settings->getComputerIndex())
     {
-        VideoMessage videoMsg(msg.payload());
+        LOG_I(LogTag, "Received new video request for this server");
 
-        if (videoMsg.camera_computerIndex == _settings->getComputerIndex())
+        if (videoMsg.rendition >= SORO_MAX_VIDEO_RENDITIONS)
         {
-            LOG_I(LogTag, "Received new video request for this server");
+            LOG_E(LogTag, "Requested rendition " + QString::number(videoMsg.rendition) + " is out of range");
+            return;
+        }
+        if (!_clientAddresses.contains(SORO_NET_FIRST_VIDEO_PORT + videoMsg.getStreamIndex()))
+        {
+            // No handshake has been received for this video port
+            LOG_E(LogTag, "No destination address available for this video port, cannot stream");
+            NotificationMessage notifyMsg;
+            notifyMsg.level = NotificationMessage::Level_Error;
+            notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
+            notifyMsg.message = "Video client has not yet given this server an address for this stream";
+            _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+            return;
+        }
 
-            if (!_clientAddresses.contains(SORO_NET_FIRST_VIDEO_PORT + videoMsg.camera_index))
-            {
-                // No handshake has been received for this video port
-                LOG_E(LogTag, "No destination address available for this video port, cannot stream");
-                NotificationMessage notifyMsg;
-                notifyMsg.level = NotificationMessage::Level_Error;
-                notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
-                notifyMsg.message = "Video client has not yet given this server an address for this stream";
-                _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
-                return;
-            }
+        QString cameraDevice = _cameraIndex->find(videoMsg.camera_vendorId,
+                                                  videoMsg.camera_productId,
+                                                  videoMsg.camera_serial,
+                                                  videoMsg.camera_offset);
+        if (cameraDevice.isEmpty())
+        {
+            // This camera wasn't found on our computer. Notify mission control
+            LOG_E(LogTag, "Requested camera definition does not exist on this computer");
+            NotificationMessage notifyMsg;
+            notifyMsg.level = NotificationMessage::Level_Error;
+            notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
+            notifyMsg.message = "The definition for this camera does not match any cameras connected to this server.";
+            _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+            return;
+        }
 
-            QString cameraDevice = findUsbCamera(videoMsg.camera_serial,
-                                                 videoMsg.camera_productId,
-                                                 videoMsg.camera_vendorId,
-                                                 videoMsg.camera_offset);
-            if (cameraDevice.isEmpty())
+        if (videoMsg.rendition > 0)
+        {
+            onRenditionRequest(videoMsg, cameraDevice);
+            return;
+        }
+
+        Assignment assignment;
+        assignment.device = cameraDevice;
+        assignment.vaapi = _useVaapi.value(videoMsg.profile.codec);
+        assignment.address = _clientAddresses.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.camera_index);
+        assignment.port = _clientPorts.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.camera_index);
+        assignment.message = videoMsg;
+        _requestTimers[assignment.device].start();
+
+        if (videoMsg.isStereo)
+        {
+            QString cameraDevice2 = _cameraIndex->find(videoMsg.camera_vendorId2,
+                                                       videoMsg.camera_productId2,
+                                                       videoMsg.camera_serial2,
+                                                       videoMsg.camera_offset2);
+            if (cameraDevice2.isEmpty())
             {
                 // This camera wasn't found on our computer. Notify mission control
                 LOG_E(LogTag, "Requested camera definition does not exist on this computer");
                 NotificationMessage notifyMsg;
                 notifyMsg.level = NotificationMessage::Level_Error;
                 notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
-                notifyMsg.message = "The definition for this camera does not match any cameras connected to this server.";
+                notifyMsg.message = "The definition for this camera (right channel) does not match any cameras connected to this server.";
                 _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
                 return;
             }
 
-            Assignment assignment;
-            assignment.device = cameraDevice;
-            assignment.vaapi = _useVaapi.value(videoMsg.profile.codec);
-            assignment.address = _clientAddresses.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.camera_index);
-            assignment.port = _clientPorts.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.camera_index);
-            assignment.message = videoMsg;
+            assignment.device2 = cameraDevice2;
 
-            if (videoMsg.isStereo)
-            {
-                QString cameraDevice2 = findUsbCamera(videoMsg.camera_serial2,
-                                                     videoMsg.camera_productId2,
-                                                     videoMsg.camera_vendorId2,
-                                                     videoMsg.camera_offset2);
-                if (cameraDevice2.isEmpty())
-                {
-                    // This camera wasn't found on our computer. Notify mission control
-                    LOG_E(LogTag, "Requested camera definition does not exist on this computer");
-                    NotificationMessage notifyMsg;
-                    notifyMsg.level = NotificationMessage::Level_Error;
-                    notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
-                    notifyMsg.message = "The definition for this camera (right channel) does not match any cameras connected to this server.";
-                    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
-                    return;
-                }
-
-                assignment.device2 = cameraDevice2;
-            }
+            // A stereo pipeline has no single capture to split
+            dropRenditions(assignment.device);
+        }
+        else
+        {
+            // Single cameras can often skip the CPU conversion, stereo pairs are always mixed from raw
+            // video. A capture with renditions or a recording must be decoded, so it is never passed through.
+            assignment.message.capture_path = chooseCapturePath(assignment.device, videoMsg.profile, assignment.vaapi,
+                                                                !_renditions.contains(assignment.device)
+                                                                && !_recordedDevices.contains(assignment.device));
+        }
 
-            if (!_children.contains(assignment.device))
+        if (_settings->getStreamInProcess())
+        {
+            if (!_pipelines.contains(assignment.device))
             {
-                // Spawn a new child, and queue this assignment to be executed when the child is ready
-                LOG_I(LogTag, "Spawning new child for " + assignment.device + "...");
-                QProcess *child = new QProcess(this);
-                _children.insert(assignment.device, child);
-
-                // The first argument to the process, representing the child's name, is the video device
-                // it is assigned to work on
-                child->start(SORO_ROVER_VIDEO_STREAM_PROCESS_PATH, QStringList() << assignment.device);
-
-                connect(child, static_cast<void (QProcess::*)(int)>(&QProcess::finished), this, [this, assignment](int exitCode)
-                {
-                    LOG_W(LogTag, "Child " + assignment.device + " has exited with code " + QString::number(exitCode));
-
-                    if (_childInterfaces.contains(assignment.device))
-                    {
-                        delete _childInterfaces[assignment.device];
-                        _childInterfaces.remove(assignment.device);
-                    }
-                    if (_children.contains(assignment.device))
-                    {
-                        delete _children[assignment.device];
-                        _children.remove(assignment.device);
-                    }
-
-                    if (_waitingAssignments.contains(assignment.device))
-                    {
-                        reportInactiveVideo(assignment);
-                        _waitingAssignments.remove(assignment.device);
-
-                        NotificationMessage notifyMsg;
-                        notifyMsg.level = NotificationMessage::Level_Error;
-                        notifyMsg.title = "Cannot stream " + assignment.message.camera_name;
-                        notifyMsg.message = "Unexpected error - child process died before accepting its stream assignment.";
-                        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
-
-                        reportActiveVideoStates();
-                    }
-                    if (_currentAssignments.contains(assignment.device))
-                    {
-                        reportInactiveVideo(assignment);
-                        _currentAssignments.remove(assignment.device);
-
-                        NotificationMessage notifyMsg;
-                        notifyMsg.level = NotificationMessage::Level_Error;
-                        notifyMsg.title = "Error streaming " + assignment.message.camera_name;
-                        notifyMsg.message = "Unexpected error while streaming this device. Try agian.";
-                        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
-
-                        reportActiveVideoStates();
-                    }
-                });
+                LOG_I(LogTag, "Creating new pipeline for " + assignment.device + "...");
+                createPipeline(assignment.device);
             }
+        }
+        else if (!_children.contains(assignment.device))
+        {
+            // Spawn a new child, and queue this assignment to be executed when the child is ready
+            startChild(assignment.device);
+        }
 
-            if(_waitingAssignments.contains(assignment.device))
-            {
-                reportInactiveVideo(assignment);
-                _waitingAssignments.remove(assignment.device);
-            }
-            if (_currentAssignments.contains(assignment.device))
+        if(_waitingAssignments.contains(assignment.device))
+        {
+            reportInactiveVideo(assignment);
+            _waitingAssignments.remove(assignment.device);
+        }
+        if (_currentAssignments.contains(assignment.device))
+        {
+            // The same camera's state is replaced below, and its stream may be reconfigured without stopping
+            if (_currentAssignments.value(assignment.device).message.camera_index != assignment.message.camera_index)
             {
-                reportInactiveVideo(assignment);
-                _currentAssignments.remove(assignment.device);
+                reportInactiveVideo(_currentAssignments.value(assignment.device));
             }
+            _currentAssignments.remove(assignment.device);
+        }
 
-            if (_childInterfaces.contains(assignment.device))
-            {
-                // Child for this device is running and can accept assignments
-                giveChildAssignment(assignment);
-                _currentAssignments.insert(assignment.device, assignment);
-                reportActiveVideoStates();
-            }
-            else
-            {
-                // There exits a process for this device, however it is still starting up
-                // and may have a previous assignment queued for it. Queue this assignment
-                _waitingAssignments.insert(assignment.device, assignment);
-            }
+        if (isChildReady(assignment.device))
+        {
+            // Child for this device is running and can accept assignments
+            giveChildAssignment(assignment);
+            _currentAssignments.insert(assignment.device, assignment);
+            reportActiveVideoStates();
         }
         else
         {
-            LOG_I(LogTag, "Received video request, but it's for a different server");
+            // There exits a process for this device, however it is still starting up
+            // and may have a previous assignment queued for it. Queue this assignment
+            _waitingAssignments.insert(assignment.device, assignment);
         }
     }
-    else if (msg.topic() == "system_down")
+    else
+    {
+        LOG_I(LogTag, "Received video request, but it's for a different server");
+    }
+}
+
+void VideoServer::onSystemDown(const QMQTT::Message &msg)
+{
+    QString clientID(msg.payload());
+    if (clientID == "master_video_client") // Master video client is down, stop all video streams
     {
-        QString clientID(msg.payload());
-        if (clientID == "master_video_client") // Master video client is down, stop all video streams
+        Logger::logWarn(LogTag, "Master video client has disconnected, stopping all video streams");
+        _waitingAssignments.clear();
+        for (QString device : _renditions.keys())
         {
-            Logger::logWarn(LogTag, "Master video client has disconnected, stopping all video streams");
-            _waitingAssignments.clear();
-            for (QString device : _currentAssignments.keys())
+            for (Assignment assignment : _renditions.value(device))
             {
-                _currentAssignments[device].message.profile.codec = GStreamerUtil::CODEC_NULL;
-                giveChildAssignment(_currentAssignments[device]);
+                assignment.message.profile.codec = GStreamerUtil::CODEC_NULL;
+                giveRendition(assignment);
             }
-
-            reportActiveVideoStates();
         }
+        for (QString device : _currentAssignments.keys())
+        {
+            _currentAssignments[device].message.profile.codec = GStreamerUtil::CODEC_NULL;
+            giveChildAssignment(_currentAssignments[device]);
+        }
+
+        reportActiveVideoStates();
     }
 }
 
@@ -328,6 +386,118 @@ VideoServer::~VideoServer()
             terminateChild(childName);
         }
     }
+
+    // Stop the worker threads, then free their pipelines from here
+    for (VideoPipeline *pipeline : _pipelines)
+    {
+        disconnect(pipeline, nullptr, this, nullptr);
+    }
+    for (QThread *thread : _workerThreads)
+    {
+        thread->quit();
+        thread->wait();
+    }
+    qDeleteAll(_pipelines);
+}
+
+void VideoServer::startChild(QString device)
+{
+    LOG_I(LogTag, "Spawning new child for " + device + "...");
+    QProcess *child = new QProcess(this);
+    _children.insert(device, child);
+
+    // The first argument to the process, representing the child's name, is the video device
+    // it is assigned to work on
+    child->start(SORO_ROVER_VIDEO_STREAM_PROCESS_PATH, QStringList() << device);
+
+    connect(child, static_cast<void (QProcess::*)(int)>(&QProcess::finished), this, [this, device](int exitCode)
+    {
+        LOG_W(LogTag, "Child " + device + " has exited with code " + QString::number(exitCode));
+
+        if (_childInterfaces.contains(device))
+        {
+            delete _childInterfaces[device];
+            _childInterfaces.remove(device);
+        }
+        if (_children.contains(device))
+        {
+            delete _children[device];
+            _children.remove(device);
+        }
+        _warmDevices.remove(device);
+        dropRenditions(device);
+
+        if (_waitingAssignments.contains(device))
+        {
+            Assignment assignment = _waitingAssignments.take(device);
+            reportInactiveVideo(assignment);
+
+            NotificationMessage notifyMsg;
+            notifyMsg.level = NotificationMessage::Level_Error;
+            notifyMsg.title = "Cannot stream " + assignment.message.camera_name;
+            notifyMsg.message = "Unexpected error - child process died before accepting its stream assignment.";
+            _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+
+            reportActiveVideoStates();
+        }
+        if (_currentAssignments.contains(device))
+        {
+            Assignment assignment = _currentAssignments.take(device);
+            reportInactiveVideo(assignment);
+
+            NotificationMessage notifyMsg;
+            notifyMsg.level = NotificationMessage::Level_Error;
+            notifyMsg.title = "Error streaming " + assignment.message.camera_name;
+            notifyMsg.message = "Unexpected error while streaming this device. Try agian.";
+            _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+
+            reportActiveVideoStates();
+        }
+    });
+}
+
+void VideoServer::createPipeline(QString device)
+{
+    VideoPipeline *pipeline = new VideoPipeline;
+    pipeline->moveToThread(_workerThreads[_nextWorkerThread]);
+    _nextWorkerThread = (_nextWorkerThread + 1) % _workerThreads.size();
+
+    // Report the same way a child process would over D-Bus
+    connect(pipeline, &VideoPipeline::logInfo, this, [this, device](const QString &tag, const QString &message)
+    {
+        onChildLogInfo(device, tag, message);
+    });
+    connect(pipeline, &VideoPipeline::streaming, this, [this, device]()
+    {
+        onChildStreaming(device);
+    });
+    connect(pipeline, &VideoPipeline::error, this, [this, device](const QString &message)
+    {
+        onChildError(device, message);
+    });
+    connect(pipeline, &VideoPipeline::reconfigured, this, [this, device](const QString &method, int latencyMs)
+    {
+        onChildReconfigured(device, method, latencyMs);
+    });
+    connect(pipeline, &VideoPipeline::stereoSkew, this, [this, device](int averageUs, int maxUs)
+    {
+        onChildStereoSkew(device, averageUs, maxUs);
+    });
+    connect(pipeline, &VideoPipeline::recordingSegment, this, [this, device](const QString &location, qint64 startMs, qint64 endMs)
+    {
+        onChildRecordingSegment(device, location, startMs, endMs);
+    });
+    connect(pipeline, &VideoPipeline::stopped, this, [this, device]()
+    {
+        onChildReady(device);
+    });
+
+    _pipelines.insert(device, pipeline);
+}
+
+bool VideoServer::isChildReady(QString childName) const
+{
+    return _pipelines.contains(childName) || _childInterfaces.contains(childName);
 }
 
 void VideoServer::terminateChild(QString childName)
@@ -342,87 +512,446 @@ void VideoServer::terminateChild(QString childName)
     }
 }
 
-QString VideoServer::findUsbCamera(QString serial, QString productId, QString vendorId, int offset)
+void VideoServer::timerEvent(QTimerEvent *e)
 {
-    // Search for all /dev/video* devices
+    if (e->timerId() == _heartbeatTimerId)
+    {
+        for (QDBusInterface* interface : _childInterfaces)
+        {
+            interface->call(QDBus::NoBlock, "heartbeat");
+        }
+    }
+    else if (e->timerId() == _warmBudgetTimerId)
+    {
+        checkWarmBudget();
+    }
+}
 
-    QDir dev("/dev");
-    QStringList allFiles = dev.entryList(QDir::NoDotAndDotDot | QDir::System | QDir::Files);
+void VideoServer::startWarmCameras()
+{
+    // Recorded cameras are kept warm too, recording branches from the capture of a running pipeline
+    QList<int> warmCameras = _settings->getWarmCameras();
+    QList<int> recordCameras = _recordingStore ? _settings->getRecordCameras() : QList<int>();
+    for (int index : recordCameras)
+    {
+        if (!warmCameras.contains(index)) warmCameras.append(index);
+    }
+    if (warmCameras.isEmpty()) return;
 
-    for (QString file : allFiles)
+    // The camera definitions are only needed to find the warm cameras before anyone requests them
+    CameraSettingsModel cameraSettings;
+    try
+    {
+        cameraSettings.load();
+    }
+    catch (QString err)
     {
-        if (file.contains("video"))
+        LOG_W(LogTag, "Cannot keep cameras warm, camera settings could not be loaded: " + err);
+        return;
+    }
+
+    GStreamerUtil::VideoProfile profile = _settings->getWarmProfile();
+    for (int index : warmCameras)
+    {
+        if (index >= cameraSettings.getCameraCount())
         {
-            // Found a new dev device
-            QString device = "/dev/" + file;
+            LOG_W(LogTag, "Camera " + QString::number(index) + " cannot be kept warm or recorded, it is not defined");
+            continue;
+        }
 
-            // Use udevadm to get info about each /dev/video* device
-            QProcess udevadm;
-            udevadm.start("udevadm info -a -n " + device);
-            udevadm.waitForFinished();
-            QString udevadmOutput = QString(udevadm.readAllStandardOutput());
+        CameraSettingsModel::Camera camera = cameraSettings.getCamera(index);
+        if (camera.computerIndex != (int)_settings->getComputerIndex()) continue;
+        if (camera.isStereo)
+        {
+            LOG_W(LogTag, "Camera " + QString::number(index) + " cannot be kept warm or recorded, stereo cameras are not supported");
+            continue;
+        }
 
-            QLatin1String vendorToken("{idVendor}==\"");
-            int vendorIndex = udevadmOutput.indexOf(vendorToken);
-            if (vendorIndex >= 0)
-            {
-                vendorIndex += vendorToken.size();
-                QString candidateVendor = udevadmOutput.mid(vendorIndex, udevadmOutput.indexOf("\"", vendorIndex) - vendorIndex);
-                if (candidateVendor.trimmed() != vendorId.trimmed()) continue;
-            }
+        QString device = _cameraIndex->find(camera.vendorId, camera.productId, camera.serial, camera.offset);
+        if (device.isEmpty())
+        {
+            LOG_W(LogTag, "Camera " + QString::number(index) + " cannot be kept warm or recorded, it is not connected");
+            continue;
+        }
 
-            QLatin1String productToken("{idProduct}==\"");
-            int productIndex = udevadmOutput.indexOf(productToken);
-            if (productIndex >= 0)
-            {
-                productIndex += productToken.size();
-                QString candidateProductId = udevadmOutput.mid(productIndex, udevadmOutput.indexOf("\"", productIndex) - productIndex);
-                if (candidateProductId.trimmed() != productId.trimmed()) continue;
-            }
+        if (recordCameras.contains(index))
+        {
+            _recordedDevices.insert(device, index);
+        }
 
-            QLatin1String serialToken("{serial}==\"");
-            int serialIndex = udevadmOutput.indexOf(serialToken);
-            if (serialIndex >= 0)
-            {
-                serialIndex += serialToken.size();
-                QString candidateSerial = udevadmOutput.mid(serialIndex, udevadmOutput.indexOf("\"", serialIndex) - serialIndex);
-                if (candidateSerial.trimmed() != serial.trimmed()) continue;
-            }
+        Assignment assignment;
+        assignment.device = device;
+        assignment.message = VideoMessage(index, camera);
+        assignment.message.profile = profile;
+        assignment.vaapi = _useVaapi.value(profile.codec);
+        // A recorded capture must be decoded, so it is never passed through
+        assignment.message.capture_path = chooseCapturePath(device, profile, assignment.vaapi, !_recordedDevices.contains(device));
+        _warmAssignments.insert(device, assignment);
+
+        if (_settings->getStreamInProcess())
+        {
+            createPipeline(device);
+            warmChild(device);
+        }
+        else
+        {
+            // Warmed once the child is ready
+            startChild(device);
+        }
+    }
+
+    LOG_I(LogTag, QString("Keeping %1 cameras warm within %2 MB and %3% CPU, %4 of them are recorded")
+          .arg(QString::number(_warmAssignments.size()),
+               QString::number(_settings->getWarmMemoryBudgetMb()),
+               QString::number(_settings->getWarmCpuBudgetPercent()),
+               QString::number(_recordedDevices.size())));
+    _cpuTimer.start();
+    _warmBudgetTimerId = startTimer(10000);
+}
 
-            // Found a matching camera
+void VideoServer::warmChild(QString childName)
+{
+    Assignment assignment = _warmAssignments.value(childName);
+    LOG_I(LogTag, "Warming " + childName + " for camera " + QString::number(assignment.message.camera_index));
+    _warmDevices.insert(childName);
 
-            if (offset > 0)
-            {
-                offset--;
-                continue;
-            }
+    if (_pipelines.contains(childName))
+    {
+        QMetaObject::invokeMethod(_pipelines[childName], "warm", Qt::QueuedConnection,
+                                  Q_ARG(QString, assignment.device),
+                                  Q_ARG(int, SORO_NET_FIRST_VIDEO_PORT + assignment.message.camera_index),
+                                  Q_ARG(QString, assignment.message.profile.toString()),
+                                  Q_ARG(bool, assignment.vaapi),
+                                  Q_ARG(int, assignment.message.capture_path));
+    }
+    else if (_childInterfaces.contains(childName))
+    {
+        _childInterfaces[childName]->call(
+                    QDBus::NoBlock,
+                    "warm",
+                    assignment.device,
+                    SORO_NET_FIRST_VIDEO_PORT + assignment.message.camera_index,
+                    assignment.message.profile.toString(),
+                    assignment.vaapi,
+                    (int)assignment.message.capture_path);
+    }
+
+    // The pipeline keeps recording through any later streams, but a new child has to be told again
+    if (_recordedDevices.contains(childName))
+    {
+        startRecording(childName);
+    }
+}
+
+void VideoServer::startRecording(QString childName)
+{
+    GStreamerUtil::VideoProfile profile = _settings->getRecordProfile();
+    QString locationPrefix = _recordingStore->getLocationPrefix(_recordedDevices.value(childName));
+    bool vaapi = _useVaapi.value(profile.codec);
+    LOG_I(LogTag, "Recording " + childName + " to " + locationPrefix + " with profile " + profile.toString());
+
+    if (_pipelines.contains(childName))
+    {
+        QMetaObject::invokeMethod(_pipelines[childName], "startRecording", Qt::QueuedConnection,
+                                  Q_ARG(QString, locationPrefix),
+                                  Q_ARG(QString, profile.toString()),
+                                  Q_ARG(bool, vaapi),
+                                  Q_ARG(int, (int)_settings->getRecordSegmentSeconds()));
+    }
+    else if (_childInterfaces.contains(childName))
+    {
+        _childInterfaces[childName]->call(
+                    QDBus::NoBlock,
+                    "startRecording",
+                    locationPrefix,
+                    profile.toString(),
+                    vaapi,
+                    (int)_settings->getRecordSegmentSeconds());
+    }
+}
 
-            return file;
+void VideoServer::checkWarmBudget()
+{
+    qint64 memoryMb = getResidentMemoryKb() / 1024;
+    int cpuPercent = getCpuPercent();
+    LOG_I(LogTag, QString("%1 cameras warm, video server is using %2 MB (budget %3 MB) and %4% CPU (budget %5%)")
+          .arg(QString::number(_warmDevices.size()),
+               QString::number(memoryMb),
+               QString::number(_settings->getWarmMemoryBudgetMb()),
+               QString::number(cpuPercent),
+               QString::number(_settings->getWarmCpuBudgetPercent())));
+
+    if (_warmDevices.isEmpty()) return;
+    if ((memoryMb <= _settings->getWarmMemoryBudgetMb()) && (cpuPercent <= (int)_settings->getWarmCpuBudgetPercent())) return;
+
+    // Over budget, let one warm camera go cold. Streams being watched always stay, and so do captures
+    // that renditions are being encoded from or that are being recorded.
+    QString device;
+    for (QString warmDevice : _warmDevices)
+    {
+        if (!_renditions.contains(warmDevice) && !_recordedDevices.contains(warmDevice))
+        {
+            device = warmDevice;
+            break;
         }
     }
-    return "";
+    if (device.isEmpty()) return;
+    Assignment assignment = _warmAssignments.value(device);
+    LOG_W(LogTag, "Over the warm camera budget, stopping " + device);
+    _warmDevices.remove(device);
+    _warmAssignments.remove(device);
+    assignment.message.profile.codec = GStreamerUtil::CODEC_NULL;
+    giveChildAssignment(assignment);
+
+    NotificationMessage notifyMsg;
+    notifyMsg.level = NotificationMessage::Level_Warning;
+    notifyMsg.title = assignment.message.camera_name + " is no longer warm";
+    notifyMsg.message = "The video server is over its memory or CPU budget for warm cameras. This camera will take longer to start.";
+    _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
 }
 
-void VideoServer::timerEvent(QTimerEvent *e)
+quint8 VideoServer::chooseCapturePath(QString device, const GStreamerUtil::VideoProfile &profile, bool vaapi, bool passthrough)
 {
-    if (e->timerId() == _heartbeatTimerId)
+    if (!_captureFormats.contains(device))
     {
-        for (QDBusInterface* interface : _childInterfaces)
+        QList<V4L2Util::CaptureFormat> formats = V4L2Util::probe(device);
+        if (formats.isEmpty())
         {
-            interface->call(QDBus::NoBlock, "heartbeat");
+            LOG_W(LogTag, "Could not probe the formats of " + device + ", it will be captured as raw video");
+        }
+        _captureFormats.insert(device, formats);
+    }
+
+    quint8 capturePath = V4L2Util::chooseCapturePath(_captureFormats.value(device), profile, vaapi, passthrough);
+    LOG_I(LogTag, QString("Capturing %1 at %2x%3@%4 on the %5 path")
+          .arg(device,
+               QString::number(profile.width),
+               QString::number(profile.height),
+               QString::number(profile.framerate),
+               GStreamerUtil::getCapturePathName(capturePath)));
+    return capturePath;
+}
+
+void VideoServer::onRenditionRequest(const VideoMessage &videoMsg, QString device)
+{
+    Assignment assignment;
+    assignment.device = device;
+    assignment.vaapi = _useVaapi.value(videoMsg.profile.codec);
+    assignment.address = _clientAddresses.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.getStreamIndex());
+    assignment.port = _clientPorts.value(SORO_NET_FIRST_VIDEO_PORT + videoMsg.getStreamIndex());
+    assignment.message = videoMsg;
+
+    if (videoMsg.profile.codec == GStreamerUtil::CODEC_NULL)
+    {
+        if (_renditions.value(device).contains(videoMsg.rendition))
+        {
+            giveRendition(assignment);
+        }
+        reportInactiveVideo(assignment);
+        return;
+    }
+
+    QString reason;
+    if (!canAddRendition(device, reason))
+    {
+        LOG_E(LogTag, "Cannot add rendition " + QString::number(videoMsg.rendition) + " to " + device + ": " + reason);
+        NotificationMessage notifyMsg;
+        notifyMsg.level = NotificationMessage::Level_Error;
+        notifyMsg.title = "Cannot stream " + videoMsg.camera_name;
+        notifyMsg.message = reason;
+        _mqtt->publish(QMQTT::Message(_nextMqttMsgId++, "notification", notifyMsg, 2));
+        reportInactiveVideo(assignment);
+        return;
+    }
+
+    // Renditions share the capture of the main stream
+    if (_currentAssignments.contains(device))
+    {
+        assignment.message.capture_path = _currentAssignments.value(device).message.capture_path;
+    }
+    else if (_warmAssignments.contains(device))
+    {
+        assignment.message.capture_path = _warmAssignments.value(device).message.capture_path;
+    }
+
+    giveRendition(assignment);
+    reportActiveVideoStates();
+}
+
+bool VideoServer::canAddRendition(QString device, QString &reason) const
+{
+    reason = "Renditions are encoded from a running stream of a single camera. Start this camera's main stream first.";
+    if (!isChildReady(device)) return false;
+
+    // Renditions need a decoded capture of a single camera to branch from
+    Assignment capture;
+    if (_currentAssignments.contains(device) && (_currentAssignments.value(device).message.profile.codec != GStreamerUtil::CODEC_NULL))
+    {
+        capture = _currentAssignments.value(device);
+    }
+    else if (_warmDevices.contains(device))
+    {
+        capture = _warmAssignments.value(device);
+    }
+    else
+    {
+        // Standing by for the renditions it already has
+        return _renditions.contains(device);
+    }
+    if (capture.message.isStereo) return false;
+    if (capture.message.capture_path == GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH)
+    {
+        // The camera's H264 is never decoded, so there are no frames to encode another rendition from
+        reason = "This camera's main stream is the camera's own H264, which cannot be split into renditions. "
+                 "Start the main stream with another codec or resolution first.";
+        return false;
+    }
+    return true;
+}
+
+void VideoServer::giveRendition(Assignment assignment)
+{
+    quint8 rendition = assignment.message.rendition;
+    bool add = assignment.message.profile.codec != GStreamerUtil::CODEC_NULL;
+    if (add)
+    {
+        LOG_I(LogTag, QString("Encoding rendition %1 of %2 to %3:%4")
+              .arg(QString::number(rendition), assignment.device, assignment.address.toString(), QString::number(assignment.port)));
+        _renditions[assignment.device].insert(rendition, assignment);
+    }
+    else
+    {
+        LOG_I(LogTag, QString("Stopping rendition %1 of %2").arg(QString::number(rendition), assignment.device));
+        _renditions[assignment.device].remove(rendition);
+        if (_renditions[assignment.device].isEmpty())
+        {
+            _renditions.remove(assignment.device);
+        }
+    }
+
+    if (_pipelines.contains(assignment.device))
+    {
+        VideoPipeline *pipeline = _pipelines[assignment.device];
+        if (add)
+        {
+            QMetaObject::invokeMethod(pipeline, "addRendition", Qt::QueuedConnection,
+                                      Q_ARG(int, rendition),
+                                      Q_ARG(QString, assignment.address.toString()),
+                                      Q_ARG(int, assignment.port),
+                                      Q_ARG(int, SORO_NET_FIRST_VIDEO_PORT + assignment.message.getStreamIndex()),
+                                      Q_ARG(QString, assignment.message.profile.toString()),
+                                      Q_ARG(bool, assignment.vaapi));
+        }
+        else
+        {
+            QMetaObject::invokeMethod(pipeline, "removeRendition", Qt::QueuedConnection, Q_ARG(int, rendition));
+        }
+    }
+    else if (_childInterfaces.contains(assignment.device))
+    {
+        if (add)
+        {
+            _childInterfaces[assignment.device]->call(
+                        QDBus::NoBlock,
+                        "addRendition",
+                        (int)rendition,
+                        assignment.address.toString(),
+                        assignment.port,
+                        SORO_NET_FIRST_VIDEO_PORT + assignment.message.getStreamIndex(),
+                        assignment.message.profile.toString(),
+                        assignment.vaapi);
+        }
+        else
+        {
+            _childInterfaces[assignment.device]->call(QDBus::NoBlock, "removeRendition", (int)rendition);
         }
     }
+
+    // The last rendition of a capture nobody else needs lets it stop
+    if (!add && !_renditions.contains(assignment.device) && !_warmAssignments.contains(assignment.device)
+            && !_waitingAssignments.contains(assignment.device)
+            && (_currentAssignments.value(assignment.device).message.profile.codec == GStreamerUtil::CODEC_NULL))
+    {
+        assignment.message.rendition = 0;
+        giveChildAssignment(assignment);
+    }
+}
+
+void VideoServer::dropRenditions(QString device)
+{
+    for (Assignment assignment : _renditions.value(device))
+    {
+        reportInactiveVideo(assignment);
+    }
+    _renditions.remove(device);
+}
+
+void VideoServer::onCamerasChanged()
+{
+    // Nodes may now belong to different cameras, probe them again when they are next used
+    _captureFormats.clear();
 }
 
 void VideoServer::giveChildAssignment(Assignment assignment)
 {
-    if (_childInterfaces.contains(assignment.device))
+    // Warm cameras, and captures that other renditions are encoded from, keep running when their
+    // main stream is stopped
+    const char *stopMethod = "stop";
+    if (assignment.message.profile.codec == GStreamerUtil::CODEC_NULL)
+    {
+        if (_warmAssignments.contains(assignment.device) && isChildReady(assignment.device))
+        {
+            stopMethod = "standby";
+            _warmDevices.insert(assignment.device);
+        }
+        else if (_renditions.contains(assignment.device) && isChildReady(assignment.device))
+        {
+            stopMethod = "standby";
+        }
+    }
+    else
+    {
+        _warmDevices.remove(assignment.device);
+    }
+
+    if (_pipelines.contains(assignment.device))
+    {
+        // Queued, so the pipeline is built on its worker thread
+        VideoPipeline *pipeline = _pipelines[assignment.device];
+        if (assignment.message.profile.codec == GStreamerUtil::CODEC_NULL)
+        {
+            QMetaObject::invokeMethod(pipeline, stopMethod, Qt::QueuedConnection);
+        }
+        else if (assignment.message.isStereo)
+        {
+            QMetaObject::invokeMethod(pipeline, "streamStereo", Qt::QueuedConnection,
+                                      Q_ARG(QString, assignment.device),
+                                      Q_ARG(QString, assignment.device2),
+                                      Q_ARG(QString, assignment.address.toString()),
+                                      Q_ARG(int, assignment.port),
+                                      Q_ARG(int, SORO_NET_FIRST_VIDEO_PORT + assignment.message.camera_index),
+                                      Q_ARG(QString, assignment.message.profile.toString()),
+                                      Q_ARG(bool, assignment.vaapi));
+        }
+        else
+        {
+            QMetaObject::invokeMethod(pipeline, "stream", Qt::QueuedConnection,
+                                      Q_ARG(QString, assignment.device),
+                                      Q_ARG(QString, assignment.address.toString()),
+                                      Q_ARG(int, assignment.port),
+                                      Q_ARG(int, SORO_NET_FIRST_VIDEO_PORT + assignment.message.camera_index),
+                                      Q_ARG(QString, assignment.message.profile.toString()),
+                                      Q_ARG(bool, assignment.vaapi),
+                                      Q_ARG(int, assignment.message.capture_path));
+        }
+    }
+    else if (_childInterfaces.contains(assignment.device))
     {
         if (assignment.message.profile.codec == GStreamerUtil::CODEC_NULL)
         {
             _childInterfaces[assignment.device]->call(
                         QDBus::NoBlock,
-                        "stop");
+                        stopMethod);
 
         }
         else if (assignment.message.isStereo)
@@ -448,7 +977,8 @@ void VideoServer::giveChildAssignment(Assignment assignment)
                         assignment.port,
                         SORO_NET_FIRST_VIDEO_PORT + assignment.message.camera_index,
                         assignment.message.profile.toString(),
-                        assignment.vaapi);
+                        assignment.vaapi,
+                        (int)assignment.message.capture_path);
         }
     }
 }
@@ -462,7 +992,11 @@ void VideoServer::onChildReady(QString childName)
 {
     LOG_I(LogTag, "Child " + childName + " is ready to accept an assignment");
 
-    if (!_childInterfaces.contains(childName))
+    if (_pipelines.contains(childName))
+    {
+        // In-process pipelines need no D-Bus interface
+    }
+    else if (!_childInterfaces.contains(childName))
     {
         // Open a D-Bus interface to this child
         LOG_I(LogTag, "Opening D-Bus interface to child " + childName);
@@ -474,7 +1008,7 @@ void VideoServer::onChildReady(QString childName)
                                     this));
     }
 
-    if (!_childInterfaces[childName]->isValid())
+    if (!_pipelines.contains(childName) && !_childInterfaces[childName]->isValid())
     {
         LOG_E(LogTag, "Cannot create D-Bus connection to child " + childName + " even though it has a D-Bus conneciton to us");
         terminateChild(childName);
@@ -506,6 +1040,10 @@ void VideoServer::onChildReady(QString childName)
         _currentAssignments.insert(childName, _waitingAssignments.value(childName));
         _waitingAssignments.remove(childName);
     }
+    else if (_warmAssignments.contains(childName) && !_warmDevices.contains(childName))
+    {
+        warmChild(childName);
+    }
 
     reportActiveVideoStates();
 }
@@ -515,10 +1053,15 @@ void VideoServer::reportActiveVideoStates()
     LOG_I(LogTag, "Reporting video state through MQTT...");
 
     // Add all video state messages from this computer
-    for (Assignment videoAssignment : _currentAssignments.values())
+    QList<Assignment> assignments = _currentAssignments.values();
+    for (const QHash<quint8, Assignment> &renditions : _renditions)
+    {
+        assignments += renditions.values();
+    }
+    for (Assignment videoAssignment : assignments)
     {
         _mqtt->publish(QMQTT::Message(_nextMqttMsgId++,
-                                      "video_state_" + QString::number(videoAssignment.message.camera_index),
+                                      "video_state_" + QString::number(videoAssignment.message.getStreamIndex()),
                                       videoAssignment.message,
                                       2,
                                       true)); // <-- Retain message
@@ -531,7 +1074,7 @@ void VideoServer::reportInactiveVideo(Assignment oldAssignment)
     oldAssignment.message.profile.codec = GStreamerUtil::CODEC_NULL;
 
     _mqtt->publish(QMQTT::Message(_nextMqttMsgId++,
-                                  "video_state_" + QString::number(oldAssignment.message.camera_index),
+                                  "video_state_" + QString::number(oldAssignment.message.getStreamIndex()),
                                   oldAssignment.message,
                                   2,
                                   true)); // <-- Retain message
@@ -540,6 +1083,17 @@ void VideoServer::reportInactiveVideo(Assignment oldAssignment)
 void VideoServer::onChildError(QString childName, QString message)
 {
     LOG_E(LogTag, "Child " + childName + " reports an error: " + message);
+    if (_warmDevices.contains(childName))
+    {
+        // Don't keep retrying a camera that fails while nobody is watching it
+        LOG_W(LogTag, "No longer keeping " + childName + " warm");
+        if (_recordedDevices.contains(childName))
+        {
+            LOG_E(LogTag, "Recording of " + childName + " has stopped, it resumes if the camera is streamed again");
+        }
+        _warmDevices.remove(childName);
+        _warmAssignments.remove(childName);
+    }
     if (_currentAssignments.contains(childName))
     {
         // Send a message on the notification topic
@@ -552,11 +1106,115 @@ void VideoServer::onChildError(QString childName, QString message)
         reportInactiveVideo(_currentAssignments.value(childName));
         _currentAssignments.remove(childName);
     }
+
+    // The capture is gone, and every rendition with it
+    dropRenditions(childName);
 }
 
 void VideoServer::onChildStreaming(QString childName)
 {
     LOG_I(LogTag, "Child " + childName + " has started streaming");
+
+    if (_requestTimers.contains(childName))
+    {
+        // Log startup cost so the in-process and child process modes can be compared
+        LOG_I(LogTag, QString("Stream for %1 started %2 ms after its request (%3 mode), %4 KB resident")
+              .arg(childName)
+              .arg(_requestTimers.value(childName).elapsed())
+              .arg(_settings->getStreamInProcess() ? "in-process" : "child process")
+              .arg(getResidentMemoryKb()));
+        _requestTimers.remove(childName);
+    }
+}
+
+void VideoServer::onChildReconfigured(QString childName, const QString &method, int latencyMs)
+{
+    QString message = QString("Child %1 applied its new profile by %2 in %3 ms")
+            .arg(childName, method, QString::number(latencyMs));
+    if (_requestTimers.contains(childName))
+    {
+        message += QString(", %1 ms after its request").arg(_requestTimers.value(childName).elapsed());
+        _requestTimers.remove(childName);
+    }
+    LOG_I(LogTag, message);
+}
+
+void VideoServer::onChildStereoSkew(QString childName, int averageUs, int maxUs)
+{
+    QString message = QString("Child %1 stereo eyes are %2 us apart on average, %3 us at most")
+            .arg(childName, QString::number(averageUs), QString::number(maxUs));
+
+    // Skew is at most half a frame, past a quarter frame the cameras are noticeably out of step
+    Assignment assignment = _currentAssignments.value(childName);
+    if (maxUs > 250000 / qMax<int>(assignment.message.profile.framerate, 1))
+    {
+        LOG_W(LogTag, message);
+    }
+    else
+    {
+        LOG_I(LogTag, message);
+    }
+}
+
+void VideoServer::onChildRecordingSegment(QString childName, const QString &location, qint64 startMs, qint64 endMs)
+{
+    LOG_I(LogTag, QString("Child %1 finished recording %2 (%3 s)")
+          .arg(childName, location, QString::number((endMs - startMs) / 1000)));
+    if (_recordingStore)
+    {
+        _recordingStore->onSegmentComplete(location, startMs, endMs);
+    }
+}
+
+QList<qint64> VideoServer::getProcessIds() const
+{
+    QList<qint64> pids;
+    pids.append(QCoreApplication::applicationPid());
+    for (QProcess *child : _children)
+    {
+        if (child->state() == QProcess::Running) pids.append(child->processId());
+    }
+    return pids;
+}
+
+qint64 VideoServer::getResidentMemoryKb() const
+{
+    // Resident size of this process and all of its children, from /proc/<pid>/statm
+    qint64 pages = 0;
+    for (qint64 pid : getProcessIds())
+    {
+        QFile statm(QString("/proc/%1/statm").arg(pid));
+        if (statm.open(QIODevice::ReadOnly))
+        {
+            QList<QByteArray> fields = statm.readAll().split(' ');
+            if (fields.size() > 1) pages += fields[1].toLongLong();
+        }
+    }
+    return pages * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+int VideoServer::getCpuPercent()
+{
+    // CPU time of this process and all of its children since the last call, from /proc/<pid>/stat,
+    // as a percentage of one core. Children that exited in between are not counted.
+    qint64 ticks = 0;
+    for (qint64 pid : getProcessIds())
+    {
+        QFile stat(QString("/proc/%1/stat").arg(pid));
+        if (stat.open(QIODevice::ReadOnly))
+        {
+            // The command name may contain spaces, fields are counted from after it
+            QByteArray contents = stat.readAll();
+            QList<QByteArray> fields = contents.mid(contents.lastIndexOf(')') + 2).split(' ');
+            if (fields.size() > 12) ticks += fields[11].toLongLong() + fields[12].toLongLong(); // utime and stime
+        }
+    }
+
+    qint64 elapsed = _cpuTimer.restart();
+    qint64 used = qMax<qint64>(ticks - _lastCpuTicks, 0);
+    _lastCpuTicks = ticks;
+    if (elapsed <= 0) return 0;
+    return used * 1000 * 100 / (sysconf(_SC_CLK_TCK) * elapsed);
 }
 
 } // namespace Soro
@@ -6,13 +6,21 @@
 #include <QtDBus>
 #include <QHostAddress>
 #include <QUdpSocket>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include "qmqtt/qmqtt.h"
 
 #include "settingsmodel.h"
+#include "usbcameraindex.h"
+#include "recordingstore.h"
+#include "recordinguploader.h"
 #include "soro_core/videomessage.h"
 #include "soro_core/videostatemessage.h"
 #include "soro_core/gstreamerutil.h"
+#include "soro_video/videopipeline.h"
+#include "soro_core/v4l2util.h"
+#include "soro_core/camerasettingsmodel.h"
 
 namespace Soro {
 
@@ -27,6 +35,9 @@ public Q_SLOTS:
     void onChildError(QString childName, QString message);
     void onChildReady(QString childName);
     void onChildStreaming(QString childName);
+    void onChildReconfigured(QString childName, const QString &method, int latencyMs);
+    void onChildStereoSkew(QString childName, int averageUs, int maxUs);
+    void onChildRecordingSegment(QString childName, const QString &location, qint64 startMs, qint64 endMs);
     void onChildLogInfo(QString childName, const QString &tag, const QString &message);
 
 Q_SIGNALS:
@@ -37,9 +48,9 @@ protected:
     void timerEvent(QTimerEvent *e);
 
 private Q_SLOTS:
+    void onCamerasChanged();
     void onMqttConnected();
     void onMqttDisconnected();
-    void onMqttMessage(const QMQTT::Message &msg);
 
 private:
     struct Assignment
@@ -54,14 +65,32 @@ private:
         Assignment();
     };
 
+    void onVideoRequest(const VideoMessage &videoMsg);
+    void onSystemDown(const QMQTT::Message &msg);
+    void startChild(QString device);
+    void createPipeline(QString device);
+    bool isChildReady(QString childName) const;
     void giveChildAssignment(Assignment assignment);
     void terminateChild(QString childName);
     void reportActiveVideoStates();
     void reportInactiveVideo(Assignment oldAssignment);
-
-    QString findUsbCamera(QString serial, QString productId, QString vendorId, int offset);
+    void startWarmCameras();
+    void warmChild(QString childName);
+    void checkWarmBudget();
+    void startRecording(QString childName);
+    quint8 chooseCapturePath(QString device, const GStreamerUtil::VideoProfile &profile, bool vaapi, bool passthrough=true);
+    void onRenditionRequest(const VideoMessage &videoMsg, QString device);
+    // Returns false with the reason shown to the operator if no rendition can be added to the device's capture
+    bool canAddRendition(QString device, QString &reason) const;
+    void giveRendition(Assignment assignment);
+    void dropRenditions(QString device);
+
+    QList<qint64> getProcessIds() const;
+    qint64 getResidentMemoryKb() const;
+    int getCpuPercent();
 
     const SettingsModel *_settings;
+    UsbCameraIndex *_cameraIndex;
     int _heartbeatTimerId;
     quint16 _nextMqttMsgId;
 
@@ -79,7 +108,36 @@ private:
     QHash<quint16, quint16> _clientPorts;
     QHash<quint8, bool> _useVaapi;
 
+    // Formats each camera device can capture in, probed when it is first streamed
+    QHash<QString, QList<V4L2Util::CaptureFormat>> _captureFormats;
+
+    // When streaming in-process, each device has a pipeline instead of a child process.
+    // The pipelines are spread over a pool of worker threads.
+    QHash<QString, VideoPipeline*> _pipelines;
+    QVector<QThread*> _workerThreads;
+    int _nextWorkerThread;
+
+    // Extra renditions being encoded from each device's capture, keyed by device and then rendition.
+    // A device's capture keeps running while it has any, even if its main stream is stopped.
+    QHash<QString, QHash<quint8, Assignment>> _renditions;
+
+    // Time since each device's latest video request, to measure stream startup
+    QHash<QString, QElapsedTimer> _requestTimers;
+
+    // Cameras to keep warm, keyed by device, and those currently warm and not streaming
+    QHash<QString, Assignment> _warmAssignments;
+    QSet<QString> _warmDevices;
+    int _warmBudgetTimerId;
+    QElapsedTimer _cpuTimer;
+    qint64 _lastCpuTicks;
+
+    // Index of the camera each recorded device is, recorded devices are always kept warm
+    QHash<QString, int> _recordedDevices;
+    RecordingStore *_recordingStore;
+    RecordingUploader *_recordingUploader;
+
     QMQTT::Client *_mqtt;
+    QMQTT::TopicDispatcher _mqttDispatcher;
 
 };
 
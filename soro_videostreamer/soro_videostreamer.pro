@@ -30,5 +30,5 @@ INCLUDEPATH += $$PWD/..
 #Link Qt5GStreamer
 LIBS += -lQt5GStreamer-1.0 -lQt5GLib-2.0
 
-# Link against soro_core
-LIBS += -L../lib -lsoro_core
+# Link against soro_core and soro_video
+LIBS += -L../lib -lsoro_core -lsoro_video
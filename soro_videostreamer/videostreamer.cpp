@@ -15,12 +15,9 @@
  */
 
 #include "videostreamer.h"
-#include "soro_core/gstreamerutil.h"
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
 
-#include <Qt5GStreamer/QGlib/Connect>
-#include <Qt5GStreamer/QGst/Bus>
 #include <QTimer>
 
 #define LogTag "VideoStreamer"
@@ -52,13 +49,46 @@ VideoStreamer::VideoStreamer(QString streamName, QObject *parent) : QObject(pare
     }
 
     _name = streamName;
+
+    // Forward everything the pipeline reports to the parent process
+    _pipeline = new VideoPipeline(this);
+    connect(_pipeline, &VideoPipeline::logInfo, this, [this](const QString &tag, const QString &message)
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildLogInfo", _name, tag, message);
+    });
+    connect(_pipeline, &VideoPipeline::streaming, this, [this]()
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildStreaming", _name);
+    });
+    connect(_pipeline, &VideoPipeline::error, this, [this](const QString &message)
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildError", _name, message);
+    });
+    connect(_pipeline, &VideoPipeline::reconfigured, this, [this](const QString &method, int latencyMs)
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildReconfigured", _name, method, latencyMs);
+    });
+    connect(_pipeline, &VideoPipeline::stereoSkew, this, [this](int averageUs, int maxUs)
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildStereoSkew", _name, averageUs, maxUs);
+    });
+    connect(_pipeline, &VideoPipeline::recordingSegment, this, [this](const QString &location, qint64 startMs, qint64 endMs)
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildRecordingSegment", _name, location, startMs, endMs);
+    });
+    connect(_pipeline, &VideoPipeline::stopped, this, [this]()
+    {
+        _parentInterface->call(QDBus::NoBlock, "onChildReady", _name);
+    });
+
     _watchdogTimerId = startTimer(3000);
     _parentInterface->call(QDBus::NoBlock, "onChildReady", _name);
 }
 
 VideoStreamer::~VideoStreamer()
 {
-    stopPrivate(false);
+    // Stop without telling the parent we're ready for another stream
+    delete _pipeline;
     if (_parentInterface)
     {
         delete _parentInterface;
@@ -67,58 +97,47 @@ VideoStreamer::~VideoStreamer()
 
 void VideoStreamer::stop()
 {
-    stopPrivate(true);
+    _pipeline->stop();
 }
 
-void VideoStreamer::stopPrivate(bool sendReady)
+void VideoStreamer::stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi, int capturePath)
 {
-    if (_pipeline)
-    {
-        _parentInterface->call(QDBus::NoBlock, "onChildLogInfo", _name, LogTag, "Freeing pipeline");
-        QGlib::disconnect(_pipeline->bus(), "message", this, &VideoStreamer::onBusMessage);
-        _pipeline->setState(QGst::StateNull);
-        _pipeline.clear();
-        if (sendReady)
-        {
-            _parentInterface->call(QDBus::NoBlock, "onChildReady", _name);
-        }
-    }
+    _pipeline->stream(device, address, port, bindPort, profile, vaapi, capturePath);
 }
 
-void VideoStreamer::stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
+void VideoStreamer::streamStereo(const QString &leftDevice, const QString &rightDevice, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
 {
-    stopPrivate(false);
-
-    _pipeline = createPipeline();
-
-    // create gstreamer command
-    QString binStr = GStreamerUtil::createRtpV4L2EncodeString(device, bindPort, QHostAddress(address), port, GStreamerUtil::VideoProfile(profile), vaapi);
-    _parentInterface->call(QDBus::NoBlock, "onChildLogInfo", _name, LogTag, "Starting GStreamer with command " + binStr);
-
-    QGst::BinPtr encoder = QGst::Bin::fromDescription(binStr);
-
-    _pipeline->add(encoder);
-    _pipeline->setState(QGst::StatePlaying);
-
-    _parentInterface->call(QDBus::NoBlock, "onChildStreaming", _name);
+    _pipeline->streamStereo(leftDevice, rightDevice, address, port, bindPort, profile, vaapi);
 }
 
-void VideoStreamer::streamStereo(const QString &leftDevice, const QString &rightDevice, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
+void VideoStreamer::warm(const QString &device, int bindPort, const QString &profile, bool vaapi, int capturePath)
 {
-    stopPrivate(false);
+    _pipeline->warm(device, bindPort, profile, vaapi, capturePath);
+}
 
-    _pipeline = createPipeline();
+void VideoStreamer::standby()
+{
+    _pipeline->standby();
+}
 
-    // create gstreamer command
-    QString binStr = GStreamerUtil::createRtpStereoV4L2EncodeString(leftDevice, rightDevice, bindPort, QHostAddress(address), port, GStreamerUtil::VideoProfile(profile), vaapi);
-    _parentInterface->call(QDBus::NoBlock, "onChildLogInfo", _name, LogTag, "Starting GStreamer with command " + binStr);
+void VideoStreamer::addRendition(int rendition, const QString &address, int port, int bindPort, const QString &profile, bool vaapi)
+{
+    _pipeline->addRendition(rendition, address, port, bindPort, profile, vaapi);
+}
 
-    QGst::BinPtr encoder = QGst::Bin::fromDescription(binStr);
+void VideoStreamer::removeRendition(int rendition)
+{
+    _pipeline->removeRendition(rendition);
+}
 
-    _pipeline->add(encoder);
-    _pipeline->setState(QGst::StatePlaying);
+void VideoStreamer::startRecording(const QString &locationPrefix, const QString &profile, bool vaapi, int segmentSeconds)
+{
+    _pipeline->startRecording(locationPrefix, profile, vaapi, segmentSeconds);
+}
 
-    _parentInterface->call(QDBus::NoBlock, "onChildStreaming", _name);
+void VideoStreamer::stopRecording()
+{
+    _pipeline->stopRecording();
 }
 
 void VideoStreamer::heartbeat()
@@ -131,39 +150,11 @@ void VideoStreamer::timerEvent(QTimerEvent *e)
 {
     if (e->timerId() == _watchdogTimerId)
     {
-        stopPrivate(false);
+        delete _pipeline;
+        _pipeline = nullptr;
         LOG_E(LogTag, "Watchdog expired");
         exit(20);
     }
 }
 
-QGst::PipelinePtr VideoStreamer::createPipeline()
-{
-    QGst::PipelinePtr pipeline = QGst::Pipeline::create();
-    pipeline->bus()->addSignalWatch();
-    QGlib::connect(pipeline->bus(), "message", this, &VideoStreamer::onBusMessage);
-
-    return pipeline;
-}
-
-void VideoStreamer::onBusMessage(const QGst::MessagePtr & message)
-{
-    QByteArray errorMessage;
-    switch (message->type())
-    {
-    case QGst::MessageEos:
-        _parentInterface->call(QDBus::NoBlock, "onChildError", _name, "Received EOS message from GStreamer");
-        stopPrivate(true);
-        break;
-    case QGst::MessageError:
-        errorMessage = message.staticCast<QGst::ErrorMessage>()->error().message().toLatin1();
-        _parentInterface->call(QDBus::NoBlock, "onChildError", _name, errorMessage);
-        stopPrivate(true);
-        break;
-    default:
-        break;
-    }
-}
-
 } // namespace Soro
-
@@ -6,9 +6,7 @@
 #include <QtDBus>
 #include <QTimerEvent>
 
-#include <Qt5GStreamer/QGst/Pipeline>
-#include <Qt5GStreamer/QGlib/RefPointer>
-#include <Qt5GStreamer/QGst/Message>
+#include "soro_video/videopipeline.h"
 
 namespace Soro {
 
@@ -24,25 +22,24 @@ public:
 
 public Q_SLOTS:
     void stop();
-    void stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi);
+    void stream(const QString &device, const QString &address, int port, int bindPort, const QString &profile, bool vaapi, int capturePath);
     void streamStereo(const QString &leftDevice, const QString &rightDevice, const QString &address, int port, int bindPort, const QString &profile, bool vaapi);
+    void warm(const QString &device, int bindPort, const QString &profile, bool vaapi, int capturePath);
+    void standby();
+    void addRendition(int rendition, const QString &address, int port, int bindPort, const QString &profile, bool vaapi);
+    void removeRendition(int rendition);
+    void startRecording(const QString &locationPrefix, const QString &profile, bool vaapi, int segmentSeconds);
+    void stopRecording();
     void heartbeat();
 
 protected:
     void timerEvent(QTimerEvent *e);
 
 private:
-    QGst::PipelinePtr createPipeline();
-
-    void stopPrivate(bool sendReady);
-
     int _watchdogTimerId;
     QString _name;
-    QGst::PipelinePtr _pipeline;
+    VideoPipeline *_pipeline;
     QDBusInterface *_parentInterface;
-
-private Q_SLOTS:
-    void onBusMessage(const QGst::MessagePtr & message);
 };
 
 } // namespace Soro
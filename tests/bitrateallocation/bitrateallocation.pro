@@ -0,0 +1,25 @@
+# Tests how the master's bitrate controller shares its link estimate between cameras and tells
+# mission control's bitrate requests from its own
+QT = core network testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_bitrateallocation
+
+BUILD_DIR = ../../build/tests/bitrateallocation
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_bitrateallocation.cpp \
+    ../../soro_mc_master/bitrateallocation.cpp
+
+HEADERS += \
+    ../../soro_mc_master/bitrateallocation.h
+
+# Link against soro_core, found at run time so "make check" works from the build tree
+LIBS += -L../../lib -lsoro_core
+QMAKE_RPATHDIR += $$OUT_PWD/../../lib
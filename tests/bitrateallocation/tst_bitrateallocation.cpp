@@ -0,0 +1,177 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+
+#include "soro_mc_master/bitrateallocation.h"
+
+using namespace Soro;
+using namespace Soro::BitrateAllocation;
+
+class TestBitrateAllocation : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void skipsPassthrough();
+    void dividesByPriority();
+    void cappedShareGoesToOthers();
+    void keepsMinimum();
+
+    void ownRequestDoesNotCap();
+    void staleStateDoesNotCap();
+    void toleratesRounding();
+    void missionControlChangeNeedsSeveralIntervals();
+    void mismatchResetsOnAgreement();
+
+private:
+    static Demand demand(int priority, quint32 maxBitrate);
+};
+
+Demand TestBitrateAllocation::demand(int priority, quint32 maxBitrate)
+{
+    Demand demand;
+    demand.priority = priority;
+    demand.maxBitrate = maxBitrate;
+    return demand;
+}
+
+void TestBitrateAllocation::skipsPassthrough()
+{
+    VideoMessage state;
+    state.profile.codec = GStreamerUtil::VIDEO_CODEC_H264;
+    state.capture_path = GStreamerUtil::CAPTURE_PATH_RAW;
+    QVERIFY(isAdjustable(state));
+
+    state.capture_path = GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH;
+    QVERIFY(!isAdjustable(state));
+
+    state.capture_path = GStreamerUtil::CAPTURE_PATH_MJPEG_DECODE;
+    state.profile.codec = GStreamerUtil::VIDEO_CODEC_MJPEG;
+    QVERIFY(!isAdjustable(state));
+    state.profile.codec = GStreamerUtil::CODEC_NULL;
+    QVERIFY(!isAdjustable(state));
+}
+
+void TestBitrateAllocation::dividesByPriority()
+{
+    QHash<uint, Demand> demands;
+    demands.insert(0, demand(1, 10000000));
+    demands.insert(1, demand(2, 10000000));
+
+    QHash<uint, quint32> targets = divide(3000000, demands, 100000);
+    QCOMPARE(targets.value(0), 1000000u);
+    QCOMPARE(targets.value(1), 2000000u);
+}
+
+void TestBitrateAllocation::cappedShareGoesToOthers()
+{
+    QHash<uint, Demand> demands;
+    demands.insert(0, demand(2, 1000000));
+    demands.insert(1, demand(1, 10000000));
+
+    QHash<uint, quint32> targets = divide(6000000, demands, 100000);
+    QCOMPARE(targets.value(0), 1000000u);
+    QCOMPARE(targets.value(1), 5000000u);
+}
+
+void TestBitrateAllocation::keepsMinimum()
+{
+    QHash<uint, Demand> demands;
+    demands.insert(0, demand(9, 10000000));
+    demands.insert(1, demand(1, 10000000));
+    demands.insert(2, demand(1, 150000));
+
+    QHash<uint, quint32> targets = divide(300000, demands, 200000);
+    QCOMPARE(targets.value(1), 200000u);
+    // The minimum does not raise a stream over its own maximum
+    QCOMPARE(targets.value(2), 150000u);
+}
+
+void TestBitrateAllocation::ownRequestDoesNotCap()
+{
+    StreamLimit limit(4000000);
+    QVERIFY(!limit.update(4000000));
+
+    limit.setRequested(2000000);
+    for (int i = 0; i < 10; ++i)
+    {
+        QVERIFY(!limit.update(2000000));
+    }
+    QCOMPARE(limit.getMax(), 4000000u);
+    QVERIFY(!limit.hasMismatch());
+}
+
+void TestBitrateAllocation::staleStateDoesNotCap()
+{
+    StreamLimit limit(4000000);
+    limit.setRequested(2000000);
+
+    // Published before the server applied the request
+    QVERIFY(!limit.update(4000000));
+    QVERIFY(limit.hasMismatch());
+    QVERIFY(!limit.update(2000000));
+    QVERIFY(!limit.hasMismatch());
+    QCOMPARE(limit.getMax(), 4000000u);
+}
+
+void TestBitrateAllocation::toleratesRounding()
+{
+    StreamLimit limit(4000000);
+    limit.setRequested(2000000);
+    for (int i = 0; i < 10; ++i)
+    {
+        QVERIFY(!limit.update(1999000));
+    }
+    QCOMPARE(limit.getMax(), 4000000u);
+}
+
+void TestBitrateAllocation::missionControlChangeNeedsSeveralIntervals()
+{
+    StreamLimit limit(4000000);
+    limit.setRequested(2000000);
+
+    QVERIFY(!limit.update(1000000));
+    QVERIFY(!limit.update(1000000));
+    QCOMPARE(limit.getMax(), 4000000u);
+    QVERIFY(limit.update(1000000));
+    QCOMPARE(limit.getMax(), 1000000u);
+    QCOMPARE(limit.getRequested(), 0u);
+    QVERIFY(!limit.hasMismatch());
+
+    // Without a request of ours, a change is mission control's as well
+    QVERIFY(!limit.update(3000000));
+    QVERIFY(!limit.update(3000000));
+    QVERIFY(limit.update(3000000));
+    QCOMPARE(limit.getMax(), 3000000u);
+}
+
+void TestBitrateAllocation::mismatchResetsOnAgreement()
+{
+    StreamLimit limit(4000000);
+    limit.setRequested(2000000);
+
+    QVERIFY(!limit.update(1000000));
+    QVERIFY(!limit.update(1000000));
+    QVERIFY(!limit.update(2000000));
+    QVERIFY(!limit.update(1000000));
+    QVERIFY(!limit.update(1000000));
+    QCOMPARE(limit.getMax(), 4000000u);
+}
+
+QTEST_GUILESS_MAIN(TestBitrateAllocation)
+#include "tst_bitrateallocation.moc"
@@ -0,0 +1,25 @@
+# Tests that the master's bounce lists drop mission control stations named in system_down
+# messages and in the will of a station's shared MQTT connection
+QT = core network testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_bouncelist
+
+BUILD_DIR = ../../build/tests/bouncelist
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_bouncelist.cpp \
+    ../../soro_mc_master/bouncelist.cpp
+
+HEADERS += \
+    ../../soro_mc_master/bouncelist.h
+
+# Link against soro_core and qmqtt, found at run time so "make check" works from the build tree
+LIBS += -L../../lib -lsoro_core -lqmqtt
+QMAKE_RPATHDIR += $$OUT_PWD/../../lib
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+
+#include "soro_core/mqtthub.h"
+#include "soro_mc_master/bouncelist.h"
+
+using namespace Soro;
+
+/* The hub is never connected here, its will is read back and handed to the bounce list the way
+ * the master's video and audio controllers receive it on component_presence
+ */
+class TestBounceList : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void addsOnce();
+    void systemDownRemovesOneClient();
+    void hubWillRemovesItsClients();
+    void hubWillSkipsComponentsWithoutWill();
+    void parsePresenceSkipsEmptyLines();
+
+private:
+    MqttHub *_hub;
+};
+
+void TestBounceList::initTestCase()
+{
+    _hub = MqttHub::getInstance(QHostAddress::LocalHost);
+    QVERIFY(_hub);
+}
+
+void TestBounceList::addsOnce()
+{
+    BounceList list;
+    QVERIFY(list.add("video_client_1", QHostAddress("10.0.0.1")));
+    QVERIFY(!list.add("video_client_1", QHostAddress("10.0.0.2")));
+    QCOMPARE(list.getAddress("video_client_1"), QHostAddress("10.0.0.1"));
+    QCOMPARE(list.getDestinations().size(), 1);
+}
+
+void TestBounceList::systemDownRemovesOneClient()
+{
+    BounceList list;
+    list.add("video_client_1", QHostAddress("10.0.0.1"));
+    list.add("video_client_2", QHostAddress("10.0.0.2"));
+
+    QHash<QString, QHostAddress> removed = list.remove(QStringList("video_client_1"));
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(removed.value("video_client_1"), QHostAddress("10.0.0.1"));
+    QVERIFY(!list.contains("video_client_1"));
+    QVERIFY(list.contains("video_client_2"));
+
+    // Other components go down too, they are not on the list
+    QVERIFY(list.remove(QStringList("video_server_0")).isEmpty());
+    QCOMPARE(list.getDestinations().size(), 1);
+}
+
+void TestBounceList::hubWillRemovesItsClients()
+{
+    // A mission control station's components, as created in soro_mc
+    MqttEndpoint *videoClient = _hub->createEndpoint("video_client_1", nullptr);
+    MqttEndpoint *audioClient = _hub->createEndpoint("audio_client_1", nullptr);
+    MqttEndpoint *driveControl = _hub->createEndpoint("drive_control_system", nullptr);
+
+    BounceList videoList;
+    videoList.add("video_client_1", QHostAddress("10.0.0.1"));
+    videoList.add("video_client_2", QHostAddress("10.0.0.2"));
+    BounceList audioList;
+    audioList.add("audio_client_1", QHostAddress("10.0.0.1"));
+    audioList.add("audio_client_2", QHostAddress("10.0.0.2"));
+
+    QStringList components = MqttHub::parsePresence(_hub->getWillMessage());
+    QCOMPARE(components.size(), 3);
+
+    QHash<QString, QHostAddress> removed = videoList.remove(components);
+    QCOMPARE(removed.keys(), QStringList("video_client_1"));
+    QCOMPARE(videoList.getDestinations().keys(), QStringList("video_client_2"));
+
+    removed = audioList.remove(components);
+    QCOMPARE(removed.keys(), QStringList("audio_client_1"));
+    QCOMPARE(audioList.getDestinations().keys(), QStringList("audio_client_2"));
+
+    delete videoClient;
+    delete audioClient;
+    delete driveControl;
+    QVERIFY(_hub->getWillMessage().isEmpty());
+}
+
+void TestBounceList::hubWillSkipsComponentsWithoutWill()
+{
+    MqttEndpoint *videoClient = _hub->createEndpoint("video_client_1", nullptr);
+    MqttEndpoint *statusController = _hub->createEndpoint("1_connectionstatuscontroller", nullptr, false);
+
+    QCOMPARE(MqttHub::parsePresence(_hub->getWillMessage()), QStringList("video_client_1"));
+
+    delete videoClient;
+    delete statusController;
+}
+
+void TestBounceList::parsePresenceSkipsEmptyLines()
+{
+    QCOMPARE(MqttHub::parsePresence("video_client_1\n\naudio_client_1\n"),
+             QStringList() << "video_client_1" << "audio_client_1");
+    QVERIFY(MqttHub::parsePresence(QByteArray()).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestBounceList)
+#include "tst_bouncelist.moc"
@@ -0,0 +1,20 @@
+# Compares the byte swap kernels of soro_core/byteswap.cpp with each other, and benchmarks them against
+# per-value deserialize(). The kernels are built in, so the test does not need the rest of soro_core.
+QT = core testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_byteswap
+
+BUILD_DIR = ../../build/tests/byteswap
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+DEFINES += SORO_CORE_LIBRARY
+
+SOURCES += tst_byteswap.cpp \
+    ../../soro_core/byteswap.cpp
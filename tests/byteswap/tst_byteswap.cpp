@@ -0,0 +1,226 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+
+#include "soro_core/byteswap.h"
+#include "soro_core/serialize.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace Soro;
+
+/* Every SIMD kernel has to produce exactly what the scalar kernel does, for every length from empty up
+ * past several vector widths and at every alignment of its input and output, without writing past the
+ * end of its output. The benchmarks time the kernels against per-value deserialize<quint16>().
+ */
+
+static const int MAX_COUNT = 300;
+static const int MAX_OFFSET = 32;
+static const int GUARD = 32;
+static const char GUARD_BYTE = 0x5A;
+
+// Benchmarked alongside the kernels
+static const int METHOD_DESERIALIZE = -1;
+static const int METHOD_DECODE = -2;
+
+Q_DECLARE_METATYPE(Soro::ByteSwap::Kernel)
+
+static bool isGuarded(const char *begin, const char *end)
+{
+    for (const char *p = begin; p < end; ++p)
+    {
+        if (*p != GUARD_BYTE) return false;
+    }
+    return true;
+}
+
+class TestByteSwap : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void kernelMatchesScalar_data();
+    void kernelMatchesScalar();
+    void scalarSwaps();
+    void conversionsMatchSerialize();
+
+    void benchmark_data();
+    void benchmark();
+};
+
+void TestByteSwap::kernelMatchesScalar_data()
+{
+    QTest::addColumn<ByteSwap::Kernel>("kernel");
+    QTest::newRow("SSE2") << ByteSwap::KernelSse2;
+    QTest::newRow("AVX2") << ByteSwap::KernelAvx2;
+}
+
+void TestByteSwap::kernelMatchesScalar()
+{
+    QFETCH(ByteSwap::Kernel, kernel);
+    if (!ByteSwap::isSupported(kernel))
+    {
+        QSKIP("Kernel is not supported by this build or CPU");
+    }
+
+    std::vector<char> in(MAX_OFFSET + MAX_COUNT * 2);
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        in[i] = static_cast<char>(i * 37 + 11);
+    }
+    std::vector<char> expected(MAX_COUNT * 2);
+    std::vector<char> out(GUARD + MAX_OFFSET + MAX_COUNT * 2 + GUARD);
+
+    for (int count = 0; count <= MAX_COUNT; ++count)
+    {
+        for (int inOffset = 0; inOffset < MAX_OFFSET; ++inOffset)
+        {
+            const char *src = in.data() + inOffset;
+            ByteSwap::swap16(ByteSwap::KernelScalar, src, expected.data(), count);
+
+            for (int outOffset = 0; outOffset < MAX_OFFSET; ++outOffset)
+            {
+                memset(out.data(), GUARD_BYTE, out.size());
+                char *dst = out.data() + GUARD + outOffset;
+                ByteSwap::swap16(kernel, src, dst, count);
+
+                QVERIFY(memcmp(dst, expected.data(), count * 2) == 0);
+                QVERIFY(isGuarded(out.data(), dst));
+                QVERIFY(isGuarded(dst + count * 2, out.data() + out.size()));
+            }
+        }
+    }
+}
+
+void TestByteSwap::scalarSwaps()
+{
+    std::vector<char> in(MAX_OFFSET + MAX_COUNT * 2);
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        in[i] = static_cast<char>(i * 37 + 11);
+    }
+    std::vector<char> out(MAX_COUNT * 2);
+
+    for (int count = 0; count <= MAX_COUNT; ++count)
+    {
+        for (int inOffset = 0; inOffset < MAX_OFFSET; ++inOffset)
+        {
+            const char *src = in.data() + inOffset;
+            ByteSwap::swap16(ByteSwap::KernelScalar, src, out.data(), count);
+            for (int i = 0; i < count; ++i)
+            {
+                QCOMPARE(out[i * 2], src[i * 2 + 1]);
+                QCOMPARE(out[i * 2 + 1], src[i * 2]);
+            }
+        }
+    }
+}
+
+void TestByteSwap::conversionsMatchSerialize()
+{
+    // Whatever kernel was chosen, the values must match the scalar codec
+    char encoded[MAX_COUNT * 2 + 1];
+    quint16 values[MAX_COUNT];
+    quint16 decoded[MAX_COUNT];
+    for (int i = 0; i < MAX_COUNT; ++i)
+    {
+        values[i] = static_cast<quint16>(i * 40503u);
+    }
+
+    for (int count = 0; count <= MAX_COUNT; ++count)
+    {
+        ByteSwap::encodeBigEndian16(values, encoded + 1, count);
+        for (int i = 0; i < count; ++i)
+        {
+            QCOMPARE(deserialize<quint16>(encoded + 1 + i * 2), values[i]);
+        }
+        ByteSwap::decodeBigEndian16(encoded + 1, decoded, count);
+        QVERIFY(memcmp(decoded, values, count * 2) == 0);
+    }
+}
+
+void TestByteSwap::benchmark_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("count");
+
+    // A spectrometer reading, then a full 64 KiB packet
+    const int counts[] = { 288, 32768 };
+    for (int count : counts)
+    {
+        QByteArray suffix = " " + QByteArray::number(count);
+        QTest::newRow(("deserialize<quint16> loop" + suffix).constData()) << METHOD_DESERIALIZE << count;
+        QTest::newRow(("scalar" + suffix).constData()) << static_cast<int>(ByteSwap::KernelScalar) << count;
+        QTest::newRow(("SSE2" + suffix).constData()) << static_cast<int>(ByteSwap::KernelSse2) << count;
+        QTest::newRow(("AVX2" + suffix).constData()) << static_cast<int>(ByteSwap::KernelAvx2) << count;
+        QTest::newRow(("decodeBigEndian16" + suffix).constData()) << METHOD_DECODE << count;
+    }
+}
+
+void TestByteSwap::benchmark()
+{
+    QFETCH(int, method);
+    QFETCH(int, count);
+    if ((method >= 0) && !ByteSwap::isSupported(static_cast<ByteSwap::Kernel>(method)))
+    {
+        QSKIP("Kernel is not supported by this build or CPU");
+    }
+
+    std::vector<char> in(count * 2 + 1);
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        in[i] = static_cast<char>(i);
+    }
+    std::vector<quint16> out(count);
+    // Offset by one, as values in a received packet usually are
+    const char *src = in.data() + 1;
+
+    QBENCHMARK
+    {
+        if (method == METHOD_DESERIALIZE)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                out[i] = deserialize<quint16>(src + i * 2);
+            }
+        }
+        else if (method == METHOD_DECODE)
+        {
+            ByteSwap::decodeBigEndian16(src, out.data(), count);
+        }
+        else
+        {
+            ByteSwap::swap16(static_cast<ByteSwap::Kernel>(method), src, reinterpret_cast<char*>(out.data()), count);
+        }
+    }
+    if (method >= 0)
+    {
+        // The kernels swap bytes whatever the host's byte order
+        const char *last = reinterpret_cast<const char*>(out.data()) + (count - 1) * 2;
+        QCOMPARE(last[0], src[(count - 1) * 2 + 1]);
+    }
+    else
+    {
+        QCOMPARE(out[count - 1], deserialize<quint16>(src + (count - 1) * 2));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestByteSwap)
+
+#include "tst_byteswap.moc"
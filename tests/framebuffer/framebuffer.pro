@@ -0,0 +1,21 @@
+# Tests qmqtt's incremental frame parser, and benchmarks it on spectrometer sized publishes. The parser is
+# private to qmqtt, so its sources are built in.
+QT = core testlib
+
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+TARGET = tst_framebuffer
+
+BUILD_DIR = ../../build/tests/framebuffer
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../.. $$PWD/../../qmqtt
+
+DEFINES += QMQTT_LIBRARY QT_NO_CAST_TO_ASCII QT_NO_CAST_FROM_ASCII
+
+SOURCES += tst_framebuffer.cpp \
+    ../../qmqtt/qmqtt_frame.cpp \
+    ../../qmqtt/qmqtt_framebuffer.cpp
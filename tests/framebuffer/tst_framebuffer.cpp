@@ -0,0 +1,330 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+#include <QBuffer>
+#include <QDataStream>
+
+#include "qmqtt/qmqtt_framebuffer_p.h"
+
+using namespace QMQTT;
+
+// Encodes a QoS 0 PUBLISH frame
+static QByteArray publishFrame(const QString &topic, const QByteArray &payload)
+{
+    Frame frame(PUBLISH);
+    frame.writeString(topic);
+    frame.writeRawData(payload);
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    frame.write(stream);
+    return encoded;
+}
+
+static QByteArray payloadOfSize(int size)
+{
+    QByteArray payload(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+    {
+        payload[i] = static_cast<char>(i * 31);
+    }
+    return payload;
+}
+
+// Checks that frame is the PUBLISH encoded by publishFrame(topic, payload)
+static void verifyPublish(Frame frame, const QString &topic, const QByteArray &payload)
+{
+    QCOMPARE(frame.header(), static_cast<quint8>(PUBLISH));
+    QCOMPARE(frame.size(), 2 + topic.toUtf8().size() + payload.size());
+    QCOMPARE(frame.readString(), topic);
+    QCOMPARE(frame.data(), payload);
+}
+
+class TestFrameBuffer : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void wholeFrame();
+    void frameSplitAcrossReads();
+    void frameReadByteByByte();
+    void lengthSplitAcrossReads();
+    void severalFramesInOneRead();
+    void fourByteLength();
+    void maximumLength();
+    void malformedFifthLengthByte();
+    void readFromDevice();
+    void compactKeepsPartialFrame();
+    void steadyStateDoesNotAllocate();
+    void parse64KiBPublishes();
+};
+
+void TestFrameBuffer::wholeFrame()
+{
+    FrameBuffer buffer;
+    QByteArray payload = payloadOfSize(100);
+    QByteArray encoded = publishFrame(QStringLiteral("spectrometer"), payload);
+    buffer.append(encoded.constData(), encoded.size());
+
+    Frame frame;
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("spectrometer"), payload);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+    QCOMPARE(buffer.bytesBuffered(), 0);
+}
+
+void TestFrameBuffer::frameSplitAcrossReads()
+{
+    QByteArray payload = payloadOfSize(300);
+    QByteArray encoded = publishFrame(QStringLiteral("gps"), payload);
+
+    // Every place the frame could be cut between two reads
+    for (int split = 1; split < encoded.size(); ++split)
+    {
+        FrameBuffer buffer;
+        Frame frame;
+        buffer.append(encoded.constData(), split);
+        QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+        buffer.compact();
+        QCOMPARE(buffer.bytesBuffered(), split);
+
+        buffer.append(encoded.constData() + split, encoded.size() - split);
+        QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+        verifyPublish(frame, QStringLiteral("gps"), payload);
+    }
+}
+
+void TestFrameBuffer::frameReadByteByByte()
+{
+    QByteArray payload = payloadOfSize(200);
+    QByteArray encoded = publishFrame(QStringLiteral("drive"), payload);
+
+    FrameBuffer buffer;
+    Frame frame;
+    for (int i = 0; i < encoded.size() - 1; ++i)
+    {
+        buffer.append(encoded.constData() + i, 1);
+        QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+        buffer.compact();
+    }
+    buffer.append(encoded.constData() + encoded.size() - 1, 1);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("drive"), payload);
+}
+
+void TestFrameBuffer::lengthSplitAcrossReads()
+{
+    // Big enough for a three byte remaining length
+    QByteArray payload = payloadOfSize(20000);
+    QByteArray encoded = publishFrame(QStringLiteral("video"), payload);
+    QVERIFY(static_cast<uchar>(encoded.at(1)) & 0x80);
+    QVERIFY(static_cast<uchar>(encoded.at(2)) & 0x80);
+    QVERIFY(!(static_cast<uchar>(encoded.at(3)) & 0x80));
+
+    FrameBuffer buffer;
+    Frame frame;
+    for (int i = 0; i < 4; ++i)
+    {
+        buffer.append(encoded.constData() + i, 1);
+        QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+        buffer.compact();
+    }
+    buffer.append(encoded.constData() + 4, encoded.size() - 4);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("video"), payload);
+}
+
+void TestFrameBuffer::severalFramesInOneRead()
+{
+    QByteArray first = payloadOfSize(10);
+    QByteArray second = payloadOfSize(5000);
+    QByteArray third = payloadOfSize(0);
+    QByteArray encoded = publishFrame(QStringLiteral("a"), first)
+            + publishFrame(QStringLiteral("b/c"), second)
+            + publishFrame(QStringLiteral("d"), third);
+
+    // The last frame arrives with a byte missing
+    FrameBuffer buffer;
+    Frame frame;
+    buffer.append(encoded.constData(), encoded.size() - 1);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("a"), first);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("b/c"), second);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+    buffer.compact();
+
+    buffer.append(encoded.constData() + encoded.size() - 1, 1);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("d"), third);
+}
+
+void TestFrameBuffer::fourByteLength()
+{
+    // The smallest frame that needs all four length bytes
+    const int remainingLength = 128 * 128 * 128;
+    QByteArray payload = payloadOfSize(remainingLength - 3);
+    QByteArray encoded = publishFrame(QStringLiteral("t"), payload);
+    QCOMPARE(encoded.mid(1, 4), QByteArray("\x80\x80\x80\x01", 4));
+
+    FrameBuffer buffer;
+    Frame frame;
+    buffer.append(encoded.constData(), encoded.size() - 1);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+    buffer.append(encoded.constData() + encoded.size() - 1, 1);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    QCOMPARE(frame.size(), remainingLength);
+    verifyPublish(frame, QStringLiteral("t"), payload);
+}
+
+void TestFrameBuffer::maximumLength()
+{
+    // 268435455 bytes, the most four length bytes can hold. That is still a valid frame that has not
+    // arrived yet, not a malformed one.
+    FrameBuffer buffer;
+    Frame frame;
+    QByteArray header("\x30\xFF\xFF\xFF\x7F", 5);
+    buffer.append(header.constData(), header.size());
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+
+    QByteArray partial = payloadOfSize(1000);
+    buffer.append(partial.constData(), partial.size());
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+    buffer.compact();
+    QCOMPARE(buffer.bytesBuffered(), header.size() + partial.size());
+}
+
+void TestFrameBuffer::malformedFifthLengthByte()
+{
+    // The fourth length byte may not ask for a fifth, whether or not the fifth has arrived
+    FrameBuffer buffer;
+    Frame frame;
+    buffer.append("\x30\xFF\xFF\xFF\xFF", 5);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameMalformed);
+
+    FrameBuffer longer;
+    longer.append("\x30\x80\x80\x80\x80\x01\x00", 7);
+    QCOMPARE(longer.next(frame), FrameBuffer::FrameMalformed);
+
+    // Arriving one byte at a time makes no difference
+    FrameBuffer split;
+    const char *bytes = "\x30\xFF\xFF\xFF\xFF\x01";
+    for (int i = 0; i < 4; ++i)
+    {
+        split.append(bytes + i, 1);
+        QCOMPARE(split.next(frame), FrameBuffer::FrameIncomplete);
+    }
+    split.append(bytes + 4, 1);
+    QCOMPARE(split.next(frame), FrameBuffer::FrameMalformed);
+}
+
+void TestFrameBuffer::readFromDevice()
+{
+    QByteArray payload = payloadOfSize(4000);
+    QByteArray encoded = publishFrame(QStringLiteral("science"), payload);
+    QBuffer device(&encoded);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    FrameBuffer buffer;
+    QVERIFY(buffer.readFrom(&device));
+    QCOMPARE(buffer.bytesBuffered(), encoded.size());
+
+    Frame frame;
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("science"), payload);
+}
+
+void TestFrameBuffer::compactKeepsPartialFrame()
+{
+    QByteArray payload = payloadOfSize(50);
+    QByteArray encoded = publishFrame(QStringLiteral("a"), payload) + publishFrame(QStringLiteral("b"), payload);
+    const int firstSize = encoded.size() / 2;
+
+    FrameBuffer buffer;
+    Frame frame;
+    buffer.append(encoded.constData(), firstSize + 10);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameIncomplete);
+    frame = Frame();
+    buffer.compact();
+    QCOMPARE(buffer.bytesBuffered(), 10);
+
+    buffer.append(encoded.constData() + firstSize + 10, encoded.size() - firstSize - 10);
+    QCOMPARE(buffer.next(frame), FrameBuffer::FrameComplete);
+    verifyPublish(frame, QStringLiteral("b"), payload);
+}
+
+void TestFrameBuffer::steadyStateDoesNotAllocate()
+{
+    // 64 KiB publishes arriving in TCP segment sized reads, parsed the way Network does it
+    QByteArray encoded = publishFrame(QStringLiteral("spectrometer"), payloadOfSize(64 * 1024));
+    const int segment = 1448;
+
+    FrameBuffer buffer;
+    int capacity = -1;
+    int frames = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        for (int offset = 0; offset < encoded.size(); offset += segment)
+        {
+            buffer.append(encoded.constData() + offset, qMin(segment, encoded.size() - offset));
+            forever
+            {
+                Frame frame;
+                if (buffer.next(frame) != FrameBuffer::FrameComplete) break;
+                QCOMPARE(frame.size(), encoded.size() - 4);
+                frames++;
+            }
+            buffer.compact();
+        }
+
+        // The first frame may grow the buffer, after that it must keep its allocation
+        if (round == 0)
+        {
+            capacity = buffer.capacity();
+        }
+        else
+        {
+            QCOMPARE(buffer.capacity(), capacity);
+        }
+    }
+    QCOMPARE(frames, 200);
+}
+
+void TestFrameBuffer::parse64KiBPublishes()
+{
+    QByteArray encoded = publishFrame(QStringLiteral("spectrometer"), payloadOfSize(64 * 1024));
+    FrameBuffer buffer;
+    int topicLength = 0;
+
+    QBENCHMARK
+    {
+        buffer.append(encoded.constData(), encoded.size());
+        forever
+        {
+            Frame frame;
+            if (buffer.next(frame) != FrameBuffer::FrameComplete) break;
+            topicLength += frame.readString().size();
+        }
+        buffer.compact();
+    }
+    QVERIFY(topicLength > 0);
+}
+
+QTEST_APPLESS_MAIN(TestFrameBuffer)
+
+#include "tst_framebuffer.moc"
@@ -0,0 +1,21 @@
+# Tests the fixed-layout message codec and its reading of the older QDataStream payloads, and
+# benchmarks the two encodings against each other
+QT = core network testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_messagecodec
+
+BUILD_DIR = ../../build/tests/messagecodec
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_messagecodec.cpp
+
+# Link against soro_core, found at run time so "make check" works from the build tree
+LIBS += -L../../lib -lsoro_core
+QMAKE_RPATHDIR += $$OUT_PWD/../../lib
@@ -0,0 +1,402 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+#include <QDataStream>
+
+#include "soro_core/drivemessage.h"
+#include "soro_core/switchmessage.h"
+#include "soro_core/spectrometermessage.h"
+#include "soro_core/videomessage.h"
+#include "soro_core/recordingrequestmessage.h"
+
+using namespace Soro;
+
+// The encodings these messages had before the codec, kept to check that they are still read
+// and to benchmark against
+
+static QByteArray legacyDrive(const DriveMessage &msg)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream << msg.wheelFL << msg.wheelML << msg.wheelBL << msg.wheelFR << msg.wheelMR << msg.wheelBR;
+    return payload;
+}
+
+static QByteArray legacyVideo(const VideoMessage &msg)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream << msg.profile.toString()
+           << msg.camera_computerIndex
+           << msg.camera_index
+           << msg.camera_name
+           << msg.camera_offset
+           << msg.camera_productId
+           << msg.camera_serial
+           << msg.camera_vendorId
+           << msg.isStereo
+           << msg.camera_offset2
+           << msg.camera_productId2
+           << msg.camera_serial2
+           << msg.camera_vendorId2;
+    return payload;
+}
+
+static void legacyDecodeVideo(const QByteArray &payload, VideoMessage &msg)
+{
+    QDataStream stream(payload);
+    stream.setByteOrder(QDataStream::BigEndian);
+    QString profileStr;
+    stream >> profileStr
+           >> msg.camera_computerIndex
+           >> msg.camera_index
+           >> msg.camera_name
+           >> msg.camera_offset
+           >> msg.camera_productId
+           >> msg.camera_serial
+           >> msg.camera_vendorId
+           >> msg.isStereo
+           >> msg.camera_offset2
+           >> msg.camera_productId2
+           >> msg.camera_serial2
+           >> msg.camera_vendorId2;
+    msg.profile = GStreamerUtil::VideoProfile(profileStr);
+}
+
+static DriveMessage sampleDrive()
+{
+    DriveMessage msg;
+    msg.wheelFL = -32768;
+    msg.wheelML = -1;
+    msg.wheelBL = 0;
+    msg.wheelFR = 1;
+    msg.wheelMR = 12345;
+    msg.wheelBR = 32767;
+    return msg;
+}
+
+static VideoMessage sampleVideo()
+{
+    VideoMessage msg;
+    msg.profile.codec = GStreamerUtil::VIDEO_CODEC_H264;
+    msg.profile.width = 1280;
+    msg.profile.height = 720;
+    msg.profile.framerate = 30;
+    msg.profile.bitrate = 2500000;
+    msg.profile.mjpeg_quality = 50;
+    msg.camera_computerIndex = 2;
+    msg.camera_index = 7;
+    msg.camera_name = QStringLiteral("Mast élévation");
+    msg.camera_offset = 1;
+    msg.camera_serial = QStringLiteral("SN-0123456789ABCDEF");
+    msg.camera_vendorId = QStringLiteral("046d");
+    msg.camera_productId = QStringLiteral("0843");
+    msg.isStereo = true;
+    msg.camera_offset2 = 3;
+    msg.camera_serial2 = QStringLiteral("SN-FEDCBA9876543210");
+    msg.camera_vendorId2 = QStringLiteral("046d");
+    msg.camera_productId2 = QStringLiteral("0844");
+    return msg;
+}
+
+static void verifyCamera(const VideoMessage &decoded, const VideoMessage &expected)
+{
+    QCOMPARE(decoded.profile.codec, expected.profile.codec);
+    QCOMPARE(decoded.profile.width, expected.profile.width);
+    QCOMPARE(decoded.profile.height, expected.profile.height);
+    QCOMPARE(decoded.profile.framerate, expected.profile.framerate);
+    QCOMPARE(decoded.profile.bitrate, expected.profile.bitrate);
+    QCOMPARE(decoded.profile.mjpeg_quality, expected.profile.mjpeg_quality);
+    QCOMPARE(decoded.camera_computerIndex, expected.camera_computerIndex);
+    QCOMPARE(decoded.camera_index, expected.camera_index);
+    QCOMPARE(decoded.camera_name, expected.camera_name);
+    QCOMPARE(decoded.camera_offset, expected.camera_offset);
+    QCOMPARE(decoded.camera_serial, expected.camera_serial);
+    QCOMPARE(decoded.camera_vendorId, expected.camera_vendorId);
+    QCOMPARE(decoded.camera_productId, expected.camera_productId);
+    QCOMPARE(decoded.isStereo, expected.isStereo);
+    QCOMPARE(decoded.camera_offset2, expected.camera_offset2);
+    QCOMPARE(decoded.camera_serial2, expected.camera_serial2);
+    QCOMPARE(decoded.camera_vendorId2, expected.camera_vendorId2);
+    QCOMPARE(decoded.camera_productId2, expected.camera_productId2);
+}
+
+static void verifyDrive(const DriveMessage &decoded, const DriveMessage &expected)
+{
+    QCOMPARE(decoded.wheelFL, expected.wheelFL);
+    QCOMPARE(decoded.wheelML, expected.wheelML);
+    QCOMPARE(decoded.wheelBL, expected.wheelBL);
+    QCOMPARE(decoded.wheelFR, expected.wheelFR);
+    QCOMPARE(decoded.wheelMR, expected.wheelMR);
+    QCOMPARE(decoded.wheelBR, expected.wheelBR);
+}
+
+class TestMessageCodec : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void driveRoundTrip();
+    void driveLegacy();
+    void driveEncodeLegacyMatchesDataStream();
+    void switchLegacy();
+    void spectrometerLegacy();
+    void videoRoundTrip();
+    void videoLegacy();
+    void olderRevisionKeepsDefaults();
+    void rejectsTruncatedField();
+    void rejectsUnknownFormat();
+    void rejectsOverlongString();
+    void rejectsOverlongStringLength();
+    void benchmarkDrive_data();
+    void benchmarkDrive();
+    void benchmarkVideo_data();
+    void benchmarkVideo();
+};
+
+void TestMessageCodec::driveRoundTrip()
+{
+    DriveMessage msg = sampleDrive();
+    DriveMessage decoded(static_cast<QByteArray>(msg));
+    QVERIFY(decoded.isValid());
+    verifyDrive(decoded, msg);
+}
+
+void TestMessageCodec::driveLegacy()
+{
+    DriveMessage msg = sampleDrive();
+    DriveMessage decoded(legacyDrive(msg));
+    QVERIFY(decoded.isValid());
+    verifyDrive(decoded, msg);
+}
+
+void TestMessageCodec::driveEncodeLegacyMatchesDataStream()
+{
+    DriveMessage msg = sampleDrive();
+    QCOMPARE(msg.encodeLegacy(), legacyDrive(msg));
+}
+
+void TestMessageCodec::switchLegacy()
+{
+    SwitchMessage on(QByteArray(1, 1));
+    QVERIFY(on.isValid());
+    QCOMPARE(on.on, true);
+
+    SwitchMessage off(QByteArray(1, 0));
+    QVERIFY(off.isValid());
+    QCOMPARE(off.on, false);
+}
+
+void TestMessageCodec::spectrometerLegacy()
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int i = 0; i < SpectrometerMessage::SPECTRUM_POINTS; ++i) stream << static_cast<quint16>(i * 7);
+    for (int i = 0; i < SpectrometerMessage::SPECTRUM_POINTS; ++i) stream << static_cast<quint16>(65535 - i);
+
+    SpectrometerMessage decoded(payload);
+    QVERIFY(decoded.isValid());
+    for (int i = 0; i < SpectrometerMessage::SPECTRUM_POINTS; ++i)
+    {
+        QCOMPARE(decoded.spectrumWhite.values[i], static_cast<quint16>(i * 7));
+        QCOMPARE(decoded.spectrum404.values[i], static_cast<quint16>(65535 - i));
+    }
+}
+
+void TestMessageCodec::videoRoundTrip()
+{
+    VideoMessage msg = sampleVideo();
+    msg.profile.fec_percentage = 20;
+    msg.capture_path = GStreamerUtil::CAPTURE_PATH_H264_PASSTHROUGH;
+    msg.rendition = 1;
+
+    VideoMessage decoded(static_cast<QByteArray>(msg));
+    QVERIFY(decoded.isValid());
+    verifyCamera(decoded, msg);
+    QCOMPARE(decoded.profile.fec_percentage, msg.profile.fec_percentage);
+    QCOMPARE(decoded.capture_path, msg.capture_path);
+    QCOMPARE(decoded.rendition, msg.rendition);
+}
+
+void TestMessageCodec::videoLegacy()
+{
+    VideoMessage msg = sampleVideo();
+    VideoMessage decoded(legacyVideo(msg));
+    QVERIFY(decoded.isValid());
+    verifyCamera(decoded, msg);
+
+    // Fields the old encoding did not have are left at their defaults
+    QCOMPARE(decoded.capture_path, static_cast<quint8>(GStreamerUtil::CAPTURE_PATH_RAW));
+    QCOMPARE(decoded.rendition, static_cast<quint8>(0));
+
+    // Cut short anywhere, it is not read
+    QByteArray payload = legacyVideo(msg);
+    for (int length = 0; length < payload.size(); ++length)
+    {
+        QVERIFY2(!VideoMessage(payload.left(length)).isValid(), qPrintable(QString::number(length)));
+    }
+}
+
+void TestMessageCodec::olderRevisionKeepsDefaults()
+{
+    // A sender that knows only the first three drive wheels
+    DriveMessage msg = sampleDrive();
+    QByteArray payload = static_cast<QByteArray>(msg).left(2 + 3 * 2);
+
+    DriveMessage decoded(payload);
+    QVERIFY(decoded.isValid());
+    QCOMPARE(decoded.wheelFL, msg.wheelFL);
+    QCOMPARE(decoded.wheelML, msg.wheelML);
+    QCOMPARE(decoded.wheelBL, msg.wheelBL);
+    QCOMPARE(decoded.wheelFR, static_cast<qint16>(0));
+    QCOMPARE(decoded.wheelMR, static_cast<qint16>(0));
+    QCOMPARE(decoded.wheelBR, static_cast<qint16>(0));
+
+    // A newer sender's trailing fields are ignored
+    decoded = DriveMessage(static_cast<QByteArray>(msg) + QByteArray(4, 'x'));
+    QVERIFY(decoded.isValid());
+    verifyDrive(decoded, msg);
+}
+
+void TestMessageCodec::rejectsTruncatedField()
+{
+    // Only cuts between two fields are an older revision, a cut inside a field is garbled
+    QByteArray payload = sampleVideo();
+    QVERIFY(!VideoMessage(payload.left(1)).isValid());
+    QVERIFY(!VideoMessage(payload.left(2)).isValid());
+    QVERIFY(VideoMessage(payload.left(2 + 12)).isValid());
+    QVERIFY(!VideoMessage(payload.left(2 + 5)).isValid());
+    QVERIFY(!DriveMessage(static_cast<QByteArray>(sampleDrive()).left(2 + 3)).isValid());
+    QVERIFY(!RecordingRequestMessage(QByteArray()).isValid());
+}
+
+void TestMessageCodec::rejectsUnknownFormat()
+{
+    QByteArray payload = sampleDrive();
+    payload[0] = static_cast<char>(MessageCodec::FORMAT_VERSION + 1);
+    QVERIFY(!DriveMessage(payload).isValid());
+}
+
+void TestMessageCodec::rejectsOverlongString()
+{
+    VideoMessage msg = sampleVideo();
+    msg.camera_serial = QString(VideoMessage::MAX_SERIAL_BYTES, QLatin1Char('9'));
+    QVERIFY(!static_cast<QByteArray>(msg).isEmpty());
+
+    // One byte too many, including as a multi byte character, fails instead of being cut short
+    msg.camera_serial = QString(VideoMessage::MAX_SERIAL_BYTES + 1, QLatin1Char('9'));
+    QVERIFY(static_cast<QByteArray>(msg).isEmpty());
+    msg.camera_serial = QString(VideoMessage::MAX_SERIAL_BYTES - 1, QLatin1Char('9')) + QChar(0x00e9);
+    QVERIFY(static_cast<QByteArray>(msg).isEmpty());
+
+    char buffer[1024];
+    QCOMPARE(msg.encode(buffer, sizeof(buffer)), -1);
+
+    // An empty payload is never read as a message
+    QVERIFY(!VideoMessage(QByteArray()).isValid());
+}
+
+void TestMessageCodec::rejectsOverlongStringLength()
+{
+    RecordingRequestMessage msg;
+    msg.camera_index = 1;
+    msg.client_id = QStringLiteral("mc");
+    QByteArray payload = msg;
+
+    // The length byte of client_id follows the header, camera_index and both times
+    const int lengthOffset = 2 + 2 + 8 + 8;
+    QCOMPARE(payload.at(lengthOffset), static_cast<char>(2));
+    payload[lengthOffset] = static_cast<char>(200);
+    QVERIFY(!RecordingRequestMessage(payload).isValid());
+}
+
+void TestMessageCodec::benchmarkDrive_data()
+{
+    QTest::addColumn<bool>("codec");
+    QTest::newRow("codec") << true;
+    QTest::newRow("QDataStream") << false;
+}
+
+void TestMessageCodec::benchmarkDrive()
+{
+    QFETCH(bool, codec);
+    DriveMessage msg = sampleDrive();
+    char buffer[64];
+    int total = 0;
+
+    // Encodes and decodes one message, as a publish and its delivery would
+    QBENCHMARK
+    {
+        if (codec)
+        {
+            int length = msg.encode(buffer, sizeof(buffer));
+            DriveMessage decoded(QByteArray::fromRawData(buffer, length));
+            total += decoded.wheelBR;
+        }
+        else
+        {
+            QByteArray payload = legacyDrive(msg);
+            QDataStream stream(payload);
+            stream.setByteOrder(QDataStream::BigEndian);
+            DriveMessage decoded;
+            stream >> decoded.wheelFL >> decoded.wheelML >> decoded.wheelBL
+                   >> decoded.wheelFR >> decoded.wheelMR >> decoded.wheelBR;
+            total += decoded.wheelBR;
+        }
+    }
+    QVERIFY(total != 0);
+}
+
+void TestMessageCodec::benchmarkVideo_data()
+{
+    QTest::addColumn<bool>("codec");
+    QTest::newRow("codec") << true;
+    QTest::newRow("QDataStream") << false;
+}
+
+void TestMessageCodec::benchmarkVideo()
+{
+    QFETCH(bool, codec);
+    VideoMessage msg = sampleVideo();
+    char buffer[512];
+    int total = 0;
+
+    QBENCHMARK
+    {
+        if (codec)
+        {
+            int length = msg.encode(buffer, sizeof(buffer));
+            VideoMessage decoded(QByteArray::fromRawData(buffer, length));
+            total += decoded.camera_serial.size();
+        }
+        else
+        {
+            VideoMessage decoded;
+            legacyDecodeVideo(legacyVideo(msg), decoded);
+            total += decoded.camera_serial.size();
+        }
+    }
+    QVERIFY(total != 0);
+}
+
+QTEST_APPLESS_MAIN(TestMessageCodec)
+
+#include "tst_messagecodec.moc"
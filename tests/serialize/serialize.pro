@@ -0,0 +1,17 @@
+# Round trip tests of soro_core/serialize.h, and benchmarks of its codecs. serialize.h is header
+# only, so the test does not link soro_core.
+QT = core testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_serialize
+
+BUILD_DIR = ../../build/tests/serialize
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_serialize.cpp
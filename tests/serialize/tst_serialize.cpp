@@ -0,0 +1,392 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+
+#include "soro_core/serialize.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+/* Round trips every 16-bit value, and for the wider integers and floating point types the edge values, every
+ * bit pattern with at most two bits set or two bits clear, and a large number of random bit patterns. Values
+ * are compared bit for bit, so NaN payloads, -0 and denormals have to come back exactly as they went in.
+ *
+ * The helpers report through QCOMPARE, so their callers stop at the first failure with
+ * QTest::currentTestFailed().
+ */
+
+static const int FUZZ_ROUNDS = 1000000;
+static const int ARRAY_COUNT = 301;
+
+static quint64 fuzzState;
+
+// xorshift64*, so every run checks the same values
+static quint64 nextRandom()
+{
+    fuzzState ^= fuzzState >> 12;
+    fuzzState ^= fuzzState << 25;
+    fuzzState ^= fuzzState >> 27;
+    return fuzzState * 0x2545F4914F6CDD1Dull;
+}
+
+template <typename T>
+static quint64 bitsOf(T value)
+{
+    typedef typename SerializeDetail::Bits<sizeof(T)>::type U;
+    U bits;
+    memcpy(&bits, &value, sizeof(T));
+    return bits;
+}
+
+template <typename T>
+static T fromBits(quint64 bits)
+{
+    typedef typename SerializeDetail::Bits<sizeof(T)>::type U;
+    U narrow = static_cast<U>(bits);
+    T value;
+    memcpy(&value, &narrow, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void verifyRoundTrip(T value)
+{
+    // Written at an odd offset, the codec must not depend on alignment
+    char buffer[sizeof(T) + 1];
+    char *out = buffer + 1;
+    serialize<T>(out, value);
+
+    // Most significant byte first
+    const quint64 bits = bitsOf(value);
+    for (unsigned i = 0; i < sizeof(T); ++i)
+    {
+        QCOMPARE(static_cast<quint8>(out[i]), static_cast<quint8>(bits >> (8 * (sizeof(T) - 1 - i))));
+    }
+
+    QCOMPARE(bitsOf(deserialize<T>(out)), bits);
+}
+
+// Every pattern with at most two bits set, and the same inverted
+template <typename T>
+static void verifySparsePatterns()
+{
+    const int width = sizeof(T) * 8;
+    const quint64 mask = width == 64 ? ~0ull : ((1ull << width) - 1);
+    verifyRoundTrip(fromBits<T>(0));
+    verifyRoundTrip(fromBits<T>(mask));
+    for (int i = 0; i < width; ++i)
+    {
+        for (int j = i; j < width; ++j)
+        {
+            const quint64 bits = (1ull << i) | (1ull << j);
+            verifyRoundTrip(fromBits<T>(bits));
+            verifyRoundTrip(fromBits<T>(~bits & mask));
+            if (QTest::currentTestFailed()) return;
+        }
+    }
+}
+
+template <typename T>
+static void verifyRandomPatterns()
+{
+    for (int i = 0; i < FUZZ_ROUNDS; ++i)
+    {
+        verifyRoundTrip(fromBits<T>(nextRandom()));
+        if (QTest::currentTestFailed()) return;
+    }
+}
+
+template <typename T>
+static void verifyIntegers()
+{
+    typedef std::numeric_limits<T> L;
+    const T values[] = { 0, 1, static_cast<T>(-1), L::min(), L::max(),
+                         static_cast<T>(L::min() + 1), static_cast<T>(L::max() - 1) };
+    for (T value : values)
+    {
+        verifyRoundTrip(value);
+        if (QTest::currentTestFailed()) return;
+    }
+    verifySparsePatterns<T>();
+    if (QTest::currentTestFailed()) return;
+    verifyRandomPatterns<T>();
+}
+
+template <typename T>
+static void verifyFloats()
+{
+    typedef std::numeric_limits<T> L;
+    const T values[] = { static_cast<T>(0), -static_cast<T>(0), static_cast<T>(1), static_cast<T>(-1),
+                         L::infinity(), -L::infinity(), L::quiet_NaN(), -L::quiet_NaN(), L::signaling_NaN(),
+                         L::denorm_min(), -L::denorm_min(), L::min(), L::max(), L::lowest(), L::epsilon() };
+    for (T value : values)
+    {
+        verifyRoundTrip(value);
+        if (QTest::currentTestFailed()) return;
+    }
+
+    // The largest denormal, and NaNs carrying a payload
+    const int mantissaBits = L::digits - 1;
+    const quint64 mantissa = (1ull << mantissaBits) - 1;
+    const quint64 exponent = bitsOf(L::infinity());
+    const quint64 sign = 1ull << (sizeof(T) * 8 - 1);
+    const quint64 patterns[] = { mantissa, sign | mantissa, exponent | 0x12345, sign | exponent | 0x12345,
+                                 exponent | 1, exponent | mantissa };
+    for (quint64 bits : patterns)
+    {
+        verifyRoundTrip(fromBits<T>(bits));
+        if (QTest::currentTestFailed()) return;
+    }
+
+    // The values also have to behave as what they are after a round trip
+    char buffer[sizeof(T)];
+    serialize<T>(buffer, -static_cast<T>(0));
+    QVERIFY(std::signbit(deserialize<T>(buffer)) && (deserialize<T>(buffer) == 0));
+    serialize<T>(buffer, L::infinity());
+    QVERIFY(std::isinf(deserialize<T>(buffer)) && (deserialize<T>(buffer) > 0));
+    serialize<T>(buffer, -L::infinity());
+    QVERIFY(std::isinf(deserialize<T>(buffer)) && (deserialize<T>(buffer) < 0));
+    serialize<T>(buffer, L::quiet_NaN());
+    QVERIFY(std::isnan(deserialize<T>(buffer)));
+    serialize<T>(buffer, L::denorm_min());
+    QCOMPARE(std::fpclassify(deserialize<T>(buffer)), FP_SUBNORMAL);
+
+    verifySparsePatterns<T>();
+    if (QTest::currentTestFailed()) return;
+    verifyRandomPatterns<T>();
+}
+
+class TestSerialize : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+
+    void all16BitValues();
+    void int32();
+    void uint32();
+    void int64();
+    void uint64();
+    void floats();
+    void doubles();
+    void knownEncodings();
+    void floatsCarriedAsDoubles();
+    void arrays();
+    void bools();
+
+    void benchmarkDeserialize_data();
+    void benchmarkDeserialize();
+    void benchmarkSerialize_data();
+    void benchmarkSerialize();
+};
+
+void TestSerialize::init()
+{
+    fuzzState = 0x9E3779B97F4A7C15ull;
+}
+
+void TestSerialize::all16BitValues()
+{
+    for (int i = 0; i < 65536; ++i)
+    {
+        verifyRoundTrip(static_cast<qint16>(i));
+        verifyRoundTrip(static_cast<quint16>(i));
+        if (QTest::currentTestFailed()) return;
+    }
+}
+
+void TestSerialize::int32()
+{
+    verifyIntegers<qint32>();
+}
+
+void TestSerialize::uint32()
+{
+    verifyIntegers<quint32>();
+}
+
+void TestSerialize::int64()
+{
+    verifyIntegers<qint64>();
+}
+
+void TestSerialize::uint64()
+{
+    verifyIntegers<quint64>();
+}
+
+void TestSerialize::floats()
+{
+    verifyFloats<float>();
+}
+
+void TestSerialize::doubles()
+{
+    verifyFloats<double>();
+}
+
+void TestSerialize::knownEncodings()
+{
+    char buffer[8];
+    serialize<float>(buffer, 1.0f);
+    QCOMPARE(QByteArray(buffer, 4), QByteArray::fromHex("3F800000"));
+    serialize<double>(buffer, 1.0);
+    QCOMPARE(QByteArray(buffer, 8), QByteArray::fromHex("3FF0000000000000"));
+    serialize<double>(buffer, -std::numeric_limits<double>::infinity());
+    QCOMPARE(QByteArray(buffer, 8), QByteArray::fromHex("FFF0000000000000"));
+    serialize<qint16>(buffer, -2);
+    QCOMPARE(QByteArray(buffer, 2), QByteArray::fromHex("FFFE"));
+    serialize<quint32>(buffer, 0x01020304u);
+    QCOMPARE(QByteArray(buffer, 4), QByteArray::fromHex("01020304"));
+}
+
+void TestSerialize::floatsCarriedAsDoubles()
+{
+    // serializeF() carries floats as doubles, which must keep what makes them special
+    char buffer[8];
+    const float floats[] = { -0.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                             std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(), 0.1f };
+    for (float value : floats)
+    {
+        serializeF(buffer, value);
+        QCOMPARE(bitsOf(static_cast<float>(deserializeF(buffer))), bitsOf(value));
+    }
+    serializeF(buffer, std::numeric_limits<float>::quiet_NaN());
+    QVERIFY(std::isnan(deserializeF(buffer)));
+
+    for (int i = 0; i < FUZZ_ROUNDS; ++i)
+    {
+        const double value = fromBits<double>(nextRandom());
+        serializeF(buffer, value);
+        QCOMPARE(bitsOf(deserializeF(buffer)), bitsOf(value));
+    }
+}
+
+void TestSerialize::arrays()
+{
+    quint16 values[ARRAY_COUNT];
+    double doubles[ARRAY_COUNT];
+    for (int i = 0; i < ARRAY_COUNT; ++i)
+    {
+        values[i] = static_cast<quint16>(nextRandom());
+        doubles[i] = fromBits<double>(nextRandom());
+    }
+
+    // At an odd offset, as values in a received packet usually are
+    char buffer[ARRAY_COUNT * 8 + 1];
+    quint16 decodedValues[ARRAY_COUNT];
+    double decodedDoubles[ARRAY_COUNT];
+
+    serializeArray<quint16>(buffer + 1, values, ARRAY_COUNT);
+    for (int i = 0; i < ARRAY_COUNT; ++i)
+    {
+        QCOMPARE(deserialize<quint16>(buffer + 1 + i * 2), values[i]);
+    }
+    deserializeArray<quint16>(buffer + 1, decodedValues, ARRAY_COUNT);
+    QVERIFY(memcmp(decodedValues, values, sizeof(values)) == 0);
+
+    serializeArray<double>(buffer + 1, doubles, ARRAY_COUNT);
+    deserializeArray<double>(buffer + 1, decodedDoubles, ARRAY_COUNT);
+    QVERIFY(memcmp(decodedDoubles, doubles, sizeof(doubles)) == 0);
+}
+
+void TestSerialize::bools()
+{
+    // Any nonzero byte is true
+    for (int i = 0; i < 256; ++i)
+    {
+        const char byte = static_cast<char>(i);
+        QCOMPARE(deserialize<bool>(&byte), i != 0);
+    }
+}
+
+void TestSerialize::benchmarkDeserialize_data()
+{
+    QTest::addColumn<bool>("array");
+    QTest::newRow("per value") << false;
+    QTest::newRow("deserializeArray") << true;
+}
+
+void TestSerialize::benchmarkDeserialize()
+{
+    QFETCH(bool, array);
+    double values[ARRAY_COUNT];
+    char buffer[ARRAY_COUNT * 8 + 1];
+    for (int i = 0; i < ARRAY_COUNT; ++i)
+    {
+        values[i] = fromBits<double>(nextRandom());
+        serialize<double>(buffer + 1 + i * 8, values[i]);
+    }
+    double decoded[ARRAY_COUNT];
+
+    QBENCHMARK
+    {
+        if (array)
+        {
+            deserializeArray<double>(buffer + 1, decoded, ARRAY_COUNT);
+        }
+        else
+        {
+            for (int i = 0; i < ARRAY_COUNT; ++i)
+            {
+                decoded[i] = deserialize<double>(buffer + 1 + i * 8);
+            }
+        }
+    }
+    QVERIFY(memcmp(decoded, values, sizeof(values)) == 0);
+}
+
+void TestSerialize::benchmarkSerialize_data()
+{
+    QTest::addColumn<bool>("array");
+    QTest::newRow("per value") << false;
+    QTest::newRow("serializeArray") << true;
+}
+
+void TestSerialize::benchmarkSerialize()
+{
+    QFETCH(bool, array);
+    double values[ARRAY_COUNT];
+    for (int i = 0; i < ARRAY_COUNT; ++i)
+    {
+        values[i] = fromBits<double>(nextRandom());
+    }
+    char buffer[ARRAY_COUNT * 8 + 1];
+
+    QBENCHMARK
+    {
+        if (array)
+        {
+            serializeArray<double>(buffer + 1, values, ARRAY_COUNT);
+        }
+        else
+        {
+            for (int i = 0; i < ARRAY_COUNT; ++i)
+            {
+                serialize<double>(buffer + 1 + i * 8, values[i]);
+            }
+        }
+    }
+    QCOMPARE(bitsOf(deserialize<double>(buffer + 1 + (ARRAY_COUNT - 1) * 8)), bitsOf(values[ARRAY_COUNT - 1]));
+}
+
+QTEST_APPLESS_MAIN(TestSerialize)
+
+#include "tst_serialize.moc"
@@ -0,0 +1,11 @@
+TEMPLATE = subdirs
+
+# Each test is run by "make check"
+SUBDIRS =\
+    framebuffer \
+    messagecodec \
+    serialize \
+    byteswap \
+    bitrateallocation \
+    usbcameraindex \
+    bouncelist
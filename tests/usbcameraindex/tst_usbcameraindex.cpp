@@ -0,0 +1,180 @@
+/*
+ * Copyright 2017 Jacob Jordan <doublejinitials@ou.edu>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "soro_videoserver/usbcameraindex.h"
+
+using namespace Soro;
+
+/* Each test builds a sysfs tree laid out like the kernel's: class/video4linux/<node>/device links to the
+ * USB interface of the camera, and the USB device above the interface holds its IDs.
+ */
+class TestUsbCameraIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void findsCamerasByIds();
+    void offsetsFollowNodeNames();
+    void dropsNodesWithoutUsbDevice();
+    void rebuildsOnMiss();
+    void ignoresWhitespace();
+
+private:
+    void addUsbCamera(const QString &node, const QString &port, const QString &vendorId,
+                      const QString &productId, const QString &serial);
+    void addPlatformCamera(const QString &node, const QString &platformDevice);
+    void writeAttribute(const QString &dir, const QString &name, const QString &value);
+
+    QTemporaryDir *_sysfs;
+};
+
+void TestUsbCameraIndex::init()
+{
+    _sysfs = new QTemporaryDir;
+    QVERIFY(_sysfs->isValid());
+    QVERIFY(QDir(_sysfs->path()).mkpath("class/video4linux"));
+}
+
+void TestUsbCameraIndex::cleanup()
+{
+    delete _sysfs;
+}
+
+void TestUsbCameraIndex::writeAttribute(const QString &dir, const QString &name, const QString &value)
+{
+    QFile file(dir + "/" + name);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    // The kernel ends every attribute with a newline
+    file.write((value + "\n").toUtf8());
+}
+
+void TestUsbCameraIndex::addUsbCamera(const QString &node, const QString &port, const QString &vendorId,
+                                      const QString &productId, const QString &serial)
+{
+    QString usbDevice = _sysfs->path() + "/devices/pci0000:00/0000:00:14.0/usb1/" + port;
+    QString usbInterface = usbDevice + "/" + port + ":1.0";
+    QVERIFY(QDir().mkpath(usbInterface + "/video4linux/" + node));
+    writeAttribute(usbDevice, "idVendor", vendorId);
+    writeAttribute(usbDevice, "idProduct", productId);
+    if (!serial.isEmpty())
+    {
+        writeAttribute(usbDevice, "serial", serial);
+    }
+
+    QString classNode = _sysfs->path() + "/class/video4linux/" + node;
+    QVERIFY(QDir().mkpath(classNode));
+    QVERIFY(QFile::link(usbInterface, classNode + "/device"));
+}
+
+void TestUsbCameraIndex::addPlatformCamera(const QString &node, const QString &platformDevice)
+{
+    QString device = _sysfs->path() + "/devices/platform/" + platformDevice;
+    QVERIFY(QDir().mkpath(device + "/video4linux/" + node));
+
+    QString classNode = _sysfs->path() + "/class/video4linux/" + node;
+    QVERIFY(QDir().mkpath(classNode));
+    QVERIFY(QFile::link(device, classNode + "/device"));
+}
+
+void TestUsbCameraIndex::findsCamerasByIds()
+{
+    addUsbCamera("video0", "1-1", "046d", "0825", "AB12");
+    addUsbCamera("video1", "1-2", "046d", "0825", "CD34");
+    addUsbCamera("video2", "1-3", "05a3", "9422", "");
+
+    UsbCameraIndex index(_sysfs->path());
+    QCOMPARE(index.find("046d", "0825", "AB12", 0), QString("video0"));
+    QCOMPARE(index.find("046d", "0825", "CD34", 0), QString("video1"));
+    QCOMPARE(index.find("05a3", "9422", "", 0), QString("video2"));
+    QCOMPARE(index.find("046d", "0825", "EF56", 0), QString());
+    QCOMPARE(index.find("046d", "0826", "AB12", 0), QString());
+}
+
+void TestUsbCameraIndex::offsetsFollowNodeNames()
+{
+    // Identical cameras are told apart by offset, in the order their node names sort in. That is the
+    // order the /dev listing this index replaced used, so configured offsets still pick the same cameras.
+    addUsbCamera("video5", "1-1", "05a3", "9422", "");
+    addUsbCamera("video10", "1-2", "05a3", "9422", "");
+    addUsbCamera("video2", "1-3", "05a3", "9422", "");
+    addUsbCamera("video3", "1-4", "046d", "0825", "AB12");
+
+    UsbCameraIndex index(_sysfs->path());
+    QCOMPARE(index.find("05a3", "9422", "", 0), QString("video10"));
+    QCOMPARE(index.find("05a3", "9422", "", 1), QString("video2"));
+    QCOMPARE(index.find("05a3", "9422", "", 2), QString("video5"));
+    QCOMPARE(index.find("05a3", "9422", "", 3), QString());
+    QCOMPARE(index.find("046d", "0825", "AB12", 0), QString("video3"));
+    QCOMPARE(index.find("046d", "0825", "AB12", 1), QString());
+}
+
+void TestUsbCameraIndex::dropsNodesWithoutUsbDevice()
+{
+    // A camera on a CSI port has no USB device above it. The udevadm search used to match such nodes
+    // whatever IDs were asked for, now they are never matched.
+    addPlatformCamera("video0", "csi0");
+    addUsbCamera("video1", "1-1", "046d", "0825", "AB12");
+
+    UsbCameraIndex index(_sysfs->path());
+    QCOMPARE(index.find("", "", "", 0), QString());
+    QCOMPARE(index.find("046d", "0825", "AB12", 0), QString("video1"));
+    QCOMPARE(index.find("046d", "0825", "AB12", 1), QString());
+}
+
+void TestUsbCameraIndex::rebuildsOnMiss()
+{
+    addUsbCamera("video0", "1-1", "046d", "0825", "AB12");
+
+    UsbCameraIndex index(_sysfs->path());
+    QSignalSpy rebuilt(&index, SIGNAL(changed()));
+
+    // Found cameras are answered from the index
+    QCOMPARE(index.find("046d", "0825", "AB12", 0), QString("video0"));
+    QCOMPARE(rebuilt.count(), 0);
+
+    // A camera plugged in since the index was built is found by rebuilding it
+    addUsbCamera("video1", "1-2", "05a3", "9422", "");
+    QCOMPARE(index.find("05a3", "9422", "", 0), QString("video1"));
+    QCOMPARE(rebuilt.count(), 1);
+
+    // So is a second camera with the same IDs
+    addUsbCamera("video2", "1-3", "046d", "0825", "AB12");
+    QCOMPARE(index.find("046d", "0825", "AB12", 1), QString("video2"));
+    QCOMPARE(rebuilt.count(), 2);
+
+    // And one that is still missing costs a rebuild every time it is asked for
+    QCOMPARE(index.find("1234", "5678", "", 0), QString());
+    QCOMPARE(rebuilt.count(), 3);
+}
+
+void TestUsbCameraIndex::ignoresWhitespace()
+{
+    addUsbCamera("video0", "1-1", "046d", "0825", "AB12");
+
+    UsbCameraIndex index(_sysfs->path());
+    QCOMPARE(index.find(" 046d", "0825 ", "\tAB12\n", 0), QString("video0"));
+}
+
+QTEST_GUILESS_MAIN(TestUsbCameraIndex)
+
+#include "tst_usbcameraindex.moc"
@@ -0,0 +1,24 @@
+# Tests the video server's USB camera index against fake sysfs trees
+QT = core testlib
+
+CONFIG += console c++11 no_keywords testcase
+CONFIG -= app_bundle
+
+TARGET = tst_usbcameraindex
+
+BUILD_DIR = ../../build/tests/usbcameraindex
+DESTDIR = ../../bin/tests
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += tst_usbcameraindex.cpp \
+    ../../soro_videoserver/usbcameraindex.cpp
+
+HEADERS += \
+    ../../soro_videoserver/usbcameraindex.h
+
+# Link against soro_core, found at run time so "make check" works from the build tree
+LIBS += -L../../lib -lsoro_core
+QMAKE_RPATHDIR += $$OUT_PWD/../../lib